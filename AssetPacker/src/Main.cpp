@@ -0,0 +1,68 @@
+#include <BrickEngine.hpp>
+
+#include <filesystem>
+
+using namespace BrickEngine;
+
+// Usage: AssetPacker <output> <directory>... [--compress]
+// Virtual paths are the file paths relative to the working directory, the same paths the engine loads them by.
+int main(int argc, char** argv)
+{
+	std::string output;
+	std::vector<std::string> directories;
+	CompressionType compression = CompressionType::None;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		if (argument == "--compress")
+			compression = CompressionType::LZ4;
+		else if (output.empty())
+			output = argument;
+		else
+			directories.push_back(argument);
+	}
+
+	if (output.empty() || directories.empty())
+	{
+		Log::Error(LogCategory::File, "Usage: AssetPacker <output> <directory>... [--compress]");
+		return 1;
+	}
+
+	AssetPackWriter writer;
+	size_t fileCount = 0;
+	for (auto& directory : directories)
+	{
+		std::error_code errorCode;
+		for (auto& file : std::filesystem::recursive_directory_iterator(directory, errorCode))
+		{
+			if (!file.is_regular_file())
+				continue;
+
+			std::string path = std::filesystem::relative(file.path(), errorCode).generic_string();
+			FileError error = writer.AddFile(path, file.path().string(), compression);
+			if (error != FileError::None)
+			{
+				Log::Error(LogCategory::File, "Failed to add '{}': {}", path, File::GetErrorString(error));
+				return 1;
+			}
+			fileCount++;
+		}
+
+		if (errorCode)
+		{
+			Log::Error(LogCategory::File, "Failed to read directory '{}': {}", directory, errorCode.message());
+			return 1;
+		}
+	}
+
+	FileError error = writer.Write(output);
+	if (error != FileError::None)
+	{
+		Log::Error(LogCategory::File, "Failed to write '{}': {}", output, File::GetErrorString(error));
+		return 1;
+	}
+
+	Log::Info(LogCategory::File, "Packed {} file(s) into '{}'", fileCount, output);
+	return 0;
+}
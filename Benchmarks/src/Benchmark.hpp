@@ -0,0 +1,130 @@
+#pragma once
+
+#include <BrickEngine.hpp>
+
+struct BenchmarkResult
+{
+	std::string Name = {};
+	// Operations timed per sample, every time below is per operation
+	uint64_t Operations = 0;
+	uint32_t Samples = 0;
+	double MinNs = 0.0;
+	double MedianNs = 0.0;
+	double MeanNs = 0.0;
+	double P99Ns = 0.0;
+};
+
+// Collects the results of every benchmark a group measures
+class BenchmarkRunner
+{
+public:
+	BenchmarkRunner(uint32_t samples, uint32_t warmupSamples)
+		: m_Samples(samples), m_WarmupSamples(warmupSamples)
+	{
+	}
+
+	// Calls function warmup + sample times, function does operations operations per call. Return values are consumed so
+	// the work can't be optimized away.
+	template<typename Function>
+	void Measure(const std::string& name, uint64_t operations, Function&& function)
+	{
+		Measure(name, operations, []() {}, function);
+	}
+
+	// Same as above with setup called before every call to function, outside of the timed part
+	template<typename Setup, typename Function>
+	void Measure(const std::string& name, uint64_t operations, Setup&& setup, Function&& function)
+	{
+		using namespace std::chrono;
+
+		uint32_t samples = m_MaxSamples > 0 && m_MaxSamples < m_Samples ? m_MaxSamples : m_Samples;
+		uint32_t warmupSamples = m_MaxSamples > 0 && m_MaxSamples < m_WarmupSamples ? m_MaxSamples : m_WarmupSamples;
+		m_WarmingUp = true;
+		for (uint32_t i = 0; i < warmupSamples; i++)
+		{
+			setup();
+			Consume(function());
+		}
+		m_WarmingUp = false;
+
+		m_Times.clear();
+		for (uint32_t i = 0; i < samples; i++)
+		{
+			setup();
+			steady_clock::time_point start = steady_clock::now();
+			uint64_t result = function();
+			steady_clock::time_point end = steady_clock::now();
+			Consume(result);
+			m_Times.push_back(duration<double, std::nano>(end - start).count() / operations);
+		}
+		AddResult(name, operations);
+	}
+
+	// Adds a result for times measured elsewhere, one per operation, like the latencies of individual requests
+	void Record(const std::string& name, const std::vector<double>& timesNs)
+	{
+		m_Times = timesNs;
+		AddResult(name, 1);
+	}
+
+	// Caps the samples and warmup samples of the benchmarks measured after it, for the ones that take seconds per call.
+	// 0 removes the cap.
+	void SetMaxSamples(uint32_t maxSamples) { m_MaxSamples = maxSamples; }
+
+	// True while Measure runs the warmup calls, for functions collecting their own measurements for Record
+	bool IsWarmingUp() const { return m_WarmingUp; }
+
+	void Consume(uint64_t value) { m_Sink = m_Sink + value; }
+
+	const std::vector<BenchmarkResult>& GetResults() const { return m_Results; }
+private:
+	void AddResult(const std::string& name, uint64_t operations);
+private:
+	uint32_t m_Samples = 0;
+	uint32_t m_WarmupSamples = 0;
+	uint32_t m_MaxSamples = 0;
+	bool m_WarmingUp = false;
+	std::vector<double> m_Times = {};
+	std::vector<BenchmarkResult> m_Results = {};
+	volatile uint64_t m_Sink = 0;
+};
+
+using BenchmarkFunction = void(*)(BenchmarkRunner& runner);
+
+struct BenchmarkGroup
+{
+	const char* Name = nullptr;
+	BenchmarkFunction Function = nullptr;
+};
+
+// Groups register themselves before main runs, in no particular order
+std::vector<BenchmarkGroup>& GetBenchmarkGroups();
+
+struct BenchmarkRegistration
+{
+	BenchmarkRegistration(const char* name, BenchmarkFunction function) { GetBenchmarkGroups().push_back({ name, function }); }
+};
+
+#define BENCHMARK_GROUP(name) \
+	static void CONCAT(Benchmark, name)(BenchmarkRunner& runner); \
+	static BenchmarkRegistration CONCAT(s_Registration, name)(#name, &CONCAT(Benchmark, name)); \
+	static void CONCAT(Benchmark, name)(BenchmarkRunner& runner)
+
+// Small, fast and the same sequence on every platform, unlike the standard distributions
+class BenchmarkRandom
+{
+public:
+	BenchmarkRandom(uint64_t seed = 0x9e3779b97f4a7c15ull) : m_State(seed) {}
+
+	uint64_t Next()
+	{
+		m_State ^= m_State << 13;
+		m_State ^= m_State >> 7;
+		m_State ^= m_State << 17;
+		return m_State;
+	}
+
+	uint32_t Next(uint32_t bound) { return static_cast<uint32_t>(Next() % bound); }
+private:
+	uint64_t m_State;
+};
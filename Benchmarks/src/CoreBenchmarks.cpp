@@ -0,0 +1,368 @@
+#include "Benchmark.hpp"
+
+#include "BrickEngine/Core/TLSFAllocator.hpp"
+#include "BrickEngine/Core/Compression.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+using namespace BrickEngine;
+
+BENCHMARK_GROUP(JobSystem)
+{
+	const uint32_t jobCount = 10000;
+	runner.Measure("JobSystem/Schedule and wait 10k empty jobs", jobCount, [&]()
+		{
+			JobCounter counter;
+			for (uint32_t i = 0; i < jobCount; i++)
+				JobSystem::Schedule([]() {}, &counter);
+			JobSystem::Wait(counter);
+			return uint64_t(jobCount);
+		}
+	);
+
+	std::vector<float> values(1 << 22, 1.0f);
+	runner.Measure("JobSystem/ParallelFor 4M floats", values.size(), [&]()
+		{
+			JobSystem::ParallelFor(values.size(), [&](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; i++)
+						values[i] = std::sqrt(values[i] * 1.0001f + 0.5f);
+				}
+			);
+			return static_cast<uint64_t>(values[values.size() / 2]);
+		}
+	);
+
+	// Scheduling overhead per job. Batches stay under the deque capacity, past it Schedule runs jobs inline.
+	const uint32_t batchSize = 1000;
+	runner.Measure("JobSystem/Schedule and wait batches of 1k empty jobs", batchSize, [&]()
+		{
+			JobCounter counter;
+			for (uint32_t i = 0; i < batchSize; i++)
+				JobSystem::Schedule([]() {}, &counter);
+			JobSystem::Wait(counter);
+			return uint64_t(batchSize);
+		}
+	);
+	runner.Measure("JobSystem/Schedule and wait 1 empty job", batchSize, [&]()
+		{
+			for (uint32_t i = 0; i < batchSize; i++)
+			{
+				JobCounter counter;
+				JobSystem::Schedule([]() {}, &counter);
+				JobSystem::Wait(counter);
+			}
+			return uint64_t(batchSize);
+		}
+	);
+	runner.Measure("JobSystem/ParallelFor 64k empty chunks", 64 * 1024, [&]()
+		{
+			std::atomic<uint64_t> chunkCount = 0;
+			JobSystem::ParallelFor(64 * 1024, [&](size_t, size_t) { chunkCount.fetch_add(1, std::memory_order_relaxed); }, 1);
+			return chunkCount.load();
+		}
+	);
+}
+
+// Restarts the job system with 1, 2, 4... workers up to one per hardware thread and runs the same work on each
+BENCHMARK_GROUP(JobSystemScaling)
+{
+	uint32_t maxWorkerCount = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<uint32_t> workerCounts;
+	for (uint32_t workerCount = 1; workerCount < maxWorkerCount; workerCount *= 2)
+		workerCounts.push_back(workerCount);
+	workerCounts.push_back(maxWorkerCount);
+
+	std::vector<float> values(1 << 22, 1.0f);
+	const uint32_t jobCount = 4096;
+	std::vector<float> results(jobCount);
+	for (uint32_t workerCount : workerCounts)
+	{
+		JobSystem::Shutdown();
+		JobSystem::Init(workerCount);
+
+		std::string suffix = ", " + std::to_string(workerCount) + " worker(s)";
+		runner.Measure("JobSystemScaling/ParallelFor 4M floats" + suffix, values.size(), [&]()
+			{
+				JobSystem::ParallelFor(values.size(), [&](size_t begin, size_t end)
+					{
+						for (size_t i = begin; i < end; i++)
+							values[i] = std::sqrt(values[i] * 1.0001f + 0.5f);
+					}
+				);
+				return static_cast<uint64_t>(values[values.size() / 2]);
+			}
+		);
+		runner.Measure("JobSystemScaling/4k jobs of 1000 sqrt steps" + suffix, jobCount, [&]()
+			{
+				JobCounter counter;
+				for (uint32_t i = 0; i < jobCount; i++)
+				{
+					JobSystem::Schedule([&results, i]()
+						{
+							float value = static_cast<float>(i);
+							for (uint32_t j = 0; j < 1000; j++)
+								value = std::sqrt(value * 1.0001f + 0.5f);
+							results[i] = value;
+						},
+						&counter
+					);
+				}
+				JobSystem::Wait(counter);
+				return static_cast<uint64_t>(results[jobCount / 2]);
+			}
+		);
+	}
+
+	JobSystem::Shutdown();
+	JobSystem::Init();
+}
+
+// Keeps a working set of live allocations and replaces a random one each step, the pattern a streaming allocator sees
+template<typename Allocate, typename Free>
+static uint64_t ChurnAllocations(const std::vector<uint32_t>& sizes, uint32_t liveCount, Allocate&& allocate, Free&& free)
+{
+	using Handle = decltype(allocate(0u));
+	std::vector<Handle> live;
+	live.reserve(liveCount);
+	for (uint32_t i = 0; i < liveCount; i++)
+		live.push_back(allocate(sizes[i]));
+
+	BenchmarkRandom random;
+	for (size_t i = liveCount; i < sizes.size(); i++)
+	{
+		Handle& handle = live[random.Next(liveCount)];
+		free(handle);
+		handle = allocate(sizes[i]);
+	}
+
+	for (auto& handle : live)
+		free(handle);
+	return sizes.size();
+}
+
+BENCHMARK_GROUP(TLSFAllocator)
+{
+	const uint32_t liveCount = 4096;
+	std::vector<uint32_t> sizes(100000);
+	BenchmarkRandom random;
+	for (auto& size : sizes)
+		size = 16 + random.Next(64 * 1024);
+
+	TLSFAllocator allocator(uint64_t(1) << 32);
+	runner.Measure("TLSFAllocator/Allocate and free random sizes", sizes.size() - liveCount, [&]()
+		{
+			return ChurnAllocations(sizes, liveCount,
+				[&](uint32_t size) { return allocator.Allocate(size, 256); },
+				[&](const TLSFAllocation& allocation) { allocator.Free(allocation); }
+			);
+		}
+	);
+
+	// Baseline for the same sequence, general purpose heaps are what the allocator replaces
+	runner.Measure("TLSFAllocator/malloc and free baseline", sizes.size() - liveCount, [&]()
+		{
+			return ChurnAllocations(sizes, liveCount,
+				// Touching the memory keeps the pair from being optimized out
+				[](uint32_t size) { void* pointer = std::malloc(size); static_cast<volatile uint8_t*>(pointer)[0] = 1; return pointer; },
+				[](void* pointer) { std::free(pointer); }
+			);
+		}
+	);
+}
+
+BENCHMARK_GROUP(Compression)
+{
+	// Text like data with a limited alphabet and repeated words, compresses about as well as shader sources
+	const char* words[] = { "layout", "binding", "uniform", "vec4", "float", "return", "void", "main", "in", "out", "{", "}", ";", "\n" };
+	std::string source;
+	BenchmarkRandom random;
+	while (source.size() < 4 * 1024 * 1024)
+	{
+		source += words[random.Next(static_cast<uint32_t>(std::size(words)))];
+		source += ' ';
+	}
+
+	std::vector<uint8_t> compressed(Compression::GetCompressBound(source.size()));
+	size_t compressedSize = 0;
+	runner.Measure("Compression/Compress 4 MiB (ops are bytes)", source.size(), [&]()
+		{
+			compressedSize = Compression::Compress(source.data(), source.size(), compressed.data(), compressed.size());
+			return static_cast<uint64_t>(compressedSize);
+		}
+	);
+
+	std::vector<uint8_t> decompressed(source.size());
+	runner.Measure("Compression/Decompress 4 MiB (ops are bytes)", source.size(), [&]()
+		{
+			bool success = Compression::Decompress(compressed.data(), compressedSize, decompressed.data(), decompressed.size());
+			return static_cast<uint64_t>(success) + decompressed[decompressed.size() / 2];
+		}
+	);
+}
+
+BENCHMARK_GROUP(EventQueue)
+{
+	EventQueue queue;
+	runner.Measure("EventQueue/Push and pop 256 key events", EventQueue::Capacity, [&]()
+		{
+			Event event;
+			event.Type = EventType::KeyPressed;
+			for (uint32_t i = 0; i < EventQueue::Capacity; i++)
+			{
+				event.Key = { static_cast<KeyCode>(1 + i % 26), false };
+				queue.Push(event);
+			}
+
+			uint64_t checksum = 0;
+			while (queue.Pop(event))
+				checksum += static_cast<uint64_t>(event.Key.Code);
+			return checksum;
+		}
+	);
+}
+
+BENCHMARK_GROUP(Log)
+{
+	const uint32_t callCount = 1000000;
+	std::vector<uint32_t> values(callCount);
+	BenchmarkRandom random;
+	for (auto& value : values)
+		value = random.Next(1000);
+
+	// The loops below should all time the same as this one. Trace is compiled out unless the log level is Trace, which
+	// is only the default in Debug, and filtered out by the category level there.
+	runner.Measure("Log/Baseline loop", callCount, [&]()
+		{
+			uint64_t sum = 0;
+			for (uint32_t value : values)
+				sum += value;
+			return sum;
+		}
+	);
+
+	LogLevel level = Log::GetLevel(LogCategory::Core);
+	Log::SetLevel(LogCategory::Core, LogLevel::Info);
+
+	runner.Measure("Log/Disabled Trace", callCount, [&]()
+		{
+			uint64_t sum = 0;
+			for (uint32_t value : values)
+			{
+				Log::Trace(LogCategory::Core, "Value {}", value);
+				sum += value;
+			}
+			return sum;
+		}
+	);
+
+	// The macro also skips evaluating the arguments
+	runner.Measure("Log/Disabled BRICKENGINE_LOG_TRACE", callCount, [&]()
+		{
+			uint64_t sum = 0;
+			for (uint32_t value : values)
+			{
+				BRICKENGINE_LOG_TRACE(LogCategory::Core, "Value {}", std::to_string(value));
+				sum += value;
+			}
+			return sum;
+		}
+	);
+
+	// More records than fit in the thread's buffer, so this is bound by the logging thread formatting them. There are no
+	// sinks to write to.
+	std::shared_ptr<LogSink> consoleSink = Log::GetConsoleSink();
+	Log::RemoveSink(consoleSink);
+
+	const uint32_t enabledCallCount = 10000;
+	runner.Measure("Log/Enabled Info sustained, without sinks", enabledCallCount, [&]()
+		{
+			uint64_t sum = 0;
+			for (uint32_t i = 0; i < enabledCallCount; i++)
+			{
+				Log::Info(LogCategory::Core, "Value {}", values[i]);
+				sum += values[i];
+			}
+			return sum;
+		}
+	);
+
+	Log::Flush();
+	Log::AddSink(consoleSink);
+	Log::SetLevel(LogCategory::Core, level);
+}
+
+// Producers logging at once, against the Log that wrote every line through std::cout with std::endl under a mutex. Both
+// write to files, std::cout is pointed at one for the run. Log::Info returns once the record is queued, the backlog the
+// logging thread still has to write is flushed between samples.
+BENCHMARK_GROUP(LogProducers)
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "BrickEngineBenchmarks";
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	std::string logFilepath = (directory / "LogProducers.log").string();
+	std::string coutFilepath = (directory / "LogProducersCout.log").string();
+
+	std::shared_ptr<LogSink> consoleSink = Log::GetConsoleSink();
+	Log::RemoveSink(consoleSink);
+	std::shared_ptr<LogSink> fileSink = std::make_shared<FileLogSink>(logFilepath);
+	Log::AddSink(fileSink);
+	LogLevel level = Log::GetLevel(LogCategory::Core);
+	Log::SetLevel(LogCategory::Core, LogLevel::Info);
+
+	std::ofstream coutFile(coutFilepath, std::ios::trunc);
+	std::streambuf* coutBuffer = std::cout.rdbuf(coutFile.rdbuf());
+	std::mutex coutMutex;
+
+	const uint32_t callsPerThread = 2000;
+	for (uint32_t threadCount : { 1u, 4u, 16u })
+	{
+		auto runProducers = [&](auto&& produce)
+		{
+			std::vector<std::thread> threads;
+			for (uint32_t thread = 0; thread < threadCount; thread++)
+			{
+				threads.emplace_back([&, thread]()
+					{
+						for (uint32_t i = 0; i < callsPerThread; i++)
+							produce(thread, i);
+					}
+				);
+			}
+			for (auto& thread : threads)
+				thread.join();
+			return uint64_t(threadCount) * callsPerThread;
+		};
+
+		std::string suffix = ", " + std::to_string(threadCount) + " thread(s)";
+		uint64_t callCount = uint64_t(threadCount) * callsPerThread;
+		runner.Measure("LogProducers/Log::Info into a file sink" + suffix, callCount, []() { Log::Flush(); }, [&]()
+			{
+				return runProducers([](uint32_t thread, uint32_t i) { Log::Info(LogCategory::Core, "Thread {} value {}", thread, i); });
+			}
+		);
+		runner.Measure("LogProducers/std::cout with std::endl" + suffix, callCount, [&]()
+			{
+				return runProducers([&](uint32_t thread, uint32_t i)
+					{
+						std::lock_guard<std::mutex> lock(coutMutex);
+						std::cout << "[INFO] [Core]: Thread " << thread << " value " << i << std::endl;
+					}
+				);
+			}
+		);
+	}
+
+	std::cout.rdbuf(coutBuffer);
+	coutFile.close();
+	Log::Flush();
+	Log::RemoveSink(fileSink);
+	fileSink.reset();
+	Log::AddSink(consoleSink);
+	Log::SetLevel(LogCategory::Core, level);
+
+	std::filesystem::remove(logFilepath, error);
+	std::filesystem::remove(coutFilepath, error);
+}
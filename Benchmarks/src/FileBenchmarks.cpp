@@ -0,0 +1,306 @@
+#include "Benchmark.hpp"
+
+#include <filesystem>
+
+#if defined(BRICKENGINE_PLATFORM_WINDOWS)
+	#include <Windows.h>
+#elif defined(BRICKENGINE_PLATFORM_LINUX)
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+using namespace BrickEngine;
+
+// Drops the file from the OS page cache so the next read comes from the disk. Returns false when the platform has no
+// way to do that without elevated rights.
+static bool EvictFromPageCache(const std::string& filepath)
+{
+#if defined(BRICKENGINE_PLATFORM_WINDOWS)
+	// Opening a file unbuffered flushes and invalidates its cached pages
+	HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	CloseHandle(file);
+	return true;
+#elif defined(BRICKENGINE_PLATFORM_LINUX)
+	int file = open(filepath.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+	// Dirty pages aren't dropped, the file was written just before
+	bool evicted = fdatasync(file) == 0 && posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0;
+	close(file);
+	return evicted;
+#else
+	return false;
+#endif
+}
+
+static bool WriteTestFile(const std::string& filepath, uint64_t size)
+{
+	std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+	std::vector<uint64_t> chunk(1024 * 1024 / sizeof(uint64_t));
+	uint64_t chunkSize = chunk.size() * sizeof(uint64_t);
+	BenchmarkRandom random;
+	for (uint64_t written = 0; file && written < size; written += chunkSize)
+	{
+		for (auto& value : chunk)
+			value = random.Next();
+		uint64_t remaining = size - written;
+		file.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(remaining < chunkSize ? remaining : chunkSize));
+	}
+	return static_cast<bool>(file);
+}
+
+// Reads one byte per page, a mapped file is only read from the disk when its pages are touched
+static uint64_t TouchPages(const char* data, size_t size)
+{
+	uint64_t sum = 0;
+	for (size_t i = 0; i < size; i += 4096)
+		sum += static_cast<uint8_t>(data[i]);
+	return sum;
+}
+
+// LoadFile is the buffered read every asset went through before MapFile, both read the whole file. Cold reads need the
+// page cache dropped between samples and are skipped where that isn't possible.
+BENCHMARK_GROUP(FileLoad)
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "BrickEngineBenchmarks";
+	std::filesystem::create_directories(directory);
+
+	const uint64_t sizes[] = { 4ull << 10, 64ull << 10, 1ull << 20, 16ull << 20, 256ull << 20, 1ull << 30 };
+	const char* sizeNames[] = { "4 KiB", "64 KiB", "1 MiB", "16 MiB", "256 MiB", "1 GiB" };
+	for (size_t i = 0; i < std::size(sizes); i++)
+	{
+		uint64_t size = sizes[i];
+		std::string filepath = (directory / ("FileLoad" + std::to_string(i) + ".bin")).string();
+		std::error_code spaceError;
+		if (std::filesystem::space(directory, spaceError).available < size * 2 || !WriteTestFile(filepath, size))
+		{
+			std::printf("FileLoad/%s skipped, couldn't write the file to '%s'\n", sizeNames[i], directory.string().c_str());
+			continue;
+		}
+
+		// A few samples are plenty for reads that take a second
+		runner.SetMaxSamples(size >= (256ull << 20) ? 3 : 0);
+
+		std::vector<char> data;
+		auto load = [&]()
+		{
+			FileError error = File::LoadFile(filepath, data);
+			return error == FileError::None ? TouchPages(data.data(), data.size()) : 0;
+		};
+		auto map = [&]()
+		{
+			FileView view;
+			FileError error = File::MapFile(filepath, view);
+			return error == FileError::None ? TouchPages(view.GetData(), view.GetSize()) : 0;
+		};
+
+		std::string prefix = std::string("FileLoad/") + sizeNames[i];
+		runner.Measure(prefix + " LoadFile warm (ops are bytes)", size, load);
+		runner.Measure(prefix + " MapFile warm (ops are bytes)", size, map);
+		if (EvictFromPageCache(filepath))
+		{
+			auto evict = [&]() { EvictFromPageCache(filepath); };
+			runner.Measure(prefix + " LoadFile cold (ops are bytes)", size, evict, load);
+			runner.Measure(prefix + " MapFile cold (ops are bytes)", size, evict, map);
+		}
+
+		data = {};
+		std::filesystem::remove(filepath, spaceError);
+	}
+
+	runner.SetMaxSamples(0);
+	std::error_code removeError;
+	std::filesystem::remove(directory, removeError);
+}
+
+// Thousands of reads of 4 KiB to 256 KiB at random offsets of a 256 MiB file, all in flight at once. Times the whole
+// batch for the throughput. The latency results are per read, from submission to completion, over every timed batch.
+BENCHMARK_GROUP(AsyncFile)
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "BrickEngineBenchmarks";
+	std::filesystem::create_directories(directory);
+
+	const uint64_t fileSize = 256ull << 20;
+	std::string filepath = (directory / "AsyncFile.bin").string();
+	std::error_code spaceError;
+	if (std::filesystem::space(directory, spaceError).available < fileSize * 2 || !WriteTestFile(filepath, fileSize))
+	{
+		std::printf("AsyncFile skipped, couldn't write the file to '%s'\n", directory.string().c_str());
+		return;
+	}
+	std::printf("AsyncFile backend: %s\n", AsyncFile::GetBackendName());
+
+	const uint32_t readCounts[] = { 1000, 4000 };
+	for (uint32_t readCount : readCounts)
+	{
+		std::vector<uint64_t> offsets(readCount);
+		std::vector<size_t> sizes(readCount);
+		uint64_t totalSize = 0;
+		BenchmarkRandom random;
+		for (uint32_t i = 0; i < readCount; i++)
+		{
+			sizes[i] = 4096 << random.Next(7);
+			offsets[i] = random.Next() % (fileSize - sizes[i]);
+			totalSize += sizes[i];
+		}
+
+		std::vector<char> buffer(totalSize);
+		std::vector<AsyncFileHandle> requests(readCount);
+		std::vector<double> latencies;
+		auto readAll = [&]()
+		{
+			size_t bufferOffset = 0;
+			for (uint32_t i = 0; i < readCount; i++)
+			{
+				requests[i] = AsyncFile::Read(filepath, offsets[i], buffer.data() + bufferOffset, sizes[i]);
+				bufferOffset += sizes[i];
+			}
+
+			uint64_t bytesRead = 0;
+			for (auto& request : requests)
+			{
+				request->Wait();
+				bytesRead += request->GetBytesRead();
+				if (!runner.IsWarmingUp())
+					latencies.push_back(request->GetLatency() * 1e9);
+			}
+			return bytesRead;
+		};
+
+		std::string prefix = "AsyncFile/" + std::to_string(readCount) + " reads";
+		runner.Measure(prefix + " warm (ops are bytes)", totalSize, readAll);
+		runner.Record(prefix + " warm latency", latencies);
+
+		if (EvictFromPageCache(filepath))
+		{
+			latencies.clear();
+			runner.SetMaxSamples(5);
+			runner.Measure(prefix + " cold (ops are bytes)", totalSize, [&]() { EvictFromPageCache(filepath); }, readAll);
+			runner.Record(prefix + " cold latency", latencies);
+			runner.SetMaxSamples(0);
+		}
+	}
+
+	std::filesystem::remove(filepath, spaceError);
+	std::error_code removeError;
+	std::filesystem::remove(directory, removeError);
+}
+
+// 10k small assets as loose files and in packs, opened and resolved through the File API the way the engine loads them.
+// The packed numbers include mounting the pack.
+BENCHMARK_GROUP(AssetPack)
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "BrickEngineBenchmarks" / "AssetPack";
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+
+	const uint32_t assetCount = 10000;
+	std::vector<std::string> paths;
+	AssetPackWriter writer;
+	AssetPackWriter compressedWriter;
+	BenchmarkRandom random;
+	for (uint32_t i = 0; i < assetCount; i++)
+	{
+		std::filesystem::path path = directory / ("Folder" + std::to_string(i / 100)) / ("Asset" + std::to_string(i) + ".glsl");
+		std::filesystem::create_directories(path.parent_path(), error);
+
+		std::vector<char> data;
+		uint32_t size = 512 + random.Next(8 * 1024);
+		while (data.size() < size)
+		{
+			std::string line = "layout(location = " + std::to_string(random.Next(16)) + ") in vec4 value;\n";
+			data.insert(data.end(), line.begin(), line.end());
+		}
+
+		paths.push_back(path.generic_string());
+		if (File::WriteFile(paths.back(), data.data(), data.size()) != FileError::None)
+		{
+			std::printf("AssetPack skipped, couldn't write '%s'\n", paths.back().c_str());
+			return;
+		}
+		writer.AddData(paths.back(), data);
+		compressedWriter.AddData(paths.back(), std::move(data), CompressionType::LZ4);
+	}
+
+	std::string packFilepath = (directory / "Assets.bpak").string();
+	std::string compressedPackFilepath = (directory / "AssetsCompressed.bpak").string();
+	if (writer.Write(packFilepath) != FileError::None || compressedWriter.Write(compressedPackFilepath) != FileError::None)
+	{
+		std::printf("AssetPack skipped, couldn't write the packs to '%s'\n", directory.string().c_str());
+		return;
+	}
+
+	auto openLoose = [&]()
+	{
+		uint64_t size = 0;
+		for (auto& path : paths)
+		{
+			FileView view;
+			if (File::MapFile(path, view) == FileError::None)
+				size += view.GetSize() + static_cast<uint8_t>(view.GetData()[0]);
+		}
+		return size;
+	};
+	auto openPacked = [&](const std::string& filepath)
+	{
+		File::MountPack(filepath);
+		uint64_t size = openLoose();
+		File::UnmountPack(filepath);
+		return size;
+	};
+	auto openPack = [&]() { return openPacked(packFilepath); };
+	auto openCompressedPack = [&]() { return openPacked(compressedPackFilepath); };
+
+	runner.Measure("AssetPack/Open 10k loose assets warm", assetCount, openLoose);
+	runner.Measure("AssetPack/Open 10k packed assets warm", assetCount, openPack);
+	runner.Measure("AssetPack/Open 10k LZ4 packed assets warm", assetCount, openCompressedPack);
+
+	if (EvictFromPageCache(packFilepath))
+	{
+		runner.SetMaxSamples(5);
+		runner.Measure("AssetPack/Open 10k loose assets cold", assetCount, [&]()
+			{
+				for (auto& path : paths)
+					EvictFromPageCache(path);
+			},
+			openLoose
+		);
+		runner.Measure("AssetPack/Open 10k packed assets cold", assetCount, [&]() { EvictFromPageCache(packFilepath); }, openPack);
+		runner.Measure("AssetPack/Open 10k LZ4 packed assets cold", assetCount, [&]() { EvictFromPageCache(compressedPackFilepath); }, openCompressedPack);
+		runner.SetMaxSamples(0);
+	}
+
+	// Ranges of a large compressed entry only decompress the blocks they overlap
+	std::string largePath = (directory / "Large.glsl").generic_string();
+	std::string largePackFilepath = (directory / "Large.bpak").string();
+	std::vector<char> large;
+	while (large.size() < (16 << 20))
+	{
+		std::string line = "layout(location = " + std::to_string(random.Next(16)) + ") in vec4 value;\n";
+		large.insert(large.end(), line.begin(), line.end());
+	}
+	AssetPackWriter largeWriter;
+	largeWriter.AddData(largePath, large, CompressionType::LZ4);
+	if (largeWriter.Write(largePackFilepath) == FileError::None && File::MountPack(largePackFilepath) == FileError::None)
+	{
+		const uint32_t readCount = 1000;
+		std::vector<char> buffer(4096);
+		runner.Measure("AssetPack/ReadFileRange 4 KiB of a 16 MiB LZ4 entry", readCount, [&]()
+			{
+				uint64_t sum = 0;
+				for (uint32_t i = 0; i < readCount; i++)
+				{
+					size_t bytesRead = 0;
+					File::ReadFileRange(largePath, random.Next(static_cast<uint32_t>(large.size() - buffer.size())), buffer.data(), buffer.size(), bytesRead);
+					sum += bytesRead + static_cast<uint8_t>(buffer[0]);
+				}
+				return sum;
+			}
+		);
+		File::UnmountPack(largePackFilepath);
+	}
+
+	std::filesystem::remove_all(directory, error);
+}
@@ -0,0 +1,96 @@
+#include "Benchmark.hpp"
+
+using namespace BrickEngine;
+
+std::vector<BenchmarkGroup>& GetBenchmarkGroups()
+{
+	static std::vector<BenchmarkGroup> groups;
+	return groups;
+}
+
+void BenchmarkRunner::AddResult(const std::string& name, uint64_t operations)
+{
+	BenchmarkResult& result = m_Results.emplace_back();
+	result.Name = name;
+	result.Operations = operations;
+	result.Samples = static_cast<uint32_t>(m_Times.size());
+
+	std::sort(m_Times.begin(), m_Times.end());
+	result.MinNs = m_Times.front();
+	result.MedianNs = m_Times[m_Times.size() / 2];
+	result.P99Ns = m_Times[std::min(m_Times.size() - 1, m_Times.size() * 99 / 100)];
+	for (double time : m_Times)
+		result.MeanNs += time;
+	result.MeanNs /= m_Times.size();
+
+	std::printf("%-48s %12.2f %12.2f %12.2f %12.2f %12.2f\n", name.c_str(), result.MinNs, result.MedianNs, result.MeanNs, result.P99Ns, 1000.0 / result.MedianNs);
+	std::fflush(stdout);
+}
+
+static bool WriteJson(const std::string& filepath, const std::vector<BenchmarkResult>& results)
+{
+	std::stringstream json;
+	json << "[\n";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchmarkResult& result = results[i];
+		json << "\t{ \"name\": \"" << result.Name << "\", \"operations\": " << result.Operations << ", \"samples\": " << result.Samples
+			<< ", \"min_ns\": " << result.MinNs << ", \"median_ns\": " << result.MedianNs << ", \"mean_ns\": " << result.MeanNs
+			<< ", \"p99_ns\": " << result.P99Ns << " }" << (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	json << "]\n";
+
+	std::string contents = json.str();
+	return File::WriteFile(filepath, contents.data(), contents.size()) == FileError::None;
+}
+
+// Usage: Benchmarks [group...] [--samples count] [--json output] [--list]
+// Runs every group whose name contains one of the given names, all of them when none are given. The Renderer group
+// needs a Vulkan device and the Sandbox assets, run it from the Sandbox directory.
+int main(int argc, char** argv)
+{
+	std::vector<std::string> filters;
+	std::string jsonPath;
+	uint32_t samples = 30;
+	bool list = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+			samples = std::max(atoi(argv[++i]), 1);
+		else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+			jsonPath = argv[++i];
+		else if (strcmp(argv[i], "--list") == 0)
+			list = true;
+		else
+			filters.push_back(argv[i]);
+	}
+
+	std::vector<BenchmarkGroup> groups = GetBenchmarkGroups();
+	std::sort(groups.begin(), groups.end(), [](const BenchmarkGroup& a, const BenchmarkGroup& b) { return strcmp(a.Name, b.Name) < 0; });
+	if (list)
+	{
+		for (auto& group : groups)
+			std::printf("%s\n", group.Name);
+		return 0;
+	}
+
+	JobSystem::Init();
+
+	BenchmarkRunner runner(samples, 3);
+	std::printf("%-48s %12s %12s %12s %12s %12s\n", "Benchmark", "Min ns/op", "Median ns/op", "Mean ns/op", "P99 ns/op", "Mops/s");
+	for (auto& group : groups)
+	{
+		bool selected = filters.empty() || std::any_of(filters.begin(), filters.end(), [&](const std::string& filter) { return strstr(group.Name, filter.c_str()) != nullptr; });
+		if (selected)
+			group.Function(runner);
+	}
+
+	JobSystem::Shutdown();
+
+	if (!jsonPath.empty() && !WriteJson(jsonPath, runner.GetResults()))
+	{
+		Log::Error(LogCategory::File, "Failed to write '{}'", jsonPath);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,235 @@
+#include "Benchmark.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanRenderer.hpp"
+
+#include <filesystem>
+
+using namespace BrickEngine;
+
+static void DrawQuads(VulkanBatchRenderer* batchRenderer, uint32_t size)
+{
+	batchRenderer->SetOrthographic(0.0f, static_cast<float>(size), 0.0f, static_cast<float>(size));
+	for (uint32_t y = 0; y < size; y++)
+	{
+		for (uint32_t x = 0; x < size; x++)
+			batchRenderer->DrawQuad(x + 0.5f, y + 0.5f, 0.5f, 0.8f, 0.8f, 0xff000000 | (x & 0xff) | ((y & 0xff) << 8), 0.0f);
+	}
+}
+
+// Headless, so the numbers don't depend on the compositor or vsync. Frames overlap with the GPU like they do in the
+// Sandbox, what is timed is the CPU side of a frame including any wait for a frame in flight.
+BENCHMARK_GROUP(Renderer)
+{
+	VulkanRenderer renderer(VkExtent2D{ 1280, 720 });
+
+	runner.Measure("Renderer/Empty frame", 1, [&]()
+		{
+			if (renderer.BeginFrame())
+				renderer.EndFrame();
+			return renderer.GetFrameNumber();
+		}
+	);
+
+	for (uint32_t size : { 100u, 316u, 1000u })
+	{
+		uint32_t quadCount = size * size;
+		runner.Measure("Renderer/Record and submit " + std::to_string(quadCount) + " quads (ops are quads)", quadCount, [&]()
+			{
+				if (renderer.BeginFrame())
+				{
+					DrawQuads(renderer.GetBatchRenderer(), size);
+					renderer.EndFrame();
+				}
+				return static_cast<uint64_t>(renderer.GetFrameStats().Batches.DrawCalls);
+			}
+		);
+	}
+
+	if (VulkanMeshRenderer* meshRenderer = renderer.GetMeshRenderer())
+	{
+		VulkanMeshVertex vertices[3] = {};
+		uint32_t indices[3] = { 0, 1, 2 };
+		VulkanMeshHandle triangle = meshRenderer->CreateMesh(vertices, 3, indices, 3);
+		float transform[16] = {
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f
+		};
+		const uint32_t objectCount = 10000;
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			transform[12] = static_cast<float>(i % 100);
+			transform[14] = static_cast<float>(i / 100);
+			meshRenderer->CreateObject(triangle, transform, 0xffffffff);
+		}
+
+		runner.Measure("Renderer/GPU culled frame of 10k objects (ops are objects)", objectCount, [&]()
+			{
+				if (renderer.BeginFrame())
+					renderer.EndFrame();
+				return static_cast<uint64_t>(renderer.GetFrameStats().Meshes.IndirectDrawCalls);
+			}
+		);
+	}
+}
+
+// 100k draws recorded through RecordParallel with the job system restarted at 1, 2, 4... workers up to one per hardware
+// thread. Each draw pushes constants and draws a zero sized sprite, so the GPU has next to nothing to do.
+BENCHMARK_GROUP(RendererRecordScaling)
+{
+	uint32_t maxWorkerCount = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<uint32_t> workerCounts;
+	for (uint32_t workerCount = 1; workerCount < maxWorkerCount; workerCount *= 2)
+		workerCounts.push_back(workerCount);
+	workerCounts.push_back(maxWorkerCount);
+
+	{
+		VulkanRenderer renderer(VkExtent2D{ 1280, 720 });
+		VulkanBatchRenderer* batchRenderer = renderer.GetBatchRenderer();
+		VulkanPipelineLibrary* pipelineLibrary = renderer.GetPipelineLibrary();
+		VkPipeline pipeline = pipelineLibrary->Get(batchRenderer->GetDefaultPipeline());
+		VkPipelineLayout pipelineLayout = pipelineLibrary->GetLayout(batchRenderer->GetDefaultPipeline());
+		if (!pipeline || !renderer.GetBindlessHeap())
+		{
+			Log::Warn(LogCategory::Renderer, "Skipping the RecordParallel benchmarks, they need the sprite shaders and descriptor indexing");
+			return;
+		}
+		VkDescriptorSet heapSet = renderer.GetBindlessHeap()->GetSet();
+
+		const uint32_t drawCount = 100000;
+		const float viewProjection[16] = {};
+		const uint32_t textureConstants[2] = {};
+		auto recordFrame = [&]()
+		{
+			if (!renderer.BeginFrame())
+				return uint64_t(0);
+
+			VulkanLinearAllocation instance = renderer.AllocateTransient(sizeof(VulkanQuadInstance));
+			VulkanQuadInstance zeroSized = {};
+			zeroSized.Size[0] = 0.0f;
+			zeroSized.Size[1] = 0.0f;
+			std::memcpy(instance.MappedData, &zeroSized, sizeof(zeroSized));
+
+			renderer.RecordParallel(drawCount, [&](VkCommandBuffer commandBuffer, size_t begin, size_t end)
+				{
+					vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+					vkCmdBindVertexBuffers(commandBuffer, 0, 1, &instance.Buffer, &instance.Offset);
+					vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &heapSet, 0, nullptr);
+					vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(viewProjection), viewProjection);
+					for (size_t i = begin; i < end; i++)
+					{
+						vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(viewProjection), sizeof(textureConstants), textureConstants);
+						vkCmdDraw(commandBuffer, 4, 1, 0, 0);
+					}
+				}
+			);
+			renderer.EndFrame();
+			return static_cast<uint64_t>(renderer.GetFrameStats().SecondaryCommandBufferCount);
+		};
+
+		for (uint32_t workerCount : workerCounts)
+		{
+			JobSystem::Shutdown();
+			JobSystem::Init(workerCount);
+			runner.Measure("RendererRecordScaling/RecordParallel 100k draws, " + std::to_string(workerCount) + " worker(s) (ops are draws)", drawCount, recordFrame);
+		}
+	}
+
+	JobSystem::Shutdown();
+	JobSystem::Init();
+}
+
+// Constructing the headless renderer without and with pipeline_cache.bin. The shader cache is warm for both, so the
+// difference is pipeline creation. Destroying the renderer saves the cache and isn't timed. An existing
+// pipeline_cache.bin is moved aside and restored afterwards.
+BENCHMARK_GROUP(RendererInit)
+{
+	const std::string cacheFilepath = "pipeline_cache.bin";
+	const std::string backupFilepath = "pipeline_cache.bin.benchmark";
+	std::error_code errorCode;
+	std::filesystem::rename(cacheFilepath, backupFilepath, errorCode);
+	bool restoreBackup = !errorCode;
+
+	std::unique_ptr<VulkanRenderer> renderer;
+	auto createRenderer = [&]()
+	{
+		renderer = std::make_unique<VulkanRenderer>(VkExtent2D{ 1280, 720 });
+		return uint64_t(renderer->GetPipelineCache()->IsWarm());
+	};
+
+	runner.SetMaxSamples(10);
+	runner.Measure("RendererInit/Init with a cold pipeline cache", 1, [&]()
+		{
+			renderer.reset();
+			std::filesystem::remove(cacheFilepath, errorCode);
+		},
+		createRenderer
+	);
+	runner.Measure("RendererInit/Init with a warm pipeline cache", 1, [&]() { renderer.reset(); }, createRenderer);
+	if (!renderer->GetPipelineCache()->IsWarm())
+		Log::Warn(LogCategory::Renderer, "'{}' wasn't warm, the driver may not support pipeline cache data", cacheFilepath);
+	runner.SetMaxSamples(0);
+
+	renderer.reset();
+	std::filesystem::remove(cacheFilepath, errorCode);
+	if (restoreBackup)
+		std::filesystem::rename(backupFilepath, cacheFilepath, errorCode);
+}
+
+// Permutations of the sprite shader like a material system with a few switches produces, compiled without a cache and
+// then loaded from a warm one. A hit still reads and hashes the source to find its entry.
+BENCHMARK_GROUP(ShaderCompiler)
+{
+	const uint32_t permutationCount = 256;
+	const std::string source = "assets/shaders/sprite.frag.glsl";
+	const std::string cacheDirectory = "benchmark_shader_cache";
+
+	uint64_t size = 0;
+	if (File::GetFileSize(source, size) != FileError::None)
+	{
+		Log::Warn("Skipping the shader compiler benchmarks, '{}' wasn't found", source);
+		return;
+	}
+
+	std::vector<std::vector<std::string>> permutations(permutationCount);
+	for (uint32_t i = 0; i < permutationCount; i++)
+	{
+		// Unused by the shader, only makes every key unique
+		permutations[i].push_back("BRICKENGINE_PERMUTATION=" + std::to_string(i));
+		if (i & 1)
+			permutations[i].push_back("BRICKENGINE_POOLED_DESCRIPTORS");
+	}
+
+	std::vector<uint32_t> code;
+	auto compileAll = [&](VulkanShaderCompiler& compiler)
+	{
+		uint64_t words = 0;
+		for (auto& defines : permutations)
+		{
+			compiler.Compile(source, VulkanShaderStage::Fragment, defines, code);
+			words += code.size();
+		}
+		return words;
+	};
+
+	VulkanShaderCompiler uncached("");
+	runner.Measure("ShaderCompiler/Cold compile of 256 permutations (ops are permutations)", permutationCount, [&]()
+		{
+			return compileAll(uncached);
+		}
+	);
+
+	std::error_code errorCode;
+	std::filesystem::remove_all(cacheDirectory, errorCode);
+	{
+		VulkanShaderCompiler cached(cacheDirectory);
+		compileAll(cached);
+		runner.Measure("ShaderCompiler/Cache hit of 256 permutations (ops are permutations)", permutationCount, [&]()
+			{
+				return compileAll(cached);
+			}
+		);
+	}
+	std::filesystem::remove_all(cacheDirectory, errorCode);
+}
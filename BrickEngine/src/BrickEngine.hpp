@@ -6,4 +6,11 @@
 // Core
 #include "BrickEngine/Core/Base.hpp"
 #include "BrickEngine/Core/Log.hpp"
+#include "BrickEngine/Core/LogSink.hpp"
+#include "BrickEngine/Core/Event.hpp"
 #include "BrickEngine/Core/Window.hpp"
+#include "BrickEngine/Core/AsyncFile.hpp"
+#include "BrickEngine/Core/AssetPack.hpp"
+#include "BrickEngine/Core/JobSystem.hpp"
+#include "BrickEngine/Core/FramePacer.hpp"
+#include "BrickEngine/Core/Profiler.hpp"
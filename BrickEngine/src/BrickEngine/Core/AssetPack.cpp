@@ -0,0 +1,370 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Core/AssetPack.hpp"
+
+namespace BrickEngine {
+
+	static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	FileError AssetPack::Open(const std::string& filepath, std::shared_ptr<AssetPack>& pack)
+	{
+		std::shared_ptr<AssetPack> result(new AssetPack());
+		result->m_Filepath = filepath;
+
+		FileView& view = result->m_View;
+		FileError error = File::MapFile(filepath, view);
+		if (error != FileError::None)
+			return error;
+
+		if (view.GetSize() < sizeof(AssetPackHeader))
+			return FileError::InvalidFormat;
+
+		AssetPackHeader& header = result->m_Header;
+		std::memcpy(&header, view.GetData(), sizeof(AssetPackHeader));
+
+		auto inBounds = [&](uint64_t offset, uint64_t size)
+		{
+			return offset <= view.GetSize() && size <= view.GetSize() - offset;
+		};
+
+		if (
+			header.Magic != AssetPackMagic																	||
+			header.Version != AssetPackVersion																||
+			header.FileSize != view.GetSize()																||
+			header.SlotCount == 0 || (header.SlotCount & (header.SlotCount - 1)) != 0						||
+			header.SlotCount < header.EntryCount															||
+			!inBounds(header.SlotsOffset, uint64_t(header.SlotCount) * sizeof(AssetPackSlot))				||
+			!inBounds(header.EntriesOffset, uint64_t(header.EntryCount) * sizeof(AssetPackEntry))			||
+			!inBounds(header.NamesOffset, header.NamesSize)													||
+			header.SlotsOffset % alignof(AssetPackSlot) != 0												||
+			header.EntriesOffset % alignof(AssetPackEntry) != 0
+		)
+			return FileError::InvalidFormat;
+
+		result->m_Slots = reinterpret_cast<const AssetPackSlot*>(view.GetData() + header.SlotsOffset);
+		result->m_Entries = reinterpret_cast<const AssetPackEntry*>(view.GetData() + header.EntriesOffset);
+		result->m_Names = view.GetData() + header.NamesOffset;
+
+		for (uint32_t i = 0; i < header.EntryCount; i++)
+		{
+			const AssetPackEntry& entry = result->m_Entries[i];
+			if (
+				!inBounds(entry.Offset, entry.Size)										||
+				uint64_t(entry.NameOffset) + entry.NameLength > header.NamesSize		||
+				entry.Compression > CompressionType::LZ4								||
+				(entry.Compression == CompressionType::None && entry.Size != entry.UncompressedSize)
+			)
+				return FileError::InvalidFormat;
+		}
+
+		for (uint32_t i = 0; i < header.SlotCount; i++)
+		{
+			if (result->m_Slots[i].EntryIndex > header.EntryCount)
+				return FileError::InvalidFormat;
+		}
+
+		pack = std::move(result);
+		return FileError::None;
+	}
+
+	const AssetPackEntry* AssetPack::Find(std::string_view path) const
+	{
+		uint64_t hash = HashPath(path);
+		uint32_t mask = m_Header.SlotCount - 1;
+		for (uint32_t probe = 0; probe < m_Header.SlotCount; probe++)
+		{
+			const AssetPackSlot& slot = m_Slots[(hash + probe) & mask];
+			if (slot.EntryIndex == 0)
+				return nullptr;
+
+			if (slot.Hash == hash)
+			{
+				const AssetPackEntry& entry = m_Entries[slot.EntryIndex - 1];
+				if (GetEntryName(entry) == path)
+					return &entry;
+			}
+		}
+		return nullptr;
+	}
+
+	static uint64_t GetBlockCount(uint64_t uncompressedSize)
+	{
+		return (uncompressedSize + AssetPackBlockSize - 1) / AssetPackBlockSize;
+	}
+
+	FileError AssetPack::Read(const AssetPackEntry& entry, FileView& view) const
+	{
+		view.Reset();
+
+		if (entry.Compression == CompressionType::None)
+		{
+			view.m_Data = m_View.GetData() + entry.Offset;
+			view.m_Size = static_cast<size_t>(entry.Size);
+			view.m_Owner = shared_from_this();
+			return FileError::None;
+		}
+
+		view.m_Buffer.resize(static_cast<size_t>(entry.UncompressedSize));
+		uint64_t blockCount = GetBlockCount(entry.UncompressedSize);
+		for (uint64_t block = 0; block < blockCount; block++)
+		{
+			if (!DecompressBlock(entry, block, view.m_Buffer.data() + block * AssetPackBlockSize))
+			{
+				view.m_Buffer.clear();
+				return FileError::InvalidFormat;
+			}
+		}
+		view.m_Data = view.m_Buffer.data();
+		view.m_Size = view.m_Buffer.size();
+		return FileError::None;
+	}
+
+	FileError AssetPack::ReadRange(const AssetPackEntry& entry, uint64_t offset, void* buffer, size_t size, size_t& bytesRead) const
+	{
+		bytesRead = 0;
+		if (offset >= entry.UncompressedSize)
+			return FileError::None;
+		size = static_cast<size_t>(std::min<uint64_t>(size, entry.UncompressedSize - offset));
+
+		if (entry.Compression == CompressionType::None)
+		{
+			std::memcpy(buffer, m_View.GetData() + entry.Offset + offset, size);
+			bytesRead = size;
+			return FileError::None;
+		}
+
+		// Whole blocks are decompressed straight into the buffer, the partial ones at either end go through a copy
+		std::vector<char> partialBlock;
+		char* destination = static_cast<char*>(buffer);
+		for (uint64_t position = offset; position < offset + size;)
+		{
+			uint64_t block = position / AssetPackBlockSize;
+			uint64_t blockStart = block * AssetPackBlockSize;
+			uint64_t blockSize = std::min(AssetPackBlockSize, entry.UncompressedSize - blockStart);
+			uint64_t copySize = std::min(blockStart + blockSize, offset + size) - position;
+			if (position == blockStart && copySize == blockSize)
+			{
+				if (!DecompressBlock(entry, block, destination))
+					return FileError::InvalidFormat;
+			}
+			else
+			{
+				partialBlock.resize(static_cast<size_t>(blockSize));
+				if (!DecompressBlock(entry, block, partialBlock.data()))
+					return FileError::InvalidFormat;
+				std::memcpy(destination, partialBlock.data() + (position - blockStart), static_cast<size_t>(copySize));
+			}
+
+			destination += copySize;
+			position += copySize;
+		}
+
+		bytesRead = size;
+		return FileError::None;
+	}
+
+	bool AssetPack::DecompressBlock(const AssetPackEntry& entry, uint64_t block, char* destination) const
+	{
+		// The block table is checked here instead of in Open, that only has to look at the entries
+		uint64_t blockCount = GetBlockCount(entry.UncompressedSize);
+		uint64_t tableSize = blockCount * sizeof(uint64_t);
+		if (entry.Size < tableSize)
+			return false;
+
+		const char* payload = m_View.GetData() + entry.Offset;
+		uint64_t start = 0;
+		uint64_t end = 0;
+		if (block > 0)
+			std::memcpy(&start, payload + (block - 1) * sizeof(uint64_t), sizeof(uint64_t));
+		std::memcpy(&end, payload + block * sizeof(uint64_t), sizeof(uint64_t));
+		if (start > end || end > entry.Size - tableSize)
+			return false;
+
+		const char* source = payload + tableSize + start;
+		size_t sourceSize = static_cast<size_t>(end - start);
+		size_t blockSize = static_cast<size_t>(std::min(AssetPackBlockSize, entry.UncompressedSize - block * AssetPackBlockSize));
+		if (sourceSize == blockSize)
+		{
+			std::memcpy(destination, source, blockSize);
+			return true;
+		}
+		return Compression::Decompress(source, sourceSize, destination, blockSize);
+	}
+
+	std::string_view AssetPack::GetEntryName(const AssetPackEntry& entry) const
+	{
+		return std::string_view(m_Names + entry.NameOffset, entry.NameLength);
+	}
+
+	std::string AssetPack::NormalizePath(std::string_view path)
+	{
+		std::string result(path);
+		std::replace(result.begin(), result.end(), '\\', '/');
+		while (result.rfind("./", 0) == 0)
+			result.erase(0, 2);
+		return result;
+	}
+
+	uint64_t AssetPack::HashPath(std::string_view normalizedPath)
+	{
+		// FNV-1a
+		uint64_t hash = 14695981039346656037ull;
+		for (char c : normalizedPath)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	void AssetPackWriter::AddData(std::string_view path, std::vector<char> data, CompressionType compression)
+	{
+		PendingEntry& entry = m_Entries.emplace_back();
+		entry.Path = AssetPack::NormalizePath(path);
+		entry.UncompressedSize = data.size();
+		entry.Compression = CompressionType::None;
+
+		if (compression == CompressionType::LZ4 && !data.empty())
+		{
+			uint64_t blockCount = GetBlockCount(data.size());
+			size_t tableSize = static_cast<size_t>(blockCount * sizeof(uint64_t));
+			std::vector<char> compressed(tableSize);
+			std::vector<char> compressedBlock(Compression::GetCompressBound(static_cast<size_t>(AssetPackBlockSize)));
+			for (uint64_t block = 0; block < blockCount; block++)
+			{
+				size_t blockStart = static_cast<size_t>(block * AssetPackBlockSize);
+				size_t blockSize = std::min(static_cast<size_t>(AssetPackBlockSize), data.size() - blockStart);
+				size_t compressedSize = Compression::Compress(data.data() + blockStart, blockSize, compressedBlock.data(), compressedBlock.size());
+				if (compressedSize > 0 && compressedSize < blockSize)
+					compressed.insert(compressed.end(), compressedBlock.begin(), compressedBlock.begin() + compressedSize);
+				else
+					compressed.insert(compressed.end(), data.begin() + blockStart, data.begin() + blockStart + blockSize);
+
+				uint64_t blockEnd = compressed.size() - tableSize;
+				std::memcpy(compressed.data() + block * sizeof(uint64_t), &blockEnd, sizeof(uint64_t));
+			}
+
+			// Only keep the compressed copy when it is worth paying for decompression
+			if (compressed.size() < data.size() - data.size() / 8)
+			{
+				data = std::move(compressed);
+				entry.Compression = CompressionType::LZ4;
+			}
+		}
+
+		entry.Data = std::move(data);
+	}
+
+	FileError AssetPackWriter::AddFile(std::string_view path, const std::string& sourceFilepath, CompressionType compression)
+	{
+		std::vector<char> data;
+		FileError error = File::LoadFile(sourceFilepath, data);
+		if (error != FileError::None)
+			return error;
+
+		AddData(path, std::move(data), compression);
+		return FileError::None;
+	}
+
+	FileError AssetPackWriter::Write(const std::string& filepath) const
+	{
+		uint32_t entryCount = static_cast<uint32_t>(m_Entries.size());
+		uint32_t slotCount = 1;
+		while (slotCount < entryCount * 2)
+			slotCount <<= 1;
+
+		AssetPackHeader header = {};
+		header.Magic = AssetPackMagic;
+		header.Version = AssetPackVersion;
+		header.EntryCount = entryCount;
+		header.SlotCount = slotCount;
+		header.SlotsOffset = AlignUp(sizeof(AssetPackHeader), alignof(AssetPackSlot));
+		header.EntriesOffset = AlignUp(header.SlotsOffset + uint64_t(slotCount) * sizeof(AssetPackSlot), alignof(AssetPackEntry));
+		header.NamesOffset = header.EntriesOffset + uint64_t(entryCount) * sizeof(AssetPackEntry);
+
+		std::vector<AssetPackSlot> slots(slotCount, AssetPackSlot{});
+		std::vector<AssetPackEntry> entries(entryCount, AssetPackEntry{});
+		std::string names;
+
+		for (uint32_t i = 0; i < entryCount; i++)
+		{
+			const PendingEntry& pending = m_Entries[i];
+			AssetPackEntry& entry = entries[i];
+			entry.NameOffset = static_cast<uint32_t>(names.size());
+			entry.NameLength = static_cast<uint32_t>(pending.Path.size());
+			entry.Size = pending.Data.size();
+			entry.UncompressedSize = pending.UncompressedSize;
+			entry.Compression = pending.Compression;
+			names += pending.Path;
+
+			uint64_t hash = AssetPack::HashPath(pending.Path);
+			for (uint32_t probe = 0; probe < slotCount; probe++)
+			{
+				AssetPackSlot& slot = slots[(hash + probe) & (slotCount - 1)];
+				if (slot.EntryIndex == 0)
+				{
+					slot.Hash = hash;
+					slot.EntryIndex = i + 1;
+					break;
+				}
+
+				// Later additions of the same path replace earlier ones
+				if (slot.Hash == hash && m_Entries[slot.EntryIndex - 1].Path == pending.Path)
+				{
+					slot.EntryIndex = i + 1;
+					break;
+				}
+			}
+		}
+		header.NamesSize = names.size();
+
+		uint64_t offset = header.NamesOffset + header.NamesSize;
+		for (auto& entry : entries)
+		{
+			offset = AlignUp(offset, AssetPackAlignment);
+			entry.Offset = offset;
+			offset += entry.Size;
+		}
+		header.FileSize = offset;
+
+		std::string temporaryFilepath = filepath + ".tmp";
+		{
+			std::ofstream file(temporaryFilepath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+				return FileError::AccessDenied;
+
+			auto writeAt = [&](uint64_t position, const void* data, size_t size)
+			{
+				file.seekp(static_cast<std::streamoff>(position));
+				file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+			};
+
+			writeAt(0, &header, sizeof(AssetPackHeader));
+			writeAt(header.SlotsOffset, slots.data(), slots.size() * sizeof(AssetPackSlot));
+			writeAt(header.EntriesOffset, entries.data(), entries.size() * sizeof(AssetPackEntry));
+			writeAt(header.NamesOffset, names.data(), names.size());
+			for (uint32_t i = 0; i < entryCount; i++)
+				writeAt(entries[i].Offset, m_Entries[i].Data.data(), m_Entries[i].Data.size());
+
+			// Pad to the full size so trailing empty entries are still inside the file
+			file.seekp(0, std::ios::end);
+			uint64_t written = static_cast<uint64_t>(file.tellp());
+			if (written < header.FileSize)
+			{
+				std::vector<char> padding(static_cast<size_t>(header.FileSize - written), 0);
+				file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+			}
+
+			if (!file)
+				return FileError::WriteFailed;
+		}
+
+		std::remove(filepath.c_str());
+		if (std::rename(temporaryFilepath.c_str(), filepath.c_str()) != 0)
+			return FileError::AccessDenied;
+		return FileError::None;
+	}
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+#include "BrickEngine/Core/File.hpp"
+#include "BrickEngine/Core/Compression.hpp"
+
+namespace BrickEngine {
+
+	// On disk layout: header, hash slots, entries, names, then the payloads, each aligned to AssetPackAlignment.
+	// Compressed entries are split into blocks of AssetPackBlockSize that are compressed on their own, so reading a range
+	// only decompresses the blocks it overlaps. Their payload starts with the end offset of every block, relative to the
+	// first block, followed by the blocks. Blocks that didn't get smaller are stored uncompressed.
+	constexpr uint32_t AssetPackMagic = 0x4B415042; // "BPAK"
+	constexpr uint32_t AssetPackVersion = 2;
+	constexpr uint64_t AssetPackAlignment = 64;
+	constexpr uint64_t AssetPackBlockSize = 64 * 1024;
+
+	struct AssetPackHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t EntryCount;
+		uint32_t SlotCount;
+		uint64_t SlotsOffset;
+		uint64_t EntriesOffset;
+		uint64_t NamesOffset;
+		uint64_t NamesSize;
+		uint64_t FileSize;
+	};
+
+	// Open addressing with linear probing, EntryIndex is 0 for an empty slot and index + 1 otherwise.
+	struct AssetPackSlot
+	{
+		uint64_t Hash;
+		uint32_t EntryIndex;
+		uint32_t Reserved;
+	};
+
+	struct AssetPackEntry
+	{
+		uint64_t Offset;
+		uint64_t Size;
+		uint64_t UncompressedSize;
+		uint32_t NameOffset;
+		uint32_t NameLength;
+		CompressionType Compression;
+		uint32_t Reserved;
+	};
+
+	class BRICKENGINE_API AssetPack : public std::enable_shared_from_this<AssetPack>
+	{
+	public:
+		// Maps the whole pack once, entries are then served straight out of the mapping.
+		static FileError Open(const std::string& filepath, std::shared_ptr<AssetPack>& pack);
+
+		// Expects a path already passed through NormalizePath.
+		const AssetPackEntry* Find(std::string_view path) const;
+		// Uncompressed entries are returned as a view into the pack mapping, compressed ones are decompressed into the view.
+		FileError Read(const AssetPackEntry& entry, FileView& view) const;
+		// Copies up to size bytes at offset into buffer, decompressing only the blocks the range overlaps.
+		FileError ReadRange(const AssetPackEntry& entry, uint64_t offset, void* buffer, size_t size, size_t& bytesRead) const;
+
+		uint32_t GetEntryCount() const { return m_Header.EntryCount; }
+		std::string_view GetEntryName(const AssetPackEntry& entry) const;
+		const std::string& GetFilepath() const { return m_Filepath; }
+
+		static std::string NormalizePath(std::string_view path);
+		static uint64_t HashPath(std::string_view normalizedPath);
+	private:
+		AssetPack() = default;
+
+		bool DecompressBlock(const AssetPackEntry& entry, uint64_t block, char* destination) const;
+	private:
+		std::string m_Filepath = {};
+		FileView m_View = {};
+		AssetPackHeader m_Header = {};
+		const AssetPackSlot* m_Slots = nullptr;
+		const AssetPackEntry* m_Entries = nullptr;
+		const char* m_Names = nullptr;
+	};
+
+	class BRICKENGINE_API AssetPackWriter
+	{
+	public:
+		void AddData(std::string_view path, std::vector<char> data, CompressionType compression = CompressionType::None);
+		FileError AddFile(std::string_view path, const std::string& sourceFilepath, CompressionType compression = CompressionType::None);
+
+		FileError Write(const std::string& filepath) const;
+	private:
+		struct PendingEntry
+		{
+			std::string Path;
+			std::vector<char> Data;
+			uint64_t UncompressedSize;
+			CompressionType Compression;
+		};
+		std::vector<PendingEntry> m_Entries = {};
+	};
+
+}
@@ -0,0 +1,589 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Core/AsyncFile.hpp"
+#include "BrickEngine/Core/AssetPack.hpp"
+
+#if defined(BRICKENGINE_PLATFORM_LINUX) && __has_include(<linux/io_uring.h>)
+	#include <linux/io_uring.h>
+	#include <sys/eventfd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <sys/syscall.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <cerrno>
+	// IORING_OP_READ came with the same kernel as this feature flag
+	#if defined(IORING_FEAT_RW_CUR_POS)
+		#define BRICKENGINE_ASYNC_FILE_IO_URING
+	#endif
+#endif
+
+namespace BrickEngine {
+
+	void AsyncFileRequest::Wait() const
+	{
+		if (IsDone())
+			return;
+
+		std::unique_lock<std::mutex> lock(m_WaitMutex);
+		m_WaitCondition.wait(lock, [this]() { return IsDone(); });
+	}
+
+	bool AsyncFileRequest::Cancel()
+	{
+		AsyncFileStatus expected = AsyncFileStatus::Pending;
+		if (!m_Status.compare_exchange_strong(expected, AsyncFileStatus::Running, std::memory_order_acq_rel))
+			return false;
+
+		Finish(AsyncFileStatus::Cancelled);
+		return true;
+	}
+
+	void AsyncFileRequest::Finish(AsyncFileStatus status)
+	{
+		m_CompleteTime = std::chrono::steady_clock::now();
+		m_Status.store(status, std::memory_order_release);
+
+		// Before waking Wait(), whatever the callback does is done by the time the request is
+		if (m_Callback)
+			m_Callback(*this);
+
+		{
+			std::lock_guard<std::mutex> lock(m_WaitMutex);
+			m_Done.store(true, std::memory_order_release);
+		}
+		m_WaitCondition.notify_all();
+	}
+
+#if defined(BRICKENGINE_ASYNC_FILE_IO_URING)
+	// Just enough of io_uring for reads, through the system calls instead of liburing. Only ever used by one thread.
+	class IoUring
+	{
+	public:
+		IoUring() = default;
+
+		~IoUring()
+		{
+			if (m_SubmissionEntries)
+				munmap(m_SubmissionEntries, m_SubmissionEntriesSize);
+			if (m_CompletionRing && m_CompletionRing != m_SubmissionRing)
+				munmap(m_CompletionRing, m_CompletionRingSize);
+			if (m_SubmissionRing)
+				munmap(m_SubmissionRing, m_SubmissionRingSize);
+			if (m_File >= 0)
+				close(m_File);
+		}
+
+		IoUring(const IoUring&) = delete;
+		IoUring& operator=(const IoUring&) = delete;
+
+		// Fails on kernels without io_uring, or where it's disabled like in many containers
+		bool Init(uint32_t entryCount)
+		{
+			io_uring_params parameters = {};
+			m_File = static_cast<int>(syscall(__NR_io_uring_setup, entryCount, &parameters));
+			if (m_File < 0 || !(parameters.features & IORING_FEAT_RW_CUR_POS))
+				return false;
+
+			m_SubmissionRingSize = parameters.sq_off.array + parameters.sq_entries * sizeof(uint32_t);
+			m_CompletionRingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+			bool singleMapping = parameters.features & IORING_FEAT_SINGLE_MMAP;
+			if (singleMapping)
+				m_SubmissionRingSize = m_CompletionRingSize = std::max(m_SubmissionRingSize, m_CompletionRingSize);
+
+			m_SubmissionRing = MapRing(m_SubmissionRingSize, IORING_OFF_SQ_RING);
+			if (!m_SubmissionRing)
+				return false;
+			m_CompletionRing = singleMapping ? m_SubmissionRing : MapRing(m_CompletionRingSize, IORING_OFF_CQ_RING);
+			if (!m_CompletionRing)
+				return false;
+
+			m_SubmissionEntriesSize = parameters.sq_entries * sizeof(io_uring_sqe);
+			m_SubmissionEntries = static_cast<io_uring_sqe*>(MapRing(m_SubmissionEntriesSize, IORING_OFF_SQES));
+			if (!m_SubmissionEntries)
+				return false;
+
+			uint8_t* submissionRing = static_cast<uint8_t*>(m_SubmissionRing);
+			m_SubmissionHead = reinterpret_cast<uint32_t*>(submissionRing + parameters.sq_off.head);
+			m_SubmissionTail = reinterpret_cast<uint32_t*>(submissionRing + parameters.sq_off.tail);
+			m_SubmissionMask = *reinterpret_cast<uint32_t*>(submissionRing + parameters.sq_off.ring_mask);
+			m_SubmissionArray = reinterpret_cast<uint32_t*>(submissionRing + parameters.sq_off.array);
+			m_SubmissionEntryCount = parameters.sq_entries;
+			m_LocalTail = *m_SubmissionTail;
+
+			uint8_t* completionRing = static_cast<uint8_t*>(m_CompletionRing);
+			m_CompletionHead = reinterpret_cast<uint32_t*>(completionRing + parameters.cq_off.head);
+			m_CompletionTail = reinterpret_cast<uint32_t*>(completionRing + parameters.cq_off.tail);
+			m_CompletionMask = *reinterpret_cast<uint32_t*>(completionRing + parameters.cq_off.ring_mask);
+			m_Completions = reinterpret_cast<io_uring_cqe*>(completionRing + parameters.cq_off.cqes);
+			return true;
+		}
+
+		// Queues a read for the next SubmitAndWait, returns false when the submission queue is full
+		bool QueueRead(int file, void* buffer, uint32_t size, uint64_t offset, uint64_t userData)
+		{
+			if (m_LocalTail - __atomic_load_n(m_SubmissionHead, __ATOMIC_ACQUIRE) >= m_SubmissionEntryCount)
+				return false;
+
+			uint32_t index = m_LocalTail & m_SubmissionMask;
+			io_uring_sqe& entry = m_SubmissionEntries[index];
+			std::memset(&entry, 0, sizeof(io_uring_sqe));
+			entry.opcode = IORING_OP_READ;
+			entry.fd = file;
+			entry.addr = reinterpret_cast<uint64_t>(buffer);
+			entry.len = size;
+			entry.off = offset;
+			entry.user_data = userData;
+			m_SubmissionArray[index] = index;
+			m_LocalTail++;
+			return true;
+		}
+
+		// Submits the queued reads and blocks until at least one completion is ready
+		bool SubmitAndWait()
+		{
+			__atomic_store_n(m_SubmissionTail, m_LocalTail, __ATOMIC_RELEASE);
+			uint32_t submitCount = m_LocalTail - __atomic_load_n(m_SubmissionHead, __ATOMIC_ACQUIRE);
+			while (syscall(__NR_io_uring_enter, m_File, submitCount, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0)
+			{
+				if (errno != EINTR && errno != EBUSY)
+					return false;
+				submitCount = m_LocalTail - __atomic_load_n(m_SubmissionHead, __ATOMIC_ACQUIRE);
+			}
+			return true;
+		}
+
+		template<typename Function>
+		void ForEachCompletion(Function&& function)
+		{
+			uint32_t head = *m_CompletionHead;
+			uint32_t tail = __atomic_load_n(m_CompletionTail, __ATOMIC_ACQUIRE);
+			for (; head != tail; head++)
+			{
+				io_uring_cqe completion = m_Completions[head & m_CompletionMask];
+				// Released before handling, the handler queues new reads which may complete into this slot
+				__atomic_store_n(m_CompletionHead, head + 1, __ATOMIC_RELEASE);
+				function(completion.user_data, completion.res);
+			}
+		}
+	private:
+		void* MapRing(size_t size, off_t offset)
+		{
+			void* ring = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_File, offset);
+			return ring == MAP_FAILED ? nullptr : ring;
+		}
+	private:
+		int m_File = -1;
+
+		void* m_SubmissionRing = nullptr;
+		size_t m_SubmissionRingSize = 0;
+		io_uring_sqe* m_SubmissionEntries = nullptr;
+		size_t m_SubmissionEntriesSize = 0;
+		uint32_t* m_SubmissionHead = nullptr;
+		uint32_t* m_SubmissionTail = nullptr;
+		uint32_t* m_SubmissionArray = nullptr;
+		uint32_t m_SubmissionMask = 0;
+		uint32_t m_SubmissionEntryCount = 0;
+		uint32_t m_LocalTail = 0;
+
+		void* m_CompletionRing = nullptr;
+		size_t m_CompletionRingSize = 0;
+		io_uring_cqe* m_Completions = nullptr;
+		uint32_t* m_CompletionHead = nullptr;
+		uint32_t* m_CompletionTail = nullptr;
+		uint32_t m_CompletionMask = 0;
+	};
+#endif
+
+	using AsyncFileQueues = std::array<std::deque<AsyncFileHandle>, static_cast<size_t>(AsyncFilePriority::Count)>;
+
+	class AsyncFileService
+	{
+	public:
+		AsyncFileService()
+		{
+#if defined(BRICKENGINE_ASYNC_FILE_IO_URING)
+			m_Ring = std::make_unique<IoUring>();
+			m_WakeEvent = eventfd(0, EFD_CLOEXEC);
+			// The ring has room for every read in flight plus the read of the wake event
+			if (m_WakeEvent >= 0 && m_Ring->Init(s_RingQueueDepth * 2))
+			{
+				m_RingThread = std::thread([this]() { RunRing(); });
+			}
+			else
+			{
+				Log::Warn(LogCategory::File, "io_uring is unavailable, async reads of loose files fall back to the thread pool");
+				m_Ring.reset();
+			}
+#endif
+
+			size_t workerCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 8);
+			for (size_t i = 0; i < workerCount; i++)
+				m_Workers.emplace_back([this]() { Run(); });
+		}
+
+		~AsyncFileService()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_QueueMutex);
+				m_Running = false;
+			}
+			m_QueueCondition.notify_all();
+			for (auto& worker : m_Workers)
+				worker.join();
+
+#if defined(BRICKENGINE_ASYNC_FILE_IO_URING)
+			if (m_RingThread.joinable())
+			{
+				WakeRing();
+				m_RingThread.join();
+			}
+			m_Ring.reset();
+			if (m_WakeEvent >= 0)
+				close(m_WakeEvent);
+#endif
+
+			for (auto& queues : { &m_Queues, &m_RingQueues })
+				for (auto& queue : *queues)
+					for (auto& request : queue)
+						request->Cancel();
+		}
+
+		static AsyncFileService& Get()
+		{
+			static AsyncFileService s_Service;
+			return s_Service;
+		}
+
+		void Submit(const AsyncFileHandle& request)
+		{
+			request->m_SubmitTime = std::chrono::steady_clock::now();
+
+			// Pack entries are memory mapped and possibly compressed, there is nothing for the ring to do for them
+			const AssetPackEntry* entry = nullptr;
+			bool useRing = IsUsingRing() && !File::FindInPacks(request->m_Filepath, entry);
+			{
+				std::lock_guard<std::mutex> lock(m_QueueMutex);
+				AsyncFileQueues& queues = useRing ? m_RingQueues : m_Queues;
+				queues[static_cast<size_t>(request->m_Priority)].push_back(request);
+				(useRing ? m_RingPendingCount : m_PendingCount)++;
+			}
+
+			if (useRing)
+				WakeRing();
+			else
+				m_QueueCondition.notify_one();
+		}
+
+		size_t GetWorkerCount() const { return m_Workers.size(); }
+
+		size_t GetPendingCount()
+		{
+			std::lock_guard<std::mutex> lock(m_QueueMutex);
+			return m_PendingCount + m_RingPendingCount;
+		}
+
+		bool IsUsingRing() const
+		{
+#if defined(BRICKENGINE_ASYNC_FILE_IO_URING)
+			return m_Ring && !m_RingFailed.load(std::memory_order_relaxed);
+#else
+			return false;
+#endif
+		}
+	private:
+		static AsyncFileHandle PopHighestPriority(AsyncFileQueues& queues)
+		{
+			for (auto& queue : queues)
+			{
+				if (!queue.empty())
+				{
+					AsyncFileHandle request = std::move(queue.front());
+					queue.pop_front();
+					return request;
+				}
+			}
+			return nullptr;
+		}
+
+		void Run()
+		{
+			while (true)
+			{
+				AsyncFileHandle request;
+				{
+					std::unique_lock<std::mutex> lock(m_QueueMutex);
+					m_QueueCondition.wait(lock, [this]() { return !m_Running || m_PendingCount > 0; });
+					if (!m_Running)
+						return;
+
+					request = PopHighestPriority(m_Queues);
+					m_PendingCount--;
+				}
+
+				AsyncFileStatus expected = AsyncFileStatus::Pending;
+				if (request->m_Status.compare_exchange_strong(expected, AsyncFileStatus::Running, std::memory_order_acq_rel))
+					Execute(*request);
+			}
+		}
+
+		void Execute(AsyncFileRequest& request)
+		{
+			if (request.m_LoadWholeFile)
+			{
+				uint64_t size = 0;
+				request.m_Error = File::GetFileSize(request.m_Filepath, size);
+				if (request.m_Error != FileError::None)
+				{
+					request.Finish(AsyncFileStatus::Failed);
+					return;
+				}
+
+				request.m_Data.resize(static_cast<size_t>(size));
+				request.m_Buffer = request.m_Data.data();
+				request.m_Size = request.m_Data.size();
+			}
+
+			request.m_Error = File::ReadFileRange(request.m_Filepath, request.m_Offset, request.m_Buffer, request.m_Size, request.m_BytesRead);
+			if (request.m_LoadWholeFile)
+				request.m_Data.resize(request.m_BytesRead);
+
+			request.Finish(request.m_Error == FileError::None ? AsyncFileStatus::Completed : AsyncFileStatus::Failed);
+		}
+
+#if defined(BRICKENGINE_ASYNC_FILE_IO_URING)
+		struct RingRead
+		{
+			AsyncFileHandle Request = nullptr;
+			int File = -1;
+		};
+
+		void WakeRing()
+		{
+			uint64_t value = 1;
+			while (write(m_WakeEvent, &value, sizeof(value)) < 0 && errno == EINTR)
+				;
+		}
+
+		// Runs on the I/O thread. Opens the file and queues the first read, finishes the request right away on failure.
+		bool StartRingRead(RingRead& read, uint64_t userData)
+		{
+			AsyncFileRequest& request = *read.Request;
+			read.File = open(request.m_Filepath.c_str(), O_RDONLY | O_CLOEXEC);
+			if (read.File < 0)
+			{
+				FinishRingRead(read, File::GetOpenError(request.m_Filepath, static_cast<uint32_t>(errno)));
+				return false;
+			}
+
+			struct stat status = {};
+			if (fstat(read.File, &status) != 0 || S_ISDIR(status.st_mode))
+			{
+				FinishRingRead(read, S_ISDIR(status.st_mode) ? FileError::IsDirectory : FileError::ReadFailed);
+				return false;
+			}
+
+			if (request.m_LoadWholeFile)
+			{
+
+				request.m_Data.resize(static_cast<size_t>(status.st_size));
+				request.m_Buffer = request.m_Data.data();
+				request.m_Size = request.m_Data.size();
+			}
+
+			if (request.m_Size == 0)
+			{
+				FinishRingRead(read, FileError::None);
+				return false;
+			}
+
+			QueueNextRead(read, userData);
+			return true;
+		}
+
+		void QueueNextRead(RingRead& read, uint64_t userData)
+		{
+			AsyncFileRequest& request = *read.Request;
+			// Reads are limited to 32 bit lengths, larger ones continue where the last one stopped
+			// Never fails, every read slot has at most one read queued and the ring has room for all of them
+			uint32_t size = static_cast<uint32_t>(std::min<size_t>(request.m_Size - request.m_BytesRead, 1u << 30));
+			m_Ring->QueueRead(read.File, static_cast<char*>(request.m_Buffer) + request.m_BytesRead, size, request.m_Offset + request.m_BytesRead, userData);
+		}
+
+		void FinishRingRead(RingRead& read, FileError error)
+		{
+			if (read.File >= 0)
+				close(read.File);
+			read.File = -1;
+
+			AsyncFileHandle request = std::move(read.Request);
+			request->m_Error = error;
+			if (request->m_LoadWholeFile)
+				request->m_Data.resize(request->m_BytesRead);
+			request->Finish(error == FileError::None ? AsyncFileStatus::Completed : AsyncFileStatus::Failed);
+		}
+
+		// Keeps up to s_RingQueueDepth reads in flight. The wake event is read through the ring as well, so a single wait
+		// covers both new requests and completed reads.
+		void RunRing()
+		{
+			// User data 0 is the wake event, the reads are their index + 1
+			std::vector<RingRead> reads(s_RingQueueDepth);
+			std::vector<uint32_t> freeReads;
+			for (uint32_t i = s_RingQueueDepth; i > 0; i--)
+				freeReads.push_back(i - 1);
+
+			uint64_t wakeValue = 0;
+			m_Ring->QueueRead(m_WakeEvent, &wakeValue, sizeof(wakeValue), 0, 0);
+
+			std::vector<AsyncFileHandle> started;
+			bool running = true;
+			while (true)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_QueueMutex);
+					running = m_Running;
+					while (running && freeReads.size() > started.size() && m_RingPendingCount > 0)
+					{
+						started.push_back(PopHighestPriority(m_RingQueues));
+						m_RingPendingCount--;
+					}
+				}
+
+				for (auto& request : started)
+				{
+					AsyncFileStatus expected = AsyncFileStatus::Pending;
+					if (!request->m_Status.compare_exchange_strong(expected, AsyncFileStatus::Running, std::memory_order_acq_rel))
+						continue;
+
+					uint32_t index = freeReads.back();
+					reads[index].Request = std::move(request);
+					if (StartRingRead(reads[index], index + 1))
+						freeReads.pop_back();
+				}
+				started.clear();
+
+				if (!running && freeReads.size() == s_RingQueueDepth)
+					break;
+
+				if (!m_Ring->SubmitAndWait())
+				{
+					Log::Error(LogCategory::File, "io_uring_enter failed with errno {}, async reads fall back to the thread pool", errno);
+					FallBackToWorkers();
+					break;
+				}
+
+				m_Ring->ForEachCompletion([&](uint64_t userData, int32_t result)
+					{
+						if (userData == 0)
+						{
+							if (running)
+								m_Ring->QueueRead(m_WakeEvent, &wakeValue, sizeof(wakeValue), 0, 0);
+							return;
+						}
+
+						uint32_t index = static_cast<uint32_t>(userData - 1);
+						RingRead& read = reads[index];
+						AsyncFileRequest& request = *read.Request;
+						if (result == -EINTR || result == -EAGAIN)
+						{
+							QueueNextRead(read, userData);
+							return;
+						}
+
+						if (result > 0)
+							request.m_BytesRead += static_cast<size_t>(result);
+						if (result > 0 && request.m_BytesRead < request.m_Size)
+						{
+							QueueNextRead(read, userData);
+							return;
+						}
+
+						FinishRingRead(read, result < 0 ? FileError::ReadFailed : FileError::None);
+						freeReads.push_back(index);
+					}
+				);
+			}
+
+			// Only left when io_uring_enter failed, nothing completes these anymore
+			for (auto& read : reads)
+				if (read.Request)
+					FinishRingRead(read, FileError::ReadFailed);
+		}
+
+		void FallBackToWorkers()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_QueueMutex);
+				m_RingFailed.store(true, std::memory_order_relaxed);
+				for (size_t i = 0; i < m_RingQueues.size(); i++)
+				{
+					m_Queues[i].insert(m_Queues[i].end(), m_RingQueues[i].begin(), m_RingQueues[i].end());
+					m_RingQueues[i].clear();
+				}
+				m_PendingCount += m_RingPendingCount;
+				m_RingPendingCount = 0;
+			}
+			m_QueueCondition.notify_all();
+		}
+#endif
+	private:
+		static constexpr uint32_t s_RingQueueDepth = 64;
+
+		std::vector<std::thread> m_Workers;
+		bool m_Running = true;
+
+		std::mutex m_QueueMutex;
+		std::condition_variable m_QueueCondition;
+		AsyncFileQueues m_Queues;
+		size_t m_PendingCount = 0;
+
+		AsyncFileQueues m_RingQueues;
+		size_t m_RingPendingCount = 0;
+#if defined(BRICKENGINE_ASYNC_FILE_IO_URING)
+		std::unique_ptr<IoUring> m_Ring;
+		std::thread m_RingThread;
+		std::atomic<bool> m_RingFailed = false;
+		int m_WakeEvent = -1;
+#endif
+	};
+
+	AsyncFileHandle AsyncFile::Read(const std::string& filepath, uint64_t offset, void* buffer, size_t size, AsyncFilePriority priority, AsyncFileCallback callback)
+	{
+		AsyncFileHandle request = std::make_shared<AsyncFileRequest>();
+		request->m_Filepath = filepath;
+		request->m_Offset = offset;
+		request->m_Buffer = buffer;
+		request->m_Size = size;
+		request->m_Priority = priority;
+		request->m_Callback = std::move(callback);
+		AsyncFileService::Get().Submit(request);
+		return request;
+	}
+
+	AsyncFileHandle AsyncFile::Load(const std::string& filepath, AsyncFilePriority priority, AsyncFileCallback callback)
+	{
+		AsyncFileHandle request = std::make_shared<AsyncFileRequest>();
+		request->m_Filepath = filepath;
+		request->m_LoadWholeFile = true;
+		request->m_Priority = priority;
+		request->m_Callback = std::move(callback);
+		AsyncFileService::Get().Submit(request);
+		return request;
+	}
+
+	size_t AsyncFile::GetWorkerCount()
+	{
+		return AsyncFileService::Get().GetWorkerCount();
+	}
+
+	size_t AsyncFile::GetPendingCount()
+	{
+		return AsyncFileService::Get().GetPendingCount();
+	}
+
+	const char* AsyncFile::GetBackendName()
+	{
+		return AsyncFileService::Get().IsUsingRing() ? "io_uring" : "thread pool";
+	}
+
+}
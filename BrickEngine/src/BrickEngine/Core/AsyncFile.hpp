@@ -0,0 +1,98 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+#include "BrickEngine/Core/File.hpp"
+
+namespace BrickEngine {
+
+	enum class AsyncFilePriority : uint8_t
+	{
+		High,
+		Normal,
+		Low,
+		Count
+	};
+
+	enum class AsyncFileStatus : uint8_t
+	{
+		Pending,
+		Running,
+		Completed,
+		Failed,
+		Cancelled
+	};
+
+	class AsyncFileRequest;
+
+	using AsyncFileHandle = std::shared_ptr<AsyncFileRequest>;
+	// Called exactly once when the request completes, fails or is cancelled, on whichever thread finished it. GetStatus()
+	// already has the final status, IsDone() and Wait() only return once the callback did.
+	using AsyncFileCallback = std::function<void(AsyncFileRequest& request)>;
+
+	class BRICKENGINE_API AsyncFileRequest
+	{
+		friend class AsyncFile;
+		friend class AsyncFileService;
+	public:
+		AsyncFileStatus GetStatus() const { return m_Status.load(std::memory_order_acquire); }
+		bool IsDone() const { return m_Done.load(std::memory_order_acquire); }
+
+		void Wait() const;
+		// Only succeeds while the request is still queued, a read that already started runs to completion.
+		bool Cancel();
+
+		FileError GetError() const { return m_Error; }
+		size_t GetBytesRead() const { return m_BytesRead; }
+
+		const std::string& GetFilepath() const { return m_Filepath; }
+		// Destination of the read, either the caller provided buffer or GetData() for whole file loads.
+		void* GetBuffer() const { return m_Buffer; }
+		// Only filled by AsyncFile::Load.
+		std::vector<char>& GetData() { return m_Data; }
+
+		// Seconds between submission and completion
+		double GetLatency() const { return std::chrono::duration<double>(m_CompleteTime - m_SubmitTime).count(); }
+	private:
+		void Finish(AsyncFileStatus status);
+	private:
+		std::string m_Filepath = {};
+		uint64_t m_Offset = 0;
+		void* m_Buffer = nullptr;
+		size_t m_Size = 0;
+		bool m_LoadWholeFile = false;
+		AsyncFilePriority m_Priority = AsyncFilePriority::Normal;
+		AsyncFileCallback m_Callback = {};
+
+		std::atomic<AsyncFileStatus> m_Status = AsyncFileStatus::Pending;
+		std::atomic<bool> m_Done = false;
+		FileError m_Error = FileError::None;
+		size_t m_BytesRead = 0;
+		std::vector<char> m_Data = {};
+
+		std::chrono::steady_clock::time_point m_SubmitTime = {};
+		std::chrono::steady_clock::time_point m_CompleteTime = {};
+
+		mutable std::mutex m_WaitMutex;
+		mutable std::condition_variable m_WaitCondition;
+	};
+
+	// Reads are served highest priority first and in submission order within a priority. On Linux loose files are read
+	// through an io_uring driven by a single I/O thread, which keeps many reads in flight at once. Files in mounted packs,
+	// and everything when io_uring isn't available, are read by a pool of worker threads.
+	class AsyncFile
+	{
+	public:
+		AsyncFile() = delete;
+
+		// Reads up to size bytes at offset into buffer, which must stay valid until the request is done.
+		static AsyncFileHandle Read(const std::string& filepath, uint64_t offset, void* buffer, size_t size, AsyncFilePriority priority = AsyncFilePriority::Normal, AsyncFileCallback callback = {});
+		// Reads the whole file into the request's own GetData() buffer.
+		static AsyncFileHandle Load(const std::string& filepath, AsyncFilePriority priority = AsyncFilePriority::Normal, AsyncFileCallback callback = {});
+
+		static size_t GetWorkerCount();
+		static size_t GetPendingCount();
+		// "io_uring" or "thread pool"
+		static const char* GetBackendName();
+	};
+
+}
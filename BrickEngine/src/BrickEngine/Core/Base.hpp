@@ -6,7 +6,8 @@
 #define STRINGIFICATE(x) STRINGIFICATE_(x)
 #define LINE_STRING STRINGIFICATE(__LINE__)
 
-#define CONCAT(x, y) x ## y
+#define CONCAT_(x, y) x ## y
+#define CONCAT(x, y) CONCAT_(x, y)
 
 #if defined(BRICKENGINE_PLATFORM_WINDOWS)
 	#define BRICKENGINE_FORCE_INLINE __forceinline
@@ -22,8 +23,8 @@
 		#define BRICKENGINE_API
 	#endif
 #else
-	#define FORCEINLINE
-	#define FORCENOINLINE
+	#define BRICKENGINE_FORCE_INLINE inline __attribute__((always_inline))
+	#define BRICKENGINE_FORCE_NO_INLINE __attribute__((noinline))
 	#define BRICKENGINE_API
 #endif
 
@@ -33,15 +34,16 @@
 		#include <intrin.h>
 		#define BRICKENGINE_DEBUG_BREAK() __debugbreak()
 	#else
-		#define BRICKENGINE_DEBUG_BREAK()
+		#include <csignal>
+		#define BRICKENGINE_DEBUG_BREAK() std::raise(SIGTRAP)
 	#endif
 
 	#define BRICKENGINE_ASSERT(x) {\
 		if (!(x)) { \
-			::BrickEngine::Log::Fatal("Assertion Failure : '" #x "' in function: '" __FUNCTION__ "' in file: " __FILE__ ":" LINE_STRING); \
+			::BrickEngine::Log::Fatal("Assertion Failure : '" #x "' in function: '{}' in file: " __FILE__ ":" LINE_STRING, static_cast<const char*>(__FUNCTION__)); \
 			BRICKENGINE_DEBUG_BREAK(); \
 		} \
 	}
 #else
-	#define ASSERT(x)
+	#define BRICKENGINE_ASSERT(x)
 #endif
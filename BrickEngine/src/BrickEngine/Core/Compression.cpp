@@ -0,0 +1,173 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Core/Compression.hpp"
+
+namespace BrickEngine {
+
+	constexpr size_t s_MinMatch = 4;
+	constexpr size_t s_LastLiterals = 5;
+	constexpr size_t s_MatchSearchLimit = 12;
+	constexpr size_t s_MaxOffset = 65535;
+	constexpr uint32_t s_HashBits = 12;
+
+	static uint32_t Read32(const uint8_t* data)
+	{
+		uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	static uint32_t Hash(uint32_t sequence)
+	{
+		return (sequence * 2654435761u) >> (32 - s_HashBits);
+	}
+
+	static uint8_t* WriteLength(uint8_t* op, size_t length)
+	{
+		while (length >= 255)
+		{
+			*op++ = 255;
+			length -= 255;
+		}
+		*op++ = static_cast<uint8_t>(length);
+		return op;
+	}
+
+	size_t Compression::GetCompressBound(size_t size)
+	{
+		return size + size / 255 + 16;
+	}
+
+	size_t Compression::Compress(const void* src, size_t srcSize, void* dst, size_t dstCapacity)
+	{
+		if (dstCapacity < GetCompressBound(srcSize))
+			return 0;
+
+		const uint8_t* const base = static_cast<const uint8_t*>(src);
+		const uint8_t* const end = base + srcSize;
+		const uint8_t* ip = base;
+		const uint8_t* anchor = base;
+		uint8_t* op = static_cast<uint8_t*>(dst);
+
+		if (srcSize >= s_MatchSearchLimit + 1)
+		{
+			std::vector<uint32_t> table(size_t(1) << s_HashBits, 0);
+			const uint8_t* const matchLimit = end - s_MatchSearchLimit;
+			const uint8_t* const matchEnd = end - s_LastLiterals;
+
+			ip++;
+			while (ip < matchLimit)
+			{
+				uint32_t sequence = Read32(ip);
+				uint32_t& slot = table[Hash(sequence)];
+				const uint8_t* match = base + slot;
+				slot = static_cast<uint32_t>(ip - base);
+
+				if (match >= ip || static_cast<size_t>(ip - match) > s_MaxOffset || Read32(match) != sequence)
+				{
+					ip++;
+					continue;
+				}
+
+				while (ip > anchor && match > base && ip[-1] == match[-1])
+				{
+					ip--;
+					match--;
+				}
+
+				size_t matchLength = s_MinMatch;
+				while (ip + matchLength < matchEnd && ip[matchLength] == match[matchLength])
+					matchLength++;
+
+				size_t literalLength = static_cast<size_t>(ip - anchor);
+				uint8_t* token = op++;
+				*token = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+				if (literalLength >= 15)
+					op = WriteLength(op, literalLength - 15);
+				std::memcpy(op, anchor, literalLength);
+				op += literalLength;
+
+				uint16_t offset = static_cast<uint16_t>(ip - match);
+				*op++ = static_cast<uint8_t>(offset);
+				*op++ = static_cast<uint8_t>(offset >> 8);
+
+				size_t extraLength = matchLength - s_MinMatch;
+				*token |= static_cast<uint8_t>(std::min<size_t>(extraLength, 15));
+				if (extraLength >= 15)
+					op = WriteLength(op, extraLength - 15);
+
+				ip += matchLength;
+				anchor = ip;
+			}
+		}
+
+		size_t literalLength = static_cast<size_t>(end - anchor);
+		*op++ = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+		if (literalLength >= 15)
+			op = WriteLength(op, literalLength - 15);
+		std::memcpy(op, anchor, literalLength);
+		op += literalLength;
+
+		return static_cast<size_t>(op - static_cast<uint8_t*>(dst));
+	}
+
+	bool Compression::Decompress(const void* src, size_t srcSize, void* dst, size_t dstSize)
+	{
+		const uint8_t* ip = static_cast<const uint8_t*>(src);
+		const uint8_t* const inputEnd = ip + srcSize;
+		uint8_t* const outputBase = static_cast<uint8_t*>(dst);
+		uint8_t* op = outputBase;
+		uint8_t* const outputEnd = op + dstSize;
+
+		auto readLength = [&](size_t& length) -> bool
+		{
+			uint8_t value;
+			do
+			{
+				if (ip >= inputEnd)
+					return false;
+				value = *ip++;
+				length += value;
+			} while (value == 255);
+			return true;
+		};
+
+		while (ip < inputEnd)
+		{
+			uint8_t token = *ip++;
+
+			size_t literalLength = token >> 4;
+			if (literalLength == 15 && !readLength(literalLength))
+				return false;
+			if (literalLength > static_cast<size_t>(inputEnd - ip) || literalLength > static_cast<size_t>(outputEnd - op))
+				return false;
+			std::memcpy(op, ip, literalLength);
+			ip += literalLength;
+			op += literalLength;
+
+			if (ip == inputEnd)
+				break;
+
+			if (inputEnd - ip < 2)
+				return false;
+			size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+			ip += 2;
+			if (offset == 0 || offset > static_cast<size_t>(op - outputBase))
+				return false;
+
+			size_t matchLength = token & 15;
+			if (matchLength == 15 && !readLength(matchLength))
+				return false;
+			matchLength += s_MinMatch;
+			if (matchLength > static_cast<size_t>(outputEnd - op))
+				return false;
+
+			const uint8_t* match = op - offset;
+			for (size_t i = 0; i < matchLength; i++)
+				op[i] = match[i];
+			op += matchLength;
+		}
+
+		return op == outputEnd;
+	}
+
+}
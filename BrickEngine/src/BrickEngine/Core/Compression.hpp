@@ -0,0 +1,26 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+namespace BrickEngine {
+
+	enum class CompressionType : uint32_t
+	{
+		None,
+		LZ4
+	};
+
+	// LZ4 block format, compatible with LZ4_compress_default / LZ4_decompress_safe.
+	class Compression
+	{
+	public:
+		Compression() = delete;
+
+		static size_t GetCompressBound(size_t size);
+		// Returns the compressed size, or 0 if dst is too small.
+		static size_t Compress(const void* src, size_t srcSize, void* dst, size_t dstCapacity);
+		// Fails on malformed input or when the output isn't exactly dstSize bytes.
+		static bool Decompress(const void* src, size_t srcSize, void* dst, size_t dstSize);
+	};
+
+}
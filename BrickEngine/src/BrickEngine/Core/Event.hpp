@@ -0,0 +1,138 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+namespace BrickEngine {
+
+	enum class EventType : uint8_t
+	{
+		WindowClose,
+		WindowResize,
+		FocusGained,
+		FocusLost,
+		KeyPressed,
+		KeyReleased,
+		MouseMoved,
+		MouseButtonPressed,
+		MouseButtonReleased,
+		MouseScrolled
+	};
+
+	// Layout independent, letters and digits are contiguous so platforms can translate them with an offset
+	enum class KeyCode : uint8_t
+	{
+		Unknown = 0,
+		A, B, C, D, E, F, G, H, I, J, K, L, M, N, O, P, Q, R, S, T, U, V, W, X, Y, Z,
+		Num0, Num1, Num2, Num3, Num4, Num5, Num6, Num7, Num8, Num9,
+		F1, F2, F3, F4, F5, F6, F7, F8, F9, F10, F11, F12,
+		Space,
+		Enter,
+		Escape,
+		Tab,
+		Backspace,
+		Left,
+		Right,
+		Up,
+		Down,
+		LeftShift,
+		LeftControl,
+		LeftAlt,
+		Count
+	};
+
+	enum class MouseButton : uint8_t
+	{
+		Left,
+		Right,
+		Middle
+	};
+
+	struct ResizeEvent
+	{
+		int32_t Width;
+		int32_t Height;
+	};
+
+	struct KeyEvent
+	{
+		KeyCode Code;
+		// Generated by holding the key down
+		bool Repeat;
+	};
+
+	// Pixels from the top left of the client area
+	struct MouseEvent
+	{
+		float X;
+		float Y;
+		// MouseButtonPressed and MouseButtonReleased only
+		MouseButton Button;
+	};
+
+	// In scroll wheel notches, positive is up and right
+	struct ScrollEvent
+	{
+		float X;
+		float Y;
+	};
+
+	struct Event
+	{
+		EventType Type;
+		union
+		{
+			ResizeEvent Resize;
+			KeyEvent Key;
+			MouseEvent Mouse;
+			ScrollEvent Scroll;
+		};
+	};
+
+	// Fixed size ring of events filled by Window::PollEvents and drained by the application once per frame, nothing is
+	// allocated after construction. Resizes and mouse moves following one of their own kind replace it, so dragging a
+	// window or moving the mouse can't flood the queue. Events arriving while it's full are dropped. Not thread safe.
+	class EventQueue
+	{
+	public:
+		static constexpr uint32_t Capacity = 256;
+
+		bool Push(const Event& event)
+		{
+			if (m_Head != m_Tail)
+			{
+				Event& newest = m_Events[(m_Head - 1) & (Capacity - 1)];
+				if (newest.Type == event.Type && (event.Type == EventType::WindowResize || event.Type == EventType::MouseMoved))
+				{
+					newest = event;
+					return true;
+				}
+			}
+
+			if (m_Head - m_Tail == Capacity)
+			{
+				m_DroppedCount++;
+				return false;
+			}
+			m_Events[m_Head++ & (Capacity - 1)] = event;
+			return true;
+		}
+
+		bool Pop(Event& event)
+		{
+			if (m_Head == m_Tail)
+				return false;
+			event = m_Events[m_Tail++ & (Capacity - 1)];
+			return true;
+		}
+
+		bool IsEmpty() const { return m_Head == m_Tail; }
+		uint32_t GetDroppedCount() const { return m_DroppedCount; }
+	private:
+		std::array<Event, Capacity> m_Events = {};
+		// Free running, only masked when indexing
+		uint32_t m_Head = 0;
+		uint32_t m_Tail = 0;
+		uint32_t m_DroppedCount = 0;
+	};
+
+}
@@ -1,17 +1,561 @@
 #include "brickpch.hpp"
 #include "BrickEngine/Core/File.hpp"
+#include "BrickEngine/Core/AssetPack.hpp"
+
+#if defined(BRICKENGINE_PLATFORM_WINDOWS)
+	#include <Windows.h>
+	#define BRICKENGINE_FILE_MAPPING_WINDOWS
+#elif __has_include(<sys/mman.h>)
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <cerrno>
+	#define BRICKENGINE_FILE_MAPPING_POSIX
+#endif
 
 namespace BrickEngine {
 
-	std::vector<char> File::LoadFile(const std::string& filepath)
+	static std::mutex s_MountedPacksMutex;
+	static std::vector<std::shared_ptr<AssetPack>> s_MountedPacks;
+
+#if defined(BRICKENGINE_FILE_MAPPING_WINDOWS)
+	static HANDLE OpenForReading(const std::string& filepath, DWORD flags, FileError& error)
+	{
+		HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | flags, nullptr);
+		error = file == INVALID_HANDLE_VALUE ? File::GetOpenError(filepath, GetLastError()) : FileError::None;
+		return file;
+	}
+#elif defined(BRICKENGINE_FILE_MAPPING_POSIX)
+	// Opening a directory read-only succeeds on POSIX, it's rejected here so it fails like it does on Windows
+	static int OpenForReading(const std::string& filepath, struct stat& status, FileError& error)
+	{
+		int file = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+		if (file < 0)
+		{
+			error = File::GetOpenError(filepath, static_cast<uint32_t>(errno));
+			return -1;
+		}
+
+		if (fstat(file, &status) != 0 || S_ISDIR(status.st_mode))
+		{
+			error = S_ISDIR(status.st_mode) ? FileError::IsDirectory : FileError::ReadFailed;
+			close(file);
+			return -1;
+		}
+		error = FileError::None;
+		return file;
+	}
+#endif
+
+	FileView::~FileView()
+	{
+		Reset();
+	}
+
+	FileView::FileView(FileView&& other) noexcept
 	{
+		*this = std::move(other);
+	}
+
+	FileView& FileView::operator=(FileView&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Reset();
+			m_Buffer = std::move(other.m_Buffer);
+			m_Owner = std::move(other.m_Owner);
+			m_Data = other.m_Data;
+			m_Size = other.m_Size;
+			m_Mapped = other.m_Mapped;
+			other.m_Data = nullptr;
+			other.m_Size = 0;
+			other.m_Mapped = false;
+		}
+		return *this;
+	}
+
+	void FileView::Reset()
+	{
+		if (m_Mapped)
+		{
+#if defined(BRICKENGINE_FILE_MAPPING_WINDOWS)
+			UnmapViewOfFile(m_Data);
+#elif defined(BRICKENGINE_FILE_MAPPING_POSIX)
+			munmap(const_cast<char*>(m_Data), m_Size);
+#endif
+		}
+		m_Data = nullptr;
+		m_Size = 0;
+		m_Mapped = false;
+		m_Buffer.clear();
+		m_Buffer.shrink_to_fit();
+		m_Owner.reset();
+	}
+
+	FileError File::LoadFile(const std::string& filepath, std::vector<char>& data)
+	{
+		const AssetPackEntry* entry = nullptr;
+		if (std::shared_ptr<AssetPack> pack = FindInPacks(filepath, entry))
+		{
+			FileView view;
+			FileError error = pack->Read(*entry, view);
+			if (error == FileError::None)
+				data.assign(view.begin(), view.end());
+			return error;
+		}
+
+#if defined(BRICKENGINE_FILE_MAPPING_WINDOWS)
+		FileError error;
+		HANDLE file = OpenForReading(filepath, FILE_FLAG_SEQUENTIAL_SCAN, error);
+		if (file == INVALID_HANDLE_VALUE)
+			return error;
+
+		LARGE_INTEGER size = {};
+		if (!GetFileSizeEx(file, &size))
+		{
+			CloseHandle(file);
+			return FileError::ReadFailed;
+		}
+
+		data.resize(static_cast<size_t>(size.QuadPart));
+		size_t bytesRead = 0;
+		while (bytesRead < data.size())
+		{
+			DWORD chunk = static_cast<DWORD>(std::min<size_t>(data.size() - bytesRead, 1u << 30));
+			DWORD read = 0;
+			if (!ReadFile(file, data.data() + bytesRead, chunk, &read, nullptr) || read == 0)
+			{
+				CloseHandle(file);
+				data.clear();
+				return FileError::ReadFailed;
+			}
+			bytesRead += read;
+		}
+
+		CloseHandle(file);
+		return FileError::None;
+#elif defined(BRICKENGINE_FILE_MAPPING_POSIX)
+		struct stat status = {};
+		FileError error;
+		int file = OpenForReading(filepath, status, error);
+		if (file < 0)
+			return error;
+
+		data.resize(static_cast<size_t>(status.st_size));
+		size_t bytesRead = 0;
+		while (bytesRead < data.size())
+		{
+			ssize_t result = read(file, data.data() + bytesRead, data.size() - bytesRead);
+			if (result < 0 && errno == EINTR)
+				continue;
+			if (result <= 0)
+			{
+				close(file);
+				data.clear();
+				return FileError::ReadFailed;
+			}
+			bytesRead += static_cast<size_t>(result);
+		}
+
+		close(file);
+		return FileError::None;
+#else
 		std::ifstream file(filepath, std::ios::ate | std::ios::binary);
-		BRICKENGINE_ASSERT(file.is_open());
-		std::vector<char> data(file.tellg());
+		if (!file.is_open())
+			return FileError::NotFound;
+
+		std::streamoff size = file.tellg();
+		if (size < 0)
+			return FileError::ReadFailed;
+
+		data.resize(static_cast<size_t>(size));
 		file.seekg(0);
 		file.read(data.data(), data.size() * sizeof(char));
-		file.close();
-		return data;
+		if (!file)
+		{
+			data.clear();
+			return FileError::ReadFailed;
+		}
+		return FileError::None;
+#endif
+	}
+
+	FileError File::MapFile(const std::string& filepath, FileView& view)
+	{
+		view.Reset();
+
+		const AssetPackEntry* entry = nullptr;
+		if (std::shared_ptr<AssetPack> pack = FindInPacks(filepath, entry))
+			return pack->Read(*entry, view);
+
+#if defined(BRICKENGINE_FILE_MAPPING_WINDOWS)
+		FileError error;
+		HANDLE file = OpenForReading(filepath, FILE_FLAG_SEQUENTIAL_SCAN, error);
+		if (file == INVALID_HANDLE_VALUE)
+			return error;
+
+		LARGE_INTEGER size = {};
+		if (!GetFileSizeEx(file, &size))
+		{
+			CloseHandle(file);
+			return FileError::ReadFailed;
+		}
+
+		if (size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return FileError::None;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (mapping)
+			CloseHandle(mapping);
+		CloseHandle(file);
+
+		if (data)
+		{
+			view.m_Data = static_cast<const char*>(data);
+			view.m_Size = static_cast<size_t>(size.QuadPart);
+			view.m_Mapped = true;
+			return FileError::None;
+		}
+#elif defined(BRICKENGINE_FILE_MAPPING_POSIX)
+		struct stat status = {};
+		FileError error;
+		int file = OpenForReading(filepath, status, error);
+		if (file < 0)
+			return error;
+
+		if (status.st_size == 0)
+		{
+			close(file);
+			return FileError::None;
+		}
+
+		void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+
+		if (data != MAP_FAILED)
+		{
+			madvise(data, static_cast<size_t>(status.st_size), MADV_WILLNEED);
+			view.m_Data = static_cast<const char*>(data);
+			view.m_Size = static_cast<size_t>(status.st_size);
+			view.m_Mapped = true;
+			return FileError::None;
+		}
+#endif
+
+		// Mapping is unavailable, read the file into memory instead
+#if !defined(BRICKENGINE_FILE_MAPPING_WINDOWS) && !defined(BRICKENGINE_FILE_MAPPING_POSIX)
+		FileError error;
+#endif
+		error = LoadFile(filepath, view.m_Buffer);
+		if (error != FileError::None)
+			return error;
+
+		view.m_Data = view.m_Buffer.data();
+		view.m_Size = view.m_Buffer.size();
+		return FileError::None;
+	}
+
+	FileError File::GetFileSize(const std::string& filepath, uint64_t& size)
+	{
+		const AssetPackEntry* entry = nullptr;
+		if (FindInPacks(filepath, entry))
+		{
+			size = entry->UncompressedSize;
+			return FileError::None;
+		}
+
+#if defined(BRICKENGINE_FILE_MAPPING_WINDOWS)
+		WIN32_FILE_ATTRIBUTE_DATA attributes = {};
+		if (!GetFileAttributesExA(filepath.c_str(), GetFileExInfoStandard, &attributes))
+			return GetOpenError(filepath, GetLastError());
+		if (attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			return FileError::IsDirectory;
+		size = (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+		return FileError::None;
+#elif defined(BRICKENGINE_FILE_MAPPING_POSIX)
+		struct stat status = {};
+		if (stat(filepath.c_str(), &status) != 0)
+			return GetOpenError(filepath, static_cast<uint32_t>(errno));
+		if (S_ISDIR(status.st_mode))
+			return FileError::IsDirectory;
+		size = static_cast<uint64_t>(status.st_size);
+		return FileError::None;
+#else
+		std::ifstream file(filepath, std::ios::ate | std::ios::binary);
+		if (!file.is_open())
+			return FileError::NotFound;
+		size = static_cast<uint64_t>(file.tellg());
+		return FileError::None;
+#endif
+	}
+
+	FileError File::ReadFileRange(const std::string& filepath, uint64_t offset, void* buffer, size_t size, size_t& bytesRead)
+	{
+		bytesRead = 0;
+
+		const AssetPackEntry* entry = nullptr;
+		if (std::shared_ptr<AssetPack> pack = FindInPacks(filepath, entry))
+			return pack->ReadRange(*entry, offset, buffer, size, bytesRead);
+
+#if defined(BRICKENGINE_FILE_MAPPING_WINDOWS)
+		FileError error;
+		HANDLE file = OpenForReading(filepath, 0, error);
+		if (file == INVALID_HANDLE_VALUE)
+			return error;
+
+		while (bytesRead < size)
+		{
+			uint64_t position = offset + bytesRead;
+			OVERLAPPED overlapped = {};
+			overlapped.Offset = static_cast<DWORD>(position);
+			overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+
+			DWORD chunk = static_cast<DWORD>(std::min<size_t>(size - bytesRead, 1u << 30));
+			DWORD read = 0;
+			if (!ReadFile(file, static_cast<char*>(buffer) + bytesRead, chunk, &read, &overlapped))
+			{
+				if (GetLastError() == ERROR_HANDLE_EOF)
+					break;
+				CloseHandle(file);
+				return FileError::ReadFailed;
+			}
+			if (read == 0)
+				break;
+			bytesRead += read;
+		}
+
+		CloseHandle(file);
+		return FileError::None;
+#elif defined(BRICKENGINE_FILE_MAPPING_POSIX)
+		struct stat status = {};
+		FileError error;
+		int file = OpenForReading(filepath, status, error);
+		if (file < 0)
+			return error;
+
+		while (bytesRead < size)
+		{
+			ssize_t read = pread(file, static_cast<char*>(buffer) + bytesRead, size - bytesRead, static_cast<off_t>(offset + bytesRead));
+			if (read < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				close(file);
+				return FileError::ReadFailed;
+			}
+			if (read == 0)
+				break;
+			bytesRead += static_cast<size_t>(read);
+		}
+
+		close(file);
+		return FileError::None;
+#else
+		std::ifstream file(filepath, std::ios::binary);
+		if (!file.is_open())
+			return FileError::NotFound;
+
+		file.seekg(static_cast<std::streamoff>(offset));
+		file.read(static_cast<char*>(buffer), static_cast<std::streamsize>(size));
+		bytesRead = static_cast<size_t>(file.gcount());
+		if (file.bad())
+			return FileError::ReadFailed;
+		return FileError::None;
+#endif
+	}
+
+	FileError File::WriteFile(const std::string& filepath, const void* data, size_t size)
+	{
+		// Unique per process and call, so concurrent writers of the same file never share a temporary file
+		static std::atomic<uint32_t> s_TemporaryCounter = 0;
+#if defined(BRICKENGINE_FILE_MAPPING_WINDOWS)
+		uint64_t processId = GetCurrentProcessId();
+#elif defined(BRICKENGINE_FILE_MAPPING_POSIX)
+		uint64_t processId = static_cast<uint64_t>(getpid());
+#else
+		uint64_t processId = static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif
+		std::string temporaryFilepath = filepath + "." + std::to_string(processId) + "." + std::to_string(s_TemporaryCounter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+
+#if defined(BRICKENGINE_FILE_MAPPING_WINDOWS)
+		HANDLE file = CreateFileA(temporaryFilepath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return FileError::AccessDenied;
+
+		size_t bytesWritten = 0;
+		while (bytesWritten < size)
+		{
+			DWORD chunk = static_cast<DWORD>(std::min<size_t>(size - bytesWritten, 1u << 30));
+			DWORD written = 0;
+			if (!::WriteFile(file, static_cast<const char*>(data) + bytesWritten, chunk, &written, nullptr) || written == 0)
+			{
+				CloseHandle(file);
+				DeleteFileA(temporaryFilepath.c_str());
+				return FileError::WriteFailed;
+			}
+			bytesWritten += written;
+		}
+
+		bool flushed = FlushFileBuffers(file);
+		CloseHandle(file);
+		if (!flushed || !MoveFileExA(temporaryFilepath.c_str(), filepath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+		{
+			DeleteFileA(temporaryFilepath.c_str());
+			return FileError::WriteFailed;
+		}
+		return FileError::None;
+#elif defined(BRICKENGINE_FILE_MAPPING_POSIX)
+		int file = open(temporaryFilepath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+		if (file < 0)
+			return FileError::AccessDenied;
+
+		size_t bytesWritten = 0;
+		while (bytesWritten < size)
+		{
+			ssize_t written = write(file, static_cast<const char*>(data) + bytesWritten, size - bytesWritten);
+			if (written < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				close(file);
+				unlink(temporaryFilepath.c_str());
+				return FileError::WriteFailed;
+			}
+			bytesWritten += static_cast<size_t>(written);
+		}
+
+		// The data has to be on disk before the rename, otherwise a crash can leave an empty file behind
+		bool synced = fsync(file) == 0;
+		close(file);
+		if (!synced || rename(temporaryFilepath.c_str(), filepath.c_str()) != 0)
+		{
+			unlink(temporaryFilepath.c_str());
+			return FileError::WriteFailed;
+		}
+
+		// The rename itself only survives a crash once the directory entry is on disk too
+		size_t separator = filepath.find_last_of('/');
+		std::string directory = separator == std::string::npos ? "." : separator == 0 ? "/" : filepath.substr(0, separator);
+		int directoryFile = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (directoryFile < 0)
+			return FileError::WriteFailed;
+		// Some file systems can't sync directories and report EINVAL, there is nothing more to do on those
+		bool directorySynced = fsync(directoryFile) == 0 || errno == EINVAL;
+		close(directoryFile);
+		return directorySynced ? FileError::None : FileError::WriteFailed;
+#else
+		{
+			std::ofstream file(temporaryFilepath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+				return FileError::AccessDenied;
+
+			file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+			if (!file)
+				return FileError::WriteFailed;
+		}
+
+		std::remove(filepath.c_str());
+		if (std::rename(temporaryFilepath.c_str(), filepath.c_str()) != 0)
+		{
+			std::remove(temporaryFilepath.c_str());
+			return FileError::WriteFailed;
+		}
+		return FileError::None;
+#endif
+	}
+
+	FileError File::MountPack(const std::string& filepath)
+	{
+		std::shared_ptr<AssetPack> pack;
+		FileError error = AssetPack::Open(filepath, pack);
+		if (error != FileError::None)
+			return error;
+
+		std::lock_guard<std::mutex> lock(s_MountedPacksMutex);
+		s_MountedPacks.push_back(std::move(pack));
+		return FileError::None;
+	}
+
+	void File::UnmountPack(const std::string& filepath)
+	{
+		std::lock_guard<std::mutex> lock(s_MountedPacksMutex);
+		s_MountedPacks.erase(std::remove_if(s_MountedPacks.begin(), s_MountedPacks.end(), [&](const std::shared_ptr<AssetPack>& pack)
+			{
+				return pack->GetFilepath() == filepath;
+			}
+		), s_MountedPacks.end());
+	}
+
+	void File::UnmountAllPacks()
+	{
+		std::lock_guard<std::mutex> lock(s_MountedPacksMutex);
+		s_MountedPacks.clear();
+	}
+
+	std::shared_ptr<AssetPack> File::FindInPacks(const std::string& filepath, const AssetPackEntry*& entry)
+	{
+		std::lock_guard<std::mutex> lock(s_MountedPacksMutex);
+		if (s_MountedPacks.empty())
+			return nullptr;
+
+		std::string path = AssetPack::NormalizePath(filepath);
+		for (auto it = s_MountedPacks.rbegin(); it != s_MountedPacks.rend(); it++)
+		{
+			entry = (*it)->Find(path);
+			if (entry)
+				return *it;
+		}
+		return nullptr;
+	}
+
+	const char* File::GetErrorString(FileError error)
+	{
+		switch (error)
+		{
+		case FileError::None:			return "None";
+		case FileError::NotFound:		return "File not found";
+		case FileError::AccessDenied:	return "Access denied";
+		case FileError::ReadFailed:		return "Read failed";
+		case FileError::WriteFailed:	return "Write failed";
+		case FileError::InvalidFormat:	return "Invalid format";
+		case FileError::IsDirectory:	return "Is a directory";
+		}
+		return "Unknown";
+	}
+
+	FileError File::GetOpenError(const std::string& filepath, uint32_t error)
+	{
+#if defined(BRICKENGINE_FILE_MAPPING_WINDOWS)
+		if (error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND || error == ERROR_INVALID_NAME)
+			return FileError::NotFound;
+		if (error == ERROR_ACCESS_DENIED || error == ERROR_SHARING_VIOLATION)
+		{
+			// Opening a directory as a file is refused with ERROR_ACCESS_DENIED
+			DWORD attributes = GetFileAttributesA(filepath.c_str());
+			if (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY))
+				return FileError::IsDirectory;
+			return FileError::AccessDenied;
+		}
+		return FileError::ReadFailed;
+#elif defined(BRICKENGINE_FILE_MAPPING_POSIX)
+		(void)filepath;
+		if (error == ENOENT || error == ENOTDIR)
+			return FileError::NotFound;
+		if (error == EACCES || error == EPERM)
+			return FileError::AccessDenied;
+		if (error == EISDIR)
+			return FileError::IsDirectory;
+		return FileError::ReadFailed;
+#else
+		(void)filepath;
+		(void)error;
+		return FileError::NotFound;
+#endif
 	}
 
 }
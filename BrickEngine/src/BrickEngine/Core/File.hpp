@@ -4,12 +4,77 @@
 
 namespace BrickEngine {
 
+	enum class FileError : uint8_t
+	{
+		None,
+		NotFound,
+		AccessDenied,
+		ReadFailed,
+		WriteFailed,
+		InvalidFormat,
+		IsDirectory
+	};
+
+	// Read-only view of a whole file, memory mapped when the platform allows it and read into memory otherwise.
+	class BRICKENGINE_API FileView
+	{
+		friend class File;
+		friend class AssetPack;
+	public:
+		FileView() = default;
+		~FileView();
+
+		FileView(FileView&& other) noexcept;
+		FileView& operator=(FileView&& other) noexcept;
+
+		FileView(const FileView&) = delete;
+		FileView& operator=(const FileView&) = delete;
+
+		const char* GetData() const { return m_Data; }
+		size_t GetSize() const { return m_Size; }
+		bool IsMapped() const { return m_Mapped; }
+
+		const char* begin() const { return m_Data; }
+		const char* end() const { return m_Data + m_Size; }
+	private:
+		void Reset();
+	private:
+		const char* m_Data = nullptr;
+		size_t m_Size = 0;
+		bool m_Mapped = false;
+		std::vector<char> m_Buffer = {};
+		// Keeps the memory m_Data points into alive when the view doesn't own it, such as an entry of a mounted pack
+		std::shared_ptr<const void> m_Owner = nullptr;
+	};
+
+	class AssetPack;
+	struct AssetPackEntry;
+
+	// Mounted packs are searched in reverse mount order before falling back to loose files.
 	class File
 	{
+		friend class AsyncFileService;
 	public:
 		File() = delete;
 
-		static std::vector<char> LoadFile(const std::string& filepath);
+		static FileError LoadFile(const std::string& filepath, std::vector<char>& data);
+		static FileError MapFile(const std::string& filepath, FileView& view);
+
+		static FileError GetFileSize(const std::string& filepath, uint64_t& size);
+		static FileError ReadFileRange(const std::string& filepath, uint64_t offset, void* buffer, size_t size, size_t& bytesRead);
+		// Writes to a temporary file next to filepath and renames it over the target, readers never see a partial file.
+		// Concurrent writers each get their own temporary file, the last rename wins.
+		static FileError WriteFile(const std::string& filepath, const void* data, size_t size);
+
+		static FileError MountPack(const std::string& filepath);
+		static void UnmountPack(const std::string& filepath);
+		static void UnmountAllPacks();
+
+		static const char* GetErrorString(FileError error);
+		// Maps the errno or GetLastError of a failed open of filepath, so every entry point reports the same FileError
+		static FileError GetOpenError(const std::string& filepath, uint32_t error);
+	private:
+		static std::shared_ptr<AssetPack> FindInPacks(const std::string& filepath, const AssetPackEntry*& entry);
 	};
 
 }
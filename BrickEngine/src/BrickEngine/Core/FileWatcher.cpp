@@ -0,0 +1,204 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Core/FileWatcher.hpp"
+
+#if defined(BRICKENGINE_PLATFORM_WINDOWS)
+	#include <Windows.h>
+#elif defined(BRICKENGINE_PLATFORM_LINUX)
+	#include <sys/inotify.h>
+	#include <poll.h>
+	#include <unistd.h>
+	#include <cerrno>
+#endif
+
+namespace BrickEngine {
+
+#if defined(BRICKENGINE_PLATFORM_WINDOWS)
+
+	struct FileWatcher::Handles
+	{
+		HANDLE Directory = INVALID_HANDLE_VALUE;
+		HANDLE Event = nullptr;
+		OVERLAPPED Overlapped = {};
+		// FILE_NOTIFY_INFORMATION records have to be DWORD aligned
+		alignas(DWORD) uint8_t Buffer[16 * 1024] = {};
+		bool Pending = false;
+
+		bool Read()
+		{
+			Overlapped = {};
+			Overlapped.hEvent = Event;
+			Pending = ReadDirectoryChangesW(Directory, Buffer, sizeof(Buffer), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE, nullptr, &Overlapped, nullptr) != FALSE;
+			return Pending;
+		}
+	};
+
+	FileWatcher::FileWatcher(const std::string& directory)
+		: m_Directory(directory), m_Handles(std::make_unique<Handles>())
+	{
+		m_Handles->Directory = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+		if (m_Handles->Directory == INVALID_HANDLE_VALUE)
+		{
+			Log::Warn(LogCategory::File, "Can't watch '{}', error {}", directory, GetLastError());
+			return;
+		}
+
+		m_Handles->Event = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+		if (!m_Handles->Read())
+			Log::Warn(LogCategory::File, "Can't watch '{}', error {}", directory, GetLastError());
+	}
+
+	FileWatcher::~FileWatcher()
+	{
+		if (m_Handles->Pending)
+		{
+			CancelIo(m_Handles->Directory);
+			DWORD bytes = 0;
+			GetOverlappedResult(m_Handles->Directory, &m_Handles->Overlapped, &bytes, TRUE);
+		}
+		if (m_Handles->Event)
+			CloseHandle(m_Handles->Event);
+		if (m_Handles->Directory != INVALID_HANDLE_VALUE)
+			CloseHandle(m_Handles->Directory);
+	}
+
+	bool FileWatcher::IsWatching() const
+	{
+		return m_Handles->Pending;
+	}
+
+	bool FileWatcher::Wait(std::vector<std::string>& changedFiles, uint32_t timeoutMs)
+	{
+		if (!m_Handles->Pending)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+			return false;
+		}
+
+		if (WaitForSingleObject(m_Handles->Event, timeoutMs) != WAIT_OBJECT_0)
+			return false;
+
+		DWORD bytes = 0;
+		m_Handles->Pending = false;
+		if (!GetOverlappedResult(m_Handles->Directory, &m_Handles->Overlapped, &bytes, FALSE))
+			bytes = 0;
+
+		// Zero bytes means the buffer overflowed and the changes are lost, callers see nothing changed
+		size_t count = changedFiles.size();
+		for (DWORD offset = 0; bytes > 0;)
+		{
+			const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(m_Handles->Buffer + offset);
+			if (info->Action != FILE_ACTION_REMOVED && info->Action != FILE_ACTION_RENAMED_OLD_NAME)
+			{
+				int nameLength = static_cast<int>(info->FileNameLength / sizeof(WCHAR));
+				int size = WideCharToMultiByte(CP_UTF8, 0, info->FileName, nameLength, nullptr, 0, nullptr, nullptr);
+				std::string& name = changedFiles.emplace_back(size, '\0');
+				WideCharToMultiByte(CP_UTF8, 0, info->FileName, nameLength, name.data(), size, nullptr, nullptr);
+			}
+			if (info->NextEntryOffset == 0)
+				break;
+			offset += info->NextEntryOffset;
+		}
+
+		ResetEvent(m_Handles->Event);
+		m_Handles->Read();
+		return changedFiles.size() > count;
+	}
+
+#elif defined(BRICKENGINE_PLATFORM_LINUX)
+
+	struct FileWatcher::Handles
+	{
+		int Instance = -1;
+		int Watch = -1;
+	};
+
+	FileWatcher::FileWatcher(const std::string& directory)
+		: m_Directory(directory), m_Handles(std::make_unique<Handles>())
+	{
+		m_Handles->Instance = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (m_Handles->Instance < 0)
+		{
+			Log::Warn(LogCategory::File, "Can't watch '{}': {}", directory, strerror(errno));
+			return;
+		}
+
+		// Editors either write in place or write a new file and move it over the old one
+		m_Handles->Watch = inotify_add_watch(m_Handles->Instance, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (m_Handles->Watch < 0)
+			Log::Warn(LogCategory::File, "Can't watch '{}': {}", directory, strerror(errno));
+	}
+
+	FileWatcher::~FileWatcher()
+	{
+		if (m_Handles->Instance >= 0)
+			close(m_Handles->Instance);
+	}
+
+	bool FileWatcher::IsWatching() const
+	{
+		return m_Handles->Watch >= 0;
+	}
+
+	bool FileWatcher::Wait(std::vector<std::string>& changedFiles, uint32_t timeoutMs)
+	{
+		if (!IsWatching())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+			return false;
+		}
+
+		pollfd descriptor = {};
+		descriptor.fd = m_Handles->Instance;
+		descriptor.events = POLLIN;
+		if (poll(&descriptor, 1, static_cast<int>(timeoutMs)) <= 0)
+			return false;
+
+		size_t count = changedFiles.size();
+		alignas(inotify_event) char buffer[4096];
+		for (;;)
+		{
+			ssize_t bytes = read(m_Handles->Instance, buffer, sizeof(buffer));
+			if (bytes <= 0)
+				break;
+
+			for (ssize_t offset = 0; offset < bytes;)
+			{
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+				if (event->len > 0 && !(event->mask & IN_ISDIR))
+					changedFiles.emplace_back(event->name);
+				offset += sizeof(inotify_event) + event->len;
+			}
+		}
+		return changedFiles.size() > count;
+	}
+
+#else
+
+	struct FileWatcher::Handles
+	{
+	};
+
+	FileWatcher::FileWatcher(const std::string& directory)
+		: m_Directory(directory), m_Handles(std::make_unique<Handles>())
+	{
+		Log::Warn(LogCategory::File, "Watching files isn't supported on this platform");
+	}
+
+	FileWatcher::~FileWatcher()
+	{
+	}
+
+	bool FileWatcher::IsWatching() const
+	{
+		return false;
+	}
+
+	bool FileWatcher::Wait(std::vector<std::string>& changedFiles, uint32_t timeoutMs)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+		return false;
+	}
+
+#endif
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+namespace BrickEngine {
+
+	// Reports files written, created or moved into one directory, subdirectories aren't watched. Uses inotify on Linux and
+	// ReadDirectoryChangesW on Windows. Wait blocks, so a watcher belongs to a background thread. Not thread safe.
+	class FileWatcher
+	{
+	public:
+		explicit FileWatcher(const std::string& directory);
+		~FileWatcher();
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		// False when the directory couldn't be watched, Wait then never reports anything
+		bool IsWatching() const;
+		const std::string& GetDirectory() const { return m_Directory; }
+
+		// Waits up to timeoutMs for changes and appends the names of the changed files, relative to the directory. A file
+		// written several times is reported as often. Returns false when nothing changed in time.
+		bool Wait(std::vector<std::string>& changedFiles, uint32_t timeoutMs);
+	private:
+		// Platform handles, keeps the system headers out of this one
+		struct Handles;
+
+		std::string m_Directory = {};
+		std::unique_ptr<Handles> m_Handles;
+	};
+
+}
@@ -0,0 +1,169 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Core/FramePacer.hpp"
+
+#if defined(BRICKENGINE_PLATFORM_WINDOWS)
+	#include <Windows.h>
+#elif __has_include(<time.h>)
+	#include <time.h>
+#endif
+
+namespace BrickEngine {
+
+	FramePacer::FramePacer(FramePacingMode mode, double targetRate, double simulationRate)
+		: m_Mode(mode), m_SimulationDelta(1.0 / simulationRate)
+	{
+		BRICKENGINE_ASSERT(simulationRate > 0.0);
+		SetTargetRate(targetRate);
+		m_SortedHistory.reserve(HistorySize);
+
+		m_FrameStart = Clock::now();
+		m_Deadline = m_FrameStart;
+		ResetStats();
+	}
+
+	void FramePacer::SetMode(FramePacingMode mode)
+	{
+		m_Mode = mode;
+		m_Deadline = Clock::now();
+	}
+
+	void FramePacer::SetTargetRate(double rate)
+	{
+		BRICKENGINE_ASSERT(rate > 0.0);
+		m_TargetPeriod = 1.0 / rate;
+	}
+
+	double FramePacer::BeginFrame()
+	{
+		Clock::time_point now;
+		if (m_Mode == FramePacingMode::TargetRate)
+		{
+			// Deadlines follow each other exactly so waits don't accumulate drift. After a long frame the schedule restarts
+			// from now instead of rushing through the missed frames.
+			auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_TargetPeriod));
+			m_Deadline += period;
+			now = Clock::now();
+			if (now < m_Deadline)
+			{
+				WaitUntil(m_Deadline);
+				now = Clock::now();
+			}
+			else if (now - m_Deadline > period)
+			{
+				m_Deadline = now;
+			}
+		}
+		else
+		{
+			now = Clock::now();
+		}
+
+		double frameTime = std::chrono::duration<double>(now - m_FrameStart).count();
+		m_FrameStart = now;
+
+		m_History[m_HistoryCount % HistorySize] = static_cast<float>(frameTime);
+		m_HistoryCount++;
+
+		frameTime = std::min(frameTime, MaxFrameTime);
+		m_Accumulator += frameTime;
+		return frameTime;
+	}
+
+	bool FramePacer::StepSimulation()
+	{
+		if (m_Accumulator < m_SimulationDelta)
+			return false;
+		m_Accumulator -= m_SimulationDelta;
+		return true;
+	}
+
+	void FramePacer::WaitUntil(Clock::time_point deadline)
+	{
+		using namespace std::chrono;
+
+		// Sleeps overshoot by the scheduler's granularity, so only sleep while more than a pessimistic sleep length is
+		// left and spin for the rest. The estimate follows what the sleeps actually took on this machine.
+		for (;;)
+		{
+			Clock::time_point start = Clock::now();
+			double remaining = duration<double>(deadline - start).count();
+			double estimate = m_SleepMean + std::sqrt(m_SleepVariance);
+			if (remaining <= estimate)
+				break;
+
+			std::this_thread::sleep_for(milliseconds(1));
+
+			double observed = duration<double>(Clock::now() - start).count();
+			double difference = observed - m_SleepMean;
+			m_SleepMean += difference * 0.05;
+			m_SleepVariance = (1.0 - 0.05) * (m_SleepVariance + 0.05 * difference * difference);
+		}
+
+		while (Clock::now() < deadline)
+			std::this_thread::yield();
+	}
+
+	FrameTimeStats FramePacer::ComputeStats()
+	{
+		FrameTimeStats stats;
+		stats.FrameCount = std::min(m_HistoryCount, HistorySize);
+		if (stats.FrameCount == 0)
+			return stats;
+
+		m_SortedHistory.assign(m_History.begin(), m_History.begin() + stats.FrameCount);
+		std::sort(m_SortedHistory.begin(), m_SortedHistory.end());
+
+		double sum = 0.0;
+		for (float frameTime : m_SortedHistory)
+			sum += frameTime;
+		double mean = sum / stats.FrameCount;
+
+		double squares = 0.0;
+		for (float frameTime : m_SortedHistory)
+			squares += (frameTime - mean) * (frameTime - mean);
+
+		double median = m_SortedHistory[stats.FrameCount / 2];
+		double hitchTime = m_Mode == FramePacingMode::TargetRate ? 1.5 * m_TargetPeriod : 2.0 * median;
+		for (float frameTime : m_SortedHistory)
+			stats.HitchCount += frameTime > hitchTime ? 1 : 0;
+
+		stats.MeanMs = mean * 1000.0;
+		stats.P50Ms = median * 1000.0;
+		stats.P99Ms = m_SortedHistory[std::min(stats.FrameCount - 1, stats.FrameCount * 99 / 100)] * 1000.0;
+		stats.MaxMs = m_SortedHistory.back() * 1000.0;
+		stats.JitterMs = std::sqrt(squares / stats.FrameCount) * 1000.0;
+
+		double wallTime = std::chrono::duration<double>(Clock::now() - m_StatsStart).count();
+		double cpuTime = GetProcessCpuTime();
+		stats.CpuUsage = cpuTime >= 0.0 && wallTime > 0.0 ? (cpuTime - m_StatsCpuStart) / wallTime : -1.0;
+		return stats;
+	}
+
+	void FramePacer::ResetStats()
+	{
+		m_HistoryCount = 0;
+		m_StatsStart = Clock::now();
+		m_StatsCpuStart = GetProcessCpuTime();
+	}
+
+	double FramePacer::GetProcessCpuTime()
+	{
+#if defined(BRICKENGINE_PLATFORM_WINDOWS)
+		FILETIME creationTime, exitTime, kernelTime, userTime;
+		if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+			return -1.0;
+		// 100 ns units
+		uint64_t kernel = (static_cast<uint64_t>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+		uint64_t user = (static_cast<uint64_t>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+		return (kernel + user) * 1e-7;
+#elif defined(CLOCK_PROCESS_CPUTIME_ID)
+		timespec time;
+		if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0)
+			return -1.0;
+		return time.tv_sec + time.tv_nsec * 1e-9;
+#else
+		return -1.0;
+#endif
+	}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+namespace BrickEngine {
+
+	enum class FramePacingMode : uint8_t
+	{
+		// Frames start as soon as the previous one ended
+		Unlimited,
+		// Frames start at a fixed rate, the pacer sleeps most of the wait and spins the rest
+		TargetRate,
+		// Presenting blocks until the display is ready, the pacer only measures
+		VSync
+	};
+
+	struct FrameTimeStats
+	{
+		uint32_t FrameCount = 0;
+		double MeanMs = 0.0;
+		double P50Ms = 0.0;
+		double P99Ms = 0.0;
+		double MaxMs = 0.0;
+		// Standard deviation of the frame times
+		double JitterMs = 0.0;
+		// Frames taking more than 1.5 times the target frame time, or twice the median without a target
+		uint32_t HitchCount = 0;
+		// Process CPU time over wall time, 1.0 is one core kept busy. Negative where the platform can't tell.
+		double CpuUsage = 0.0;
+	};
+
+	// Decides when frames start and how far the simulation advances. Call BeginFrame once at the top of every frame,
+	// then StepSimulation in a loop to run fixed steps and GetInterpolation to blend the rendered state between the last
+	// two of them. The clock is read once per frame. Not thread safe.
+	class FramePacer
+	{
+	public:
+		// Frame times kept for the stats, the oldest is overwritten
+		static constexpr uint32_t HistorySize = 1024;
+		// Longer frames are clamped so a breakpoint or a stall doesn't make the simulation run hundreds of steps
+		static constexpr double MaxFrameTime = 0.25;
+
+		FramePacer(FramePacingMode mode = FramePacingMode::VSync, double targetRate = 60.0, double simulationRate = 60.0);
+
+		void SetMode(FramePacingMode mode);
+		void SetTargetRate(double rate);
+		FramePacingMode GetMode() const { return m_Mode; }
+		double GetTargetRate() const { return 1.0 / m_TargetPeriod; }
+
+		// Waits until the next frame should start, returns the seconds since the previous frame started
+		double BeginFrame();
+
+		// True while a fixed step of GetSimulationDelta seconds is due, consumes it
+		bool StepSimulation();
+		double GetSimulationDelta() const { return m_SimulationDelta; }
+		// Between 0 and 1, how far the frame is past the last simulation step towards the next one
+		double GetInterpolation() const { return m_Accumulator / m_SimulationDelta; }
+
+		// Over the frames since the last ResetStats, at most HistorySize of them
+		FrameTimeStats ComputeStats();
+		void ResetStats();
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		void WaitUntil(Clock::time_point deadline);
+		static double GetProcessCpuTime();
+	private:
+		FramePacingMode m_Mode = FramePacingMode::VSync;
+		double m_TargetPeriod = 0.0;
+		double m_SimulationDelta = 0.0;
+		double m_Accumulator = 0.0;
+
+		Clock::time_point m_FrameStart = {};
+		Clock::time_point m_Deadline = {};
+
+		// Running estimate of how long a 1 ms sleep really takes, waits spin once less than that is left
+		double m_SleepMean = 0.001;
+		double m_SleepVariance = 0.0;
+
+		std::array<float, HistorySize> m_History = {};
+		uint32_t m_HistoryCount = 0;
+		// Reused by ComputeStats
+		std::vector<float> m_SortedHistory = {};
+		Clock::time_point m_StatsStart = {};
+		double m_StatsCpuStart = 0.0;
+	};
+
+}
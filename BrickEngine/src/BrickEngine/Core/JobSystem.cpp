@@ -0,0 +1,330 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Core/JobSystem.hpp"
+
+#include "BrickEngine/Core/Profiler.hpp"
+
+namespace BrickEngine {
+
+	bool JobDeque::Push(Job* job)
+	{
+		int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+		int64_t top = m_Top.load(std::memory_order_acquire);
+		if (bottom - top >= Capacity)
+			return false;
+
+		m_Jobs[bottom & (Capacity - 1)].store(job, std::memory_order_relaxed);
+		m_Bottom.store(bottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	Job* JobDeque::Pop()
+	{
+		int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+		m_Bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = m_Top.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Job* job = m_Jobs[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+		if (top == bottom)
+		{
+			// Last job, race the thieves for it
+			if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				job = nullptr;
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	Job* JobDeque::Steal()
+	{
+		int64_t top = m_Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+
+		if (top >= bottom)
+			return nullptr;
+
+		Job* job = m_Jobs[top & (Capacity - 1)].load(std::memory_order_relaxed);
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+		return job;
+	}
+
+	constexpr uint32_t s_SpinCountBeforeSleep = 64;
+
+	struct JobWorker
+	{
+		JobDeque Deque;
+		std::vector<Job*> FreeJobs;
+		std::thread Thread;
+		uint32_t NextVictim = 0;
+	};
+
+	static std::vector<std::unique_ptr<JobWorker>> s_Workers;
+	static std::atomic<bool> s_Initialized = false;
+	static std::atomic<bool> s_Running = false;
+
+	static std::mutex s_SharedQueueMutex;
+	static std::deque<Job*> s_SharedQueue;
+	static std::atomic<uint32_t> s_SharedQueueSize = 0;
+
+	static std::mutex s_SleepMutex;
+	static std::condition_variable s_SleepCondition;
+	static std::atomic<uint32_t> s_SleepingCount = 0;
+
+	static thread_local int32_t t_WorkerIndex = -1;
+
+	void JobSystem::ExecuteJob(Job* job)
+	{
+		job->Invoke(*job);
+		job->Destroy(*job);
+
+		JobCounter* counter = job->Counter;
+
+		if (t_WorkerIndex >= 0)
+			s_Workers[t_WorkerIndex]->FreeJobs.push_back(job);
+		else
+			delete job;
+
+		if (counter)
+			counter->m_Count.fetch_sub(1, std::memory_order_release);
+	}
+
+	static Job* FindJob()
+	{
+		int32_t workerIndex = t_WorkerIndex;
+		if (workerIndex >= 0)
+		{
+			if (Job* job = s_Workers[workerIndex]->Deque.Pop())
+				return job;
+		}
+
+		if (s_SharedQueueSize.load(std::memory_order_acquire) > 0)
+		{
+			std::lock_guard<std::mutex> lock(s_SharedQueueMutex);
+			if (!s_SharedQueue.empty())
+			{
+				Job* job = s_SharedQueue.front();
+				s_SharedQueue.pop_front();
+				s_SharedQueueSize.fetch_sub(1, std::memory_order_release);
+				return job;
+			}
+		}
+
+		uint32_t workerCount = static_cast<uint32_t>(s_Workers.size());
+		uint32_t start = workerIndex >= 0 ? s_Workers[workerIndex]->NextVictim++ : 0;
+		for (uint32_t i = 0; i < workerCount; i++)
+		{
+			uint32_t victim = (start + i) % workerCount;
+			if (static_cast<int32_t>(victim) == workerIndex)
+				continue;
+
+			if (Job* job = s_Workers[victim]->Deque.Steal())
+				return job;
+		}
+
+		return nullptr;
+	}
+
+	static bool HasPendingJobs()
+	{
+		if (s_SharedQueueSize.load(std::memory_order_acquire) > 0)
+			return true;
+
+		for (auto& worker : s_Workers)
+		{
+			if (!worker->Deque.IsEmpty())
+				return true;
+		}
+		return false;
+	}
+
+	static void WakeWorker()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (s_SleepingCount.load(std::memory_order_relaxed) > 0)
+		{
+			std::lock_guard<std::mutex> lock(s_SleepMutex);
+			s_SleepCondition.notify_one();
+		}
+	}
+
+	void JobSystem::WorkerMain(int32_t workerIndex)
+	{
+		t_WorkerIndex = workerIndex;
+		BRICKENGINE_PROFILE_THREAD("Worker " + std::to_string(workerIndex));
+
+		uint32_t spinCount = 0;
+		while (s_Running.load(std::memory_order_acquire))
+		{
+			if (Job* job = FindJob())
+			{
+				ExecuteJob(job);
+				spinCount = 0;
+				continue;
+			}
+
+			if (++spinCount < s_SpinCountBeforeSleep)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(s_SleepMutex);
+			s_SleepingCount.fetch_add(1, std::memory_order_seq_cst);
+			if (!HasPendingJobs() && s_Running.load(std::memory_order_acquire))
+				s_SleepCondition.wait_for(lock, std::chrono::milliseconds(10));
+			s_SleepingCount.fetch_sub(1, std::memory_order_relaxed);
+			spinCount = 0;
+		}
+
+		t_WorkerIndex = -1;
+	}
+
+	void JobSystem::Init(uint32_t workerCount)
+	{
+		BRICKENGINE_ASSERT(!s_Initialized);
+
+		if (workerCount == 0)
+			workerCount = std::max(1u, std::thread::hardware_concurrency());
+
+		s_Workers.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; i++)
+		{
+			s_Workers.push_back(std::make_unique<JobWorker>());
+			s_Workers.back()->NextVictim = i + 1;
+		}
+
+		t_WorkerIndex = 0;
+		s_Running = true;
+		for (uint32_t i = 1; i < workerCount; i++)
+			s_Workers[i]->Thread = std::thread(WorkerMain, static_cast<int32_t>(i));
+		s_Initialized = true;
+
+		Log::Info("Job system started with {} worker(s)", workerCount);
+	}
+
+	void JobSystem::Shutdown()
+	{
+		BRICKENGINE_ASSERT(s_Initialized && t_WorkerIndex == 0);
+
+		// Drain whatever is still queued before stopping the workers
+		while (Job* job = FindJob())
+			ExecuteJob(job);
+
+		{
+			std::lock_guard<std::mutex> lock(s_SleepMutex);
+			s_Running = false;
+		}
+		s_SleepCondition.notify_all();
+
+		for (auto& worker : s_Workers)
+		{
+			if (worker->Thread.joinable())
+				worker->Thread.join();
+		}
+
+		while (Job* job = FindJob())
+			ExecuteJob(job);
+
+		s_Initialized = false;
+		t_WorkerIndex = -1;
+
+		for (auto& worker : s_Workers)
+		{
+			for (Job* job : worker->FreeJobs)
+				delete job;
+		}
+		s_Workers.clear();
+	}
+
+	bool JobSystem::IsInitialized()
+	{
+		return s_Initialized.load(std::memory_order_acquire);
+	}
+
+	uint32_t JobSystem::GetWorkerCount()
+	{
+		return IsInitialized() ? static_cast<uint32_t>(s_Workers.size()) : 1;
+	}
+
+	int32_t JobSystem::GetWorkerIndex()
+	{
+		return t_WorkerIndex;
+	}
+
+	void JobSystem::Wait(JobCounter& counter)
+	{
+		while (!counter.IsDone())
+		{
+			if (IsInitialized())
+			{
+				if (Job* job = FindJob())
+				{
+					ExecuteJob(job);
+					continue;
+				}
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	size_t JobSystem::GetAutomaticGrainSize(size_t count)
+	{
+		// Aim for a few chunks per worker so stealing can even out uneven chunks
+		constexpr size_t chunksPerWorker = 4;
+		size_t chunkCount = static_cast<size_t>(GetWorkerCount()) * chunksPerWorker;
+		return std::max<size_t>(1, (count + chunkCount - 1) / chunkCount);
+	}
+
+	Job* JobSystem::AllocateJob()
+	{
+		int32_t workerIndex = t_WorkerIndex;
+		if (workerIndex >= 0)
+		{
+			std::vector<Job*>& freeJobs = s_Workers[workerIndex]->FreeJobs;
+			if (!freeJobs.empty())
+			{
+				Job* job = freeJobs.back();
+				freeJobs.pop_back();
+				return job;
+			}
+		}
+		return new Job();
+	}
+
+	void JobSystem::Submit(Job* job)
+	{
+		if (!IsInitialized())
+		{
+			ExecuteJob(job);
+			return;
+		}
+
+		int32_t workerIndex = t_WorkerIndex;
+		if (workerIndex >= 0)
+		{
+			if (!s_Workers[workerIndex]->Deque.Push(job))
+			{
+				// Deque is full, running the job now keeps the system from deadlocking
+				ExecuteJob(job);
+				return;
+			}
+		}
+		else
+		{
+			std::lock_guard<std::mutex> lock(s_SharedQueueMutex);
+			s_SharedQueue.push_back(job);
+			s_SharedQueueSize.fetch_add(1, std::memory_order_release);
+		}
+
+		WakeWorker();
+	}
+
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+namespace BrickEngine {
+
+	// Number of jobs still in flight, jobs decrement it when they finish.
+	class JobCounter
+	{
+		friend class JobSystem;
+	public:
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool IsDone() const { return m_Count.load(std::memory_order_acquire) == 0; }
+	private:
+		std::atomic<uint32_t> m_Count = 0;
+	};
+
+	struct Job
+	{
+		static constexpr size_t StorageSize = 64;
+
+		void (*Invoke)(Job& job) = nullptr;
+		void (*Destroy)(Job& job) = nullptr;
+		JobCounter* Counter = nullptr;
+		alignas(std::max_align_t) uint8_t Storage[StorageSize];
+	};
+
+	// Chase-Lev deque, the owning worker pushes and pops at the bottom while other workers steal from the top.
+	class JobDeque
+	{
+	public:
+		static constexpr int64_t Capacity = 4096;
+
+		bool Push(Job* job);
+		Job* Pop();
+		Job* Steal();
+
+		bool IsEmpty() const { return m_Bottom.load(std::memory_order_relaxed) <= m_Top.load(std::memory_order_relaxed); }
+	private:
+		alignas(64) std::atomic<int64_t> m_Top = 0;
+		alignas(64) std::atomic<int64_t> m_Bottom = 0;
+		alignas(64) std::array<std::atomic<Job*>, Capacity> m_Jobs = {};
+	};
+
+	// Work-stealing job system. The thread calling Init becomes worker 0 and runs jobs while it waits on a counter.
+	// Jobs scheduled from threads that are not workers go through a shared queue. Without Init, jobs run inline.
+	class BRICKENGINE_API JobSystem
+	{
+	public:
+		JobSystem() = delete;
+
+		// workerCount includes the calling thread, 0 uses one worker per hardware thread.
+		static void Init(uint32_t workerCount = 0);
+		static void Shutdown();
+
+		static bool IsInitialized();
+		static uint32_t GetWorkerCount();
+		// Index of the calling worker, or -1 if it isn't a worker thread.
+		static int32_t GetWorkerIndex();
+
+		template<typename Function>
+		static void Schedule(Function&& function, JobCounter* counter = nullptr)
+		{
+			using Callable = std::decay_t<Function>;
+
+			Job* job = AllocateJob();
+			job->Counter = counter;
+			if constexpr (sizeof(Callable) <= Job::StorageSize && alignof(Callable) <= alignof(std::max_align_t))
+			{
+				new (job->Storage) Callable(std::forward<Function>(function));
+				job->Invoke = [](Job& job) { (*std::launder(reinterpret_cast<Callable*>(job.Storage)))(); };
+				job->Destroy = [](Job& job) { std::launder(reinterpret_cast<Callable*>(job.Storage))->~Callable(); };
+			}
+			else
+			{
+				Callable* callable = new Callable(std::forward<Function>(function));
+				std::memcpy(job->Storage, &callable, sizeof(Callable*));
+				job->Invoke = [](Job& job) { Callable* callable; std::memcpy(&callable, job.Storage, sizeof(Callable*)); (*callable)(); };
+				job->Destroy = [](Job& job) { Callable* callable; std::memcpy(&callable, job.Storage, sizeof(Callable*)); delete callable; };
+			}
+
+			if (counter)
+				counter->m_Count.fetch_add(1, std::memory_order_relaxed);
+			Submit(job);
+		}
+
+		// Runs other jobs until the counter reaches zero.
+		static void Wait(JobCounter& counter);
+
+		// Calls function(begin, end) over [0, count) split into chunks of grainSize, 0 picks a grain size automatically.
+		template<typename Function>
+		static void ParallelFor(size_t count, Function&& function, size_t grainSize = 0)
+		{
+			if (count == 0)
+				return;
+
+			if (grainSize == 0)
+				grainSize = GetAutomaticGrainSize(count);
+
+			if (GetChunkCount(count, grainSize) == 1)
+			{
+				function(size_t(0), count);
+				return;
+			}
+
+			JobCounter counter;
+			for (size_t begin = grainSize; begin < count; begin += grainSize)
+			{
+				size_t end = std::min(begin + grainSize, count);
+				Schedule([&function, begin, end]() { function(begin, end); }, &counter);
+			}
+			function(size_t(0), grainSize);
+			Wait(counter);
+		}
+
+		static size_t GetAutomaticGrainSize(size_t count);
+
+		// Number of chunks ParallelFor splits [0, count) into, 1 when it runs the whole range inline.
+		static size_t GetChunkCount(size_t count, size_t grainSize)
+		{
+			if (count == 0)
+				return 0;
+			if (!IsInitialized() || count <= grainSize)
+				return 1;
+			return (count + grainSize - 1) / grainSize;
+		}
+	private:
+		static Job* AllocateJob();
+		static void Submit(Job* job);
+		static void ExecuteJob(Job* job);
+		static void WorkerMain(int32_t workerIndex);
+	};
+
+}
@@ -0,0 +1,404 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Core/Log.hpp"
+#include "BrickEngine/Core/LogSink.hpp"
+#include "BrickEngine/Core/RingBuffer.hpp"
+
+namespace BrickEngine {
+
+	constexpr auto s_IdleWaitTime = std::chrono::milliseconds(1);
+
+	struct LogThreadBuffer
+	{
+		RingBuffer Buffer = RingBuffer(Log::ThreadBufferCapacity);
+		std::atomic<bool> Retired = false;
+		std::atomic<uint64_t> DroppedCount = 0;
+	};
+
+	class LogBackend
+	{
+	public:
+		LogBackend()
+		{
+			m_Sinks.push_back(m_ConsoleSink);
+			m_Thread = std::thread([this]() { Run(); });
+		}
+
+		~LogBackend()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_WakeMutex);
+				m_Running.store(false, std::memory_order_release);
+			}
+			m_WakeCondition.notify_one();
+			m_Thread.join();
+		}
+
+		static LogBackend& Get()
+		{
+			static LogBackend s_Backend;
+			return s_Backend;
+		}
+
+		std::shared_ptr<LogThreadBuffer> RegisterThread()
+		{
+			std::shared_ptr<LogThreadBuffer> buffer = std::make_shared<LogThreadBuffer>();
+			std::lock_guard<std::mutex> lock(m_BuffersMutex);
+			m_Buffers.push_back(buffer);
+			return buffer;
+		}
+
+		void Wake()
+		{
+			m_WakeCondition.notify_one();
+		}
+
+		bool Flush(std::chrono::milliseconds timeout)
+		{
+			if (std::this_thread::get_id() == m_Thread.get_id())
+				return false;
+
+			uint64_t generation = m_FlushRequested.fetch_add(1, std::memory_order_acq_rel) + 1;
+			m_WakeCondition.notify_one();
+
+			std::unique_lock<std::mutex> lock(m_FlushMutex);
+			return m_FlushCondition.wait_for(lock, timeout, [&]() { return m_FlushCompleted >= generation; });
+		}
+
+		const std::shared_ptr<LogSink>& GetConsoleSink() const { return m_ConsoleSink; }
+
+		void AddSink(const std::shared_ptr<LogSink>& sink)
+		{
+			std::lock_guard<std::mutex> lock(m_SinksMutex);
+			m_Sinks.push_back(sink);
+		}
+
+		void RemoveSink(const std::shared_ptr<LogSink>& sink)
+		{
+			std::lock_guard<std::mutex> lock(m_SinksMutex);
+			m_Sinks.erase(std::remove(m_Sinks.begin(), m_Sinks.end(), sink), m_Sinks.end());
+		}
+	private:
+		void Run()
+		{
+			while (true)
+			{
+				uint64_t flushRequested = m_FlushRequested.load(std::memory_order_acquire);
+				bool running = m_Running.load(std::memory_order_acquire);
+
+				size_t drained = Drain();
+
+				if (flushRequested != m_FlushCompletedLocal || !running)
+				{
+					{
+						std::lock_guard<std::mutex> lock(m_SinksMutex);
+						for (auto& sink : m_Sinks)
+							sink->Flush();
+					}
+					{
+						std::lock_guard<std::mutex> lock(m_FlushMutex);
+						m_FlushCompleted = flushRequested;
+					}
+					m_FlushCompletedLocal = flushRequested;
+					m_FlushCondition.notify_all();
+				}
+
+				if (!running)
+					break;
+
+				if (drained == 0)
+				{
+					std::unique_lock<std::mutex> lock(m_WakeMutex);
+					m_WakeCondition.wait_for(lock, s_IdleWaitTime, [&]()
+						{
+							return !m_Running.load(std::memory_order_acquire) || m_FlushRequested.load(std::memory_order_acquire) != m_FlushCompletedLocal;
+						}
+					);
+				}
+			}
+		}
+
+		// Merges the per-thread buffers by timestamp so interleaved output stays in order.
+		size_t Drain()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_BuffersMutex);
+				m_DrainBuffers = m_Buffers;
+			}
+
+			size_t drained = 0;
+			while (true)
+			{
+				LogThreadBuffer* oldest = nullptr;
+				LogRecordHeader oldestHeader = {};
+				for (auto& buffer : m_DrainBuffers)
+				{
+					const uint8_t* record = buffer->Buffer.Peek();
+					if (!record)
+						continue;
+
+					LogRecordHeader header;
+					std::memcpy(&header, record, sizeof(LogRecordHeader));
+					if (!oldest || header.Timestamp < oldestHeader.Timestamp)
+					{
+						oldest = buffer.get();
+						oldestHeader = header;
+					}
+				}
+
+				if (!oldest)
+					break;
+
+				FormatRecord(oldestHeader, oldest->Buffer.Peek() + sizeof(LogRecordHeader));
+				oldest->Buffer.Pop();
+				WriteLine(oldestHeader.Level);
+				drained++;
+			}
+
+			for (auto& buffer : m_DrainBuffers)
+			{
+				uint64_t dropped = buffer->DroppedCount.exchange(0, std::memory_order_relaxed);
+				if (dropped > 0)
+				{
+					m_Line.clear();
+					m_Line += "[WARN] [Core]: Dropped ";
+					m_Line += std::to_string(dropped);
+					m_Line += " log message(s) that were too large for the log buffer\n";
+					WriteLine(LogLevel::Warn);
+				}
+			}
+
+			m_DrainBuffers.clear();
+
+			std::lock_guard<std::mutex> lock(m_BuffersMutex);
+			m_Buffers.erase(std::remove_if(m_Buffers.begin(), m_Buffers.end(), [](const std::shared_ptr<LogThreadBuffer>& buffer)
+				{
+					return buffer->Retired.load(std::memory_order_acquire) && buffer->Buffer.IsEmpty();
+				}
+			), m_Buffers.end());
+
+			return drained;
+		}
+
+		void FormatRecord(const LogRecordHeader& header, const uint8_t* arguments)
+		{
+			static constexpr const char* s_LevelNames[] = { "TRACE", "INFO", "WARN", "ERROR", "FATAL" };
+
+			m_Line.clear();
+
+			auto timestamp = std::chrono::system_clock::time_point(std::chrono::system_clock::duration(header.Timestamp));
+			std::time_t time = std::chrono::system_clock::to_time_t(timestamp);
+			auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(timestamp.time_since_epoch()).count() % 1000;
+			char timeString[32];
+			size_t timeLength = std::strftime(timeString, sizeof(timeString), "%H:%M:%S", std::localtime(&time));
+			std::snprintf(timeString + timeLength, sizeof(timeString) - timeLength, ".%03d", static_cast<int>(milliseconds));
+
+			m_Line += '[';
+			m_Line += timeString;
+			m_Line += "] [";
+			m_Line += s_LevelNames[static_cast<size_t>(header.Level)];
+			m_Line += "] [";
+			m_Line += Log::GetCategoryName(header.Category);
+			m_Line += "]: ";
+
+			uint8_t argumentsLeft = header.ArgumentCount;
+			for (const char* c = header.Format; *c; c++)
+			{
+				if (c[0] == '{' && c[1] == '{')
+				{
+					m_Line += '{';
+					c++;
+				}
+				else if (c[0] == '}' && c[1] == '}')
+				{
+					m_Line += '}';
+					c++;
+				}
+				else if (c[0] == '{' && c[1] == '}' && argumentsLeft > 0)
+				{
+					arguments = FormatArgument(arguments);
+					argumentsLeft--;
+					c++;
+				}
+				else
+					m_Line += *c;
+			}
+
+			m_Line += '\n';
+		}
+
+		const uint8_t* FormatArgument(const uint8_t* argument)
+		{
+			LogArgumentType type = static_cast<LogArgumentType>(*argument++);
+
+			auto read = [&](auto& value)
+			{
+				std::memcpy(&value, argument, sizeof(value));
+				argument += sizeof(value);
+			};
+
+			char number[32];
+			switch (type)
+			{
+			case LogArgumentType::Bool:
+			{
+				uint8_t value;
+				read(value);
+				m_Line += value ? "true" : "false";
+				break;
+			}
+			case LogArgumentType::Char:
+			{
+				char value;
+				read(value);
+				m_Line += value;
+				break;
+			}
+			case LogArgumentType::Int:
+			{
+				int64_t value;
+				read(value);
+				std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(value));
+				m_Line += number;
+				break;
+			}
+			case LogArgumentType::UInt:
+			{
+				uint64_t value;
+				read(value);
+				std::snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(value));
+				m_Line += number;
+				break;
+			}
+			case LogArgumentType::Float:
+			{
+				double value;
+				read(value);
+				std::snprintf(number, sizeof(number), "%g", value);
+				m_Line += number;
+				break;
+			}
+			case LogArgumentType::Pointer:
+			{
+				uintptr_t value;
+				read(value);
+				std::snprintf(number, sizeof(number), "0x%llx", static_cast<unsigned long long>(value));
+				m_Line += number;
+				break;
+			}
+			case LogArgumentType::String:
+			{
+				uint32_t length;
+				read(length);
+				m_Line.append(reinterpret_cast<const char*>(argument), length);
+				argument += length;
+				break;
+			}
+			}
+
+			return argument;
+		}
+
+		void WriteLine(LogLevel level)
+		{
+			std::lock_guard<std::mutex> lock(m_SinksMutex);
+			for (auto& sink : m_Sinks)
+				sink->Write(level, m_Line);
+		}
+	private:
+		std::thread m_Thread;
+		std::atomic<bool> m_Running = true;
+
+		std::mutex m_WakeMutex;
+		std::condition_variable m_WakeCondition;
+
+		std::atomic<uint64_t> m_FlushRequested = 0;
+		uint64_t m_FlushCompletedLocal = 0;
+		uint64_t m_FlushCompleted = 0;
+		std::mutex m_FlushMutex;
+		std::condition_variable m_FlushCondition;
+
+		std::mutex m_BuffersMutex;
+		std::vector<std::shared_ptr<LogThreadBuffer>> m_Buffers;
+		std::vector<std::shared_ptr<LogThreadBuffer>> m_DrainBuffers;
+
+		std::mutex m_SinksMutex;
+		std::vector<std::shared_ptr<LogSink>> m_Sinks;
+		std::shared_ptr<LogSink> m_ConsoleSink = std::make_shared<ConsoleLogSink>();
+
+		std::string m_Line;
+	};
+
+	struct LogThreadRegistration
+	{
+		std::shared_ptr<LogThreadBuffer> Buffer = LogBackend::Get().RegisterThread();
+
+		~LogThreadRegistration()
+		{
+			Buffer->Retired.store(true, std::memory_order_release);
+		}
+	};
+
+	static thread_local LogThreadRegistration t_Registration;
+
+	uint8_t* Log::BeginRecord(size_t size)
+	{
+		LogThreadBuffer& threadBuffer = *t_Registration.Buffer;
+		if (RingBuffer::GetFrameSize(size) > threadBuffer.Buffer.GetCapacity())
+		{
+			threadBuffer.DroppedCount.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		uint8_t* buffer = threadBuffer.Buffer.TryReserve(size);
+		while (!buffer)
+		{
+			LogBackend::Get().Wake();
+			std::this_thread::yield();
+			buffer = threadBuffer.Buffer.TryReserve(size);
+		}
+		return buffer;
+	}
+
+	void Log::EndRecord()
+	{
+		t_Registration.Buffer->Buffer.Commit();
+	}
+
+	void Log::SetLevel(LogCategory category, LogLevel level)
+	{
+		s_CategoryLevels[static_cast<size_t>(category)].store(level, std::memory_order_relaxed);
+	}
+
+	LogLevel Log::GetLevel(LogCategory category)
+	{
+		return s_CategoryLevels[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+	}
+
+	const char* Log::GetCategoryName(LogCategory category)
+	{
+		static constexpr const char* s_CategoryNames[] = { "Core", "Window", "File", "Renderer" };
+		static_assert(std::size(s_CategoryNames) == static_cast<size_t>(LogCategory::Count));
+		return s_CategoryNames[static_cast<size_t>(category)];
+	}
+
+	bool Log::Flush(std::chrono::milliseconds timeout)
+	{
+		return LogBackend::Get().Flush(timeout);
+	}
+
+	void Log::AddSink(const std::shared_ptr<LogSink>& sink)
+	{
+		LogBackend::Get().AddSink(sink);
+	}
+
+	void Log::RemoveSink(const std::shared_ptr<LogSink>& sink)
+	{
+		LogBackend::Get().RemoveSink(sink);
+	}
+
+	std::shared_ptr<LogSink> Log::GetConsoleSink()
+	{
+		return LogBackend::Get().GetConsoleSink();
+	}
+
+}
@@ -2,42 +2,289 @@
 
 #include "BrickEngine/Core/Base.hpp"
 
+// Log calls below this level compile to nothing, Fatal is never stripped
+#define BRICKENGINE_LOG_LEVEL_TRACE 0
+#define BRICKENGINE_LOG_LEVEL_INFO 1
+#define BRICKENGINE_LOG_LEVEL_WARN 2
+#define BRICKENGINE_LOG_LEVEL_ERROR 3
+#define BRICKENGINE_LOG_LEVEL_FATAL 4
+
+#if !defined(BRICKENGINE_LOG_LEVEL)
+	#if defined(BRICKENGINE_DEBUG)
+		#define BRICKENGINE_LOG_LEVEL BRICKENGINE_LOG_LEVEL_TRACE
+	#else
+		#define BRICKENGINE_LOG_LEVEL BRICKENGINE_LOG_LEVEL_INFO
+	#endif
+#endif
+
+// Unlike the Log functions these also skip evaluating the arguments when the message is filtered out
+#define BRICKENGINE_LOG_(level, function, category, ...) do { \
+		if constexpr (::BrickEngine::Log::IsCompiledIn(level)) { \
+			if (::BrickEngine::Log::IsEnabled(category, level)) \
+				::BrickEngine::Log::function(category, __VA_ARGS__); \
+		} \
+	} while (false)
+
+#define BRICKENGINE_LOG_TRACE(category, ...) BRICKENGINE_LOG_(::BrickEngine::LogLevel::Trace, Trace, category, __VA_ARGS__)
+#define BRICKENGINE_LOG_INFO(category, ...) BRICKENGINE_LOG_(::BrickEngine::LogLevel::Info, Info, category, __VA_ARGS__)
+#define BRICKENGINE_LOG_WARN(category, ...) BRICKENGINE_LOG_(::BrickEngine::LogLevel::Warn, Warn, category, __VA_ARGS__)
+#define BRICKENGINE_LOG_ERROR(category, ...) BRICKENGINE_LOG_(::BrickEngine::LogLevel::Error, Error, category, __VA_ARGS__)
+
 namespace BrickEngine {
 
+	enum class LogLevel : uint8_t
+	{
+		Trace,
+		Info,
+		Warn,
+		Error,
+		Fatal
+	};
+
+	static_assert(static_cast<int>(LogLevel::Trace) == BRICKENGINE_LOG_LEVEL_TRACE && static_cast<int>(LogLevel::Fatal) == BRICKENGINE_LOG_LEVEL_FATAL);
+
+	enum class LogCategory : uint8_t
+	{
+		Core,
+		Window,
+		File,
+		Renderer,
+		Count
+	};
+
+	enum class LogArgumentType : uint8_t
+	{
+		Bool,
+		Char,
+		Int,
+		UInt,
+		Float,
+		Pointer,
+		String
+	};
+
+	// Arguments are captured as binary right after this header and are only formatted on the logging thread.
+	struct LogRecordHeader
+	{
+		uint64_t Timestamp;
+		const char* Format;
+		LogLevel Level;
+		LogCategory Category;
+		uint8_t ArgumentCount;
+	};
+
+	namespace LogEncoding {
+
+		template<typename T>
+		constexpr bool IsString = std::is_same_v<T, const char*> || std::is_same_v<T, char*> || std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+
+		template<typename T>
+		BRICKENGINE_FORCE_INLINE std::string_view AsStringView(const T& value)
+		{
+			if constexpr (std::is_pointer_v<std::decay_t<T>>)
+			{
+				const char* string = value;
+				return string ? std::string_view(string) : std::string_view("(null)");
+			}
+			else
+				return std::string_view(value);
+		}
+
+		template<typename T>
+		BRICKENGINE_FORCE_INLINE size_t GetSize(const T& value)
+		{
+			using Type = std::decay_t<T>;
+			if constexpr (IsString<Type>)
+				return 1 + sizeof(uint32_t) + AsStringView(value).size();
+			else if constexpr (std::is_same_v<Type, bool> || std::is_same_v<Type, char>)
+				return 1 + 1;
+			else if constexpr (std::is_integral_v<Type> || std::is_enum_v<Type>)
+				return 1 + sizeof(uint64_t);
+			else if constexpr (std::is_floating_point_v<Type>)
+				return 1 + sizeof(double);
+			else if constexpr (std::is_pointer_v<Type>)
+				return 1 + sizeof(uintptr_t);
+			else
+				static_assert(!sizeof(Type), "Unsupported log argument type!");
+		}
+
+		template<typename T>
+		BRICKENGINE_FORCE_INLINE void Write(uint8_t*& buffer, LogArgumentType type, const T& value)
+		{
+			*buffer++ = static_cast<uint8_t>(type);
+			std::memcpy(buffer, &value, sizeof(T));
+			buffer += sizeof(T);
+		}
+
+		template<typename T>
+		BRICKENGINE_FORCE_INLINE void Encode(uint8_t*& buffer, const T& value)
+		{
+			using Type = std::decay_t<T>;
+			if constexpr (IsString<Type>)
+			{
+				std::string_view string = AsStringView(value);
+				Write(buffer, LogArgumentType::String, static_cast<uint32_t>(string.size()));
+				std::memcpy(buffer, string.data(), string.size());
+				buffer += string.size();
+			}
+			else if constexpr (std::is_same_v<Type, bool>)
+				Write(buffer, LogArgumentType::Bool, static_cast<uint8_t>(value));
+			else if constexpr (std::is_same_v<Type, char>)
+				Write(buffer, LogArgumentType::Char, value);
+			else if constexpr (std::is_enum_v<Type>)
+				Write(buffer, LogArgumentType::Int, static_cast<int64_t>(value));
+			else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>)
+				Write(buffer, LogArgumentType::Int, static_cast<int64_t>(value));
+			else if constexpr (std::is_integral_v<Type>)
+				Write(buffer, LogArgumentType::UInt, static_cast<uint64_t>(value));
+			else if constexpr (std::is_floating_point_v<Type>)
+				Write(buffer, LogArgumentType::Float, static_cast<double>(value));
+			else if constexpr (std::is_pointer_v<Type>)
+				Write(buffer, LogArgumentType::Pointer, reinterpret_cast<uintptr_t>(value));
+		}
+
+	}
+
+	class LogSink;
+
+	// Format strings use '{}' placeholders and must be string literals, only a pointer to them is stored. Mutable char
+	// arrays don't compile, a const array passed as the format has to be static.
 	class BRICKENGINE_API Log
 	{
 	public:
 		Log() = delete;
 
-		template<typename... Args>
-		BRICKENGINE_FORCE_INLINE static void Trace(const std::string& message)
+		// Every thread logs into a buffer of this size, larger records are dropped
+		static constexpr size_t ThreadBufferCapacity = 256 * 1024;
+
+		template<size_t N, typename... Args>
+		BRICKENGINE_FORCE_INLINE static void Trace(LogCategory category, const char (&format)[N], const Args&... args)
 		{
-			std::cout << "[TRACE]: " << message << std::endl;
+			Write<LogLevel::Trace>(category, format, args...);
 		}
 
-		template<typename... Args>
-		BRICKENGINE_FORCE_INLINE static void Info(const std::string& message)
+		template<size_t N, typename... Args>
+		BRICKENGINE_FORCE_INLINE static void Trace(const char (&format)[N], const Args&... args)
 		{
-			std::cout << "[INFO]: " << message << std::endl;
+			Trace(LogCategory::Core, format, args...);
 		}
 
-		template<typename... Args>
-		BRICKENGINE_FORCE_INLINE static void Warn(const std::string& message)
+		template<size_t N, typename... Args>
+		BRICKENGINE_FORCE_INLINE static void Info(LogCategory category, const char (&format)[N], const Args&... args)
 		{
-			std::cout << "[WARN]: " << message << std::endl;
+			Write<LogLevel::Info>(category, format, args...);
 		}
 
-		template<typename... Args>
-		BRICKENGINE_FORCE_INLINE static void Error(const std::string& message)
+		template<size_t N, typename... Args>
+		BRICKENGINE_FORCE_INLINE static void Info(const char (&format)[N], const Args&... args)
 		{
-			std::cout << "[ERROR]: " << message << std::endl;
+			Info(LogCategory::Core, format, args...);
 		}
 
-		template<typename... Args>
-		BRICKENGINE_FORCE_INLINE static void Fatal(const std::string& message)
+		template<size_t N, typename... Args>
+		BRICKENGINE_FORCE_INLINE static void Warn(LogCategory category, const char (&format)[N], const Args&... args)
 		{
-			std::cout << "[FATAL]: " << message << std::endl;
+			Write<LogLevel::Warn>(category, format, args...);
 		}
+
+		template<size_t N, typename... Args>
+		BRICKENGINE_FORCE_INLINE static void Warn(const char (&format)[N], const Args&... args)
+		{
+			Warn(LogCategory::Core, format, args...);
+		}
+
+		template<size_t N, typename... Args>
+		BRICKENGINE_FORCE_INLINE static void Error(LogCategory category, const char (&format)[N], const Args&... args)
+		{
+			Write<LogLevel::Error>(category, format, args...);
+		}
+
+		template<size_t N, typename... Args>
+		BRICKENGINE_FORCE_INLINE static void Error(const char (&format)[N], const Args&... args)
+		{
+			Error(LogCategory::Core, format, args...);
+		}
+
+		template<size_t N, typename... Args>
+		BRICKENGINE_FORCE_INLINE static void Fatal(LogCategory category, const char (&format)[N], const Args&... args)
+		{
+			Write<LogLevel::Fatal>(category, format, args...);
+			Flush();
+		}
+
+		template<size_t N, typename... Args>
+		BRICKENGINE_FORCE_INLINE static void Fatal(const char (&format)[N], const Args&... args)
+		{
+			Fatal(LogCategory::Core, format, args...);
+		}
+
+		// Better matches than the overloads above for buffers that aren't const, which would be formatted after they changed
+		template<size_t N, typename... Args> static void Trace(LogCategory category, char (&format)[N], const Args&... args) = delete;
+		template<size_t N, typename... Args> static void Trace(char (&format)[N], const Args&... args) = delete;
+		template<size_t N, typename... Args> static void Info(LogCategory category, char (&format)[N], const Args&... args) = delete;
+		template<size_t N, typename... Args> static void Info(char (&format)[N], const Args&... args) = delete;
+		template<size_t N, typename... Args> static void Warn(LogCategory category, char (&format)[N], const Args&... args) = delete;
+		template<size_t N, typename... Args> static void Warn(char (&format)[N], const Args&... args) = delete;
+		template<size_t N, typename... Args> static void Error(LogCategory category, char (&format)[N], const Args&... args) = delete;
+		template<size_t N, typename... Args> static void Error(char (&format)[N], const Args&... args) = delete;
+		template<size_t N, typename... Args> static void Fatal(LogCategory category, char (&format)[N], const Args&... args) = delete;
+		template<size_t N, typename... Args> static void Fatal(char (&format)[N], const Args&... args) = delete;
+
+		static constexpr bool IsCompiledIn(LogLevel level)
+		{
+			return level == LogLevel::Fatal || level >= static_cast<LogLevel>(BRICKENGINE_LOG_LEVEL);
+		}
+
+		BRICKENGINE_FORCE_INLINE static bool IsEnabled(LogCategory category, LogLevel level)
+		{
+			return IsCompiledIn(level) && level >= s_CategoryLevels[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+		}
+
+		static void SetLevel(LogCategory category, LogLevel level);
+		static LogLevel GetLevel(LogCategory category);
+		static const char* GetCategoryName(LogCategory category);
+
+		// Blocks until everything logged before the call reached the sinks, or the timeout expires.
+		static bool Flush(std::chrono::milliseconds timeout = std::chrono::milliseconds(250));
+
+		static void AddSink(const std::shared_ptr<LogSink>& sink);
+		static void RemoveSink(const std::shared_ptr<LogSink>& sink);
+		// The sink every log starts out with, remove it to keep the console quiet
+		static std::shared_ptr<LogSink> GetConsoleSink();
+	private:
+		template<LogLevel Level, typename... Args>
+		BRICKENGINE_FORCE_INLINE static void Write(LogCategory category, const char* format, const Args&... args)
+		{
+			static_assert(sizeof...(Args) <= std::numeric_limits<uint8_t>::max(), "Too many log arguments!");
+
+			if constexpr (IsCompiledIn(Level))
+			{
+				if (Level < s_CategoryLevels[static_cast<size_t>(category)].load(std::memory_order_relaxed))
+					return;
+
+				size_t size = sizeof(LogRecordHeader) + (size_t(0) + ... + LogEncoding::GetSize(args));
+				uint8_t* buffer = BeginRecord(size);
+				if (!buffer)
+					return;
+
+				LogRecordHeader header = {};
+				header.Timestamp = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+				header.Format = format;
+				header.Level = Level;
+				header.Category = category;
+				header.ArgumentCount = static_cast<uint8_t>(sizeof...(Args));
+				std::memcpy(buffer, &header, sizeof(LogRecordHeader));
+				buffer += sizeof(LogRecordHeader);
+
+				(LogEncoding::Encode(buffer, args), ...);
+				EndRecord();
+			}
+		}
+
+		static uint8_t* BeginRecord(size_t size);
+		static void EndRecord();
+	private:
+		inline static std::atomic<LogLevel> s_CategoryLevels[static_cast<size_t>(LogCategory::Count)] = {};
 	};
 
 }
@@ -0,0 +1,41 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Core/LogSink.hpp"
+
+namespace BrickEngine {
+
+	void ConsoleLogSink::Write(LogLevel level, std::string_view line)
+	{
+		std::FILE* stream = level >= LogLevel::Error ? stderr : stdout;
+		std::fwrite(line.data(), sizeof(char), line.size(), stream);
+	}
+
+	void ConsoleLogSink::Flush()
+	{
+		std::fflush(stdout);
+		std::fflush(stderr);
+	}
+
+	FileLogSink::FileLogSink(const std::string& filepath)
+		: m_File(std::fopen(filepath.c_str(), "wb"))
+	{
+	}
+
+	FileLogSink::~FileLogSink()
+	{
+		if (m_File)
+			std::fclose(m_File);
+	}
+
+	void FileLogSink::Write(LogLevel, std::string_view line)
+	{
+		if (m_File)
+			std::fwrite(line.data(), sizeof(char), line.size(), m_File);
+	}
+
+	void FileLogSink::Flush()
+	{
+		if (m_File)
+			std::fflush(m_File);
+	}
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+#include "BrickEngine/Core/Log.hpp"
+
+namespace BrickEngine {
+
+	// Sinks are only ever called from the logging thread.
+	class BRICKENGINE_API LogSink
+	{
+	public:
+		virtual ~LogSink() = default;
+
+		virtual void Write(LogLevel level, std::string_view line) = 0;
+		virtual void Flush() = 0;
+	};
+
+	class BRICKENGINE_API ConsoleLogSink final : public LogSink
+	{
+	public:
+		virtual void Write(LogLevel level, std::string_view line) override final;
+		virtual void Flush() override final;
+	};
+
+	class BRICKENGINE_API FileLogSink final : public LogSink
+	{
+	public:
+		FileLogSink(const std::string& filepath);
+		~FileLogSink();
+
+		virtual void Write(LogLevel level, std::string_view line) override final;
+		virtual void Flush() override final;
+	private:
+		std::FILE* m_File = nullptr;
+	};
+
+}
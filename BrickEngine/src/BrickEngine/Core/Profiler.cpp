@@ -0,0 +1,136 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Core/Profiler.hpp"
+
+namespace BrickEngine {
+
+	static std::mutex s_TracksMutex;
+	static std::vector<std::unique_ptr<ProfilerTrack>> s_Tracks;
+	static thread_local ProfilerTrack* t_Track = nullptr;
+
+	ProfilerTrack::ProfilerTrack(const std::string& name, uint32_t id)
+		: m_Name(name), m_Id(id)
+	{
+	}
+
+	void ProfilerTrack::Record(const char* name, uint64_t start, uint64_t end)
+	{
+		uint32_t capture = Profiler::s_Capture.load(std::memory_order_relaxed);
+		if (m_Capture.load(std::memory_order_relaxed) != capture)
+		{
+			m_Count.store(0, std::memory_order_relaxed);
+			m_DroppedCount.store(0, std::memory_order_relaxed);
+			m_Capture.store(capture, std::memory_order_release);
+		}
+
+		uint32_t count = m_Count.load(std::memory_order_relaxed);
+		if (count == Capacity)
+		{
+			m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		if (!m_Events)
+			m_Events = std::make_unique<ProfilerEvent[]>(Capacity);
+
+		m_Events[count] = { name, start, end };
+		m_Count.store(count + 1, std::memory_order_release);
+	}
+
+	void Profiler::BeginCapture()
+	{
+		s_CaptureStart = Now();
+		s_Capture.fetch_add(1, std::memory_order_relaxed);
+		s_Capturing.store(true, std::memory_order_relaxed);
+		Log::Info(LogCategory::Core, "Profiler capture started");
+	}
+
+	void Profiler::EndCapture()
+	{
+		s_Capturing.store(false, std::memory_order_relaxed);
+		Log::Info(LogCategory::Core, "Profiler capture stopped after {} ms", (Now() - s_CaptureStart) / 1000000.0);
+	}
+
+	ProfilerTrack* Profiler::GetThreadTrack()
+	{
+		if (!t_Track)
+		{
+			std::lock_guard<std::mutex> lock(s_TracksMutex);
+			uint32_t id = static_cast<uint32_t>(s_Tracks.size());
+			t_Track = s_Tracks.emplace_back(std::make_unique<ProfilerTrack>("Thread " + std::to_string(id), id)).get();
+		}
+		return t_Track;
+	}
+
+	void Profiler::SetThreadName(const std::string& name)
+	{
+		ProfilerTrack* track = GetThreadTrack();
+		std::lock_guard<std::mutex> lock(s_TracksMutex);
+		track->m_Name = name;
+	}
+
+	ProfilerTrack* Profiler::CreateTrack(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lock(s_TracksMutex);
+		uint32_t id = static_cast<uint32_t>(s_Tracks.size());
+		return s_Tracks.emplace_back(std::make_unique<ProfilerTrack>(name, id)).get();
+	}
+
+	FileError Profiler::WriteChromeTrace(const std::string& filepath)
+	{
+		auto writeString = [](std::ostringstream& out, const char* string)
+			{
+				out << '"';
+				for (const char* c = string; *c; c++)
+				{
+					if (*c == '"' || *c == '\\')
+						out << '\\';
+					out << *c;
+				}
+				out << '"';
+			};
+
+		std::ostringstream out;
+		out << std::fixed << std::setprecision(3);
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+		uint32_t capture = s_Capture.load(std::memory_order_relaxed);
+		size_t eventCount = 0;
+		uint32_t droppedCount = 0;
+		bool first = true;
+		std::lock_guard<std::mutex> lock(s_TracksMutex);
+		for (auto& track : s_Tracks)
+		{
+			if (track->m_Capture.load(std::memory_order_acquire) != capture)
+				continue;
+			uint32_t count = track->m_Count.load(std::memory_order_acquire);
+			droppedCount += track->m_DroppedCount.load(std::memory_order_relaxed);
+
+			out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track->m_Id << ",\"args\":{\"name\":";
+			writeString(out, track->m_Name.c_str());
+			out << "}}";
+			first = false;
+
+			// Microseconds since the capture began
+			for (uint32_t i = 0; i < count; i++)
+			{
+				const ProfilerEvent& event = track->m_Events[i];
+				out << ",\n{\"name\":";
+				writeString(out, event.Name);
+				out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << track->m_Id
+					<< ",\"ts\":" << (static_cast<int64_t>(event.Start) - static_cast<int64_t>(s_CaptureStart)) / 1000.0
+					<< ",\"dur\":" << (event.End - event.Start) / 1000.0 << "}";
+			}
+			eventCount += count;
+		}
+		out << "\n]}\n";
+
+		if (droppedCount > 0)
+			Log::Warn(LogCategory::Core, "Profiler dropped {} events, tracks hold {} per capture", droppedCount, ProfilerTrack::Capacity);
+
+		std::string trace = out.str();
+		FileError error = File::WriteFile(filepath, trace.data(), trace.size());
+		if (error == FileError::None)
+			Log::Info(LogCategory::Core, "Wrote {} profiler events to '{}'", eventCount, filepath);
+		return error;
+	}
+
+}
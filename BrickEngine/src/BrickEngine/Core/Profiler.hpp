@@ -0,0 +1,114 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+#include "BrickEngine/Core/File.hpp"
+
+// Defined by the build for Debug, and for Dist with premake's --profiler. Everywhere else the macros compile to nothing.
+#if defined(BRICKENGINE_ENABLE_PROFILER)
+	// name has to outlive the capture, string literals and __FUNCTION__ do
+	#define BRICKENGINE_PROFILE_SCOPE(name) ::BrickEngine::ProfileScope CONCAT(profileScope, __LINE__)(name)
+	#define BRICKENGINE_PROFILE_FUNCTION() BRICKENGINE_PROFILE_SCOPE(__FUNCTION__)
+	#define BRICKENGINE_PROFILE_THREAD(name) ::BrickEngine::Profiler::SetThreadName(name)
+#else
+	#define BRICKENGINE_PROFILE_SCOPE(name)
+	#define BRICKENGINE_PROFILE_FUNCTION()
+	#define BRICKENGINE_PROFILE_THREAD(name)
+#endif
+
+namespace BrickEngine {
+
+	struct ProfilerEvent
+	{
+		const char* Name = nullptr;
+		// Profiler::Now nanoseconds
+		uint64_t Start = 0;
+		uint64_t End = 0;
+	};
+
+	// Events of one timeline, a thread or something with its own clock like a GPU queue. Only one thread records into a
+	// track, so recording is a store and a counter bump without any locking.
+	class ProfilerTrack
+	{
+		friend class Profiler;
+	public:
+		// Events past this are dropped until the next capture
+		static constexpr uint32_t Capacity = 64 * 1024;
+
+		explicit ProfilerTrack(const std::string& name, uint32_t id);
+
+		void Record(const char* name, uint64_t start, uint64_t end);
+
+		const std::string& GetName() const { return m_Name; }
+	private:
+		std::string m_Name = {};
+		uint32_t m_Id = 0;
+		// Allocated by the first event recorded
+		std::unique_ptr<ProfilerEvent[]> m_Events = nullptr;
+		// Reset by the writer once it sees a new capture, the capture is published after the count
+		std::atomic<uint32_t> m_Count = 0;
+		std::atomic<uint32_t> m_Capture = 0;
+		std::atomic<uint32_t> m_DroppedCount = 0;
+	};
+
+	// Captures scoped CPU and GPU timings into per thread tracks and exports them as Chrome trace JSON, which both
+	// chrome://tracing and Perfetto open. Outside a capture a scope costs one relaxed atomic load.
+	class BRICKENGINE_API Profiler
+	{
+		friend class ProfilerTrack;
+	public:
+		Profiler() = delete;
+
+		static constexpr bool IsCompiledIn()
+		{
+#if defined(BRICKENGINE_ENABLE_PROFILER)
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		// Starts over, events of earlier captures are discarded
+		static void BeginCapture();
+		static void EndCapture();
+		static bool IsCapturing() { return s_Capturing.load(std::memory_order_relaxed); }
+
+		// Steady clock nanoseconds, the same clock VulkanPlatform converts calibrated host timestamps to
+		static uint64_t Now() { return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()); }
+
+		// The calling thread's track, created by its first use
+		static ProfilerTrack* GetThreadTrack();
+		static void SetThreadName(const std::string& name);
+		// For timelines that aren't threads, the track lives as long as the program
+		static ProfilerTrack* CreateTrack(const std::string& name);
+
+		// Everything recorded since BeginCapture, meant to be called after EndCapture
+		static FileError WriteChromeTrace(const std::string& filepath);
+	private:
+		inline static std::atomic<bool> s_Capturing = false;
+		// Starts at 1 so new tracks, which start at 0, never belong to a capture
+		inline static std::atomic<uint32_t> s_Capture = 0;
+		inline static uint64_t s_CaptureStart = 0;
+	};
+
+	class ProfileScope
+	{
+	public:
+		explicit ProfileScope(const char* name)
+			: m_Name(Profiler::IsCapturing() ? name : nullptr), m_Start(m_Name ? Profiler::Now() : 0)
+		{
+		}
+
+		~ProfileScope()
+		{
+			if (m_Name)
+				Profiler::GetThreadTrack()->Record(m_Name, m_Start, Profiler::Now());
+		}
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+	private:
+		const char* m_Name;
+		uint64_t m_Start;
+	};
+
+}
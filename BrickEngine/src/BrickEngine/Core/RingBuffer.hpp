@@ -0,0 +1,147 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+namespace BrickEngine {
+
+	// Lock-free single producer / single consumer ring of variable sized, 8 byte aligned frames.
+	// Frames never wrap: when a frame doesn't fit before the end of the buffer a padding frame is written instead.
+	// Any frame up to the capacity fits once the consumer catches up.
+	class RingBuffer
+	{
+	public:
+		RingBuffer(size_t capacity)
+			: m_Capacity(capacity), m_Mask(capacity - 1), m_Data(static_cast<uint8_t*>(::operator new(capacity, std::align_val_t(FrameAlignment))))
+		{
+			BRICKENGINE_ASSERT(capacity >= FrameAlignment && (capacity & (capacity - 1)) == 0);
+		}
+
+		~RingBuffer()
+		{
+			::operator delete(m_Data, std::align_val_t(FrameAlignment));
+		}
+
+		RingBuffer(const RingBuffer&) = delete;
+		RingBuffer& operator=(const RingBuffer&) = delete;
+
+		static constexpr size_t FrameAlignment = 8;
+
+		static constexpr size_t GetFrameSize(size_t payloadSize)
+		{
+			return (sizeof(FrameHeader) + payloadSize + FrameAlignment - 1) & ~(FrameAlignment - 1);
+		}
+
+		size_t GetCapacity() const { return m_Capacity; }
+
+		// Producer side. Returns nullptr when the buffer is currently too full, or when the frame can never fit.
+		uint8_t* TryReserve(size_t payloadSize)
+		{
+			size_t frameSize = GetFrameSize(payloadSize);
+			if (frameSize > m_Capacity)
+				return nullptr;
+
+			uint64_t head = m_Head.load(std::memory_order_relaxed);
+			size_t offset = static_cast<size_t>(head & m_Mask);
+			size_t contiguous = m_Capacity - offset;
+			if (frameSize > contiguous)
+			{
+				// The padding is published on its own so the consumer can free the space before the end while the frame
+				// waits for space at the start. Waiting for both at once could never succeed for frames over half the capacity.
+				if (!HasSpace(head, contiguous))
+					return nullptr;
+
+				FrameHeader padding = { static_cast<uint32_t>(contiguous), FrameType::Padding };
+				std::memcpy(m_Data + offset, &padding, sizeof(FrameHeader));
+				head += contiguous;
+				offset = 0;
+				m_Head.store(head, std::memory_order_release);
+			}
+
+			if (!HasSpace(head, frameSize))
+				return nullptr;
+
+			FrameHeader frame = { static_cast<uint32_t>(frameSize), FrameType::Data };
+			std::memcpy(m_Data + offset, &frame, sizeof(FrameHeader));
+			m_ReservedHead = head + frameSize;
+			return m_Data + offset + sizeof(FrameHeader);
+		}
+
+		// Publishes the frame returned by the last successful TryReserve.
+		void Commit()
+		{
+			m_Head.store(m_ReservedHead, std::memory_order_release);
+		}
+
+		// Consumer side. Returns the payload of the oldest committed frame, or nullptr when empty.
+		const uint8_t* Peek()
+		{
+			uint64_t tail = m_Tail.load(std::memory_order_relaxed);
+			while (true)
+			{
+				if (tail == m_CachedHead)
+				{
+					m_CachedHead = m_Head.load(std::memory_order_acquire);
+					if (tail == m_CachedHead)
+						return nullptr;
+				}
+
+				const uint8_t* frameData = m_Data + (tail & m_Mask);
+				FrameHeader frame;
+				std::memcpy(&frame, frameData, sizeof(FrameHeader));
+				if (frame.Type == FrameType::Data)
+					return frameData + sizeof(FrameHeader);
+
+				tail += frame.Size;
+				m_Tail.store(tail, std::memory_order_release);
+			}
+		}
+
+		// Releases the frame returned by the last Peek.
+		void Pop()
+		{
+			uint64_t tail = m_Tail.load(std::memory_order_relaxed);
+			FrameHeader frame;
+			std::memcpy(&frame, m_Data + (tail & m_Mask), sizeof(FrameHeader));
+			m_Tail.store(tail + frame.Size, std::memory_order_release);
+		}
+
+		bool IsEmpty() const
+		{
+			return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire);
+		}
+	private:
+		bool HasSpace(uint64_t head, size_t size)
+		{
+			if (m_Capacity - (head - m_CachedTail) >= size)
+				return true;
+
+			m_CachedTail = m_Tail.load(std::memory_order_acquire);
+			return m_Capacity - (head - m_CachedTail) >= size;
+		}
+	private:
+		enum class FrameType : uint32_t
+		{
+			Data,
+			Padding
+		};
+
+		struct FrameHeader
+		{
+			uint32_t Size;
+			FrameType Type;
+		};
+		static_assert(sizeof(FrameHeader) == FrameAlignment);
+	private:
+		const size_t m_Capacity;
+		const uint64_t m_Mask;
+		uint8_t* m_Data;
+
+		alignas(64) std::atomic<uint64_t> m_Head = 0;
+		uint64_t m_ReservedHead = 0;
+		uint64_t m_CachedTail = 0;
+
+		alignas(64) std::atomic<uint64_t> m_Tail = 0;
+		uint64_t m_CachedHead = 0;
+	};
+
+}
@@ -0,0 +1,285 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Core/TLSFAllocator.hpp"
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+namespace BrickEngine {
+
+	static uint32_t FindLastSet(uint64_t value)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return static_cast<uint32_t>(index);
+#else
+		return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+	}
+
+	static uint32_t FindFirstSet(uint64_t value)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return static_cast<uint32_t>(index);
+#else
+		return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+	}
+
+	TLSFAllocator::TLSFAllocator(uint64_t capacity)
+	{
+		Reset(capacity);
+	}
+
+	void TLSFAllocator::Reset(uint64_t capacity)
+	{
+		m_Capacity = capacity;
+		m_UsedBytes = 0;
+		m_AllocationCount = 0;
+
+		m_Nodes.clear();
+		m_UnusedNodes.clear();
+		m_FirstNode = TLSFAllocation::InvalidNode;
+
+		m_FirstLevelBitmap = 0;
+		for (uint32_t i = 0; i < FirstLevelCount; i++)
+		{
+			m_SecondLevelBitmaps[i] = 0;
+			for (uint32_t j = 0; j < SecondLevelCount; j++)
+				m_FreeHeads[i][j] = TLSFAllocation::InvalidNode;
+		}
+
+		if (capacity == 0)
+			return;
+
+		m_FirstNode = CreateNode();
+		m_Nodes[m_FirstNode].Offset = 0;
+		m_Nodes[m_FirstNode].Size = capacity;
+		InsertFree(m_FirstNode);
+	}
+
+	TLSFAllocation TLSFAllocator::Allocate(uint64_t size, uint64_t alignment)
+	{
+		BRICKENGINE_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+		size = std::max<uint64_t>(size, 1);
+		uint64_t searchSize = size + alignment - 1;
+		if (searchSize < size)
+			return {};
+
+		uint32_t node = FindFree(searchSize);
+		if (node == TLSFAllocation::InvalidNode)
+			return {};
+		RemoveFree(node);
+
+		uint64_t padding = ((m_Nodes[node].Offset + alignment - 1) & ~(alignment - 1)) - m_Nodes[node].Offset;
+		if (padding > 0)
+		{
+			// Keep the padding as a free region of its own, the allocation continues in the split off part
+			Split(node, padding);
+			uint32_t remainder = m_Nodes[node].NextPhysical;
+			RemoveFree(remainder);
+			InsertFree(node);
+			node = remainder;
+		}
+
+		if (m_Nodes[node].Size > size)
+			Split(node, size);
+
+		m_Nodes[node].Free = false;
+		m_UsedBytes += size;
+		m_AllocationCount++;
+
+		TLSFAllocation allocation;
+		allocation.Offset = m_Nodes[node].Offset;
+		allocation.Size = size;
+		allocation.Node = node;
+		return allocation;
+	}
+
+	void TLSFAllocator::Free(const TLSFAllocation& allocation)
+	{
+		BRICKENGINE_ASSERT(allocation.IsValid() && allocation.Node < m_Nodes.size());
+
+		uint32_t node = allocation.Node;
+		BRICKENGINE_ASSERT(!m_Nodes[node].Free && m_Nodes[node].Offset == allocation.Offset);
+
+		m_UsedBytes -= m_Nodes[node].Size;
+		m_AllocationCount--;
+		m_Nodes[node].Free = true;
+
+		uint32_t previous = m_Nodes[node].PrevPhysical;
+		if (previous != TLSFAllocation::InvalidNode && m_Nodes[previous].Free)
+		{
+			RemoveFree(previous);
+			m_Nodes[previous].Size += m_Nodes[node].Size;
+			m_Nodes[previous].NextPhysical = m_Nodes[node].NextPhysical;
+			if (m_Nodes[node].NextPhysical != TLSFAllocation::InvalidNode)
+				m_Nodes[m_Nodes[node].NextPhysical].PrevPhysical = previous;
+			ReleaseNode(node);
+			node = previous;
+		}
+
+		uint32_t next = m_Nodes[node].NextPhysical;
+		if (next != TLSFAllocation::InvalidNode && m_Nodes[next].Free)
+		{
+			RemoveFree(next);
+			m_Nodes[node].Size += m_Nodes[next].Size;
+			m_Nodes[node].NextPhysical = m_Nodes[next].NextPhysical;
+			if (m_Nodes[next].NextPhysical != TLSFAllocation::InvalidNode)
+				m_Nodes[m_Nodes[next].NextPhysical].PrevPhysical = node;
+			ReleaseNode(next);
+		}
+
+		InsertFree(node);
+	}
+
+	TLSFStats TLSFAllocator::GetStats() const
+	{
+		TLSFStats stats;
+		stats.Capacity = m_Capacity;
+		stats.AllocationCount = m_AllocationCount;
+
+		for (uint32_t node = m_FirstNode; node != TLSFAllocation::InvalidNode; node = m_Nodes[node].NextPhysical)
+		{
+			if (m_Nodes[node].Free)
+			{
+				stats.FreeBytes += m_Nodes[node].Size;
+				stats.LargestFreeRegion = std::max(stats.LargestFreeRegion, m_Nodes[node].Size);
+				stats.FreeRegionCount++;
+			}
+			else
+				stats.UsedBytes += m_Nodes[node].Size;
+		}
+		return stats;
+	}
+
+	void TLSFAllocator::MapSize(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+	{
+		if (size < SecondLevelCount)
+		{
+			// Small sizes get a linear bin each
+			firstLevel = 0;
+			secondLevel = static_cast<uint32_t>(size);
+			return;
+		}
+
+		uint32_t lastSet = FindLastSet(size);
+		firstLevel = lastSet - SecondLevelCountLog2 + 1;
+		secondLevel = static_cast<uint32_t>(size >> (lastSet - SecondLevelCountLog2)) ^ SecondLevelCount;
+	}
+
+	uint32_t TLSFAllocator::CreateNode()
+	{
+		if (!m_UnusedNodes.empty())
+		{
+			uint32_t node = m_UnusedNodes.back();
+			m_UnusedNodes.pop_back();
+			m_Nodes[node] = {};
+			return node;
+		}
+
+		m_Nodes.emplace_back();
+		return static_cast<uint32_t>(m_Nodes.size() - 1);
+	}
+
+	void TLSFAllocator::ReleaseNode(uint32_t node)
+	{
+		m_UnusedNodes.push_back(node);
+	}
+
+	void TLSFAllocator::InsertFree(uint32_t node)
+	{
+		uint32_t firstLevel, secondLevel;
+		MapSize(m_Nodes[node].Size, firstLevel, secondLevel);
+
+		uint32_t head = m_FreeHeads[firstLevel][secondLevel];
+		m_Nodes[node].Free = true;
+		m_Nodes[node].PrevFree = TLSFAllocation::InvalidNode;
+		m_Nodes[node].NextFree = head;
+		if (head != TLSFAllocation::InvalidNode)
+			m_Nodes[head].PrevFree = node;
+		m_FreeHeads[firstLevel][secondLevel] = node;
+
+		m_FirstLevelBitmap |= 1ull << firstLevel;
+		m_SecondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+	}
+
+	void TLSFAllocator::RemoveFree(uint32_t node)
+	{
+		uint32_t firstLevel, secondLevel;
+		MapSize(m_Nodes[node].Size, firstLevel, secondLevel);
+
+		uint32_t previous = m_Nodes[node].PrevFree;
+		uint32_t next = m_Nodes[node].NextFree;
+		if (previous != TLSFAllocation::InvalidNode)
+			m_Nodes[previous].NextFree = next;
+		else
+			m_FreeHeads[firstLevel][secondLevel] = next;
+		if (next != TLSFAllocation::InvalidNode)
+			m_Nodes[next].PrevFree = previous;
+
+		if (m_FreeHeads[firstLevel][secondLevel] == TLSFAllocation::InvalidNode)
+		{
+			m_SecondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+			if (m_SecondLevelBitmaps[firstLevel] == 0)
+				m_FirstLevelBitmap &= ~(1ull << firstLevel);
+		}
+
+		m_Nodes[node].PrevFree = TLSFAllocation::InvalidNode;
+		m_Nodes[node].NextFree = TLSFAllocation::InvalidNode;
+	}
+
+	uint32_t TLSFAllocator::FindFree(uint64_t size)
+	{
+		// Round up to the next bin so any region found there is large enough
+		if (size >= SecondLevelCount)
+		{
+			uint64_t rounded = size + (1ull << (FindLastSet(size) - SecondLevelCountLog2)) - 1;
+			if (rounded < size)
+				return TLSFAllocation::InvalidNode;
+			size = rounded;
+		}
+
+		uint32_t firstLevel, secondLevel;
+		MapSize(size, firstLevel, secondLevel);
+
+		uint32_t secondLevelMap = m_SecondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+		if (secondLevelMap == 0)
+		{
+			if (firstLevel + 1 >= FirstLevelCount)
+				return TLSFAllocation::InvalidNode;
+
+			uint64_t firstLevelMap = m_FirstLevelBitmap & (~0ull << (firstLevel + 1));
+			if (firstLevelMap == 0)
+				return TLSFAllocation::InvalidNode;
+
+			firstLevel = FindFirstSet(firstLevelMap);
+			secondLevelMap = m_SecondLevelBitmaps[firstLevel];
+		}
+
+		return m_FreeHeads[firstLevel][FindFirstSet(secondLevelMap)];
+	}
+
+	void TLSFAllocator::Split(uint32_t node, uint64_t size)
+	{
+		BRICKENGINE_ASSERT(m_Nodes[node].Size > size);
+
+		uint32_t remainder = CreateNode();
+		m_Nodes[remainder].Offset = m_Nodes[node].Offset + size;
+		m_Nodes[remainder].Size = m_Nodes[node].Size - size;
+		m_Nodes[remainder].PrevPhysical = node;
+		m_Nodes[remainder].NextPhysical = m_Nodes[node].NextPhysical;
+		if (m_Nodes[node].NextPhysical != TLSFAllocation::InvalidNode)
+			m_Nodes[m_Nodes[node].NextPhysical].PrevPhysical = remainder;
+
+		m_Nodes[node].NextPhysical = remainder;
+		m_Nodes[node].Size = size;
+
+		InsertFree(remainder);
+	}
+
+}
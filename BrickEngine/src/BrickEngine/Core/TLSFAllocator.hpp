@@ -0,0 +1,100 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+namespace BrickEngine {
+
+	struct TLSFAllocation
+	{
+		static constexpr uint32_t InvalidNode = std::numeric_limits<uint32_t>::max();
+
+		uint64_t Offset = 0;
+		uint64_t Size = 0;
+		uint32_t Node = InvalidNode;
+
+		bool IsValid() const { return Node != InvalidNode; }
+	};
+
+	struct TLSFStats
+	{
+		uint64_t Capacity = 0;
+		uint64_t UsedBytes = 0;
+		uint64_t FreeBytes = 0;
+		uint64_t LargestFreeRegion = 0;
+		uint32_t AllocationCount = 0;
+		uint32_t FreeRegionCount = 0;
+
+		// 0 when all free space is one region, approaches 1 as it gets split into many small ones
+		float GetFragmentation() const { return FreeBytes > 0 ? 1.0f - static_cast<float>(LargestFreeRegion) / static_cast<float>(FreeBytes) : 0.0f; }
+	};
+
+	// Two-level segregated fit allocator over the offset range [0, capacity). It only hands out offsets, the memory itself is
+	// owned by the caller. Allocate and Free are O(1), neighbouring free regions are merged on Free.
+	class TLSFAllocator
+	{
+	public:
+		static constexpr uint32_t SecondLevelCountLog2 = 5;
+		static constexpr uint32_t SecondLevelCount = 1u << SecondLevelCountLog2;
+		static constexpr uint32_t FirstLevelCount = 64 - SecondLevelCountLog2 + 1;
+
+		TLSFAllocator() = default;
+		TLSFAllocator(uint64_t capacity);
+
+		void Reset(uint64_t capacity);
+
+		// alignment must be a power of two. Returns an invalid allocation when no free region fits.
+		TLSFAllocation Allocate(uint64_t size, uint64_t alignment = 1);
+		void Free(const TLSFAllocation& allocation);
+
+		bool IsEmpty() const { return m_AllocationCount == 0; }
+		uint64_t GetCapacity() const { return m_Capacity; }
+		uint64_t GetUsedBytes() const { return m_UsedBytes; }
+		uint32_t GetAllocationCount() const { return m_AllocationCount; }
+		TLSFStats GetStats() const;
+
+		// Calls function(offset, size, node) for every allocation in offset order.
+		template<typename Function>
+		void ForEachAllocation(Function&& function) const
+		{
+			for (uint32_t node = m_FirstNode; node != TLSFAllocation::InvalidNode; node = m_Nodes[node].NextPhysical)
+			{
+				if (!m_Nodes[node].Free)
+					function(m_Nodes[node].Offset, m_Nodes[node].Size, node);
+			}
+		}
+	private:
+		struct Node
+		{
+			uint64_t Offset = 0;
+			uint64_t Size = 0;
+			uint32_t PrevPhysical = TLSFAllocation::InvalidNode;
+			uint32_t NextPhysical = TLSFAllocation::InvalidNode;
+			uint32_t PrevFree = TLSFAllocation::InvalidNode;
+			uint32_t NextFree = TLSFAllocation::InvalidNode;
+			bool Free = false;
+		};
+
+		static void MapSize(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+
+		uint32_t CreateNode();
+		void ReleaseNode(uint32_t node);
+		void InsertFree(uint32_t node);
+		void RemoveFree(uint32_t node);
+		uint32_t FindFree(uint64_t size);
+		// Splits size bytes off the front of node, the remainder becomes a new free node
+		void Split(uint32_t node, uint64_t size);
+	private:
+		uint64_t m_Capacity = 0;
+		uint64_t m_UsedBytes = 0;
+		uint32_t m_AllocationCount = 0;
+
+		std::vector<Node> m_Nodes = {};
+		std::vector<uint32_t> m_UnusedNodes = {};
+		uint32_t m_FirstNode = TLSFAllocation::InvalidNode;
+
+		uint64_t m_FirstLevelBitmap = 0;
+		uint32_t m_SecondLevelBitmaps[FirstLevelCount] = {};
+		uint32_t m_FreeHeads[FirstLevelCount][SecondLevelCount] = {};
+	};
+
+}
@@ -3,6 +3,8 @@
 
 #if defined(BRICKENGINE_PLATFORM_WINDOWS)
     #include "Platform/Windows/WindowsWindow.hpp"
+#elif defined(BRICKENGINE_PLATFORM_LINUX)
+    #include "Platform/Linux/LinuxWindow.hpp"
 #endif
 
 namespace BrickEngine {
@@ -11,6 +13,14 @@ namespace BrickEngine {
     {
 #if defined(BRICKENGINE_PLATFORM_WINDOWS)
         return new WindowsWindow(width, height, title, resizable);
+#elif defined(BRICKENGINE_PLATFORM_LINUX)
+        LinuxWindow* window = new LinuxWindow(width, height, title, resizable);
+        if (!window->IsOpen())
+        {
+            delete window;
+            return nullptr;
+        }
+        return window;
 #else
         return nullptr;
 #endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "BrickEngine/Core/Base.hpp"
+#include "BrickEngine/Core/Event.hpp"
 
 namespace BrickEngine {
 
@@ -10,14 +11,20 @@ namespace BrickEngine {
 		virtual ~Window() = default;
 
 		virtual bool WantsToClose() = 0;
+		// Never blocks, moves everything the platform has pending into the event queue
 		virtual void PollEvents() = 0;
+		// Takes the oldest event queued by PollEvents, false once the queue is empty
+		bool PollEvent(Event& event) { return m_Events.Pop(event); }
 
 		virtual int32_t GetWidth() = 0;
 		virtual int32_t GetHeight() = 0;
 
+		// nullptr when the platform has no windows or no display to open one on, callers can fall back to headless rendering
 		static Window* Create(uint32_t width, uint32_t height, const std::string& title, bool resizable = true);
 	protected:
 		Window() = default;
+	protected:
+		EventQueue m_Events;
 	};
 
 }
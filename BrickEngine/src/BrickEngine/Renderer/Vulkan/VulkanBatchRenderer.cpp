@@ -0,0 +1,393 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanBatchRenderer.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanRenderer.hpp"
+
+namespace BrickEngine {
+
+	VulkanBatchRenderer::VulkanBatchRenderer(VulkanRenderer* renderer, VkDevice device, VulkanPipelineLibrary* pipelineLibrary, VkRenderPass renderPass)
+		: m_Renderer(renderer), m_Device(device), m_PipelineLibrary(pipelineLibrary), m_RenderPass(renderPass)
+	{
+		m_BindlessHeap = m_Renderer->GetBindlessHeap();
+		if (!m_BindlessHeap)
+		{
+			// Owned by the layout cache, the same layout sprite.frag.glsl reflects to
+			VkDescriptorSetLayoutBinding textureBinding = {};
+			textureBinding.binding = 0;
+			textureBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			textureBinding.descriptorCount = 1;
+			textureBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+			m_DescriptorSetLayout = m_Renderer->GetLayoutCache()->GetDescriptorSetLayout({ textureBinding });
+
+			m_DescriptorAllocator = std::make_unique<VulkanDescriptorAllocator>(m_Renderer, m_Device, std::vector<VkDescriptorPoolSize>{ { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 } });
+		}
+
+		VkSamplerCreateInfo samplerCreateInfo = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+		samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
+		samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+		samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerCreateInfo.maxLod = 0.0f;
+		VK_CHECK(vkCreateSampler(m_Device, &samplerCreateInfo, nullptr, &m_Sampler));
+		if (m_BindlessHeap)
+			m_SamplerIndex = m_BindlessHeap->AddSampler(m_Sampler);
+
+		VulkanPipelineDescription description = {};
+		description.Name = "Sprite";
+		// sprite.frag.glsl compiled with BRICKENGINE_POOLED_DESCRIPTORS
+		description.ShaderPath = m_BindlessHeap ? "assets/shaders/sprite" : "assets/shaders/sprite_pooled";
+		description.ShaderSource = "assets/shaders/sprite";
+		if (!m_BindlessHeap)
+			description.ShaderDefines = { "BRICKENGINE_POOLED_DESCRIPTORS" };
+		description.Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+		// Negative sizes mirror the quad
+		description.CullMode = VK_CULL_MODE_NONE;
+		// Quads with equal Z are drawn over each other in submission order
+		description.DepthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+		description.Blend = true;
+		m_DefaultPipeline = RegisterPipeline(description);
+		// Reflected from the sprite shaders, every pipeline registered later shares it
+		m_PipelineLayout = m_PipelineLibrary->GetLayout(m_DefaultPipeline);
+
+		uint32_t white = 0xffffffff;
+		VulkanTextureHandle whiteTexture = CreateTexture(1, 1, &white);
+		BRICKENGINE_ASSERT(whiteTexture == WhiteTexture);
+
+		const float identity[16] = {
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f
+		};
+		SetViewProjection(identity);
+	}
+
+	VulkanBatchRenderer::~VulkanBatchRenderer()
+	{
+		// The renderer waited for the device to go idle, pending destroys don't have to wait any longer
+		for (auto& texture : m_Textures)
+			DestroyTextureResources(texture);
+		if (m_BindlessHeap)
+			m_BindlessHeap->Remove(VulkanBindlessType::Sampler, m_SamplerIndex);
+
+		vkDestroySampler(m_Device, m_Sampler, nullptr);
+		m_DescriptorAllocator.reset();
+	}
+
+	VulkanTextureHandle VulkanBatchRenderer::CreateTexture(uint32_t width, uint32_t height, const void* pixels)
+	{
+		BRICKENGINE_ASSERT(width > 0 && height > 0 && pixels);
+
+		VulkanTextureHandle handle;
+		if (!m_FreeTextures.empty())
+		{
+			handle = m_FreeTextures.back();
+			m_FreeTextures.pop_back();
+		}
+		else
+		{
+			BRICKENGINE_ASSERT(m_Textures.size() < MaxTextures);
+			handle = static_cast<VulkanTextureHandle>(m_Textures.size());
+			m_Textures.emplace_back();
+		}
+		Texture& texture = m_Textures[handle];
+
+		VkImageCreateInfo imageCreateInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+		imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageCreateInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+		imageCreateInfo.extent = { width, height, 1 };
+		imageCreateInfo.mipLevels = 1;
+		imageCreateInfo.arrayLayers = 1;
+		imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VK_CHECK(vkCreateImage(m_Device, &imageCreateInfo, nullptr, &texture.Image));
+
+		texture.Allocation = m_Renderer->GetAllocator()->AllocateForImage(texture.Image, VulkanMemoryUsage::GPUOnly);
+		BRICKENGINE_ASSERT(texture.Allocation);
+
+		VulkanImageUpload upload = {};
+		upload.Image = texture.Image;
+		upload.Extent = { width, height, 1 };
+		texture.UploadValue = m_Renderer->GetUploadManager()->UploadImage(upload, pixels, static_cast<VkDeviceSize>(width) * height * 4);
+
+		VkImageViewCreateInfo imageViewCreateInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+		imageViewCreateInfo.image = texture.Image;
+		imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		imageViewCreateInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+		imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+		imageViewCreateInfo.subresourceRange.levelCount = 1;
+		imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+		imageViewCreateInfo.subresourceRange.layerCount = 1;
+		VK_CHECK(vkCreateImageView(m_Device, &imageViewCreateInfo, nullptr, &texture.View));
+
+		if (m_BindlessHeap)
+		{
+			texture.BindlessIndex = m_BindlessHeap->AddSampledImage(texture.View);
+			return handle;
+		}
+
+		texture.DescriptorSet = m_DescriptorAllocator->Allocate(m_DescriptorSetLayout);
+
+		VkDescriptorImageInfo imageInfo = {};
+		imageInfo.sampler = m_Sampler;
+		imageInfo.imageView = texture.View;
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkWriteDescriptorSet descriptorWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+		descriptorWrite.dstSet = texture.DescriptorSet.Set;
+		descriptorWrite.dstBinding = 0;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		descriptorWrite.pImageInfo = &imageInfo;
+		vkUpdateDescriptorSets(m_Device, 1, &descriptorWrite, 0, nullptr);
+
+		return handle;
+	}
+
+	void VulkanBatchRenderer::DestroyTexture(VulkanTextureHandle texture)
+	{
+		BRICKENGINE_ASSERT(texture != WhiteTexture && texture < m_Textures.size() && m_Textures[texture].Image);
+
+		// Both defer reusing the descriptor until the frame being recorded completed
+		Texture& resources = m_Textures[texture];
+		if (m_BindlessHeap)
+			m_BindlessHeap->Remove(VulkanBindlessType::SampledImage, resources.BindlessIndex);
+		else
+			m_DescriptorAllocator->Free(resources.DescriptorSet);
+		resources.BindlessIndex = VulkanBindlessHeap::InvalidIndex;
+		resources.DescriptorSet = {};
+
+		// The frame being recorded may still draw with it
+		PendingDestroy& pendingDestroy = m_PendingDestroys.emplace_back();
+		pendingDestroy.Texture = texture;
+		pendingDestroy.FrameNumber = m_Renderer->GetFrameNumber() + 1;
+	}
+
+	VulkanPipelineHandle VulkanBatchRenderer::RegisterPipeline(VulkanPipelineDescription description)
+	{
+		// nullptr for the default pipeline, its layout is reflected with the texture set given
+		description.Layout = m_PipelineLayout;
+		description.SetLayouts = { m_BindlessHeap ? m_BindlessHeap->GetLayout() : m_DescriptorSetLayout };
+		description.RenderPass = m_RenderPass;
+		description.Subpass = 0;
+
+		VkVertexInputBindingDescription& binding = description.VertexBindings.emplace_back();
+		binding.binding = 0;
+		binding.stride = sizeof(VulkanQuadInstance);
+		binding.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+		// Position and rotation share one attribute
+		description.VertexAttributes = {
+			{ 0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(VulkanQuadInstance, Position) },
+			{ 1, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(VulkanQuadInstance, Size) },
+			{ 2, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(VulkanQuadInstance, UVMin) },
+			{ 3, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(VulkanQuadInstance, Color) }
+		};
+
+		return m_PipelineLibrary->Register(description);
+	}
+
+	void VulkanBatchRenderer::SetViewProjection(const float matrix[16])
+	{
+		std::memcpy(m_ViewProjection, matrix, sizeof(m_ViewProjection));
+	}
+
+	void VulkanBatchRenderer::SetOrthographic(float left, float right, float bottom, float top)
+	{
+		// Z is passed through as the depth
+		const float matrix[16] = {
+			2.0f / (right - left), 0.0f, 0.0f, 0.0f,
+			0.0f, 2.0f / (top - bottom), 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			-(right + left) / (right - left), -(top + bottom) / (top - bottom), 0.0f, 1.0f
+		};
+		SetViewProjection(matrix);
+	}
+
+	VulkanBatchStats VulkanBatchRenderer::Flush()
+	{
+		BRICKENGINE_PROFILE_FUNCTION();
+
+		auto start = std::chrono::steady_clock::now();
+
+		DestroyPendingTextures();
+
+		VulkanBatchStats stats;
+		m_DrawOrder.clear();
+		for (uint32_t i = 0; i < m_Batches.size(); i++)
+		{
+			if (!m_Batches[i].Instances.empty())
+				m_DrawOrder.push_back(i);
+		}
+		if (m_DrawOrder.empty())
+			return stats;
+
+		// Pipeline changes cost the most, group by pipeline first and by texture within
+		std::sort(m_DrawOrder.begin(), m_DrawOrder.end(), [&](uint32_t a, uint32_t b)
+			{
+				const Batch& batchA = m_Batches[a];
+				const Batch& batchB = m_Batches[b];
+				if (batchA.Pipeline != batchB.Pipeline)
+					return batchA.Pipeline < batchB.Pipeline;
+				return batchA.Texture < batchB.Texture;
+			}
+		);
+
+		size_t instanceCount = 0;
+		for (uint32_t index : m_DrawOrder)
+		{
+			m_Batches[index].FirstInstance = static_cast<uint32_t>(instanceCount);
+			instanceCount += m_Batches[index].Instances.size();
+		}
+
+		VulkanLinearAllocation instances = m_Renderer->AllocateTransient(instanceCount * sizeof(VulkanQuadInstance));
+		BRICKENGINE_ASSERT(instances.IsValid());
+		VulkanQuadInstance* destination = static_cast<VulkanQuadInstance*>(instances.MappedData);
+
+		// Split the copy over the instances rather than the batches, most frames have one batch holding nearly everything
+		JobSystem::ParallelFor(instanceCount, [&](size_t begin, size_t end)
+			{
+				auto it = std::upper_bound(m_DrawOrder.begin(), m_DrawOrder.end(), begin, [&](size_t instance, uint32_t index)
+					{
+						return instance < m_Batches[index].FirstInstance;
+					}
+				);
+				for (--it; begin < end; ++it)
+				{
+					const Batch& batch = m_Batches[*it];
+					size_t count = std::min<size_t>(end, batch.FirstInstance + batch.Instances.size()) - begin;
+					std::memcpy(destination + begin, batch.Instances.data() + (begin - batch.FirstInstance), count * sizeof(VulkanQuadInstance));
+					begin += count;
+				}
+			}
+		);
+
+		std::atomic<uint32_t> pipelineBinds = 0;
+		m_Renderer->RecordParallel(m_DrawOrder.size(), [&](VkCommandBuffer commandBuffer, size_t begin, size_t end)
+			{
+				// The sprite shaders failed to load, already reported by the pipeline library
+				if (!m_PipelineLayout)
+					return;
+
+				vkCmdBindVertexBuffers(commandBuffer, 0, 1, &instances.Buffer, &instances.Offset);
+				vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(m_ViewProjection), m_ViewProjection);
+				if (m_BindlessHeap)
+				{
+					VkDescriptorSet heapSet = m_BindlessHeap->GetSet();
+					vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &heapSet, 0, nullptr);
+				}
+
+				VkPipeline boundPipeline = nullptr;
+				VulkanTextureHandle boundTexture = std::numeric_limits<VulkanTextureHandle>::max();
+				for (size_t i = begin; i < end; i++)
+				{
+					const Batch& batch = m_Batches[m_DrawOrder[i]];
+					VkPipeline pipeline = m_PipelineLibrary->Get(batch.Pipeline);
+					// Shaders that failed to load, already reported by the pipeline library
+					if (!pipeline)
+						continue;
+
+					if (pipeline != boundPipeline)
+					{
+						vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+						boundPipeline = pipeline;
+						pipelineBinds.fetch_add(1, std::memory_order_relaxed);
+					}
+					if (batch.Texture != boundTexture)
+					{
+						const Texture& texture = m_Textures[batch.Texture];
+						if (m_BindlessHeap)
+						{
+							TexturePushConstants constants;
+							constants.Texture = texture.BindlessIndex;
+							constants.Sampler = m_SamplerIndex;
+							vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(m_ViewProjection), sizeof(constants), &constants);
+						}
+						else
+						{
+							vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &texture.DescriptorSet.Set, 0, nullptr);
+						}
+						boundTexture = batch.Texture;
+					}
+					vkCmdDraw(commandBuffer, 4, static_cast<uint32_t>(batch.Instances.size()), 0, batch.FirstInstance);
+				}
+			}, DrawsPerCommandBuffer
+		);
+
+		for (uint32_t index : m_DrawOrder)
+			m_Batches[index].Instances.clear();
+
+		stats.QuadCount = static_cast<uint32_t>(instanceCount);
+		stats.DrawCalls = static_cast<uint32_t>(m_DrawOrder.size());
+		stats.PipelineBinds = pipelineBinds.load(std::memory_order_relaxed);
+		stats.SubmitTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return stats;
+	}
+
+	uint32_t VulkanBatchRenderer::PackColor(float r, float g, float b, float a)
+	{
+		auto pack = [](float value) { return static_cast<uint32_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f); };
+		return pack(r) | (pack(g) << 8) | (pack(b) << 16) | (pack(a) << 24);
+	}
+
+	uint32_t VulkanBatchRenderer::FindBatch(VulkanPipelineHandle pipeline, VulkanTextureHandle texture, uint64_t key)
+	{
+		BRICKENGINE_ASSERT(texture < m_Textures.size() && m_Textures[texture].Image);
+
+		auto [it, inserted] = m_BatchLookup.try_emplace(key, static_cast<uint32_t>(m_Batches.size()));
+		if (inserted)
+		{
+			Batch& batch = m_Batches.emplace_back();
+			batch.Pipeline = pipeline;
+			batch.Texture = texture;
+		}
+		return it->second;
+	}
+
+	void VulkanBatchRenderer::DestroyPendingTextures()
+	{
+		VulkanUploadManager* uploadManager = m_Renderer->GetUploadManager();
+		for (size_t i = 0; i < m_PendingDestroys.size();)
+		{
+			PendingDestroy& pendingDestroy = m_PendingDestroys[i];
+			Texture& texture = m_Textures[pendingDestroy.Texture];
+			if (!m_Renderer->IsFrameComplete(pendingDestroy.FrameNumber) || !uploadManager->IsComplete(texture.UploadValue))
+			{
+				i++;
+				continue;
+			}
+
+			DestroyTextureResources(texture);
+			m_FreeTextures.push_back(pendingDestroy.Texture);
+
+			// Give back the instance storage of its batches, the handle may be reused for a much smaller texture
+			for (auto& batch : m_Batches)
+			{
+				if (batch.Texture == pendingDestroy.Texture && batch.Instances.empty())
+					std::vector<VulkanQuadInstance>().swap(batch.Instances);
+			}
+
+			m_PendingDestroys[i] = m_PendingDestroys.back();
+			m_PendingDestroys.pop_back();
+		}
+	}
+
+	void VulkanBatchRenderer::DestroyTextureResources(Texture& texture)
+	{
+		if (!texture.Image)
+			return;
+
+		// Descriptors were given back by DestroyTexture, or go with the heap and the allocator on shutdown
+		vkDestroyImageView(m_Device, texture.View, nullptr);
+		vkDestroyImage(m_Device, texture.Image, nullptr);
+		m_Renderer->GetAllocator()->Free(texture.Allocation);
+		texture = {};
+	}
+
+}
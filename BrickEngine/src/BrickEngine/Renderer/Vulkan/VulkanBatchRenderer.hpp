@@ -0,0 +1,178 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanPlatform.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanMemoryAllocator.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanPipelineLibrary.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanBindlessHeap.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanDescriptorAllocator.hpp"
+
+namespace BrickEngine {
+
+	class VulkanRenderer;
+
+	using VulkanTextureHandle = uint32_t;
+
+	// Per-instance vertex data, matches the inputs of assets/shaders/sprite.vert.glsl
+	struct VulkanQuadInstance
+	{
+		// Center of the quad, quads with a smaller Z are drawn in front
+		float Position[3] = { 0.0f, 0.0f, 0.0f };
+		// Radians, counter clockwise around the center
+		float Rotation = 0.0f;
+		float Size[2] = { 1.0f, 1.0f };
+		// Texture coordinates of the top left and bottom right corner
+		float UVMin[2] = { 0.0f, 0.0f };
+		float UVMax[2] = { 1.0f, 1.0f };
+		// RGBA8 with red in the lowest byte, multiplied with the texture
+		uint32_t Color = 0xffffffff;
+	};
+
+	struct VulkanBatchStats
+	{
+		uint32_t QuadCount = 0;
+		uint32_t DrawCalls = 0;
+		uint32_t PipelineBinds = 0;
+		// Seconds spent in Flush sorting, copying and recording the batches
+		double SubmitTime = 0.0;
+	};
+
+	// Collects quads into one batch per pipeline and texture and draws each batch with a single instanced draw.
+	// The batches are sorted by pipeline, then texture, and copied into the frame's persistently mapped transient pool
+	// back to back so one vertex buffer binding serves all of them. Quads of one batch are drawn in submission order,
+	// use Z to order quads across batches. Textures live in the renderer's bindless heap and are selected per draw
+	// through push constants, without descriptor indexing every texture gets a descriptor set of its own instead.
+	// Not thread safe, draw from the thread calling BeginFrame and EndFrame.
+	class VulkanBatchRenderer
+	{
+	public:
+		static constexpr VulkanTextureHandle WhiteTexture = 0;
+		static constexpr uint32_t MaxTextures = 4096;
+		// Draws recorded per secondary command buffer
+		static constexpr size_t DrawsPerCommandBuffer = 64;
+
+		VulkanBatchRenderer(VulkanRenderer* renderer, VkDevice device, VulkanPipelineLibrary* pipelineLibrary, VkRenderPass renderPass);
+		~VulkanBatchRenderer();
+
+		VulkanBatchRenderer(const VulkanBatchRenderer&) = delete;
+		VulkanBatchRenderer& operator=(const VulkanBatchRenderer&) = delete;
+
+		// pixels is width * height RGBA8. Like every upload the texture may only be drawn with from the next BeginFrame on.
+		VulkanTextureHandle CreateTexture(uint32_t width, uint32_t height, const void* pixels);
+		// Destroyed once the GPU stopped using it
+		void DestroyTexture(VulkanTextureHandle texture);
+
+		// Fills in the pipeline layout, render pass and vertex input so the shaders only have to match the default sprite shaders' interface.
+		// Fragment shaders have to be compiled with BRICKENGINE_POOLED_DESCRIPTORS defined when UsesBindless returns false.
+		VulkanPipelineHandle RegisterPipeline(VulkanPipelineDescription description);
+		VulkanPipelineHandle GetDefaultPipeline() const { return m_DefaultPipeline; }
+		bool UsesBindless() const { return m_BindlessHeap != nullptr; }
+
+		// Column major, applies to every quad drawn this frame
+		void SetViewProjection(const float matrix[16]);
+		void SetOrthographic(float left, float right, float bottom, float top);
+
+		void DrawQuad(float x, float y, float z, float width, float height, uint32_t color, float rotation = 0.0f)
+		{
+			VulkanQuadInstance& instance = GetBatch(m_DefaultPipeline, WhiteTexture).Instances.emplace_back();
+			instance.Position[0] = x;
+			instance.Position[1] = y;
+			instance.Position[2] = z;
+			instance.Rotation = rotation;
+			instance.Size[0] = width;
+			instance.Size[1] = height;
+			instance.Color = color;
+		}
+
+		void DrawSprite(const VulkanQuadInstance& instance, VulkanTextureHandle texture) { GetBatch(m_DefaultPipeline, texture).Instances.push_back(instance); }
+		// pipeline has to come from RegisterPipeline
+		void DrawSprite(const VulkanQuadInstance& instance, VulkanTextureHandle texture, VulkanPipelineHandle pipeline) { GetBatch(pipeline, texture).Instances.push_back(instance); }
+
+		// Records the batches into the current frame and starts over, called by VulkanRenderer::EndFrame
+		VulkanBatchStats Flush();
+
+		static uint32_t PackColor(float r, float g, float b, float a = 1.0f);
+	private:
+		struct Batch
+		{
+			VulkanPipelineHandle Pipeline = 0;
+			VulkanTextureHandle Texture = 0;
+			std::vector<VulkanQuadInstance> Instances = {};
+			// Offset into the frame's instance buffer, set by Flush
+			uint32_t FirstInstance = 0;
+		};
+
+		// Pushed to the fragment shader per draw, right behind the view projection
+		struct TexturePushConstants
+		{
+			VulkanBindlessIndex Texture = 0;
+			VulkanBindlessIndex Sampler = 0;
+		};
+
+		struct Texture
+		{
+			VkImage Image = nullptr;
+			VulkanAllocation* Allocation = nullptr;
+			VkImageView View = nullptr;
+			// One of the two, depending on UsesBindless
+			VulkanBindlessIndex BindlessIndex = VulkanBindlessHeap::InvalidIndex;
+			VulkanDescriptorAllocation DescriptorSet = {};
+			// Upload timeline value the image contents are ready at
+			uint64_t UploadValue = 0;
+		};
+
+		struct PendingDestroy
+		{
+			VulkanTextureHandle Texture = 0;
+			// Frame number of the last frame that may have used the texture
+			uint64_t FrameNumber = 0;
+		};
+
+		Batch& GetBatch(VulkanPipelineHandle pipeline, VulkanTextureHandle texture)
+		{
+			// Consecutive quads mostly share their batch, only look it up when it changes
+			uint64_t key = (static_cast<uint64_t>(pipeline) << 32) | texture;
+			if (key != m_LastBatchKey)
+			{
+				m_LastBatch = FindBatch(pipeline, texture, key);
+				m_LastBatchKey = key;
+			}
+			return m_Batches[m_LastBatch];
+		}
+
+		uint32_t FindBatch(VulkanPipelineHandle pipeline, VulkanTextureHandle texture, uint64_t key);
+		void DestroyPendingTextures();
+		void DestroyTextureResources(Texture& texture);
+	private:
+		VulkanRenderer* m_Renderer = nullptr;
+		VkDevice m_Device = nullptr;
+		VulkanPipelineLibrary* m_PipelineLibrary = nullptr;
+		VkRenderPass m_RenderPass = nullptr;
+
+		// nullptr without descriptor indexing, m_DescriptorSetLayout and m_DescriptorAllocator are only used then
+		VulkanBindlessHeap* m_BindlessHeap = nullptr;
+		VkDescriptorSetLayout m_DescriptorSetLayout = nullptr;
+		std::unique_ptr<VulkanDescriptorAllocator> m_DescriptorAllocator;
+		// Owned by the layout cache like m_DescriptorSetLayout
+		VkPipelineLayout m_PipelineLayout = nullptr;
+		VkSampler m_Sampler = nullptr;
+		VulkanBindlessIndex m_SamplerIndex = VulkanBindlessHeap::InvalidIndex;
+		VulkanPipelineHandle m_DefaultPipeline = 0;
+
+		std::vector<Texture> m_Textures = {};
+		std::vector<VulkanTextureHandle> m_FreeTextures = {};
+		std::vector<PendingDestroy> m_PendingDestroys = {};
+
+		float m_ViewProjection[16] = {};
+
+		// Batches are kept across frames so their instance storage is reused
+		std::vector<Batch> m_Batches = {};
+		std::unordered_map<uint64_t, uint32_t> m_BatchLookup = {};
+		uint64_t m_LastBatchKey = std::numeric_limits<uint64_t>::max();
+		uint32_t m_LastBatch = 0;
+		// Indices of the batches drawn this frame in draw order, kept to reuse the storage
+		std::vector<uint32_t> m_DrawOrder = {};
+	};
+
+}
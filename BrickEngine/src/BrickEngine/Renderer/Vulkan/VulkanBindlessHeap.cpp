@@ -0,0 +1,166 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanBindlessHeap.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanRenderer.hpp"
+
+namespace BrickEngine {
+
+	static constexpr VkDescriptorType s_DescriptorTypes[] = { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_SAMPLER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER };
+	static constexpr uint32_t s_TypeCount = static_cast<uint32_t>(VulkanBindlessType::Count);
+
+	VulkanBindlessHeap::VulkanBindlessHeap(VulkanRenderer* renderer, VkDevice device, uint32_t sampledImageCapacity, uint32_t samplerCapacity, uint32_t storageBufferCapacity)
+		: m_Renderer(renderer), m_Device(device)
+	{
+		m_Arrays[static_cast<size_t>(VulkanBindlessType::SampledImage)].Capacity = sampledImageCapacity;
+		m_Arrays[static_cast<size_t>(VulkanBindlessType::Sampler)].Capacity = samplerCapacity;
+		m_Arrays[static_cast<size_t>(VulkanBindlessType::StorageBuffer)].Capacity = storageBufferCapacity;
+
+		VkDescriptorSetLayoutBinding bindings[s_TypeCount] = {};
+		VkDescriptorBindingFlags bindingFlags[s_TypeCount] = {};
+		VkDescriptorPoolSize poolSizes[s_TypeCount] = {};
+		for (uint32_t i = 0; i < s_TypeCount; i++)
+		{
+			BRICKENGINE_ASSERT(m_Arrays[i].Capacity > 0);
+			bindings[i].binding = i;
+			bindings[i].descriptorType = s_DescriptorTypes[i];
+			bindings[i].descriptorCount = m_Arrays[i].Capacity;
+			bindings[i].stageFlags = VK_SHADER_STAGE_ALL;
+			// Unused elements may stay unwritten and free elements may be rewritten while earlier frames are in flight
+			bindingFlags[i] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+			poolSizes[i].type = s_DescriptorTypes[i];
+			poolSizes[i].descriptorCount = m_Arrays[i].Capacity;
+		}
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO };
+		bindingFlagsCreateInfo.bindingCount = s_TypeCount;
+		bindingFlagsCreateInfo.pBindingFlags = bindingFlags;
+
+		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+		descriptorSetLayoutCreateInfo.pNext = &bindingFlagsCreateInfo;
+		descriptorSetLayoutCreateInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		descriptorSetLayoutCreateInfo.bindingCount = s_TypeCount;
+		descriptorSetLayoutCreateInfo.pBindings = bindings;
+		VK_CHECK(vkCreateDescriptorSetLayout(m_Device, &descriptorSetLayoutCreateInfo, nullptr, &m_Layout));
+
+		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+		descriptorPoolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		descriptorPoolCreateInfo.maxSets = 1;
+		descriptorPoolCreateInfo.poolSizeCount = s_TypeCount;
+		descriptorPoolCreateInfo.pPoolSizes = poolSizes;
+		VK_CHECK(vkCreateDescriptorPool(m_Device, &descriptorPoolCreateInfo, nullptr, &m_Pool));
+
+		VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+		descriptorSetAllocateInfo.descriptorPool = m_Pool;
+		descriptorSetAllocateInfo.descriptorSetCount = 1;
+		descriptorSetAllocateInfo.pSetLayouts = &m_Layout;
+		VK_CHECK(vkAllocateDescriptorSets(m_Device, &descriptorSetAllocateInfo, &m_Set));
+
+		Log::Info(LogCategory::Renderer, "Bindless heap with {} sampled images, {} samplers and {} storage buffers", sampledImageCapacity, samplerCapacity, storageBufferCapacity);
+	}
+
+	VulkanBindlessHeap::~VulkanBindlessHeap()
+	{
+		vkDestroyDescriptorPool(m_Device, m_Pool, nullptr);
+		vkDestroyDescriptorSetLayout(m_Device, m_Layout, nullptr);
+	}
+
+	VulkanBindlessIndex VulkanBindlessHeap::AddSampledImage(VkImageView view, VkImageLayout layout)
+	{
+		VkDescriptorImageInfo imageInfo = {};
+		imageInfo.imageView = view;
+		imageInfo.imageLayout = layout;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		VulkanBindlessIndex index = Allocate(VulkanBindlessType::SampledImage);
+
+		VkWriteDescriptorSet descriptorWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+		descriptorWrite.dstSet = m_Set;
+		descriptorWrite.dstBinding = static_cast<uint32_t>(VulkanBindlessType::SampledImage);
+		descriptorWrite.dstArrayElement = index;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		descriptorWrite.pImageInfo = &imageInfo;
+		vkUpdateDescriptorSets(m_Device, 1, &descriptorWrite, 0, nullptr);
+		return index;
+	}
+
+	VulkanBindlessIndex VulkanBindlessHeap::AddSampler(VkSampler sampler)
+	{
+		VkDescriptorImageInfo imageInfo = {};
+		imageInfo.sampler = sampler;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		VulkanBindlessIndex index = Allocate(VulkanBindlessType::Sampler);
+
+		VkWriteDescriptorSet descriptorWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+		descriptorWrite.dstSet = m_Set;
+		descriptorWrite.dstBinding = static_cast<uint32_t>(VulkanBindlessType::Sampler);
+		descriptorWrite.dstArrayElement = index;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+		descriptorWrite.pImageInfo = &imageInfo;
+		vkUpdateDescriptorSets(m_Device, 1, &descriptorWrite, 0, nullptr);
+		return index;
+	}
+
+	VulkanBindlessIndex VulkanBindlessHeap::AddStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+	{
+		VkDescriptorBufferInfo bufferInfo = {};
+		bufferInfo.buffer = buffer;
+		bufferInfo.offset = offset;
+		bufferInfo.range = range;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		VulkanBindlessIndex index = Allocate(VulkanBindlessType::StorageBuffer);
+
+		VkWriteDescriptorSet descriptorWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+		descriptorWrite.dstSet = m_Set;
+		descriptorWrite.dstBinding = static_cast<uint32_t>(VulkanBindlessType::StorageBuffer);
+		descriptorWrite.dstArrayElement = index;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorWrite.pBufferInfo = &bufferInfo;
+		vkUpdateDescriptorSets(m_Device, 1, &descriptorWrite, 0, nullptr);
+		return index;
+	}
+
+	void VulkanBindlessHeap::Remove(VulkanBindlessType type, VulkanBindlessIndex index)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		DescriptorArray& array = m_Arrays[static_cast<size_t>(type)];
+		BRICKENGINE_ASSERT(index < array.Next);
+
+		// The frame being recorded may still use it, the descriptor itself is left as is since nothing reads it afterwards
+		PendingFree& pendingFree = array.Pending.emplace_back();
+		pendingFree.Index = index;
+		pendingFree.FrameNumber = m_Renderer->GetFrameNumber() + 1;
+	}
+
+	uint32_t VulkanBindlessHeap::GetUsedCount(VulkanBindlessType type) const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		const DescriptorArray& array = m_Arrays[static_cast<size_t>(type)];
+		return array.Next - static_cast<uint32_t>(array.Free.size());
+	}
+
+	VulkanBindlessIndex VulkanBindlessHeap::Allocate(VulkanBindlessType type)
+	{
+		DescriptorArray& array = m_Arrays[static_cast<size_t>(type)];
+		while (!array.Pending.empty() && m_Renderer->IsFrameComplete(array.Pending.front().FrameNumber))
+		{
+			array.Free.push_back(array.Pending.front().Index);
+			array.Pending.pop_front();
+		}
+
+		if (!array.Free.empty())
+		{
+			VulkanBindlessIndex index = array.Free.back();
+			array.Free.pop_back();
+			return index;
+		}
+
+		BRICKENGINE_ASSERT(array.Next < array.Capacity);
+		return array.Next++;
+	}
+
+}
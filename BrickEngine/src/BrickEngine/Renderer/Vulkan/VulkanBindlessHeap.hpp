@@ -0,0 +1,81 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanPlatform.hpp"
+
+namespace BrickEngine {
+
+	class VulkanRenderer;
+
+	// Also the binding of the descriptor array in the heap's set
+	enum class VulkanBindlessType : uint8_t
+	{
+		SampledImage = 0,
+		Sampler,
+		StorageBuffer,
+		Count
+	};
+
+	using VulkanBindlessIndex = uint32_t;
+
+	// One update after bind descriptor set holding every sampled image, sampler and storage buffer in a partially bound
+	// array per type. Shaders index the arrays with indices passed through push constants, so the set is bound once
+	// per command buffer and never changes between draws. Indices stay stable while in use, removed ones are only handed
+	// out again once every frame recorded before the removal completed. Thread safe.
+	class VulkanBindlessHeap
+	{
+	public:
+		static constexpr VulkanBindlessIndex InvalidIndex = std::numeric_limits<VulkanBindlessIndex>::max();
+
+		// Capacities are clamped to the device limits by the renderer
+		VulkanBindlessHeap(VulkanRenderer* renderer, VkDevice device, uint32_t sampledImageCapacity, uint32_t samplerCapacity, uint32_t storageBufferCapacity);
+		~VulkanBindlessHeap();
+
+		VulkanBindlessHeap(const VulkanBindlessHeap&) = delete;
+		VulkanBindlessHeap& operator=(const VulkanBindlessHeap&) = delete;
+
+		VulkanBindlessIndex AddSampledImage(VkImageView view, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		VulkanBindlessIndex AddSampler(VkSampler sampler);
+		VulkanBindlessIndex AddStorageBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+		// The resource itself has to stay alive until the frames that may use it completed as well
+		void Remove(VulkanBindlessType type, VulkanBindlessIndex index);
+
+		// Set 0 of every pipeline layout drawing with the heap
+		VkDescriptorSetLayout GetLayout() const { return m_Layout; }
+		VkDescriptorSet GetSet() const { return m_Set; }
+		uint32_t GetCapacity(VulkanBindlessType type) const { return m_Arrays[static_cast<size_t>(type)].Capacity; }
+		// Indices in use, including removed ones waiting for their frames to complete
+		uint32_t GetUsedCount(VulkanBindlessType type) const;
+	private:
+		struct PendingFree
+		{
+			VulkanBindlessIndex Index = 0;
+			// Frame number of the last frame that may have used the index
+			uint64_t FrameNumber = 0;
+		};
+
+		struct DescriptorArray
+		{
+			uint32_t Capacity = 0;
+			// Indices at and above this one were never handed out
+			uint32_t Next = 0;
+			std::vector<VulkanBindlessIndex> Free = {};
+			// Frame numbers only grow, the oldest removal completes first
+			std::deque<PendingFree> Pending = {};
+		};
+
+		VulkanBindlessIndex Allocate(VulkanBindlessType type);
+	private:
+		VulkanRenderer* m_Renderer = nullptr;
+		VkDevice m_Device = nullptr;
+
+		VkDescriptorSetLayout m_Layout = nullptr;
+		VkDescriptorPool m_Pool = nullptr;
+		VkDescriptorSet m_Set = nullptr;
+
+		mutable std::mutex m_Mutex;
+		std::array<DescriptorArray, static_cast<size_t>(VulkanBindlessType::Count)> m_Arrays = {};
+	};
+
+}
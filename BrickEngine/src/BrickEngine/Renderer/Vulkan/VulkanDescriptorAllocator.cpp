@@ -0,0 +1,91 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanDescriptorAllocator.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanRenderer.hpp"
+
+namespace BrickEngine {
+
+	VulkanDescriptorAllocator::VulkanDescriptorAllocator(VulkanRenderer* renderer, VkDevice device, const std::vector<VkDescriptorPoolSize>& setSizes, uint32_t setsPerPool)
+		: m_Renderer(renderer), m_Device(device), m_PoolSizes(setSizes), m_SetsPerPool(setsPerPool)
+	{
+		BRICKENGINE_ASSERT(!m_PoolSizes.empty() && m_SetsPerPool > 0);
+		for (auto& poolSize : m_PoolSizes)
+			poolSize.descriptorCount *= m_SetsPerPool;
+	}
+
+	VulkanDescriptorAllocator::~VulkanDescriptorAllocator()
+	{
+		// Destroying a pool frees its sets
+		for (auto& pool : m_Pools)
+			vkDestroyDescriptorPool(m_Device, pool.Handle, nullptr);
+	}
+
+	VulkanDescriptorAllocation VulkanDescriptorAllocator::Allocate(VkDescriptorSetLayout layout)
+	{
+		FreeRetiredSets();
+
+		VulkanDescriptorAllocation allocation;
+		if (m_Pools.empty() || m_Pools[m_CurrentPool].FreeSets == 0)
+		{
+			auto it = std::find_if(m_Pools.begin(), m_Pools.end(), [](const Pool& pool) { return pool.FreeSets > 0; });
+			m_CurrentPool = it != m_Pools.end() ? static_cast<uint32_t>(it - m_Pools.begin()) : CreatePool();
+		}
+
+		VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+		descriptorSetAllocateInfo.descriptorPool = m_Pools[m_CurrentPool].Handle;
+		descriptorSetAllocateInfo.descriptorSetCount = 1;
+		descriptorSetAllocateInfo.pSetLayouts = &layout;
+		VkResult result = vkAllocateDescriptorSets(m_Device, &descriptorSetAllocateInfo, &allocation.Set);
+		if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+		{
+			// Fragmented, a fresh pool has room for any set of the allocator's shape. Skipped until one of its sets is freed.
+			m_Pools[m_CurrentPool].FreeSets = 0;
+			m_CurrentPool = CreatePool();
+			descriptorSetAllocateInfo.descriptorPool = m_Pools[m_CurrentPool].Handle;
+			result = vkAllocateDescriptorSets(m_Device, &descriptorSetAllocateInfo, &allocation.Set);
+		}
+		VK_CHECK(result);
+
+		allocation.Pool = m_CurrentPool;
+		m_Pools[m_CurrentPool].FreeSets--;
+		return allocation;
+	}
+
+	void VulkanDescriptorAllocator::Free(const VulkanDescriptorAllocation& allocation)
+	{
+		BRICKENGINE_ASSERT(allocation.Set && allocation.Pool < m_Pools.size());
+
+		// The frame being recorded may still bind it
+		PendingFree& pendingFree = m_PendingFrees.emplace_back();
+		pendingFree.Allocation = allocation;
+		pendingFree.FrameNumber = m_Renderer->GetFrameNumber() + 1;
+	}
+
+	void VulkanDescriptorAllocator::FreeRetiredSets()
+	{
+		while (!m_PendingFrees.empty() && m_Renderer->IsFrameComplete(m_PendingFrees.front().FrameNumber))
+		{
+			const VulkanDescriptorAllocation& allocation = m_PendingFrees.front().Allocation;
+			VK_CHECK(vkFreeDescriptorSets(m_Device, m_Pools[allocation.Pool].Handle, 1, &allocation.Set));
+			m_Pools[allocation.Pool].FreeSets++;
+			m_PendingFrees.pop_front();
+		}
+	}
+
+	uint32_t VulkanDescriptorAllocator::CreatePool()
+	{
+		Pool& pool = m_Pools.emplace_back();
+		pool.FreeSets = m_SetsPerPool;
+
+		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+		descriptorPoolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+		descriptorPoolCreateInfo.maxSets = m_SetsPerPool;
+		descriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(m_PoolSizes.size());
+		descriptorPoolCreateInfo.pPoolSizes = m_PoolSizes.data();
+		VK_CHECK(vkCreateDescriptorPool(m_Device, &descriptorPoolCreateInfo, nullptr, &pool.Handle));
+
+		Log::Trace(LogCategory::Renderer, "Created descriptor pool {} for {} sets", m_Pools.size(), m_SetsPerPool);
+		return static_cast<uint32_t>(m_Pools.size() - 1);
+	}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanPlatform.hpp"
+
+namespace BrickEngine {
+
+	class VulkanRenderer;
+
+	struct VulkanDescriptorAllocation
+	{
+		VkDescriptorSet Set = nullptr;
+		uint32_t Pool = 0;
+	};
+
+	// Allocates descriptor sets of one shape from a growing list of pools, for devices without descriptor indexing
+	// where resources are bound per draw instead of through the bindless heap. Freed sets go back to their pool once
+	// every frame recorded before the free completed. Not thread safe.
+	class VulkanDescriptorAllocator
+	{
+	public:
+		static constexpr uint32_t DefaultSetsPerPool = 256;
+
+		// setSizes are the descriptors a single set needs, every pool holds setsPerPool of them
+		VulkanDescriptorAllocator(VulkanRenderer* renderer, VkDevice device, const std::vector<VkDescriptorPoolSize>& setSizes, uint32_t setsPerPool = DefaultSetsPerPool);
+		~VulkanDescriptorAllocator();
+
+		VulkanDescriptorAllocator(const VulkanDescriptorAllocator&) = delete;
+		VulkanDescriptorAllocator& operator=(const VulkanDescriptorAllocator&) = delete;
+
+		VulkanDescriptorAllocation Allocate(VkDescriptorSetLayout layout);
+		void Free(const VulkanDescriptorAllocation& allocation);
+
+		uint32_t GetPoolCount() const { return static_cast<uint32_t>(m_Pools.size()); }
+	private:
+		struct Pool
+		{
+			VkDescriptorPool Handle = nullptr;
+			uint32_t FreeSets = 0;
+		};
+
+		struct PendingFree
+		{
+			VulkanDescriptorAllocation Allocation = {};
+			// Frame number of the last frame that may have used the set
+			uint64_t FrameNumber = 0;
+		};
+
+		void FreeRetiredSets();
+		uint32_t CreatePool();
+	private:
+		VulkanRenderer* m_Renderer = nullptr;
+		VkDevice m_Device = nullptr;
+		std::vector<VkDescriptorPoolSize> m_PoolSizes = {};
+		uint32_t m_SetsPerPool = 0;
+
+		std::vector<Pool> m_Pools = {};
+		// Pool tried first, the last one that had room
+		uint32_t m_CurrentPool = 0;
+		std::deque<PendingFree> m_PendingFrees = {};
+	};
+
+}
@@ -0,0 +1,169 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanGpuProfiler.hpp"
+
+namespace BrickEngine {
+
+	VulkanGpuProfiler::VulkanGpuProfiler(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, uint32_t framesInFlight, uint32_t timestampValidBits, bool calibratedTimestamps)
+		: m_Device(device)
+	{
+		BRICKENGINE_ASSERT(timestampValidBits > 0 && timestampValidBits <= 64);
+
+		VkPhysicalDeviceProperties physicalDeviceProperties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+		m_TimestampPeriod = physicalDeviceProperties.limits.timestampPeriod;
+		m_TimestampMask = timestampValidBits == 64 ? std::numeric_limits<uint64_t>::max() : (uint64_t(1) << timestampValidBits) - 1;
+		m_TimestampShift = 64 - timestampValidBits;
+
+		if (calibratedTimestamps)
+		{
+			// The device has to be able to calibrate against the clock the profiler reads, not just any host clock
+			PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT vkGetPhysicalDeviceCalibrateableTimeDomainsEXT = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+			uint32_t timeDomainCount = 0;
+			std::vector<VkTimeDomainEXT> timeDomains;
+			if (vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)
+			{
+				VK_CHECK(vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(physicalDevice, &timeDomainCount, nullptr));
+				timeDomains.resize(timeDomainCount);
+				VK_CHECK(vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(physicalDevice, &timeDomainCount, timeDomains.data()));
+			}
+
+			m_HostTimeDomain = VulkanPlatform::GetHostTimeDomain();
+			bool hasDomains =
+				std::find(timeDomains.begin(), timeDomains.end(), VK_TIME_DOMAIN_DEVICE_EXT) != timeDomains.end()		&&
+				std::find(timeDomains.begin(), timeDomains.end(), m_HostTimeDomain) != timeDomains.end();
+			if (hasDomains)
+				m_GetCalibratedTimestamps = (PFN_vkGetCalibratedTimestampsEXT)vkGetDeviceProcAddr(m_Device, "vkGetCalibratedTimestampsEXT");
+		}
+		if (!m_GetCalibratedTimestamps)
+			Log::Warn(LogCategory::Renderer, "Calibrated timestamps aren't available, GPU profiler scopes are aligned to submits");
+
+		m_Frames.resize(framesInFlight);
+		for (auto& frame : m_Frames)
+		{
+			VkQueryPoolCreateInfo queryPoolCreateInfo = { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+			queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			queryPoolCreateInfo.queryCount = MaxQueriesPerFrame;
+			VK_CHECK(vkCreateQueryPool(m_Device, &queryPoolCreateInfo, nullptr, &frame.QueryPool));
+			frame.Scopes.reserve(MaxQueriesPerFrame / 2);
+		}
+		m_Results.resize(MaxQueriesPerFrame);
+
+		m_Track = Profiler::CreateTrack("GPU");
+	}
+
+	VulkanGpuProfiler::~VulkanGpuProfiler()
+	{
+		for (auto& frame : m_Frames)
+			vkDestroyQueryPool(m_Device, frame.QueryPool, nullptr);
+	}
+
+	void VulkanGpuProfiler::BeginFrame(uint32_t frameIndex, VkCommandBuffer commandBuffer)
+	{
+		BRICKENGINE_PROFILE_FUNCTION();
+
+		m_FrameIndex = frameIndex;
+		Frame& frame = m_Frames[m_FrameIndex];
+		Collect(frame);
+
+		frame.Scopes.clear();
+		frame.Capturing = Profiler::IsCapturing();
+		if (!frame.Capturing)
+		{
+			m_FrameScope = InvalidScope;
+			return;
+		}
+
+		// Queries have to be reset before they are written again
+		vkCmdResetQueryPool(commandBuffer, frame.QueryPool, 0, MaxQueriesPerFrame);
+		frame.QueryCount = 0;
+		m_FrameScope = BeginScope(commandBuffer, "Frame");
+	}
+
+	void VulkanGpuProfiler::EndFrame(VkCommandBuffer commandBuffer)
+	{
+		EndScope(commandBuffer, m_FrameScope);
+		m_FrameScope = InvalidScope;
+		m_Frames[m_FrameIndex].SubmitTime = Profiler::Now();
+	}
+
+	uint32_t VulkanGpuProfiler::BeginScope(VkCommandBuffer commandBuffer, const char* name)
+	{
+		Frame& frame = m_Frames[m_FrameIndex];
+		if (!frame.Capturing || frame.QueryCount + 2 > MaxQueriesPerFrame)
+			return InvalidScope;
+
+		Scope& scope = frame.Scopes.emplace_back();
+		scope.Name = name;
+		scope.BeginQuery = frame.QueryCount;
+		// The end query is reserved right away so the pair stays adjacent however scopes nest
+		frame.QueryCount += 2;
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.QueryPool, scope.BeginQuery);
+		return static_cast<uint32_t>(frame.Scopes.size() - 1);
+	}
+
+	void VulkanGpuProfiler::EndScope(VkCommandBuffer commandBuffer, uint32_t scope)
+	{
+		if (scope == InvalidScope)
+			return;
+
+		Frame& frame = m_Frames[m_FrameIndex];
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.QueryPool, frame.Scopes[scope].BeginQuery + 1);
+	}
+
+	void VulkanGpuProfiler::Collect(Frame& frame)
+	{
+		// Results of a capture that has ended since were never going to be exported
+		if (!frame.Capturing || frame.Scopes.empty() || !Profiler::IsCapturing())
+			return;
+
+		// The frame finished on the GPU, so every query it wrote is available and this doesn't wait
+		VkResult result = vkGetQueryPoolResults(m_Device, frame.QueryPool, 0, frame.QueryCount, frame.QueryCount * sizeof(uint64_t), m_Results.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS)
+			return;
+
+		uint64_t gpuReference = 0;
+		uint64_t cpuReference = 0;
+		if (!Calibrate(gpuReference, cpuReference))
+		{
+			// The GPU can't have started before the submit, so that is where the frame's first timestamp is put
+			gpuReference = m_Results[frame.Scopes.front().BeginQuery] & m_TimestampMask;
+			cpuReference = frame.SubmitTime;
+		}
+
+		auto toCpuTime = [&](uint64_t ticks)
+			{
+				// Ticks wrap at timestampValidBits, the difference is sign extended from that width
+				int64_t delta = static_cast<int64_t>((ticks - gpuReference) << m_TimestampShift) >> m_TimestampShift;
+				return static_cast<uint64_t>(static_cast<int64_t>(cpuReference) + static_cast<int64_t>(delta * m_TimestampPeriod));
+			};
+
+		for (auto& scope : frame.Scopes)
+		{
+			uint64_t begin = m_Results[scope.BeginQuery] & m_TimestampMask;
+			uint64_t end = m_Results[scope.BeginQuery + 1] & m_TimestampMask;
+			m_Track->Record(scope.Name, toCpuTime(begin), toCpuTime(end));
+		}
+	}
+
+	bool VulkanGpuProfiler::Calibrate(uint64_t& gpuTicks, uint64_t& cpuTime)
+	{
+		if (!m_GetCalibratedTimestamps)
+			return false;
+
+		VkCalibratedTimestampInfoEXT timestampInfos[2] = {};
+		timestampInfos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		timestampInfos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+		timestampInfos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		timestampInfos[1].timeDomain = m_HostTimeDomain;
+
+		uint64_t timestamps[2] = {};
+		uint64_t maxDeviation = 0;
+		if (m_GetCalibratedTimestamps(m_Device, 2, timestampInfos, timestamps, &maxDeviation) != VK_SUCCESS)
+			return false;
+
+		gpuTicks = timestamps[0] & m_TimestampMask;
+		cpuTime = VulkanPlatform::HostTimestampToNanoseconds(timestamps[1]);
+		return true;
+	}
+
+}
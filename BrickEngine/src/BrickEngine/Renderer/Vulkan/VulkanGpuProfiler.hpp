@@ -0,0 +1,80 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+#include "BrickEngine/Core/Profiler.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanPlatform.hpp"
+
+namespace BrickEngine {
+
+	// Times GPU work with timestamp queries and records it on the profiler's "GPU" track next to the CPU threads. Each
+	// frame in flight has its own query pool, read back once the frame's slot comes around again, so nothing ever waits
+	// on the GPU. Device ticks are mapped onto the CPU clock with VK_EXT_calibrated_timestamps when the device has it,
+	// otherwise the frame's first timestamp is aligned with its submit, which only places GPU work roughly.
+	// Queries are only written while the profiler is capturing. Not thread safe, scopes go into primary command buffers.
+	class VulkanGpuProfiler
+	{
+	public:
+		static constexpr uint32_t InvalidScope = std::numeric_limits<uint32_t>::max();
+		// Two per scope, scopes past it aren't timed
+		static constexpr uint32_t MaxQueriesPerFrame = 256;
+
+		// timestampValidBits of the queue family the command buffers are submitted to
+		VulkanGpuProfiler(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, uint32_t framesInFlight, uint32_t timestampValidBits, bool calibratedTimestamps);
+		~VulkanGpuProfiler();
+
+		VulkanGpuProfiler(const VulkanGpuProfiler&) = delete;
+		VulkanGpuProfiler& operator=(const VulkanGpuProfiler&) = delete;
+
+		// Once the GPU finished the frame's previous use, first thing in its command buffer. Collects the previous results
+		// and opens a scope covering the whole frame.
+		void BeginFrame(uint32_t frameIndex, VkCommandBuffer commandBuffer);
+		// Right before the command buffer ends and is submitted
+		void EndFrame(VkCommandBuffer commandBuffer);
+
+		// Outside render passes recording secondary command buffers, those only allow executing them. name has to
+		// outlive the capture.
+		uint32_t BeginScope(VkCommandBuffer commandBuffer, const char* name);
+		void EndScope(VkCommandBuffer commandBuffer, uint32_t scope);
+	private:
+		struct Scope
+		{
+			const char* Name = nullptr;
+			uint32_t BeginQuery = 0;
+		};
+
+		struct Frame
+		{
+			VkQueryPool QueryPool = nullptr;
+			std::vector<Scope> Scopes = {};
+			uint32_t QueryCount = 0;
+			// Profiler::Now when the frame was submitted, aligns the timestamps without calibration
+			uint64_t SubmitTime = 0;
+			// The capture the queries were written for, their results are dropped when it ended meanwhile
+			bool Capturing = false;
+		};
+
+		void Collect(Frame& frame);
+		// Pairs a device tick with a Profiler::Now time, false without VK_EXT_calibrated_timestamps
+		bool Calibrate(uint64_t& gpuTicks, uint64_t& cpuTime);
+	private:
+		VkDevice m_Device = nullptr;
+		ProfilerTrack* m_Track = nullptr;
+
+		std::vector<Frame> m_Frames = {};
+		uint32_t m_FrameIndex = 0;
+		uint32_t m_FrameScope = InvalidScope;
+
+		// Nanoseconds per tick
+		double m_TimestampPeriod = 1.0;
+		uint64_t m_TimestampMask = 0;
+		uint32_t m_TimestampShift = 0;
+
+		PFN_vkGetCalibratedTimestampsEXT m_GetCalibratedTimestamps = nullptr;
+		VkTimeDomainEXT m_HostTimeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+
+		// Reused by Collect
+		std::vector<uint64_t> m_Results = {};
+	};
+
+}
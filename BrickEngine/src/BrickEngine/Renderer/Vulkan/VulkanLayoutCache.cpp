@@ -0,0 +1,149 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanLayoutCache.hpp"
+
+namespace BrickEngine {
+
+	// FNV-1a
+	static uint64_t HashData(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 0x100000001b3;
+		}
+		return hash;
+	}
+
+	template<typename T>
+	static uint64_t HashValue(const T& value, uint64_t hash)
+	{
+		return HashData(&value, sizeof(value), hash);
+	}
+
+	VulkanLayoutCache::VulkanLayoutCache(VkDevice device)
+		: m_Device(device)
+	{
+	}
+
+	VulkanLayoutCache::~VulkanLayoutCache()
+	{
+		for (auto& [key, layout] : m_PipelineLayouts)
+			vkDestroyPipelineLayout(m_Device, layout, nullptr);
+		for (auto& [key, layout] : m_SetLayouts)
+			vkDestroyDescriptorSetLayout(m_Device, layout, nullptr);
+	}
+
+	VkDescriptorSetLayout VulkanLayoutCache::GetDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings, VkDescriptorSetLayoutCreateFlags flags)
+	{
+		SetLayoutKey key;
+		key.Flags = flags;
+		key.Bindings = bindings;
+		std::sort(key.Bindings.begin(), key.Bindings.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) { return a.binding < b.binding; });
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto it = m_SetLayouts.find(key);
+		if (it != m_SetLayouts.end())
+		{
+			m_HitCount++;
+			return it->second;
+		}
+
+		for (auto& binding : key.Bindings)
+			BRICKENGINE_ASSERT(!binding.pImmutableSamplers);
+
+		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+		descriptorSetLayoutCreateInfo.flags = flags;
+		descriptorSetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(key.Bindings.size());
+		descriptorSetLayoutCreateInfo.pBindings = key.Bindings.data();
+
+		VkDescriptorSetLayout layout = nullptr;
+		VK_CHECK(vkCreateDescriptorSetLayout(m_Device, &descriptorSetLayoutCreateInfo, nullptr, &layout));
+		m_SetLayouts.emplace(std::move(key), layout);
+		return layout;
+	}
+
+	VkPipelineLayout VulkanLayoutCache::GetPipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges)
+	{
+		PipelineLayoutKey key;
+		key.SetLayouts = setLayouts;
+		key.PushConstantRanges = pushConstantRanges;
+		std::sort(key.PushConstantRanges.begin(), key.PushConstantRanges.end(), [](const VkPushConstantRange& a, const VkPushConstantRange& b) { return a.stageFlags < b.stageFlags; });
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto it = m_PipelineLayouts.find(key);
+		if (it != m_PipelineLayouts.end())
+		{
+			m_HitCount++;
+			return it->second;
+		}
+
+		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+		pipelineLayoutCreateInfo.setLayoutCount = static_cast<uint32_t>(key.SetLayouts.size());
+		pipelineLayoutCreateInfo.pSetLayouts = key.SetLayouts.data();
+		pipelineLayoutCreateInfo.pushConstantRangeCount = static_cast<uint32_t>(key.PushConstantRanges.size());
+		pipelineLayoutCreateInfo.pPushConstantRanges = key.PushConstantRanges.data();
+
+		VkPipelineLayout layout = nullptr;
+		VK_CHECK(vkCreatePipelineLayout(m_Device, &pipelineLayoutCreateInfo, nullptr, &layout));
+		m_PipelineLayouts.emplace(std::move(key), layout);
+		return layout;
+	}
+
+	VulkanLayoutCacheStats VulkanLayoutCache::GetStats()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		VulkanLayoutCacheStats stats;
+		stats.DescriptorSetLayoutCount = static_cast<uint32_t>(m_SetLayouts.size());
+		stats.PipelineLayoutCount = static_cast<uint32_t>(m_PipelineLayouts.size());
+		stats.HitCount = m_HitCount;
+		return stats;
+	}
+
+	bool VulkanLayoutCache::SetLayoutKey::operator==(const SetLayoutKey& other) const
+	{
+		return Flags == other.Flags && std::equal(Bindings.begin(), Bindings.end(), other.Bindings.begin(), other.Bindings.end(),
+			[](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b)
+			{
+				return a.binding == b.binding && a.descriptorType == b.descriptorType && a.descriptorCount == b.descriptorCount && a.stageFlags == b.stageFlags;
+			}
+		);
+	}
+
+	bool VulkanLayoutCache::PipelineLayoutKey::operator==(const PipelineLayoutKey& other) const
+	{
+		return SetLayouts == other.SetLayouts && std::equal(PushConstantRanges.begin(), PushConstantRanges.end(), other.PushConstantRanges.begin(), other.PushConstantRanges.end(),
+			[](const VkPushConstantRange& a, const VkPushConstantRange& b)
+			{
+				return a.stageFlags == b.stageFlags && a.offset == b.offset && a.size == b.size;
+			}
+		);
+	}
+
+	size_t VulkanLayoutCache::KeyHash::operator()(const SetLayoutKey& key) const
+	{
+		// Field by field, the structs have padding and pointers
+		uint64_t hash = HashValue(key.Flags, 0xcbf29ce484222325);
+		for (auto& binding : key.Bindings)
+		{
+			hash = HashValue(binding.binding, hash);
+			hash = HashValue(binding.descriptorType, hash);
+			hash = HashValue(binding.descriptorCount, hash);
+			hash = HashValue(binding.stageFlags, hash);
+		}
+		return static_cast<size_t>(hash);
+	}
+
+	size_t VulkanLayoutCache::KeyHash::operator()(const PipelineLayoutKey& key) const
+	{
+		uint64_t hash = HashData(key.SetLayouts.data(), key.SetLayouts.size() * sizeof(VkDescriptorSetLayout));
+		for (auto& range : key.PushConstantRanges)
+		{
+			hash = HashValue(range.stageFlags, hash);
+			hash = HashValue(range.offset, hash);
+			hash = HashValue(range.size, hash);
+		}
+		return static_cast<size_t>(hash);
+	}
+
+}
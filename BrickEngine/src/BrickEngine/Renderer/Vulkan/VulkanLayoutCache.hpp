@@ -0,0 +1,68 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanPlatform.hpp"
+
+namespace BrickEngine {
+
+	struct VulkanLayoutCacheStats
+	{
+		uint32_t DescriptorSetLayoutCount = 0;
+		uint32_t PipelineLayoutCount = 0;
+		// Requests answered with a layout created earlier
+		uint32_t HitCount = 0;
+	};
+
+	// Creates descriptor set and pipeline layouts once per distinct shape and hands out the same handle to everything
+	// asking for an equal one, so pipelines reflected from the same interface share their layouts and stay compatible
+	// for descriptor set binds. Owns the layouts until destroyed. Thread safe.
+	class VulkanLayoutCache
+	{
+	public:
+		VulkanLayoutCache(VkDevice device);
+		~VulkanLayoutCache();
+
+		VulkanLayoutCache(const VulkanLayoutCache&) = delete;
+		VulkanLayoutCache& operator=(const VulkanLayoutCache&) = delete;
+
+		// Binding order doesn't matter, immutable samplers aren't supported
+		VkDescriptorSetLayout GetDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings, VkDescriptorSetLayoutCreateFlags flags = 0);
+		// Push constant range order doesn't matter
+		VkPipelineLayout GetPipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges);
+
+		VulkanLayoutCacheStats GetStats();
+	private:
+		struct SetLayoutKey
+		{
+			VkDescriptorSetLayoutCreateFlags Flags = 0;
+			// Sorted by binding
+			std::vector<VkDescriptorSetLayoutBinding> Bindings = {};
+
+			bool operator==(const SetLayoutKey& other) const;
+		};
+
+		struct PipelineLayoutKey
+		{
+			std::vector<VkDescriptorSetLayout> SetLayouts = {};
+			// Sorted by stage
+			std::vector<VkPushConstantRange> PushConstantRanges = {};
+
+			bool operator==(const PipelineLayoutKey& other) const;
+		};
+
+		struct KeyHash
+		{
+			size_t operator()(const SetLayoutKey& key) const;
+			size_t operator()(const PipelineLayoutKey& key) const;
+		};
+	private:
+		VkDevice m_Device = nullptr;
+
+		std::mutex m_Mutex;
+		std::unordered_map<SetLayoutKey, VkDescriptorSetLayout, KeyHash> m_SetLayouts;
+		std::unordered_map<PipelineLayoutKey, VkPipelineLayout, KeyHash> m_PipelineLayouts;
+		uint32_t m_HitCount = 0;
+	};
+
+}
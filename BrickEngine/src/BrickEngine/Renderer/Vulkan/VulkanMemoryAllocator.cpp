@@ -0,0 +1,606 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanMemoryAllocator.hpp"
+
+namespace BrickEngine {
+
+	static uint32_t CountBits(uint32_t value)
+	{
+		uint32_t count = 0;
+		for (; value; value &= value - 1)
+			count++;
+		return count;
+	}
+
+	VulkanMemoryAllocator::VulkanMemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize)
+		: m_PhysicalDevice(physicalDevice), m_Device(device), m_BlockSize(blockSize)
+	{
+		vkGetPhysicalDeviceMemoryProperties(m_PhysicalDevice, &m_MemoryProperties);
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(m_PhysicalDevice, &properties);
+		m_NonCoherentAtomSize = std::max<VkDeviceSize>(properties.limits.nonCoherentAtomSize, 1);
+
+		m_Pools.resize(m_MemoryProperties.memoryTypeCount * 2);
+	}
+
+	VulkanMemoryAllocator::~VulkanMemoryAllocator()
+	{
+		BRICKENGINE_ASSERT(m_PendingMoves.empty());
+
+		for (auto& pool : m_Pools)
+		{
+			for (auto& block : pool)
+			{
+				if (!block->Allocator.IsEmpty())
+					Log::Warn(LogCategory::Renderer, "{} allocation(s) leaked in memory type {}", block->Allocator.GetAllocationCount(), block->MemoryType);
+				vkFreeMemory(m_Device, block->Memory, nullptr);
+			}
+		}
+
+		for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+		{
+			if (m_Dedicated[i].Count > 0)
+				Log::Warn(LogCategory::Renderer, "{} dedicated allocation(s) leaked in memory type {}", m_Dedicated[i].Count, i);
+		}
+	}
+
+	VulkanAllocation* VulkanMemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VulkanMemoryUsage usage, bool linear, uint32_t flags)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return AllocateInternal(requirements, usage, linear, flags, nullptr, nullptr);
+	}
+
+	VulkanAllocation* VulkanMemoryAllocator::AllocateForBuffer(VkBuffer buffer, VulkanMemoryUsage usage, uint32_t flags)
+	{
+		VkMemoryDedicatedRequirements dedicatedRequirements = { VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS };
+		VkMemoryRequirements2 memoryRequirements = { VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2 };
+		memoryRequirements.pNext = &dedicatedRequirements;
+
+		VkBufferMemoryRequirementsInfo2 requirementsInfo = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2 };
+		requirementsInfo.buffer = buffer;
+		vkGetBufferMemoryRequirements2(m_Device, &requirementsInfo, &memoryRequirements);
+
+		if (dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation)
+			flags |= VulkanAllocationFlagsDedicated;
+
+		VulkanAllocation* allocation;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			allocation = AllocateInternal(memoryRequirements.memoryRequirements, usage, true, flags, buffer, nullptr);
+		}
+		if (allocation)
+			VK_CHECK(vkBindBufferMemory(m_Device, buffer, allocation->Memory, allocation->Offset));
+		return allocation;
+	}
+
+	VulkanAllocation* VulkanMemoryAllocator::AllocateForImage(VkImage image, VulkanMemoryUsage usage, bool linearTiling, uint32_t flags)
+	{
+		VkMemoryDedicatedRequirements dedicatedRequirements = { VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS };
+		VkMemoryRequirements2 memoryRequirements = { VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2 };
+		memoryRequirements.pNext = &dedicatedRequirements;
+
+		VkImageMemoryRequirementsInfo2 requirementsInfo = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2 };
+		requirementsInfo.image = image;
+		vkGetImageMemoryRequirements2(m_Device, &requirementsInfo, &memoryRequirements);
+
+		if (dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation)
+			flags |= VulkanAllocationFlagsDedicated;
+
+		VulkanAllocation* allocation;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			allocation = AllocateInternal(memoryRequirements.memoryRequirements, usage, linearTiling, flags, nullptr, image);
+		}
+		if (allocation)
+			VK_CHECK(vkBindImageMemory(m_Device, image, allocation->Memory, allocation->Offset));
+		return allocation;
+	}
+
+	void VulkanMemoryAllocator::Free(VulkanAllocation* allocation)
+	{
+		if (!allocation)
+			return;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		VulkanMemoryBlock* block = allocation->Block;
+		if (!block)
+		{
+			vkFreeMemory(m_Device, allocation->Memory, nullptr);
+			m_Dedicated[allocation->MemoryType].Count--;
+			m_Dedicated[allocation->MemoryType].Bytes -= allocation->Size;
+			ReleaseAllocation(allocation);
+			return;
+		}
+
+		block->Allocations.erase(allocation->Range.Node);
+		block->Allocator.Free(allocation->Range);
+		ReleaseAllocation(allocation);
+
+		// Keep one empty block around per pool so allocating and freeing in a loop doesn't hit the driver every time
+		auto& pool = m_Pools[GetPoolIndex(block->MemoryType, block->Linear)];
+		if (block->Allocator.IsEmpty() && pool.size() > 1)
+		{
+			DestroyBlock(block);
+			pool.erase(std::find_if(pool.begin(), pool.end(), [&](const std::unique_ptr<VulkanMemoryBlock>& other) { return other.get() == block; }));
+		}
+	}
+
+	void VulkanMemoryAllocator::Flush(const VulkanAllocation* allocation, VkDeviceSize offset, VkDeviceSize size)
+	{
+		if (m_MemoryProperties.memoryTypes[allocation->MemoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+			return;
+
+		VkMappedMemoryRange range = GetMappedRange(allocation, offset, size);
+		VK_CHECK(vkFlushMappedMemoryRanges(m_Device, 1, &range));
+	}
+
+	void VulkanMemoryAllocator::Invalidate(const VulkanAllocation* allocation, VkDeviceSize offset, VkDeviceSize size)
+	{
+		if (m_MemoryProperties.memoryTypes[allocation->MemoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+			return;
+
+		VkMappedMemoryRange range = GetMappedRange(allocation, offset, size);
+		VK_CHECK(vkInvalidateMappedMemoryRanges(m_Device, 1, &range));
+	}
+
+	VkMappedMemoryRange VulkanMemoryAllocator::GetMappedRange(const VulkanAllocation* allocation, VkDeviceSize offset, VkDeviceSize size) const
+	{
+		if (size == VK_WHOLE_SIZE)
+			size = allocation->Size - offset;
+
+		// Flushed and invalidated ranges have to be aligned to nonCoherentAtomSize
+		VkDeviceSize begin = (allocation->Offset + offset) / m_NonCoherentAtomSize * m_NonCoherentAtomSize;
+		VkDeviceSize end = (allocation->Offset + offset + size + m_NonCoherentAtomSize - 1) / m_NonCoherentAtomSize * m_NonCoherentAtomSize;
+
+		VkMappedMemoryRange range = { VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE };
+		range.memory = allocation->Memory;
+		range.offset = begin;
+		range.size = end - begin;
+		return range;
+	}
+
+	std::vector<VulkanDefragmentationMove> VulkanMemoryAllocator::BeginDefragmentation(VkDeviceSize maxBytes)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		BRICKENGINE_ASSERT(m_PendingMoves.empty() && "EndDefragmentation has to be called before defragmenting again!");
+
+		std::vector<VulkanDefragmentationMove> moves;
+		VkDeviceSize movedBytes = 0;
+		for (auto& pool : m_Pools)
+		{
+			if (pool.size() < 2 || movedBytes >= maxBytes)
+				continue;
+
+			// Emptying the least used block is the cheapest way to give memory back
+			VulkanMemoryBlock* source = std::min_element(pool.begin(), pool.end(), [](const std::unique_ptr<VulkanMemoryBlock>& a, const std::unique_ptr<VulkanMemoryBlock>& b)
+				{
+					return a->Allocator.GetUsedBytes() < b->Allocator.GetUsedBytes();
+				}
+			)->get();
+
+			std::vector<VulkanAllocation*> candidates;
+			source->Allocator.ForEachAllocation([&](uint64_t offset, uint64_t size, uint32_t node)
+				{
+					auto it = source->Allocations.find(node);
+					if (it != source->Allocations.end() && (it->second->Flags & VulkanAllocationFlagsMovable))
+						candidates.push_back(it->second);
+				}
+			);
+
+			for (VulkanAllocation* allocation : candidates)
+			{
+				if (movedBytes + allocation->Size > maxBytes)
+					break;
+
+				for (auto& destination : pool)
+				{
+					if (destination.get() == source)
+						continue;
+
+					TLSFAllocation range = destination->Allocator.Allocate(allocation->Size, allocation->Alignment);
+					if (!range.IsValid())
+						continue;
+
+					VulkanDefragmentationMove& move = moves.emplace_back();
+					move.Allocation = allocation;
+					move.SourceMemory = allocation->Memory;
+					move.SourceOffset = allocation->Offset;
+					move.Size = allocation->Size;
+
+					m_PendingMoves.emplace_back(source, allocation->Range);
+					source->Allocations.erase(allocation->Range.Node);
+
+					allocation->Memory = destination->Memory;
+					allocation->Offset = range.Offset;
+					allocation->MappedData = destination->MappedData ? static_cast<uint8_t*>(destination->MappedData) + range.Offset : nullptr;
+					allocation->Block = destination.get();
+					allocation->Range = range;
+					destination->Allocations[range.Node] = allocation;
+
+					movedBytes += allocation->Size;
+					break;
+				}
+			}
+		}
+
+		if (!moves.empty())
+			Log::Trace(LogCategory::Renderer, "Defragmentation moving {} allocation(s), {} bytes", moves.size(), movedBytes);
+		return moves;
+	}
+
+	void VulkanMemoryAllocator::EndDefragmentation()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		for (auto& [block, range] : m_PendingMoves)
+			block->Allocator.Free(range);
+		m_PendingMoves.clear();
+
+		for (auto& pool : m_Pools)
+		{
+			for (size_t i = 0; i < pool.size() && pool.size() > 1;)
+			{
+				if (pool[i]->Allocator.IsEmpty())
+				{
+					DestroyBlock(pool[i].get());
+					pool.erase(pool.begin() + i);
+				}
+				else
+					i++;
+			}
+		}
+	}
+
+	VulkanMemoryTypeStats VulkanMemoryAllocator::GetStats(uint32_t memoryType) const
+	{
+		BRICKENGINE_ASSERT(memoryType < m_MemoryProperties.memoryTypeCount);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		VulkanMemoryTypeStats stats;
+		stats.PropertyFlags = m_MemoryProperties.memoryTypes[memoryType].propertyFlags;
+		for (bool linear : { false, true })
+		{
+			for (auto& block : m_Pools[GetPoolIndex(memoryType, linear)])
+			{
+				TLSFStats blockStats = block->Allocator.GetStats();
+				stats.BlockCount++;
+				stats.AllocationCount += blockStats.AllocationCount;
+				stats.ReservedBytes += blockStats.Capacity;
+				stats.UsedBytes += blockStats.UsedBytes;
+				stats.FreeBytes += blockStats.FreeBytes;
+				stats.LargestFreeRegion = std::max(stats.LargestFreeRegion, blockStats.LargestFreeRegion);
+				stats.FreeRegionCount += blockStats.FreeRegionCount;
+			}
+		}
+
+		stats.DedicatedCount = m_Dedicated[memoryType].Count;
+		stats.AllocationCount += m_Dedicated[memoryType].Count;
+		stats.ReservedBytes += m_Dedicated[memoryType].Bytes;
+		stats.UsedBytes += m_Dedicated[memoryType].Bytes;
+		return stats;
+	}
+
+	void VulkanMemoryAllocator::LogStats() const
+	{
+		for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+		{
+			VulkanMemoryTypeStats stats = GetStats(i);
+			if (stats.ReservedBytes == 0)
+				continue;
+
+			Log::Info(LogCategory::Renderer, "Memory type {}: {} allocation(s) using {} of {} KiB in {} block(s) and {} dedicated, {} free region(s), fragmentation {}",
+				i, stats.AllocationCount, stats.UsedBytes / 1024, stats.ReservedBytes / 1024, stats.BlockCount, stats.DedicatedCount, stats.FreeRegionCount, stats.GetFragmentation());
+		}
+	}
+
+	uint32_t VulkanMemoryAllocator::FindMemoryType(uint32_t typeBits, VulkanMemoryUsage usage, uint32_t skipTypeBits) const
+	{
+		VkMemoryPropertyFlags required = 0;
+		VkMemoryPropertyFlags preferred = 0;
+		VkMemoryPropertyFlags avoided = 0;
+		switch (usage)
+		{
+		case VulkanMemoryUsage::GPUOnly:
+			required = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			avoided = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+			break;
+		case VulkanMemoryUsage::Upload:
+			required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			avoided = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+			break;
+		case VulkanMemoryUsage::Readback:
+			required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+			preferred = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+			break;
+		}
+
+		// Lowest cost wins, types earlier in the list are faster according to the spec so ties keep the first one
+		uint32_t bestType = std::numeric_limits<uint32_t>::max();
+		uint32_t bestCost = std::numeric_limits<uint32_t>::max();
+		for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+		{
+			VkMemoryPropertyFlags flags = m_MemoryProperties.memoryTypes[i].propertyFlags;
+			if (!(typeBits & (1u << i)) || (skipTypeBits & (1u << i)) || (flags & required) != required)
+				continue;
+
+			uint32_t cost = CountBits(preferred & ~flags) + CountBits(avoided & flags);
+			if (cost < bestCost)
+			{
+				bestType = i;
+				bestCost = cost;
+			}
+		}
+		return bestType;
+	}
+
+	VulkanAllocation* VulkanMemoryAllocator::AllocateInternal(const VkMemoryRequirements& requirements, VulkanMemoryUsage usage, bool linear, uint32_t flags, VkBuffer buffer, VkImage image)
+	{
+		// Fall back to the next best memory type when one runs out
+		uint32_t skipTypeBits = 0;
+		while (true)
+		{
+			uint32_t memoryType = FindMemoryType(requirements.memoryTypeBits, usage, skipTypeBits);
+			if (memoryType == std::numeric_limits<uint32_t>::max())
+			{
+				Log::Error(LogCategory::Renderer, "Out of device memory allocating {} bytes", requirements.size);
+				return nullptr;
+			}
+
+			VulkanAllocation* allocation = nullptr;
+			if ((flags & VulkanAllocationFlagsDedicated) || requirements.size > m_BlockSize / 2)
+				allocation = AllocateDedicated(memoryType, requirements, flags, buffer, image);
+			else
+				allocation = AllocateFromPool(memoryType, linear, requirements, flags);
+
+			if (allocation)
+				return allocation;
+			skipTypeBits |= 1u << memoryType;
+		}
+	}
+
+	VulkanAllocation* VulkanMemoryAllocator::AllocateFromPool(uint32_t memoryType, bool linear, const VkMemoryRequirements& requirements, uint32_t flags)
+	{
+		auto& pool = m_Pools[GetPoolIndex(memoryType, linear)];
+
+		VulkanMemoryBlock* block = nullptr;
+		TLSFAllocation range;
+		for (auto& candidate : pool)
+		{
+			range = candidate->Allocator.Allocate(requirements.size, requirements.alignment);
+			if (range.IsValid())
+			{
+				block = candidate.get();
+				break;
+			}
+		}
+
+		if (!block)
+		{
+			block = CreateBlock(memoryType, linear, requirements.size + requirements.alignment);
+			if (!block)
+				return nullptr;
+			pool.emplace_back(block);
+
+			range = block->Allocator.Allocate(requirements.size, requirements.alignment);
+			BRICKENGINE_ASSERT(range.IsValid());
+		}
+
+		VulkanAllocation* allocation = CreateAllocation();
+		allocation->Memory = block->Memory;
+		allocation->Offset = range.Offset;
+		allocation->Size = range.Size;
+		allocation->MappedData = block->MappedData ? static_cast<uint8_t*>(block->MappedData) + range.Offset : nullptr;
+		allocation->MemoryType = memoryType;
+		allocation->Flags = flags;
+		allocation->Block = block;
+		allocation->Range = range;
+		allocation->Alignment = requirements.alignment;
+		block->Allocations[range.Node] = allocation;
+		return allocation;
+	}
+
+	VulkanAllocation* VulkanMemoryAllocator::AllocateDedicated(uint32_t memoryType, const VkMemoryRequirements& requirements, uint32_t flags, VkBuffer buffer, VkImage image)
+	{
+		VkMemoryDedicatedAllocateInfo dedicatedAllocateInfo = { VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO };
+		dedicatedAllocateInfo.buffer = buffer;
+		dedicatedAllocateInfo.image = image;
+
+		VkMemoryAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+		allocateInfo.pNext = (buffer || image) ? &dedicatedAllocateInfo : nullptr;
+		// Rounded up so flushing whole atoms never reaches past the end of the memory
+		allocateInfo.allocationSize = (requirements.size + m_NonCoherentAtomSize - 1) / m_NonCoherentAtomSize * m_NonCoherentAtomSize;
+		allocateInfo.memoryTypeIndex = memoryType;
+
+		VkDeviceMemory memory = nullptr;
+		if (vkAllocateMemory(m_Device, &allocateInfo, nullptr, &memory) != VK_SUCCESS)
+			return nullptr;
+
+		VulkanAllocation* allocation = CreateAllocation();
+		allocation->Memory = memory;
+		allocation->Offset = 0;
+		allocation->Size = allocateInfo.allocationSize;
+		allocation->MappedData = MapMemory(memory, memoryType);
+		allocation->MemoryType = memoryType;
+		// Dedicated memory is never moved, there is nothing to compact
+		allocation->Flags = flags & ~VulkanAllocationFlagsMovable;
+
+		m_Dedicated[memoryType].Count++;
+		m_Dedicated[memoryType].Bytes += allocateInfo.allocationSize;
+		return allocation;
+	}
+
+	VulkanMemoryBlock* VulkanMemoryAllocator::CreateBlock(uint32_t memoryType, bool linear, VkDeviceSize minimumSize)
+	{
+		// Small heaps like the host visible part of VRAM would run out after a couple of full size blocks
+		VkDeviceSize heapSize = m_MemoryProperties.memoryHeaps[m_MemoryProperties.memoryTypes[memoryType].heapIndex].size;
+		VkDeviceSize blockSize = std::max(std::min(m_BlockSize, heapSize / 8), minimumSize);
+		blockSize = (blockSize + m_NonCoherentAtomSize - 1) / m_NonCoherentAtomSize * m_NonCoherentAtomSize;
+
+		VkMemoryAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+		allocateInfo.memoryTypeIndex = memoryType;
+
+		// Retry with smaller blocks before giving up on the memory type
+		VkDeviceMemory memory = nullptr;
+		while (true)
+		{
+			allocateInfo.allocationSize = blockSize;
+			if (vkAllocateMemory(m_Device, &allocateInfo, nullptr, &memory) == VK_SUCCESS)
+				break;
+			if (blockSize / 2 < minimumSize)
+				return nullptr;
+			blockSize /= 2;
+		}
+
+		VulkanMemoryBlock* block = new VulkanMemoryBlock();
+		block->Memory = memory;
+		block->MappedData = MapMemory(memory, memoryType);
+		block->MemoryType = memoryType;
+		block->Linear = linear;
+		block->Allocator.Reset(blockSize);
+
+		Log::Trace(LogCategory::Renderer, "Allocated {} KiB block in memory type {}", blockSize / 1024, memoryType);
+		return block;
+	}
+
+	void VulkanMemoryAllocator::DestroyBlock(VulkanMemoryBlock* block)
+	{
+		Log::Trace(LogCategory::Renderer, "Released {} KiB block in memory type {}", block->Allocator.GetCapacity() / 1024, block->MemoryType);
+		vkFreeMemory(m_Device, block->Memory, nullptr);
+		block->Memory = nullptr;
+	}
+
+	void* VulkanMemoryAllocator::MapMemory(VkDeviceMemory memory, uint32_t memoryType)
+	{
+		if (!(m_MemoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+			return nullptr;
+
+		void* data = nullptr;
+		VK_CHECK(vkMapMemory(m_Device, memory, 0, VK_WHOLE_SIZE, 0, &data));
+		return data;
+	}
+
+	VulkanAllocation* VulkanMemoryAllocator::CreateAllocation()
+	{
+		if (!m_UnusedAllocations.empty())
+		{
+			VulkanAllocation* allocation = m_UnusedAllocations.back();
+			m_UnusedAllocations.pop_back();
+			return allocation;
+		}
+		return &m_AllocationStorage.emplace_back();
+	}
+
+	void VulkanMemoryAllocator::ReleaseAllocation(VulkanAllocation* allocation)
+	{
+		*allocation = {};
+		m_UnusedAllocations.push_back(allocation);
+	}
+
+	VulkanLinearPool::VulkanLinearPool(VulkanMemoryAllocator* allocator, VkDevice device, VkDeviceSize capacity, VkBufferUsageFlags usage)
+		: m_Allocator(allocator), m_Device(device), m_Usage(usage)
+	{
+		m_Page = CreatePage(capacity);
+		m_Capacity = capacity;
+	}
+
+	VulkanLinearPool::~VulkanLinearPool()
+	{
+		for (auto& page : m_OverflowPages)
+			DestroyPage(page);
+		DestroyPage(m_Page);
+	}
+
+	VulkanLinearAllocation VulkanLinearPool::Allocate(VkDeviceSize size, VkDeviceSize alignment)
+	{
+		BRICKENGINE_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+		VkDeviceSize offset = m_Offset.load(std::memory_order_relaxed);
+		VkDeviceSize alignedOffset;
+		do
+		{
+			alignedOffset = (offset + alignment - 1) & ~(alignment - 1);
+			if (alignedOffset + size > m_Capacity)
+				return AllocateOverflow(size, alignment);
+		} while (!m_Offset.compare_exchange_weak(offset, alignedOffset + size, std::memory_order_relaxed));
+
+		VulkanLinearAllocation allocation;
+		allocation.Buffer = m_Page.Buffer;
+		allocation.Offset = alignedOffset;
+		allocation.MappedData = static_cast<uint8_t*>(m_Page.Allocation->MappedData) + alignedOffset;
+		return allocation;
+	}
+
+	void VulkanLinearPool::Reset()
+	{
+		if (!m_OverflowPages.empty())
+		{
+			// Grow to what this frame needed so the next one stays on the lock free path
+			VkDeviceSize peak = m_Capacity + m_OverflowBytes;
+			VkDeviceSize capacity = m_Capacity;
+			while (capacity < peak)
+				capacity *= 2;
+
+			for (auto& page : m_OverflowPages)
+				DestroyPage(page);
+			m_OverflowPages.clear();
+			DestroyPage(m_Page);
+
+			Log::Trace(LogCategory::Renderer, "Linear pool grew from {} to {} KiB", m_Capacity / 1024, capacity / 1024);
+			m_Page = CreatePage(capacity);
+			m_Capacity = capacity;
+		}
+
+		m_Offset.store(0, std::memory_order_relaxed);
+		m_OverflowOffset = 0;
+		m_OverflowBytes = 0;
+	}
+
+	VulkanLinearPool::Page VulkanLinearPool::CreatePage(VkDeviceSize capacity)
+	{
+		Page page;
+		page.Capacity = capacity;
+
+		VkBufferCreateInfo bufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		bufferCreateInfo.size = capacity;
+		bufferCreateInfo.usage = m_Usage;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		VK_CHECK(vkCreateBuffer(m_Device, &bufferCreateInfo, nullptr, &page.Buffer));
+
+		page.Allocation = m_Allocator->AllocateForBuffer(page.Buffer, VulkanMemoryUsage::Upload);
+		BRICKENGINE_ASSERT(page.Allocation && page.Allocation->MappedData);
+		return page;
+	}
+
+	void VulkanLinearPool::DestroyPage(Page& page)
+	{
+		vkDestroyBuffer(m_Device, page.Buffer, nullptr);
+		m_Allocator->Free(page.Allocation);
+		page = {};
+	}
+
+	VulkanLinearAllocation VulkanLinearPool::AllocateOverflow(VkDeviceSize size, VkDeviceSize alignment)
+	{
+		std::lock_guard<std::mutex> lock(m_OverflowMutex);
+
+		VkDeviceSize alignedOffset = (m_OverflowOffset + alignment - 1) & ~(alignment - 1);
+		if (m_OverflowPages.empty() || alignedOffset + size > m_OverflowPages.back().Capacity)
+		{
+			m_OverflowPages.push_back(CreatePage(std::max(m_Capacity, size)));
+			alignedOffset = 0;
+		}
+
+		m_OverflowBytes += alignedOffset - m_OverflowOffset + size;
+		m_OverflowOffset = alignedOffset + size;
+
+		Page& page = m_OverflowPages.back();
+		VulkanLinearAllocation allocation;
+		allocation.Buffer = page.Buffer;
+		allocation.Offset = alignedOffset;
+		allocation.MappedData = static_cast<uint8_t*>(page.Allocation->MappedData) + alignedOffset;
+		return allocation;
+	}
+
+}
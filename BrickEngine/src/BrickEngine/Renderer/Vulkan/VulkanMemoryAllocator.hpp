@@ -0,0 +1,214 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+#include "BrickEngine/Core/TLSFAllocator.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanPlatform.hpp"
+
+namespace BrickEngine {
+
+	enum class VulkanMemoryUsage : uint8_t
+	{
+		// Device local, never mapped
+		GPUOnly,
+		// Host visible and coherent, written by the CPU and read by the GPU, preferably device local as well
+		Upload,
+		// Host visible, written by the GPU and read back by the CPU, preferably cached
+		Readback
+	};
+
+	enum VulkanAllocationFlags : uint32_t
+	{
+		VulkanAllocationFlagsNone = 0,
+		// Always gets its own VkDeviceMemory
+		VulkanAllocationFlagsDedicated = 1 << 0,
+		// May be handed out by BeginDefragmentation, the owner has to be able to recreate and rebind its resource
+		VulkanAllocationFlagsMovable = 1 << 1
+	};
+
+	struct VulkanMemoryBlock;
+
+	struct VulkanAllocation
+	{
+		VkDeviceMemory Memory = nullptr;
+		VkDeviceSize Offset = 0;
+		VkDeviceSize Size = 0;
+		// Points at Offset inside the memory, nullptr unless the memory is host visible
+		void* MappedData = nullptr;
+		uint32_t MemoryType = 0;
+		uint32_t Flags = VulkanAllocationFlagsNone;
+
+		// nullptr for dedicated allocations
+		VulkanMemoryBlock* Block = nullptr;
+		TLSFAllocation Range = {};
+		VkDeviceSize Alignment = 1;
+	};
+
+	struct VulkanMemoryBlock
+	{
+		VkDeviceMemory Memory = nullptr;
+		void* MappedData = nullptr;
+		uint32_t MemoryType = 0;
+		// Buffers and linear images, see VulkanMemoryAllocator::Allocate
+		bool Linear = false;
+		TLSFAllocator Allocator = {};
+		// Allocations living in this block indexed by their TLSF node, needed to find what to move when defragmenting
+		std::unordered_map<uint32_t, VulkanAllocation*> Allocations = {};
+	};
+
+	struct VulkanMemoryTypeStats
+	{
+		VkMemoryPropertyFlags PropertyFlags = 0;
+		uint32_t BlockCount = 0;
+		uint32_t DedicatedCount = 0;
+		uint32_t AllocationCount = 0;
+		// Bytes of VkDeviceMemory allocated from the driver, blocks and dedicated allocations
+		VkDeviceSize ReservedBytes = 0;
+		VkDeviceSize UsedBytes = 0;
+		VkDeviceSize FreeBytes = 0;
+		VkDeviceSize LargestFreeRegion = 0;
+		uint32_t FreeRegionCount = 0;
+
+		float GetFragmentation() const { return FreeBytes > 0 ? 1.0f - static_cast<float>(LargestFreeRegion) / static_cast<float>(FreeBytes) : 0.0f; }
+	};
+
+	// The allocation has already been given its new place when this is returned, the caller has to create a new resource
+	// bound to Memory/Offset, copy the contents over from SourceMemory/SourceOffset and call EndDefragmentation once the copies completed on the GPU.
+	struct VulkanDefragmentationMove
+	{
+		VulkanAllocation* Allocation = nullptr;
+		VkDeviceMemory SourceMemory = nullptr;
+		VkDeviceSize SourceOffset = 0;
+		VkDeviceSize Size = 0;
+	};
+
+	// Sub-allocates large VkDeviceMemory blocks per memory type with a TLSF allocator, allocations bigger than
+	// half a block or that the driver wants dedicated get their own memory. Host visible blocks stay mapped. Thread safe.
+	class VulkanMemoryAllocator
+	{
+	public:
+		static constexpr VkDeviceSize DefaultBlockSize = 64ull * 1024 * 1024;
+
+		VulkanMemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize = DefaultBlockSize);
+		~VulkanMemoryAllocator();
+
+		VulkanMemoryAllocator(const VulkanMemoryAllocator&) = delete;
+		VulkanMemoryAllocator& operator=(const VulkanMemoryAllocator&) = delete;
+
+		// linear is true for buffers and linear images, they are kept in different blocks than optimal images so
+		// bufferImageGranularity never has to be considered. Returns nullptr when out of memory.
+		VulkanAllocation* Allocate(const VkMemoryRequirements& requirements, VulkanMemoryUsage usage, bool linear, uint32_t flags = VulkanAllocationFlagsNone);
+		// Allocate and bind memory for the resource
+		VulkanAllocation* AllocateForBuffer(VkBuffer buffer, VulkanMemoryUsage usage, uint32_t flags = VulkanAllocationFlagsNone);
+		VulkanAllocation* AllocateForImage(VkImage image, VulkanMemoryUsage usage, bool linearTiling = false, uint32_t flags = VulkanAllocationFlagsNone);
+		void Free(VulkanAllocation* allocation);
+
+		// Flush CPU writes for memory that isn't host coherent, does nothing otherwise
+		void Flush(const VulkanAllocation* allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+		// Make GPU writes visible to the CPU for memory that isn't host coherent, does nothing otherwise
+		void Invalidate(const VulkanAllocation* allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+		// Moves up to maxBytes of movable allocations out of the emptiest block of each memory type into the others so
+		// it can be released. Call once every few frames with a small budget to defragment incrementally.
+		std::vector<VulkanDefragmentationMove> BeginDefragmentation(VkDeviceSize maxBytes);
+		// Releases the source ranges of the moves returned by the last BeginDefragmentation and any block left empty
+		void EndDefragmentation();
+
+		uint32_t GetMemoryTypeCount() const { return m_MemoryProperties.memoryTypeCount; }
+		VulkanMemoryTypeStats GetStats(uint32_t memoryType) const;
+		void LogStats() const;
+	private:
+		// Index into m_Pools, one pool per memory type and linear/optimal
+		static uint32_t GetPoolIndex(uint32_t memoryType, bool linear) { return memoryType * 2 + (linear ? 1 : 0); }
+
+		uint32_t FindMemoryType(uint32_t typeBits, VulkanMemoryUsage usage, uint32_t skipTypeBits) const;
+		VulkanAllocation* AllocateFromPool(uint32_t memoryType, bool linear, const VkMemoryRequirements& requirements, uint32_t flags);
+		VulkanAllocation* AllocateDedicated(uint32_t memoryType, const VkMemoryRequirements& requirements, uint32_t flags, VkBuffer buffer, VkImage image);
+		// Rounded out to nonCoherentAtomSize, all memory is allocated in multiples of it so the range stays inside
+		VkMappedMemoryRange GetMappedRange(const VulkanAllocation* allocation, VkDeviceSize offset, VkDeviceSize size) const;
+		VulkanAllocation* AllocateInternal(const VkMemoryRequirements& requirements, VulkanMemoryUsage usage, bool linear, uint32_t flags, VkBuffer buffer, VkImage image);
+		VulkanMemoryBlock* CreateBlock(uint32_t memoryType, bool linear, VkDeviceSize minimumSize);
+		void DestroyBlock(VulkanMemoryBlock* block);
+		void* MapMemory(VkDeviceMemory memory, uint32_t memoryType);
+
+		VulkanAllocation* CreateAllocation();
+		void ReleaseAllocation(VulkanAllocation* allocation);
+	private:
+		VkPhysicalDevice m_PhysicalDevice = nullptr;
+		VkDevice m_Device = nullptr;
+		VkPhysicalDeviceMemoryProperties m_MemoryProperties = {};
+		VkDeviceSize m_NonCoherentAtomSize = 1;
+		VkDeviceSize m_BlockSize = DefaultBlockSize;
+
+		mutable std::mutex m_Mutex;
+		std::vector<std::vector<std::unique_ptr<VulkanMemoryBlock>>> m_Pools = {};
+
+		struct DedicatedStats
+		{
+			uint32_t Count = 0;
+			VkDeviceSize Bytes = 0;
+		};
+		DedicatedStats m_Dedicated[VK_MAX_MEMORY_TYPES] = {};
+
+		// Allocation objects are recycled so the pointers handed out stay cheap to create
+		std::deque<VulkanAllocation> m_AllocationStorage = {};
+		std::vector<VulkanAllocation*> m_UnusedAllocations = {};
+
+		// Source ranges of moves waiting for EndDefragmentation
+		std::vector<std::pair<VulkanMemoryBlock*, TLSFAllocation>> m_PendingMoves = {};
+	};
+
+	struct VulkanLinearAllocation
+	{
+		VkBuffer Buffer = nullptr;
+		VkDeviceSize Offset = 0;
+		void* MappedData = nullptr;
+
+		bool IsValid() const { return Buffer != nullptr; }
+	};
+
+	// Persistently mapped buffer handed out with a bump pointer, for data that only lives for one frame. Allocate is lock free
+	// as long as the pool has room, overflow goes into extra buffers and the next Reset grows the pool to the peak usage.
+	class VulkanLinearPool
+	{
+	public:
+		VulkanLinearPool(VulkanMemoryAllocator* allocator, VkDevice device, VkDeviceSize capacity, VkBufferUsageFlags usage);
+		~VulkanLinearPool();
+
+		VulkanLinearPool(const VulkanLinearPool&) = delete;
+		VulkanLinearPool& operator=(const VulkanLinearPool&) = delete;
+
+		// alignment must be a power of two
+		VulkanLinearAllocation Allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+		// Only call once the GPU is done with everything allocated since the last Reset
+		void Reset();
+
+		VkDeviceSize GetCapacity() const { return m_Capacity; }
+		VkDeviceSize GetUsedBytes() const { return std::min(m_Offset.load(std::memory_order_relaxed), m_Capacity) + m_OverflowBytes; }
+	private:
+		struct Page
+		{
+			VkBuffer Buffer = nullptr;
+			VulkanAllocation* Allocation = nullptr;
+			VkDeviceSize Capacity = 0;
+		};
+
+		Page CreatePage(VkDeviceSize capacity);
+		void DestroyPage(Page& page);
+		VulkanLinearAllocation AllocateOverflow(VkDeviceSize size, VkDeviceSize alignment);
+	private:
+		VulkanMemoryAllocator* m_Allocator = nullptr;
+		VkDevice m_Device = nullptr;
+		VkBufferUsageFlags m_Usage = 0;
+
+		Page m_Page = {};
+		VkDeviceSize m_Capacity = 0;
+		std::atomic<VkDeviceSize> m_Offset = 0;
+
+		std::mutex m_OverflowMutex;
+		std::vector<Page> m_OverflowPages = {};
+		VkDeviceSize m_OverflowOffset = 0;
+		VkDeviceSize m_OverflowBytes = 0;
+	};
+
+}
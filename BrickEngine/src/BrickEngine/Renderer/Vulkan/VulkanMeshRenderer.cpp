@@ -0,0 +1,413 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanMeshRenderer.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanRenderer.hpp"
+
+namespace BrickEngine {
+
+	VulkanMeshRenderer::VulkanMeshRenderer(VulkanRenderer* renderer, VkDevice device, VulkanPipelineLibrary* pipelineLibrary, VkRenderPass renderPass,
+		uint32_t maxObjects, VkDeviceSize vertexCapacity, VkDeviceSize indexCapacity)
+		: m_Renderer(renderer), m_Device(device), m_PipelineLibrary(pipelineLibrary), m_MaxObjects(maxObjects), m_VertexCapacity(vertexCapacity), m_IndexCapacity(indexCapacity)
+	{
+		const VulkanDeviceFeatures& features = m_Renderer->GetFeatures();
+		// The culling pass passes the object index to the vertex shader as the first instance
+		BRICKENGINE_ASSERT(features.DrawIndirectFirstInstance);
+		m_DrawIndirectCount = features.DrawIndirectCount;
+		m_MultiDrawIndirect = features.MultiDrawIndirect && features.MaxDrawIndirectCount >= m_MaxObjects;
+		Log::Info(LogCategory::Renderer, "GPU driven meshes drawn with {}", m_DrawIndirectCount ? "vkCmdDrawIndexedIndirectCount" : m_MultiDrawIndirect ? "multi draw indirect" : "one indirect draw per object");
+
+		// Objects, meshes, draw commands and draw count
+		VkDescriptorSetLayoutBinding bindings[4] = {};
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			bindings[i].binding = i;
+			bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			bindings[i].descriptorCount = 1;
+			bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+		bindings[0].stageFlags |= VK_SHADER_STAGE_VERTEX_BIT;
+		// Shared by both pipelines, the vertex shader alone would reflect to a set with just the objects
+		m_DescriptorSetLayout = m_Renderer->GetLayoutCache()->GetDescriptorSetLayout({ std::begin(bindings), std::end(bindings) });
+
+		VkDescriptorPoolSize poolSize = {};
+		poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSize.descriptorCount = 4;
+
+		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+		descriptorPoolCreateInfo.maxSets = 1;
+		descriptorPoolCreateInfo.poolSizeCount = 1;
+		descriptorPoolCreateInfo.pPoolSizes = &poolSize;
+		VK_CHECK(vkCreateDescriptorPool(m_Device, &descriptorPoolCreateInfo, nullptr, &m_DescriptorPool));
+
+		VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+		descriptorSetAllocateInfo.descriptorPool = m_DescriptorPool;
+		descriptorSetAllocateInfo.descriptorSetCount = 1;
+		descriptorSetAllocateInfo.pSetLayouts = &m_DescriptorSetLayout;
+		VK_CHECK(vkAllocateDescriptorSets(m_Device, &descriptorSetAllocateInfo, &m_DescriptorSet));
+
+		m_VertexBuffer = CreateBuffer(m_VertexCapacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+		m_IndexBuffer = CreateBuffer(m_IndexCapacity, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+		m_MeshBuffer = CreateBuffer(MaxMeshes * sizeof(GPUMesh), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+		m_ObjectBuffer = CreateBuffer(m_MaxObjects * sizeof(GPUObject), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+		m_DrawBuffer = CreateBuffer(m_MaxObjects * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+		m_CountBuffer = CreateBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+
+		VkDescriptorBufferInfo bufferInfos[4] = {};
+		bufferInfos[0] = { m_ObjectBuffer.Handle, 0, VK_WHOLE_SIZE };
+		bufferInfos[1] = { m_MeshBuffer.Handle, 0, VK_WHOLE_SIZE };
+		bufferInfos[2] = { m_DrawBuffer.Handle, 0, VK_WHOLE_SIZE };
+		bufferInfos[3] = { m_CountBuffer.Handle, 0, VK_WHOLE_SIZE };
+
+		VkWriteDescriptorSet descriptorWrites[4] = {};
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[i].dstSet = m_DescriptorSet;
+			descriptorWrites[i].dstBinding = i;
+			descriptorWrites[i].descriptorCount = 1;
+			descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+		}
+		vkUpdateDescriptorSets(m_Device, 4, descriptorWrites, 0, nullptr);
+
+		VulkanPipelineDescription description = {};
+		description.Name = "Mesh";
+		description.ShaderPath = "assets/shaders/mesh";
+		description.SetLayouts = { m_DescriptorSetLayout };
+		description.RenderPass = renderPass;
+		description.Subpass = 0;
+		// The vertex input is reflected, a tightly packed position and normal is exactly VulkanMeshVertex
+		static_assert(sizeof(VulkanMeshVertex) == 6 * sizeof(float));
+		m_Pipeline = m_PipelineLibrary->Register(description);
+		m_PipelineLayout = m_PipelineLibrary->GetLayout(m_Pipeline);
+
+		VulkanPipelineDescription cullDescription = {};
+		cullDescription.Name = "MeshCull";
+		cullDescription.ShaderPath = "assets/shaders/cull";
+		cullDescription.Compute = true;
+		cullDescription.SetLayouts = { m_DescriptorSetLayout };
+		cullDescription.Specialization = { { 0, CullGroupSize } };
+		m_CullPipeline = m_PipelineLibrary->Register(cullDescription);
+		m_CullPipelineLayout = m_PipelineLibrary->GetLayout(m_CullPipeline);
+
+		const float identity[16] = {
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f
+		};
+		SetViewProjection(identity);
+	}
+
+	VulkanMeshRenderer::~VulkanMeshRenderer()
+	{
+		DestroyBuffer(m_VertexBuffer);
+		DestroyBuffer(m_IndexBuffer);
+		DestroyBuffer(m_MeshBuffer);
+		DestroyBuffer(m_ObjectBuffer);
+		DestroyBuffer(m_DrawBuffer);
+		DestroyBuffer(m_CountBuffer);
+
+		vkDestroyDescriptorPool(m_Device, m_DescriptorPool, nullptr);
+	}
+
+	VulkanMeshHandle VulkanMeshRenderer::CreateMesh(const VulkanMeshVertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
+	{
+		BRICKENGINE_ASSERT(vertexCount > 0 && indexCount > 0);
+		BRICKENGINE_ASSERT(m_Meshes.size() < MaxMeshes);
+		BRICKENGINE_ASSERT((m_VertexCount + vertexCount) * sizeof(VulkanMeshVertex) <= m_VertexCapacity);
+		BRICKENGINE_ASSERT((m_IndexCount + indexCount) * sizeof(uint32_t) <= m_IndexCapacity);
+
+		Mesh& mesh = m_Meshes.emplace_back();
+		mesh.Draw.IndexCount = indexCount;
+		mesh.Draw.FirstIndex = m_IndexCount;
+		mesh.Draw.VertexOffset = static_cast<int32_t>(m_VertexCount);
+
+		// Centered on the bounding box, not the tightest sphere but close enough for culling
+		float min[3] = { vertices[0].Position[0], vertices[0].Position[1], vertices[0].Position[2] };
+		float max[3] = { min[0], min[1], min[2] };
+		for (uint32_t i = 1; i < vertexCount; i++)
+		{
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				min[axis] = std::min(min[axis], vertices[i].Position[axis]);
+				max[axis] = std::max(max[axis], vertices[i].Position[axis]);
+			}
+		}
+		float radiusSquared = 0.0f;
+		for (uint32_t axis = 0; axis < 3; axis++)
+			mesh.BoundingSphere[axis] = (min[axis] + max[axis]) * 0.5f;
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			float dx = vertices[i].Position[0] - mesh.BoundingSphere[0];
+			float dy = vertices[i].Position[1] - mesh.BoundingSphere[1];
+			float dz = vertices[i].Position[2] - mesh.BoundingSphere[2];
+			radiusSquared = std::max(radiusSquared, dx * dx + dy * dy + dz * dz);
+		}
+		mesh.BoundingSphere[3] = std::sqrt(radiusSquared);
+
+		VulkanUploadManager* uploadManager = m_Renderer->GetUploadManager();
+		uploadManager->UploadBuffer(m_VertexBuffer.Handle, m_VertexCount * sizeof(VulkanMeshVertex), vertices, vertexCount * sizeof(VulkanMeshVertex));
+		uploadManager->UploadBuffer(m_IndexBuffer.Handle, m_IndexCount * sizeof(uint32_t), indices, indexCount * sizeof(uint32_t));
+		m_VertexCount += vertexCount;
+		m_IndexCount += indexCount;
+
+		return static_cast<VulkanMeshHandle>(m_Meshes.size() - 1);
+	}
+
+	VulkanObjectHandle VulkanMeshRenderer::CreateObject(VulkanMeshHandle mesh, const float transform[16], uint32_t color)
+	{
+		BRICKENGINE_ASSERT(mesh < m_Meshes.size());
+
+		// The GPU copy of a reused slot only changes with this frame's copies, after the last frame stopped reading it
+		VulkanObjectHandle handle;
+		if (!m_FreeObjects.empty())
+		{
+			handle = m_FreeObjects.back();
+			m_FreeObjects.pop_back();
+		}
+		else
+		{
+			BRICKENGINE_ASSERT(m_Objects.size() < m_MaxObjects);
+			handle = static_cast<VulkanObjectHandle>(m_Objects.size());
+			m_Objects.emplace_back();
+			m_ObjectDirty.push_back(0);
+		}
+
+		GPUObject& object = m_Objects[handle];
+		std::memcpy(object.Transform, transform, sizeof(object.Transform));
+		object.Mesh = mesh;
+		object.Color = color;
+		UpdateBoundingSphere(object);
+		MarkDirty(handle);
+		return handle;
+	}
+
+	void VulkanMeshRenderer::SetTransform(VulkanObjectHandle object, const float transform[16])
+	{
+		BRICKENGINE_ASSERT(object < m_Objects.size() && m_Objects[object].Mesh != InvalidMesh);
+		std::memcpy(m_Objects[object].Transform, transform, sizeof(m_Objects[object].Transform));
+		UpdateBoundingSphere(m_Objects[object]);
+		MarkDirty(object);
+	}
+
+	void VulkanMeshRenderer::SetColor(VulkanObjectHandle object, uint32_t color)
+	{
+		BRICKENGINE_ASSERT(object < m_Objects.size() && m_Objects[object].Mesh != InvalidMesh);
+		m_Objects[object].Color = color;
+		MarkDirty(object);
+	}
+
+	void VulkanMeshRenderer::DestroyObject(VulkanObjectHandle object)
+	{
+		BRICKENGINE_ASSERT(object < m_Objects.size() && m_Objects[object].Mesh != InvalidMesh);
+		// The culling pass skips it until the slot is reused
+		m_Objects[object].Mesh = InvalidMesh;
+		MarkDirty(object);
+		m_FreeObjects.push_back(object);
+	}
+
+	void VulkanMeshRenderer::SetViewProjection(const float matrix[16])
+	{
+		std::memcpy(m_ViewProjection, matrix, sizeof(m_ViewProjection));
+
+		// Planes from the rows of the matrix: left, right, bottom, top, near, far. Vulkan clip space depth is [0, w],
+		// so the near plane is the third row alone.
+		auto element = [&](uint32_t row, uint32_t column) { return matrix[column * 4 + row]; };
+		const uint32_t rows[6] = { 0, 0, 1, 1, 2, 2 };
+		const float signs[6] = { 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f };
+		for (uint32_t i = 0; i < 6; i++)
+		{
+			float* plane = m_CullConstants.FrustumPlanes[i];
+			for (uint32_t column = 0; column < 4; column++)
+				plane[column] = (i == 4 ? 0.0f : element(3, column)) + signs[i] * element(rows[i], column);
+
+			float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+			if (length > 0.0f)
+			{
+				for (uint32_t column = 0; column < 4; column++)
+					plane[column] /= length;
+			}
+		}
+	}
+
+	void VulkanMeshRenderer::RecordCulling(VkCommandBuffer commandBuffer)
+	{
+		uint32_t objectCount = static_cast<uint32_t>(m_Objects.size());
+		if (objectCount == 0)
+			return;
+
+		// Last frame's culling pass and draws read the buffers overwritten below, on the same queue an execution dependency covers that
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+			0, nullptr,
+			0, nullptr,
+			0, nullptr
+		);
+
+		uint32_t meshCount = static_cast<uint32_t>(m_Meshes.size());
+		VkDeviceSize copySize = m_DirtyObjects.size() * sizeof(GPUObject) + (meshCount - m_UploadedMeshCount) * sizeof(GPUMesh);
+		if (copySize > 0)
+		{
+			VulkanLinearAllocation staging = m_Renderer->AllocateTransient(copySize);
+			BRICKENGINE_ASSERT(staging.IsValid());
+			uint8_t* data = static_cast<uint8_t*>(staging.MappedData);
+			VkDeviceSize offset = 0;
+
+			// Sorted so neighbouring objects share a copy region
+			std::sort(m_DirtyObjects.begin(), m_DirtyObjects.end());
+			m_CopyRegions.clear();
+			for (VulkanObjectHandle object : m_DirtyObjects)
+			{
+				std::memcpy(data + offset, &m_Objects[object], sizeof(GPUObject));
+				m_ObjectDirty[object] = 0;
+
+				VkDeviceSize destinationOffset = object * sizeof(GPUObject);
+				if (!m_CopyRegions.empty() && m_CopyRegions.back().dstOffset + m_CopyRegions.back().size == destinationOffset)
+					m_CopyRegions.back().size += sizeof(GPUObject);
+				else
+					m_CopyRegions.push_back({ staging.Offset + offset, destinationOffset, sizeof(GPUObject) });
+				offset += sizeof(GPUObject);
+			}
+			if (!m_CopyRegions.empty())
+				vkCmdCopyBuffer(commandBuffer, staging.Buffer, m_ObjectBuffer.Handle, static_cast<uint32_t>(m_CopyRegions.size()), m_CopyRegions.data());
+
+			if (meshCount > m_UploadedMeshCount)
+			{
+				VkBufferCopy region = { staging.Offset + offset, m_UploadedMeshCount * sizeof(GPUMesh), (meshCount - m_UploadedMeshCount) * sizeof(GPUMesh) };
+				for (uint32_t i = m_UploadedMeshCount; i < meshCount; i++)
+				{
+					std::memcpy(data + offset, &m_Meshes[i].Draw, sizeof(GPUMesh));
+					offset += sizeof(GPUMesh);
+				}
+				vkCmdCopyBuffer(commandBuffer, staging.Buffer, m_MeshBuffer.Handle, 1, &region);
+				m_UploadedMeshCount = meshCount;
+			}
+
+			m_DirtyObjects.clear();
+		}
+
+		if (m_DrawIndirectCount)
+			vkCmdFillBuffer(commandBuffer, m_CountBuffer.Handle, 0, sizeof(uint32_t), 0);
+
+		VkMemoryBarrier transferBarrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+		transferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		transferBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0,
+			1, &transferBarrier,
+			0, nullptr,
+			0, nullptr
+		);
+
+		// Shaders that failed to load, already reported by the pipeline library
+		VkPipeline cullPipeline = m_PipelineLibrary->Get(m_CullPipeline);
+		if (cullPipeline)
+		{
+			m_CullConstants.ObjectCount = objectCount;
+			m_CullConstants.Compact = m_DrawIndirectCount ? 1 : 0;
+
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_CullPipelineLayout, 0, 1, &m_DescriptorSet, 0, nullptr);
+			vkCmdPushConstants(commandBuffer, m_CullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants), &m_CullConstants);
+			vkCmdDispatch(commandBuffer, (objectCount + CullGroupSize - 1) / CullGroupSize, 1, 1);
+		}
+	}
+
+	VulkanMeshStats VulkanMeshRenderer::Draw()
+	{
+		BRICKENGINE_PROFILE_FUNCTION();
+
+		auto start = std::chrono::steady_clock::now();
+
+		VulkanMeshStats stats;
+		stats.ObjectCount = static_cast<uint32_t>(m_Objects.size());
+		// Copied over by the RecordCulling that follows
+		stats.UpdatedObjects = static_cast<uint32_t>(m_DirtyObjects.size());
+
+		VkPipeline pipeline = m_PipelineLibrary->Get(m_Pipeline);
+		if (m_Objects.empty() || !pipeline || !m_PipelineLibrary->Get(m_CullPipeline))
+			return stats;
+
+		uint32_t drawCount = stats.ObjectCount;
+		const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+		m_Renderer->RecordParallel(1, [&](VkCommandBuffer commandBuffer, size_t begin, size_t end)
+			{
+				VkDeviceSize vertexOffset = 0;
+				vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &m_DescriptorSet, 0, nullptr);
+				vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(m_ViewProjection), m_ViewProjection);
+				vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_VertexBuffer.Handle, &vertexOffset);
+				vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer.Handle, 0, VK_INDEX_TYPE_UINT32);
+
+				if (m_DrawIndirectCount)
+				{
+					vkCmdDrawIndexedIndirectCount(commandBuffer, m_DrawBuffer.Handle, 0, m_CountBuffer.Handle, 0, drawCount, stride);
+					stats.IndirectDrawCalls = 1;
+				}
+				else if (m_MultiDrawIndirect)
+				{
+					vkCmdDrawIndexedIndirect(commandBuffer, m_DrawBuffer.Handle, 0, drawCount, stride);
+					stats.IndirectDrawCalls = 1;
+				}
+				else
+				{
+					for (uint32_t i = 0; i < drawCount; i++)
+						vkCmdDrawIndexedIndirect(commandBuffer, m_DrawBuffer.Handle, i * stride, 1, stride);
+					stats.IndirectDrawCalls = drawCount;
+				}
+			}
+		);
+
+		stats.RecordTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return stats;
+	}
+
+	VulkanMeshRenderer::Buffer VulkanMeshRenderer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage)
+	{
+		Buffer buffer;
+
+		VkBufferCreateInfo bufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		bufferCreateInfo.size = size;
+		bufferCreateInfo.usage = usage;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		VK_CHECK(vkCreateBuffer(m_Device, &bufferCreateInfo, nullptr, &buffer.Handle));
+
+		buffer.Allocation = m_Renderer->GetAllocator()->AllocateForBuffer(buffer.Handle, VulkanMemoryUsage::GPUOnly);
+		BRICKENGINE_ASSERT(buffer.Allocation);
+		return buffer;
+	}
+
+	void VulkanMeshRenderer::DestroyBuffer(Buffer& buffer)
+	{
+		vkDestroyBuffer(m_Device, buffer.Handle, nullptr);
+		m_Renderer->GetAllocator()->Free(buffer.Allocation);
+		buffer = {};
+	}
+
+	void VulkanMeshRenderer::UpdateBoundingSphere(GPUObject& object)
+	{
+		const float* transform = object.Transform;
+		const float* sphere = m_Meshes[object.Mesh].BoundingSphere;
+		for (uint32_t row = 0; row < 3; row++)
+			object.BoundingSphere[row] = transform[row] * sphere[0] + transform[4 + row] * sphere[1] + transform[8 + row] * sphere[2] + transform[12 + row];
+
+		// Scaled by the longest axis so non uniform scales stay conservative
+		float scaleSquared = 0.0f;
+		for (uint32_t column = 0; column < 3; column++)
+		{
+			const float* axis = transform + column * 4;
+			scaleSquared = std::max(scaleSquared, axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		}
+		object.BoundingSphere[3] = sphere[3] * std::sqrt(scaleSquared);
+	}
+
+	void VulkanMeshRenderer::MarkDirty(VulkanObjectHandle object)
+	{
+		if (m_ObjectDirty[object])
+			return;
+		m_ObjectDirty[object] = 1;
+		m_DirtyObjects.push_back(object);
+	}
+
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanPlatform.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanMemoryAllocator.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanPipelineLibrary.hpp"
+
+namespace BrickEngine {
+
+	class VulkanRenderer;
+
+	using VulkanMeshHandle = uint32_t;
+	using VulkanObjectHandle = uint32_t;
+
+	// Vertex layout of every mesh, matches the inputs of assets/shaders/mesh.vert.glsl
+	struct VulkanMeshVertex
+	{
+		float Position[3] = { 0.0f, 0.0f, 0.0f };
+		float Normal[3] = { 0.0f, 0.0f, 1.0f };
+	};
+
+	struct VulkanMeshStats
+	{
+		// Objects handed to the culling pass, the number drawn is only known on the GPU
+		uint32_t ObjectCount = 0;
+		// Objects whose data was copied to the GPU this frame
+		uint32_t UpdatedObjects = 0;
+		// Indirect draw commands recorded on the CPU
+		uint32_t IndirectDrawCalls = 0;
+		// Seconds spent recording the culling pass and the draws
+		double RecordTime = 0.0;
+	};
+
+	// GPU driven mesh rendering. All meshes share one vertex and one index buffer, objects live in a storage buffer.
+	// Every frame a compute pass culls the objects' bounding spheres against the view frustum and writes one indexed
+	// indirect command per visible object, which are drawn with a single vkCmdDrawIndexedIndirectCount. Without
+	// drawIndirectCount culled objects are written as zero instance draws instead. Not thread safe, use it from the
+	// thread calling BeginFrame and EndFrame.
+	class VulkanMeshRenderer
+	{
+	public:
+		static constexpr uint32_t DefaultMaxObjects = 64 * 1024;
+		static constexpr uint32_t MaxMeshes = 4096;
+		static constexpr VkDeviceSize DefaultVertexCapacity = 64ull * 1024 * 1024;
+		static constexpr VkDeviceSize DefaultIndexCapacity = 32ull * 1024 * 1024;
+		// Specializes local_size_x of assets/shaders/cull.comp.glsl
+		static constexpr uint32_t CullGroupSize = 64;
+
+		VulkanMeshRenderer(VulkanRenderer* renderer, VkDevice device, VulkanPipelineLibrary* pipelineLibrary, VkRenderPass renderPass,
+			uint32_t maxObjects = DefaultMaxObjects, VkDeviceSize vertexCapacity = DefaultVertexCapacity, VkDeviceSize indexCapacity = DefaultIndexCapacity);
+		~VulkanMeshRenderer();
+
+		VulkanMeshRenderer(const VulkanMeshRenderer&) = delete;
+		VulkanMeshRenderer& operator=(const VulkanMeshRenderer&) = delete;
+
+		// Meshes live as long as the renderer. Like every upload they may only be drawn from the next BeginFrame on.
+		VulkanMeshHandle CreateMesh(const VulkanMeshVertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+
+		// transform is a column major model matrix, color is RGBA8 with red in the lowest byte
+		VulkanObjectHandle CreateObject(VulkanMeshHandle mesh, const float transform[16], uint32_t color = 0xffffffff);
+		void SetTransform(VulkanObjectHandle object, const float transform[16]);
+		void SetColor(VulkanObjectHandle object, uint32_t color);
+		void DestroyObject(VulkanObjectHandle object);
+
+		// Column major, also the frustum objects are culled against
+		void SetViewProjection(const float matrix[16]);
+
+		// Called by VulkanRenderer::EndFrame, Draw records the secondary command buffers before the render graph executes and
+		// RecordCulling is the graph's culling pass. The graph places the barrier between the culling results and the draws.
+		void RecordCulling(VkCommandBuffer commandBuffer);
+		VulkanMeshStats Draw();
+
+		// Written by the culling pass and read by the indirect draws
+		VkBuffer GetDrawBuffer() const { return m_DrawBuffer.Handle; }
+		VkBuffer GetCountBuffer() const { return m_CountBuffer.Handle; }
+	private:
+		// std430 layouts shared with the shaders
+		struct GPUObject
+		{
+			float Transform[16] = {};
+			// World space center and radius
+			float BoundingSphere[4] = {};
+			uint32_t Mesh = 0;
+			uint32_t Color = 0;
+			uint32_t Padding[2] = {};
+		};
+
+		struct GPUMesh
+		{
+			uint32_t IndexCount = 0;
+			uint32_t FirstIndex = 0;
+			int32_t VertexOffset = 0;
+			uint32_t Padding = 0;
+		};
+
+		struct CullPushConstants
+		{
+			float FrustumPlanes[6][4] = {};
+			uint32_t ObjectCount = 0;
+			// Zero writes a draw for every object with instanceCount 0 for culled ones
+			uint32_t Compact = 0;
+		};
+
+		struct Mesh
+		{
+			GPUMesh Draw = {};
+			// Object space center and radius
+			float BoundingSphere[4] = {};
+		};
+
+		struct Buffer
+		{
+			VkBuffer Handle = nullptr;
+			VulkanAllocation* Allocation = nullptr;
+		};
+
+		static constexpr uint32_t InvalidMesh = std::numeric_limits<uint32_t>::max();
+
+		Buffer CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage);
+		void DestroyBuffer(Buffer& buffer);
+		void UpdateBoundingSphere(GPUObject& object);
+		void MarkDirty(VulkanObjectHandle object);
+	private:
+		VulkanRenderer* m_Renderer = nullptr;
+		VkDevice m_Device = nullptr;
+		VulkanPipelineLibrary* m_PipelineLibrary = nullptr;
+
+		uint32_t m_MaxObjects = 0;
+		// Chosen from the device features, see Draw
+		bool m_DrawIndirectCount = false;
+		bool m_MultiDrawIndirect = false;
+
+		// The layouts are owned by the layout cache
+		VkDescriptorSetLayout m_DescriptorSetLayout = nullptr;
+		VkDescriptorPool m_DescriptorPool = nullptr;
+		VkDescriptorSet m_DescriptorSet = nullptr;
+		VkPipelineLayout m_PipelineLayout = nullptr;
+		VkPipelineLayout m_CullPipelineLayout = nullptr;
+		VulkanPipelineHandle m_Pipeline = 0;
+		VulkanPipelineHandle m_CullPipeline = 0;
+
+		Buffer m_VertexBuffer = {};
+		Buffer m_IndexBuffer = {};
+		Buffer m_MeshBuffer = {};
+		Buffer m_ObjectBuffer = {};
+		Buffer m_DrawBuffer = {};
+		Buffer m_CountBuffer = {};
+		VkDeviceSize m_VertexCapacity = 0;
+		VkDeviceSize m_IndexCapacity = 0;
+		uint32_t m_VertexCount = 0;
+		uint32_t m_IndexCount = 0;
+
+		std::vector<Mesh> m_Meshes = {};
+		// Meshes before this one are in m_MeshBuffer
+		uint32_t m_UploadedMeshCount = 0;
+
+		// CPU copy of the object buffer, changed objects are copied over by the next RecordCulling
+		std::vector<GPUObject> m_Objects = {};
+		std::vector<uint8_t> m_ObjectDirty = {};
+		std::vector<VulkanObjectHandle> m_DirtyObjects = {};
+		std::vector<VulkanObjectHandle> m_FreeObjects = {};
+
+		float m_ViewProjection[16] = {};
+		CullPushConstants m_CullConstants = {};
+		std::vector<VkBufferCopy> m_CopyRegions = {};
+	};
+
+}
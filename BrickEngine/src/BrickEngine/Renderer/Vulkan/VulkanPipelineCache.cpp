@@ -0,0 +1,139 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanPipelineCache.hpp"
+
+namespace BrickEngine {
+
+	// Layout of the header every driver puts at the start of vkGetPipelineCacheData
+	struct VulkanPipelineCacheDriverHeader
+	{
+		uint32_t HeaderSize;
+		uint32_t HeaderVersion;
+		uint32_t VendorID;
+		uint32_t DeviceID;
+		uint8_t CacheUUID[VK_UUID_SIZE];
+	};
+
+	static uint64_t HashData(const char* data, size_t size)
+	{
+		uint64_t hash = 0xcbf29ce484222325;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= static_cast<uint8_t>(data[i]);
+			hash *= 0x100000001b3;
+		}
+		return hash;
+	}
+
+	VulkanPipelineCache::VulkanPipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& filepath)
+		: m_Device(device), m_Filepath(filepath)
+	{
+		vkGetPhysicalDeviceProperties(physicalDevice, &m_Properties);
+
+		VkPipelineCacheCreateInfo cacheCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+
+		FileView file;
+		FileError error = File::MapFile(m_Filepath, file);
+		if (error == FileError::None)
+		{
+			if (Validate(file.GetData(), file.GetSize()))
+			{
+				cacheCreateInfo.initialDataSize = file.GetSize() - sizeof(VulkanPipelineCacheHeader);
+				cacheCreateInfo.pInitialData = file.GetData() + sizeof(VulkanPipelineCacheHeader);
+				m_SavedSize = cacheCreateInfo.initialDataSize;
+				m_Warm = true;
+			}
+			else
+				Log::Warn(LogCategory::Renderer, "Ignoring pipeline cache '{}', it is corrupt or was created by another device or driver", m_Filepath);
+		}
+		else if (error != FileError::NotFound)
+			Log::Warn(LogCategory::Renderer, "Failed to load pipeline cache '{}': {}", m_Filepath, File::GetErrorString(error));
+
+		VkResult result = vkCreatePipelineCache(m_Device, &cacheCreateInfo, nullptr, &m_Cache);
+		if (result != VK_SUCCESS && m_Warm)
+		{
+			// The driver is allowed to reject data it doesn't like, start empty instead
+			Log::Warn(LogCategory::Renderer, "Driver rejected pipeline cache '{}'", m_Filepath);
+			cacheCreateInfo.initialDataSize = 0;
+			cacheCreateInfo.pInitialData = nullptr;
+			m_SavedSize = 0;
+			m_Warm = false;
+			result = vkCreatePipelineCache(m_Device, &cacheCreateInfo, nullptr, &m_Cache);
+		}
+		VK_CHECK(result);
+
+		Log::Info(LogCategory::Renderer, "Pipeline cache '{}' is {}", m_Filepath, m_Warm ? "warm" : "cold");
+	}
+
+	VulkanPipelineCache::~VulkanPipelineCache()
+	{
+		vkDestroyPipelineCache(m_Device, m_Cache, nullptr);
+	}
+
+	FileError VulkanPipelineCache::Save()
+	{
+		size_t size = 0;
+		VK_CHECK(vkGetPipelineCacheData(m_Device, m_Cache, &size, nullptr));
+		if (size == m_SavedSize)
+			return FileError::None;
+
+		std::vector<char> data(sizeof(VulkanPipelineCacheHeader) + size);
+		VkResult result = vkGetPipelineCacheData(m_Device, m_Cache, &size, data.data() + sizeof(VulkanPipelineCacheHeader));
+		if (result != VK_SUCCESS && result != VK_INCOMPLETE)
+			return FileError::ReadFailed;
+		data.resize(sizeof(VulkanPipelineCacheHeader) + size);
+
+		VulkanPipelineCacheHeader header = {};
+		header.Magic = VulkanPipelineCacheMagic;
+		header.Version = VulkanPipelineCacheVersion;
+		header.VendorID = m_Properties.vendorID;
+		header.DeviceID = m_Properties.deviceID;
+		header.DriverVersion = m_Properties.driverVersion;
+		std::memcpy(header.CacheUUID, m_Properties.pipelineCacheUUID, VK_UUID_SIZE);
+		header.DataSize = size;
+		header.DataHash = HashData(data.data() + sizeof(VulkanPipelineCacheHeader), size);
+		std::memcpy(data.data(), &header, sizeof(VulkanPipelineCacheHeader));
+
+		FileError error = File::WriteFile(m_Filepath, data.data(), data.size());
+		if (error != FileError::None)
+		{
+			Log::Warn(LogCategory::Renderer, "Failed to save pipeline cache '{}': {}", m_Filepath, File::GetErrorString(error));
+			return error;
+		}
+
+		Log::Trace(LogCategory::Renderer, "Saved pipeline cache '{}' ({} bytes)", m_Filepath, size);
+		m_SavedSize = size;
+		return FileError::None;
+	}
+
+	bool VulkanPipelineCache::Validate(const char* data, size_t size) const
+	{
+		if (size < sizeof(VulkanPipelineCacheHeader) + sizeof(VulkanPipelineCacheDriverHeader))
+			return false;
+
+		VulkanPipelineCacheHeader header;
+		std::memcpy(&header, data, sizeof(VulkanPipelineCacheHeader));
+		if (header.Magic != VulkanPipelineCacheMagic || header.Version != VulkanPipelineCacheVersion)
+			return false;
+		if (header.VendorID != m_Properties.vendorID || header.DeviceID != m_Properties.deviceID || header.DriverVersion != m_Properties.driverVersion)
+			return false;
+		if (std::memcmp(header.CacheUUID, m_Properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+			return false;
+
+		const char* cacheData = data + sizeof(VulkanPipelineCacheHeader);
+		size_t cacheSize = size - sizeof(VulkanPipelineCacheHeader);
+		if (header.DataSize != cacheSize || header.DataHash != HashData(cacheData, cacheSize))
+			return false;
+
+		// Check the driver's own header as well, some drivers crash on data they didn't write
+		VulkanPipelineCacheDriverHeader driverHeader;
+		std::memcpy(&driverHeader, cacheData, sizeof(VulkanPipelineCacheDriverHeader));
+		if (driverHeader.HeaderSize < sizeof(VulkanPipelineCacheDriverHeader) || driverHeader.HeaderSize > cacheSize)
+			return false;
+		if (driverHeader.HeaderVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+			return false;
+		if (driverHeader.VendorID != m_Properties.vendorID || driverHeader.DeviceID != m_Properties.deviceID)
+			return false;
+		return std::memcmp(driverHeader.CacheUUID, m_Properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+	}
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+#include "BrickEngine/Core/File.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanPlatform.hpp"
+
+namespace BrickEngine {
+
+	// Written in front of the driver's cache data so files from another device, driver or a torn write are never handed to Vulkan.
+	struct VulkanPipelineCacheHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t VendorID;
+		uint32_t DeviceID;
+		uint32_t DriverVersion;
+		uint8_t CacheUUID[VK_UUID_SIZE];
+		uint64_t DataSize;
+		uint64_t DataHash;
+	};
+
+	constexpr uint32_t VulkanPipelineCacheMagic = 0x43504B42; // "BKPC"
+	constexpr uint32_t VulkanPipelineCacheVersion = 1;
+
+	// VkPipelineCache backed by a file, loaded on creation and written back by Save.
+	class VulkanPipelineCache
+	{
+	public:
+		VulkanPipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& filepath);
+		~VulkanPipelineCache();
+
+		VulkanPipelineCache(const VulkanPipelineCache&) = delete;
+		VulkanPipelineCache& operator=(const VulkanPipelineCache&) = delete;
+
+		VkPipelineCache Get() const { return m_Cache; }
+		// True when valid data was loaded from disk, pipelines built with it should mostly hit the cache.
+		bool IsWarm() const { return m_Warm; }
+
+		// Does nothing when the cache didn't grow since it was loaded or last saved.
+		FileError Save();
+	private:
+		bool Validate(const char* data, size_t size) const;
+	private:
+		VkDevice m_Device = nullptr;
+		VkPipelineCache m_Cache = nullptr;
+		VkPhysicalDeviceProperties m_Properties = {};
+		std::string m_Filepath = {};
+		size_t m_SavedSize = 0;
+		bool m_Warm = false;
+	};
+
+}
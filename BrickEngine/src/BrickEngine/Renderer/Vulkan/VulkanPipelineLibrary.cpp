@@ -0,0 +1,621 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanPipelineLibrary.hpp"
+
+#include "BrickEngine/Core/JobSystem.hpp"
+
+namespace BrickEngine {
+
+	VulkanPipelineLibrary::VulkanPipelineLibrary(VkDevice device, VkPipelineCache pipelineCache, VulkanShaderCompiler* compiler, VulkanLayoutCache* layoutCache)
+		: m_Device(device), m_PipelineCache(pipelineCache), m_Compiler(compiler), m_LayoutCache(layoutCache)
+	{
+	}
+
+	VulkanPipelineLibrary::~VulkanPipelineLibrary()
+	{
+		for (auto& entry : m_Entries)
+		{
+			if (entry.Pipeline)
+				vkDestroyPipeline(m_Device, entry.Pipeline, nullptr);
+		}
+
+		for (auto& [path, modules] : m_Shaders)
+			DestroyShaderModules(*modules);
+
+		for (auto& reload : m_PendingReloads)
+		{
+			for (auto& [entry, pipeline] : reload.Pipelines)
+				vkDestroyPipeline(m_Device, pipeline, nullptr);
+			DestroyShaderModules(*reload.Modules);
+		}
+	}
+
+	VulkanPipelineHandle VulkanPipelineLibrary::Register(const VulkanPipelineDescription& description)
+	{
+		std::lock_guard<std::mutex> lock(m_EntriesMutex);
+		Entry& entry = m_Entries.emplace_back();
+		entry.Description = description;
+		return static_cast<VulkanPipelineHandle>(m_Entries.size() - 1);
+	}
+
+	void VulkanPipelineLibrary::Build(const std::vector<VulkanPipelineHandle>& handles)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		std::vector<Entry*> entries;
+		entries.reserve(handles.size());
+		for (auto handle : handles)
+			entries.push_back(&GetEntry(handle));
+
+		JobSystem::ParallelFor(entries.size(), [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+					BuildEntry(*entries[i]);
+			}, 1
+		);
+
+		double totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		for (Entry* entry : entries)
+		{
+			Log::Trace(LogCategory::Renderer, "Pipeline '{}': shader modules {} ms, pipeline {} ms on worker {}",
+				entry->Description.Name, entry->Stats.ShaderModuleTime * 1000.0, entry->Stats.PipelineTime * 1000.0, entry->Stats.WorkerIndex);
+		}
+		Log::Info(LogCategory::Renderer, "Built {} pipeline(s) in {} ms using {} worker(s)", entries.size(), totalTime * 1000.0, JobSystem::GetWorkerCount());
+	}
+
+	void VulkanPipelineLibrary::BuildAll()
+	{
+		std::vector<VulkanPipelineHandle> handles(GetPipelineCount());
+		for (size_t i = 0; i < handles.size(); i++)
+			handles[i] = static_cast<VulkanPipelineHandle>(i);
+		Build(handles);
+	}
+
+	VkPipeline VulkanPipelineLibrary::Get(VulkanPipelineHandle handle)
+	{
+		Entry& entry = GetEntry(handle);
+		if (!entry.Built.load(std::memory_order_acquire))
+			BuildEntry(entry);
+		return entry.Pipeline;
+	}
+
+	bool VulkanPipelineLibrary::IsBuilt(VulkanPipelineHandle handle)
+	{
+		return GetEntry(handle).Built.load(std::memory_order_acquire);
+	}
+
+	const VulkanPipelineDescription& VulkanPipelineLibrary::GetDescription(VulkanPipelineHandle handle)
+	{
+		return GetEntry(handle).Description;
+	}
+
+	VkPipelineLayout VulkanPipelineLibrary::GetLayout(VulkanPipelineHandle handle)
+	{
+		Entry& entry = GetEntry(handle);
+		ResolveEntry(entry);
+		return entry.State.Layout;
+	}
+
+	VkDescriptorSetLayout VulkanPipelineLibrary::GetDescriptorSetLayout(VulkanPipelineHandle handle, uint32_t set)
+	{
+		Entry& entry = GetEntry(handle);
+		ResolveEntry(entry);
+		return set < entry.State.SetLayouts.size() ? entry.State.SetLayouts[set] : nullptr;
+	}
+
+	VulkanShaderReflection VulkanPipelineLibrary::GetReflection(VulkanPipelineHandle handle)
+	{
+		Entry& entry = GetEntry(handle);
+		ResolveEntry(entry);
+
+		std::lock_guard<std::mutex> lock(m_ShadersMutex);
+		auto it = m_Shaders.find(entry.Description.ShaderPath);
+		return it != m_Shaders.end() ? it->second->Reflection : VulkanShaderReflection();
+	}
+
+	VulkanPipelineStats VulkanPipelineLibrary::GetStats(VulkanPipelineHandle handle)
+	{
+		Entry& entry = GetEntry(handle);
+		if (!entry.Built.load(std::memory_order_acquire))
+			return {};
+		return entry.Stats;
+	}
+
+	size_t VulkanPipelineLibrary::GetPipelineCount()
+	{
+		std::lock_guard<std::mutex> lock(m_EntriesMutex);
+		return m_Entries.size();
+	}
+
+	std::vector<VulkanShaderSource> VulkanPipelineLibrary::GetShaderSources()
+	{
+		std::lock_guard<std::mutex> lock(m_EntriesMutex);
+		std::vector<VulkanShaderSource> sources;
+		for (auto& entry : m_Entries)
+		{
+			const VulkanPipelineDescription& description = entry.Description;
+			auto it = std::find_if(sources.begin(), sources.end(), [&](const VulkanShaderSource& source) { return source.ShaderPath == description.ShaderPath; });
+			if (it != sources.end())
+				continue;
+
+			VulkanShaderSource& source = sources.emplace_back();
+			source.ShaderPath = description.ShaderPath;
+			source.Source = description.ShaderSource.empty() ? description.ShaderPath : description.ShaderSource;
+			source.Defines = description.ShaderDefines;
+			source.Compute = description.Compute;
+		}
+		return sources;
+	}
+
+	bool VulkanPipelineLibrary::PrepareReload(const std::string& shaderPath, const VulkanShaderCode& code)
+	{
+		PendingReload reload;
+		reload.ShaderPath = shaderPath;
+		reload.Modules = std::make_unique<ShaderModules>();
+		// Marks the modules as created, pipelines built after the swap must not load the old SPIR-V again
+		std::call_once(reload.Modules->Once, []() {});
+
+		ShaderModules& modules = *reload.Modules;
+		auto start = std::chrono::steady_clock::now();
+		if (!code.Compute.empty())
+			modules.Compute = CreateShaderModule(code.Compute.data(), code.Compute.size() * sizeof(uint32_t), modules);
+		if (!code.Vertex.empty())
+			modules.Vertex = CreateShaderModule(code.Vertex.data(), code.Vertex.size() * sizeof(uint32_t), modules);
+		if (!code.Fragment.empty())
+			modules.Fragment = CreateShaderModule(code.Fragment.data(), code.Fragment.size() * sizeof(uint32_t), modules);
+		modules.CreateTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::vector<Entry*> entries;
+		{
+			std::lock_guard<std::mutex> lock(m_EntriesMutex);
+			for (auto& entry : m_Entries)
+			{
+				if (entry.Description.ShaderPath == shaderPath && entry.Built.load(std::memory_order_acquire))
+					entries.push_back(&entry);
+			}
+		}
+
+		bool succeeded = true;
+		for (Entry* entry : entries)
+		{
+			const VulkanPipelineDescription& description = entry->Description;
+			if (description.Compute ? !modules.Compute : !modules.Vertex || !modules.Fragment)
+			{
+				succeeded = false;
+				break;
+			}
+
+			PipelineState state;
+			if (!ResolveState(description, modules, state))
+			{
+				succeeded = false;
+				break;
+			}
+			// Descriptor sets and push constants are bound with the old layout, only the shaders themselves can change
+			if (state.Layout != entry->State.Layout)
+			{
+				Log::Warn(LogCategory::Renderer, "Reloaded shaders of pipeline '{}' need a different layout, restart to pick them up", description.Name);
+				succeeded = false;
+				break;
+			}
+
+			VkPipeline pipeline = nullptr;
+			VkResult result = CreatePipeline(description, state, modules, pipeline);
+			if (result != VK_SUCCESS)
+			{
+				Log::Error(LogCategory::Renderer, "Failed to rebuild pipeline '{}': {}", description.Name, static_cast<int32_t>(result));
+				succeeded = false;
+				break;
+			}
+			reload.Pipelines.emplace_back(entry, pipeline);
+		}
+
+		if (!succeeded)
+		{
+			for (auto& [entry, pipeline] : reload.Pipelines)
+				vkDestroyPipeline(m_Device, pipeline, nullptr);
+			DestroyShaderModules(modules);
+			return false;
+		}
+
+		Log::Trace(LogCategory::Renderer, "Rebuilt {} pipeline(s) using '{}' in {} ms", reload.Pipelines.size(), shaderPath,
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1000.0);
+
+		std::lock_guard<std::mutex> lock(m_ReloadsMutex);
+		m_PendingReloads.push_back(std::move(reload));
+		return true;
+	}
+
+	uint32_t VulkanPipelineLibrary::ApplyReloads(const std::function<void(std::function<void()>)>& retire)
+	{
+		std::vector<PendingReload> reloads;
+		{
+			std::lock_guard<std::mutex> lock(m_ReloadsMutex);
+			if (m_PendingReloads.empty())
+				return 0;
+			reloads.swap(m_PendingReloads);
+		}
+
+		uint32_t count = 0;
+		std::vector<VkPipeline> oldPipelines;
+		std::vector<VkShaderModule> oldModules;
+		for (auto& reload : reloads)
+		{
+			for (auto& [entry, pipeline] : reload.Pipelines)
+			{
+				if (entry->Pipeline)
+					oldPipelines.push_back(entry->Pipeline);
+				entry->Pipeline = pipeline;
+				count++;
+			}
+
+			std::lock_guard<std::mutex> lock(m_ShadersMutex);
+			std::unique_ptr<ShaderModules>& slot = m_Shaders[reload.ShaderPath];
+			if (slot)
+			{
+				for (VkShaderModule module : { slot->Vertex, slot->Fragment, slot->Compute })
+				{
+					if (module)
+						oldModules.push_back(module);
+				}
+			}
+			slot = std::move(reload.Modules);
+		}
+
+		retire([device = m_Device, oldPipelines = std::move(oldPipelines), oldModules = std::move(oldModules)]()
+			{
+				for (VkPipeline pipeline : oldPipelines)
+					vkDestroyPipeline(device, pipeline, nullptr);
+				for (VkShaderModule module : oldModules)
+					vkDestroyShaderModule(device, module, nullptr);
+			}
+		);
+		return count;
+	}
+
+	VulkanPipelineLibrary::Entry& VulkanPipelineLibrary::GetEntry(VulkanPipelineHandle handle)
+	{
+		std::lock_guard<std::mutex> lock(m_EntriesMutex);
+		BRICKENGINE_ASSERT(handle < m_Entries.size());
+		return m_Entries[handle];
+	}
+
+	void VulkanPipelineLibrary::ResolveEntry(Entry& entry)
+	{
+		std::call_once(entry.ResolveOnce, [&]()
+			{
+				const VulkanPipelineDescription& description = entry.Description;
+
+				bool createdModules = false;
+				ShaderModules& modules = GetShaderModules(description, createdModules);
+				entry.Stats.ShaderModuleTime = createdModules ? modules.CreateTime : 0.0;
+
+				// Without a layout the pipeline is never created
+				bool hasModules = description.Compute ? modules.Compute != nullptr : modules.Vertex && modules.Fragment;
+				if (hasModules && !ResolveState(description, modules, entry.State))
+					entry.State = {};
+			}
+		);
+	}
+
+	void VulkanPipelineLibrary::BuildEntry(Entry& entry)
+	{
+		std::call_once(entry.Once, [&]()
+			{
+				const VulkanPipelineDescription& description = entry.Description;
+				entry.Stats.WorkerIndex = JobSystem::GetWorkerIndex();
+				ResolveEntry(entry);
+
+				if (entry.State.Layout)
+				{
+					bool createdModules = false;
+					ShaderModules& modules = GetShaderModules(description, createdModules);
+
+					auto start = std::chrono::steady_clock::now();
+					VK_CHECK(CreatePipeline(description, entry.State, modules, entry.Pipeline));
+					entry.Stats.PipelineTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				}
+				entry.Built.store(true, std::memory_order_release);
+			}
+		);
+	}
+
+	bool VulkanPipelineLibrary::ResolveState(const VulkanPipelineDescription& description, const ShaderModules& modules, PipelineState& state)
+	{
+		const VulkanShaderReflection& reflection = modules.Reflection;
+		if (!description.Layout && !m_LayoutCache)
+		{
+			Log::Error(LogCategory::Renderer, "Pipeline '{}' has no layout and the library no layout cache to build one", description.Name);
+			return false;
+		}
+		if (!modules.Reflected)
+		{
+			if (!description.Layout)
+			{
+				Log::Error(LogCategory::Renderer, "Failed to reflect the shaders of pipeline '{}', it needs a layout", description.Name);
+				return false;
+			}
+			Log::Warn(LogCategory::Renderer, "Failed to reflect the shaders of pipeline '{}', its layout and vertex input aren't checked", description.Name);
+		}
+
+		if (description.Layout)
+		{
+			state.Layout = description.Layout;
+			state.SetLayouts = description.SetLayouts;
+		}
+		else
+		{
+			uint32_t setCount = std::max(reflection.GetSetCount(), static_cast<uint32_t>(description.SetLayouts.size()));
+			for (uint32_t set = 0; set < setCount; set++)
+			{
+				if (set < description.SetLayouts.size() && description.SetLayouts[set])
+				{
+					state.SetLayouts.push_back(description.SetLayouts[set]);
+					continue;
+				}
+
+				// Sets no binding uses get an empty layout
+				std::vector<VkDescriptorSetLayoutBinding> bindings = reflection.GetSetBindings(set);
+				for (auto& binding : bindings)
+				{
+					if (binding.descriptorCount == 0)
+					{
+						Log::Error(LogCategory::Renderer, "Binding {} of set {} in pipeline '{}' is a runtime sized array, the set's layout has to be given", binding.binding, set, description.Name);
+						return false;
+					}
+				}
+				state.SetLayouts.push_back(m_LayoutCache->GetDescriptorSetLayout(bindings));
+			}
+			state.Layout = m_LayoutCache->GetPipelineLayout(state.SetLayouts, reflection.PushConstantRanges);
+		}
+
+		if (!description.Compute)
+		{
+			state.VertexBindings = description.VertexBindings;
+			state.VertexAttributes = description.VertexAttributes;
+			if (state.VertexAttributes.empty())
+			{
+				uint32_t offset = 0;
+				for (auto& input : reflection.VertexInputs)
+				{
+					state.VertexAttributes.push_back({ input.Location, 0, input.Format, offset });
+					offset += input.Size;
+				}
+				if (offset > 0)
+					state.VertexBindings = { { 0, offset, VK_VERTEX_INPUT_RATE_VERTEX } };
+			}
+
+			for (auto& input : reflection.VertexInputs)
+			{
+				auto it = std::find_if(state.VertexAttributes.begin(), state.VertexAttributes.end(), [&](const VkVertexInputAttributeDescription& attribute) { return attribute.location == input.Location; });
+				if (it == state.VertexAttributes.end())
+				{
+					Log::Error(LogCategory::Renderer, "Pipeline '{}' has no vertex attribute for input '{}' at location {}", description.Name, input.Name, input.Location);
+					return false;
+				}
+			}
+		}
+
+		for (auto& value : description.Specialization)
+		{
+			auto it = std::find_if(reflection.SpecializationConstants.begin(), reflection.SpecializationConstants.end(), [&](const VulkanShaderSpecializationConstant& constant) { return constant.Id == value.Id; });
+			if (modules.Reflected && it == reflection.SpecializationConstants.end())
+			{
+				Log::Warn(LogCategory::Renderer, "Pipeline '{}' specializes constant {}, its shaders don't declare it", description.Name, value.Id);
+				continue;
+			}
+
+			VkSpecializationMapEntry& mapEntry = state.SpecializationEntries.emplace_back();
+			mapEntry.constantID = value.Id;
+			mapEntry.offset = static_cast<uint32_t>(state.SpecializationData.size());
+			mapEntry.size = it != reflection.SpecializationConstants.end() ? it->Size : sizeof(uint32_t);
+
+			uint32_t narrow = static_cast<uint32_t>(value.Value);
+			state.SpecializationData.resize(mapEntry.offset + mapEntry.size);
+			memcpy(state.SpecializationData.data() + mapEntry.offset, mapEntry.size == sizeof(uint64_t) ? static_cast<const void*>(&value.Value) : &narrow, mapEntry.size);
+		}
+		return true;
+	}
+
+	VkResult VulkanPipelineLibrary::CreatePipeline(const VulkanPipelineDescription& description, const PipelineState& state, const ShaderModules& modules, VkPipeline& pipeline)
+	{
+		VkSpecializationInfo specializationInfo = {};
+		specializationInfo.mapEntryCount = static_cast<uint32_t>(state.SpecializationEntries.size());
+		specializationInfo.pMapEntries = state.SpecializationEntries.data();
+		specializationInfo.dataSize = state.SpecializationData.size();
+		specializationInfo.pData = state.SpecializationData.data();
+		const VkSpecializationInfo* specialization = state.SpecializationEntries.empty() ? nullptr : &specializationInfo;
+
+		if (description.Compute)
+		{
+			VkComputePipelineCreateInfo pipelineCreateInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+			pipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			pipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+			pipelineCreateInfo.stage.module = modules.Compute;
+			pipelineCreateInfo.stage.pName = "main";
+			pipelineCreateInfo.stage.pSpecializationInfo = specialization;
+			pipelineCreateInfo.layout = state.Layout;
+			pipelineCreateInfo.basePipelineHandle = nullptr;
+			pipelineCreateInfo.basePipelineIndex = -1;
+			return vkCreateComputePipelines(m_Device, m_PipelineCache, 1, &pipelineCreateInfo, nullptr, &pipeline);
+		}
+
+		VkPipelineShaderStageCreateInfo shaderStages[2] = {};
+		shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+		shaderStages[0].module = modules.Vertex;
+		shaderStages[0].pName = "main";
+		shaderStages[0].pSpecializationInfo = specialization;
+		shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		shaderStages[1].module = modules.Fragment;
+		shaderStages[1].pName = "main";
+		shaderStages[1].pSpecializationInfo = specialization;
+
+		// Set by whatever records the draws, see VulkanRenderer::BeginSecondaryCommandBuffer
+		VkPipelineViewportStateCreateInfo viewportState = { VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
+		viewportState.viewportCount = 1;
+		viewportState.pViewports = nullptr;
+		viewportState.scissorCount = 1;
+		viewportState.pScissors = nullptr;
+
+		VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+		VkPipelineDynamicStateCreateInfo dynamicState = { VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
+		dynamicState.dynamicStateCount = static_cast<uint32_t>(std::size(dynamicStates));
+		dynamicState.pDynamicStates = dynamicStates;
+
+		VkPipelineRasterizationStateCreateInfo rasterizerCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO };
+		rasterizerCreateInfo.depthBiasEnable = VK_FALSE;
+		rasterizerCreateInfo.rasterizerDiscardEnable = VK_FALSE;
+		rasterizerCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
+		rasterizerCreateInfo.lineWidth = 1.0f;
+		rasterizerCreateInfo.cullMode = description.CullMode;
+		rasterizerCreateInfo.frontFace = description.FrontFace;
+		rasterizerCreateInfo.depthBiasConstantFactor = 0.0f;
+		rasterizerCreateInfo.depthBiasClamp = 0.0f;
+		rasterizerCreateInfo.depthBiasSlopeFactor = 0.0f;
+
+		VkPipelineMultisampleStateCreateInfo multisamplingCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO };
+		multisamplingCreateInfo.sampleShadingEnable = VK_FALSE;
+		multisamplingCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+		multisamplingCreateInfo.minSampleShading = 1.0f;
+		multisamplingCreateInfo.pSampleMask = nullptr;
+		multisamplingCreateInfo.alphaToCoverageEnable = VK_FALSE;
+		multisamplingCreateInfo.alphaToOneEnable = VK_FALSE;
+
+		VkPipelineDepthStencilStateCreateInfo depthStencil = { VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO };
+		depthStencil.depthTestEnable = description.DepthTest ? VK_TRUE : VK_FALSE;
+		depthStencil.depthWriteEnable = description.DepthWrite ? VK_TRUE : VK_FALSE;
+		depthStencil.depthCompareOp = description.DepthCompareOp;
+		depthStencil.depthBoundsTestEnable = VK_FALSE;
+		depthStencil.stencilTestEnable = VK_FALSE;
+
+		VkPipelineColorBlendAttachmentState colorBlendAttachmentState = {};
+		colorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		colorBlendAttachmentState.blendEnable = description.Blend ? VK_TRUE : VK_FALSE;
+		colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		colorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+		colorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		colorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
+
+		VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO };
+		colorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
+		colorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
+		colorBlendStateCreateInfo.attachmentCount = 1;
+		colorBlendStateCreateInfo.pAttachments = &colorBlendAttachmentState;
+
+		VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
+		vertexInputCreateInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(state.VertexBindings.size());
+		vertexInputCreateInfo.pVertexBindingDescriptions = state.VertexBindings.data();
+		vertexInputCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(state.VertexAttributes.size());
+		vertexInputCreateInfo.pVertexAttributeDescriptions = state.VertexAttributes.data();
+
+		VkPipelineInputAssemblyStateCreateInfo inputAssembly = { VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO };
+		inputAssembly.topology = description.Topology;
+		inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+		VkGraphicsPipelineCreateInfo pipelineCreateInfo = { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+		pipelineCreateInfo.stageCount = 2;
+		pipelineCreateInfo.pStages = shaderStages;
+		pipelineCreateInfo.pVertexInputState = &vertexInputCreateInfo;
+		pipelineCreateInfo.pInputAssemblyState = &inputAssembly;
+		pipelineCreateInfo.pViewportState = &viewportState;
+		pipelineCreateInfo.pRasterizationState = &rasterizerCreateInfo;
+		pipelineCreateInfo.pMultisampleState = &multisamplingCreateInfo;
+		pipelineCreateInfo.pDepthStencilState = &depthStencil;
+		pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
+		pipelineCreateInfo.pDynamicState = &dynamicState;
+
+		pipelineCreateInfo.layout = state.Layout;
+		pipelineCreateInfo.renderPass = description.RenderPass;
+		pipelineCreateInfo.subpass = description.Subpass;
+		pipelineCreateInfo.basePipelineHandle = nullptr;
+		pipelineCreateInfo.basePipelineIndex = -1;
+
+		return vkCreateGraphicsPipelines(m_Device, m_PipelineCache, 1, &pipelineCreateInfo, nullptr, &pipeline);
+	}
+
+	VulkanPipelineLibrary::ShaderModules& VulkanPipelineLibrary::GetShaderModules(const VulkanPipelineDescription& description, bool& created)
+	{
+		ShaderModules* modules = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(m_ShadersMutex);
+			std::unique_ptr<ShaderModules>& slot = m_Shaders[description.ShaderPath];
+			if (!slot)
+				slot = std::make_unique<ShaderModules>();
+			modules = slot.get();
+		}
+
+		created = false;
+		std::call_once(modules->Once, [&]()
+			{
+				auto start = std::chrono::steady_clock::now();
+				if (description.Compute)
+					modules->Compute = LoadShaderModule(description, VulkanShaderStage::Compute, *modules);
+				else
+				{
+					modules->Vertex = LoadShaderModule(description, VulkanShaderStage::Vertex, *modules);
+					modules->Fragment = LoadShaderModule(description, VulkanShaderStage::Fragment, *modules);
+				}
+				modules->CreateTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				created = true;
+			}
+		);
+		return *modules;
+	}
+
+	VkShaderModule VulkanPipelineLibrary::LoadShaderModule(const VulkanPipelineDescription& description, VulkanShaderStage stage, ShaderModules& modules)
+	{
+		const char* extension = stage == VulkanShaderStage::Vertex ? ".vert" : stage == VulkanShaderStage::Fragment ? ".frag" : ".comp";
+
+		uint64_t size = 0;
+		std::string source = (description.ShaderSource.empty() ? description.ShaderPath : description.ShaderSource) + extension + ".glsl";
+		if (m_Compiler && File::GetFileSize(source, size) == FileError::None)
+		{
+			std::vector<uint32_t> code;
+			if (!m_Compiler->Compile(source, stage, description.ShaderDefines, code))
+				return nullptr;
+			return CreateShaderModule(code.data(), code.size() * sizeof(uint32_t), modules);
+		}
+		return CreateShaderModule(description.ShaderPath + extension + ".spv", modules);
+	}
+
+	VkShaderModule VulkanPipelineLibrary::CreateShaderModule(const std::string& filepath, ShaderModules& modules)
+	{
+		FileView source;
+		FileError error = File::MapFile(filepath, source);
+		if (error != FileError::None)
+		{
+			Log::Error(LogCategory::Renderer, "Failed to load shader '{}': {}", filepath, File::GetErrorString(error));
+			return nullptr;
+		}
+		return CreateShaderModule((const uint32_t*)source.GetData(), source.GetSize(), modules);
+	}
+
+	VkShaderModule VulkanPipelineLibrary::CreateShaderModule(const uint32_t* code, size_t size, ShaderModules& modules)
+	{
+		// Layouts and vertex input are taken from the merged interface of the stages
+		if (!modules.Reflection.Reflect(code, size / sizeof(uint32_t)))
+			modules.Reflected = false;
+
+		VkShaderModuleCreateInfo shaderCreateInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+		shaderCreateInfo.codeSize = size;
+		shaderCreateInfo.pCode = code;
+
+		VkShaderModule shaderModule = nullptr;
+		VK_CHECK(vkCreateShaderModule(m_Device, &shaderCreateInfo, nullptr, &shaderModule));
+		return shaderModule;
+	}
+
+	void VulkanPipelineLibrary::DestroyShaderModules(const ShaderModules& modules)
+	{
+		if (modules.Vertex)
+			vkDestroyShaderModule(m_Device, modules.Vertex, nullptr);
+		if (modules.Fragment)
+			vkDestroyShaderModule(m_Device, modules.Fragment, nullptr);
+		if (modules.Compute)
+			vkDestroyShaderModule(m_Device, modules.Compute, nullptr);
+	}
+
+}
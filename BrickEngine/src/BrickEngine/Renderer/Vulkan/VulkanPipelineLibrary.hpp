@@ -0,0 +1,195 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanPlatform.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanShaderCompiler.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanShaderReflection.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanLayoutCache.hpp"
+
+namespace BrickEngine {
+
+	// Overrides the default of the specialization constant with constant_id Id
+	struct VulkanSpecializationValue
+	{
+		uint32_t Id = 0;
+		uint64_t Value = 0;
+	};
+
+	struct VulkanPipelineDescription
+	{
+		std::string Name = {};
+		// Names the shaders, their SPIR-V is ShaderPath + ".vert.spv" and ShaderPath + ".frag.spv", or ShaderPath +
+		// ".comp.spv" for compute pipelines. Only loaded when the GLSL can't be compiled.
+		std::string ShaderPath = {};
+		// GLSL the shaders are compiled from, ShaderSource + ".vert.glsl" and so on, and the definitions they're compiled
+		// with. Empty means the sources sit next to the SPIR-V under the same name.
+		std::string ShaderSource = {};
+		std::vector<std::string> ShaderDefines = {};
+		// Compute pipelines only use the layout and specialization, everything else is graphics state
+		bool Compute = false;
+
+		// nullptr builds the layout from what the shaders declare. SetLayouts replaces the reflected layout of the set at
+		// its index, for sets the shaders can't describe like runtime sized arrays with binding flags. Null entries are
+		// reflected.
+		VkPipelineLayout Layout = nullptr;
+		std::vector<VkDescriptorSetLayout> SetLayouts = {};
+		std::vector<VulkanSpecializationValue> Specialization = {};
+		VkRenderPass RenderPass = nullptr;
+		uint32_t Subpass = 0;
+
+		// Empty takes every vertex shader input from binding 0, tightly packed in location order and per vertex
+		std::vector<VkVertexInputBindingDescription> VertexBindings = {};
+		std::vector<VkVertexInputAttributeDescription> VertexAttributes = {};
+
+		VkPrimitiveTopology Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		VkCullModeFlags CullMode = VK_CULL_MODE_BACK_BIT;
+		VkFrontFace FrontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		bool DepthTest = true;
+		bool DepthWrite = true;
+		VkCompareOp DepthCompareOp = VK_COMPARE_OP_LESS;
+		bool Blend = false;
+	};
+
+	using VulkanPipelineHandle = uint32_t;
+
+	// What a shader path is compiled from, see VulkanPipelineDescription
+	struct VulkanShaderSource
+	{
+		std::string ShaderPath = {};
+		std::string Source = {};
+		std::vector<std::string> Defines = {};
+		bool Compute = false;
+	};
+
+	// SPIR-V words of the stages of one shader path, Compute for compute pipelines and the others for graphics ones
+	struct VulkanShaderCode
+	{
+		std::vector<uint32_t> Vertex = {};
+		std::vector<uint32_t> Fragment = {};
+		std::vector<uint32_t> Compute = {};
+	};
+
+	struct VulkanPipelineStats
+	{
+		// Seconds spent compiling or loading the shaders and in vkCreateShaderModule, zero when another pipeline created
+		// the modules
+		double ShaderModuleTime = 0.0;
+		// Seconds spent in vkCreateGraphicsPipelines or vkCreateComputePipelines
+		double PipelineTime = 0.0;
+		int32_t WorkerIndex = -1;
+	};
+
+	// Owns the shader modules and pipelines built from descriptions. Shaders are compiled from GLSL when the library has a
+	// compiler and the sources exist, shipped builds without sources load the SPIR-V instead. Viewport and scissor are dynamic state, so pipelines
+	// don't depend on the size of what they render to and survive resizes.
+	// The SPIR-V is reflected, layouts not given by the description come from the layout cache and are shared by every
+	// pipeline with the same interface.
+	// Build compiles a batch across the job system workers, Get builds a pipeline on first use if nothing built it yet.
+	// Shaders can be replaced while running: PrepareReload builds new pipelines on any thread and ApplyReloads swaps them
+	// in between frames.
+	class VulkanPipelineLibrary
+	{
+	public:
+		// Without a layout cache every description needs a Layout
+		VulkanPipelineLibrary(VkDevice device, VkPipelineCache pipelineCache = nullptr, VulkanShaderCompiler* compiler = nullptr, VulkanLayoutCache* layoutCache = nullptr);
+		~VulkanPipelineLibrary();
+
+		VulkanPipelineLibrary(const VulkanPipelineLibrary&) = delete;
+		VulkanPipelineLibrary& operator=(const VulkanPipelineLibrary&) = delete;
+
+		VulkanPipelineHandle Register(const VulkanPipelineDescription& description);
+
+		void Build(const std::vector<VulkanPipelineHandle>& handles);
+		void BuildAll();
+
+		VkPipeline Get(VulkanPipelineHandle handle);
+		bool IsBuilt(VulkanPipelineHandle handle);
+
+		const VulkanPipelineDescription& GetDescription(VulkanPipelineHandle handle);
+		// Layout the pipeline is built with, loads the shaders but doesn't create the pipeline. nullptr when the shaders
+		// failed to load or reflect.
+		VkPipelineLayout GetLayout(VulkanPipelineHandle handle);
+		VkDescriptorSetLayout GetDescriptorSetLayout(VulkanPipelineHandle handle, uint32_t set);
+		// Merged interface of the pipeline's shader stages
+		VulkanShaderReflection GetReflection(VulkanPipelineHandle handle);
+		VulkanPipelineStats GetStats(VulkanPipelineHandle handle);
+		size_t GetPipelineCount();
+
+		// One per shader path, the first description registered with a path decides its source and definitions
+		std::vector<VulkanShaderSource> GetShaderSources();
+		// Creates shader modules from code and rebuilds every built pipeline using shaderPath with them, pipelines in use
+		// stay untouched until ApplyReloads. Thread safe. False when a module or pipeline couldn't be created or the code
+		// needs a different pipeline layout, nothing is kept then.
+		bool PrepareReload(const std::string& shaderPath, const VulkanShaderCode& code);
+		// Swaps the prepared pipelines in and hands a function destroying the replaced ones to retire. Only while no
+		// thread records, between EndFrame and BeginFrame. Returns the number of pipelines swapped.
+		uint32_t ApplyReloads(const std::function<void(std::function<void()>)>& retire);
+	private:
+		struct ShaderModules
+		{
+			std::once_flag Once;
+			VkShaderModule Vertex = nullptr;
+			VkShaderModule Fragment = nullptr;
+			VkShaderModule Compute = nullptr;
+			double CreateTime = 0.0;
+			VulkanShaderReflection Reflection;
+			bool Reflected = true;
+		};
+
+		// What a description resolves to once its shaders are reflected
+		struct PipelineState
+		{
+			VkPipelineLayout Layout = nullptr;
+			std::vector<VkDescriptorSetLayout> SetLayouts = {};
+			std::vector<VkVertexInputBindingDescription> VertexBindings = {};
+			std::vector<VkVertexInputAttributeDescription> VertexAttributes = {};
+			std::vector<VkSpecializationMapEntry> SpecializationEntries = {};
+			std::vector<uint8_t> SpecializationData = {};
+		};
+
+		struct Entry
+		{
+			VulkanPipelineDescription Description;
+			std::once_flag ResolveOnce;
+			PipelineState State;
+			std::once_flag Once;
+			std::atomic<bool> Built = false;
+			VkPipeline Pipeline = nullptr;
+			VulkanPipelineStats Stats;
+		};
+
+		struct PendingReload
+		{
+			std::string ShaderPath = {};
+			std::unique_ptr<ShaderModules> Modules;
+			std::vector<std::pair<Entry*, VkPipeline>> Pipelines = {};
+		};
+
+		Entry& GetEntry(VulkanPipelineHandle handle);
+		void ResolveEntry(Entry& entry);
+		void BuildEntry(Entry& entry);
+		bool ResolveState(const VulkanPipelineDescription& description, const ShaderModules& modules, PipelineState& state);
+		VkResult CreatePipeline(const VulkanPipelineDescription& description, const PipelineState& state, const ShaderModules& modules, VkPipeline& pipeline);
+		ShaderModules& GetShaderModules(const VulkanPipelineDescription& description, bool& created);
+		VkShaderModule LoadShaderModule(const VulkanPipelineDescription& description, VulkanShaderStage stage, ShaderModules& modules);
+		VkShaderModule CreateShaderModule(const std::string& filepath, ShaderModules& modules);
+		VkShaderModule CreateShaderModule(const uint32_t* code, size_t size, ShaderModules& modules);
+		void DestroyShaderModules(const ShaderModules& modules);
+	private:
+		VkDevice m_Device = nullptr;
+		VkPipelineCache m_PipelineCache = nullptr;
+		VulkanShaderCompiler* m_Compiler = nullptr;
+		VulkanLayoutCache* m_LayoutCache = nullptr;
+
+		std::mutex m_EntriesMutex;
+		std::deque<Entry> m_Entries;
+
+		std::mutex m_ShadersMutex;
+		std::unordered_map<std::string, std::unique_ptr<ShaderModules>> m_Shaders;
+
+		std::mutex m_ReloadsMutex;
+		std::vector<PendingReload> m_PendingReloads;
+	};
+
+}
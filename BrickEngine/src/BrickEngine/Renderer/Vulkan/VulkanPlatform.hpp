@@ -8,6 +8,13 @@
 #endif
 #include <vulkan/vulkan.h>
 
+#undef min
+#undef max
+
+#define VK_CHECK(x) { \
+	VkResult result = x; BRICKENGINE_ASSERT(result == VK_SUCCESS) \
+}
+
 namespace BrickEngine {
 
 	class VulkanPlatform
@@ -15,7 +22,14 @@ namespace BrickEngine {
 	public:
 		VulkanPlatform() = delete;
 
+		// Instance extension CreateSurface needs besides VK_KHR_surface
+		static const char* GetSurfaceExtensionName();
 		static VkSurfaceKHR CreateSurface(VkInstance instance, Window* window);
+
+		// Host clock VK_EXT_calibrated_timestamps pairs with device timestamps, the one std::chrono::steady_clock reads
+		static VkTimeDomainEXT GetHostTimeDomain();
+		// Converts a timestamp of the host time domain to Profiler::Now nanoseconds
+		static uint64_t HostTimestampToNanoseconds(uint64_t timestamp);
 	};
 
 }
@@ -0,0 +1,800 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanRenderGraph.hpp"
+
+namespace BrickEngine {
+
+	static const char* GetLayoutName(VkImageLayout layout)
+	{
+		switch (layout)
+		{
+			case VK_IMAGE_LAYOUT_UNDEFINED: return "Undefined";
+			case VK_IMAGE_LAYOUT_GENERAL: return "General";
+			case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL: return "ColorAttachment";
+			case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL: return "DepthAttachment";
+			case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL: return "ShaderReadOnly";
+			case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL: return "TransferSource";
+			case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL: return "TransferDestination";
+			case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR: return "Present";
+			default: return "Other";
+		}
+	}
+
+	VulkanRenderGraph::VulkanRenderGraph(VkDevice device, VulkanMemoryAllocator* allocator)
+		: m_Device(device), m_Allocator(allocator)
+	{
+	}
+
+	VulkanRenderGraph::~VulkanRenderGraph()
+	{
+		Destroy();
+	}
+
+	VulkanGraphResource VulkanRenderGraph::CreateImage(const std::string& name, const VulkanGraphImageDescription& description)
+	{
+		BRICKENGINE_ASSERT(description.Format != VK_FORMAT_UNDEFINED);
+		Resource& resource = m_Resources.emplace_back();
+		resource.Name = name;
+		resource.Description = description;
+		return static_cast<VulkanGraphResource>(m_Resources.size() - 1);
+	}
+
+	VulkanGraphResource VulkanRenderGraph::ImportImage(const std::string& name, VkFormat format, VkImageAspectFlags aspect, VkPipelineStageFlags initialStages, VkImageLayout initialLayout)
+	{
+		Resource& resource = m_Resources.emplace_back();
+		resource.Name = name;
+		resource.Imported = true;
+		resource.Description.Format = format;
+		resource.Description.Aspect = aspect;
+		resource.InitialStages = initialStages;
+		resource.InitialLayout = initialLayout;
+		return static_cast<VulkanGraphResource>(m_Resources.size() - 1);
+	}
+
+	VulkanGraphResource VulkanRenderGraph::ImportBuffer(const std::string& name, VkBuffer buffer)
+	{
+		BRICKENGINE_ASSERT(buffer);
+		Resource& resource = m_Resources.emplace_back();
+		resource.Name = name;
+		resource.IsImage = false;
+		resource.Imported = true;
+		resource.Buffer = buffer;
+		return static_cast<VulkanGraphResource>(m_Resources.size() - 1);
+	}
+
+	void VulkanRenderGraph::SetImportedImage(VulkanGraphResource resource, VkImage image, VkImageView view)
+	{
+		BRICKENGINE_ASSERT(resource < m_Resources.size() && m_Resources[resource].Imported && m_Resources[resource].IsImage);
+		m_Resources[resource].Image = image;
+		m_Resources[resource].View = view;
+	}
+
+	void VulkanRenderGraph::MarkOutput(VulkanGraphResource resource, VulkanGraphUsage finalUsage)
+	{
+		BRICKENGINE_ASSERT(resource < m_Resources.size());
+		m_Resources[resource].Output = true;
+		m_Resources[resource].FinalUsage = finalUsage;
+	}
+
+	VulkanGraphPass VulkanRenderGraph::AddPass(const std::string& name, VulkanGraphPassType type, ExecuteFunction execute, VkSubpassContents contents)
+	{
+		Pass& pass = m_Passes.emplace_back();
+		pass.Name = name;
+		pass.Type = type;
+		pass.Execute = std::move(execute);
+		pass.Contents = contents;
+		return static_cast<VulkanGraphPass>(m_Passes.size() - 1);
+	}
+
+	void VulkanRenderGraph::Read(VulkanGraphPass pass, VulkanGraphResource resource, VulkanGraphUsage usage)
+	{
+		BRICKENGINE_ASSERT(pass < m_Passes.size() && resource < m_Resources.size());
+		m_Passes[pass].Accesses.push_back({ resource, usage, false });
+	}
+
+	void VulkanRenderGraph::Write(VulkanGraphPass pass, VulkanGraphResource resource, VulkanGraphUsage usage)
+	{
+		BRICKENGINE_ASSERT(pass < m_Passes.size() && resource < m_Resources.size());
+		BRICKENGINE_ASSERT(usage != VulkanGraphUsage::SampledFragment && usage != VulkanGraphUsage::SampledCompute && usage != VulkanGraphUsage::IndirectBuffer);
+		m_Passes[pass].Accesses.push_back({ resource, usage, true });
+	}
+
+	void VulkanRenderGraph::SetColorAttachment(VulkanGraphPass pass, VulkanGraphResource resource, VkAttachmentLoadOp loadOp, VkClearColorValue clearColor)
+	{
+		BRICKENGINE_ASSERT(m_Passes[pass].Type == VulkanGraphPassType::Graphics && m_Resources[resource].IsImage);
+		Attachment& attachment = m_Passes[pass].ColorAttachments.emplace_back();
+		attachment.Resource = resource;
+		attachment.LoadOp = loadOp;
+		attachment.ClearValue.color = clearColor;
+
+		if (loadOp == VK_ATTACHMENT_LOAD_OP_LOAD)
+			Read(pass, resource, VulkanGraphUsage::ColorAttachment);
+		Write(pass, resource, VulkanGraphUsage::ColorAttachment);
+	}
+
+	void VulkanRenderGraph::SetDepthAttachment(VulkanGraphPass pass, VulkanGraphResource resource, VkAttachmentLoadOp loadOp, float clearDepth)
+	{
+		BRICKENGINE_ASSERT(m_Passes[pass].Type == VulkanGraphPassType::Graphics && m_Resources[resource].IsImage);
+		Attachment& attachment = m_Passes[pass].DepthAttachment;
+		attachment.Resource = resource;
+		attachment.LoadOp = loadOp;
+		attachment.ClearValue.depthStencil = { clearDepth, 0 };
+
+		if (loadOp == VK_ATTACHMENT_LOAD_OP_LOAD)
+			Read(pass, resource, VulkanGraphUsage::DepthAttachment);
+		Write(pass, resource, VulkanGraphUsage::DepthAttachment);
+	}
+
+	void VulkanRenderGraph::SetSideEffects(VulkanGraphPass pass)
+	{
+		m_Passes[pass].SideEffects = true;
+	}
+
+	void VulkanRenderGraph::Compile(VkExtent2D extent)
+	{
+		BRICKENGINE_PROFILE_FUNCTION();
+
+		Destroy();
+		m_Extent = extent;
+		m_Stats = {};
+
+		CullPasses();
+		CreateTransientImages(extent);
+		PlanBarriers();
+
+		for (auto& pass : m_Passes)
+		{
+			if (pass.Culled)
+				continue;
+			if (pass.Type == VulkanGraphPassType::Graphics)
+				CreateRenderPass(pass);
+
+			m_Stats.PassCount++;
+			m_Stats.BarrierCount += static_cast<uint32_t>(pass.Barriers.size());
+			m_Stats.PipelineBarrierCount += pass.Barriers.empty() ? 0 : 1;
+		}
+		m_Stats.CulledPassCount = static_cast<uint32_t>(m_Passes.size()) - m_Stats.PassCount;
+		m_Stats.BarrierCount += static_cast<uint32_t>(m_FinalBarriers.size());
+		m_Stats.PipelineBarrierCount += m_FinalBarriers.empty() ? 0 : 1;
+
+		Log::Info(LogCategory::Renderer, "Compiled render graph for {}x{}\n{}", extent.width, extent.height, Dump());
+	}
+
+	void VulkanRenderGraph::Execute(VkCommandBuffer commandBuffer)
+	{
+		for (auto& pass : m_Passes)
+		{
+			if (pass.Culled)
+				continue;
+
+			BRICKENGINE_PROFILE_SCOPE(pass.Name.c_str());
+			// Around the render pass, timestamps can't be written inside one that executes secondary command buffers
+			uint32_t gpuScope = m_GpuProfiler ? m_GpuProfiler->BeginScope(commandBuffer, pass.Name.c_str()) : VulkanGpuProfiler::InvalidScope;
+
+			RecordBarriers(commandBuffer, pass.Barriers);
+			if (pass.Type == VulkanGraphPassType::Compute)
+				pass.Execute(commandBuffer);
+			else
+			{
+				m_ClearValues.clear();
+				for (auto& attachment : pass.ColorAttachments)
+					m_ClearValues.push_back(attachment.ClearValue);
+				if (pass.DepthAttachment.Resource != InvalidResource)
+					m_ClearValues.push_back(pass.DepthAttachment.ClearValue);
+
+				VkRenderPassBeginInfo renderPassBeginInfo = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+				renderPassBeginInfo.renderPass = pass.RenderPass;
+				renderPassBeginInfo.framebuffer = GetFramebuffer(pass);
+				renderPassBeginInfo.renderArea.offset = { 0, 0 };
+				renderPassBeginInfo.renderArea.extent = m_Extent;
+				renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(m_ClearValues.size());
+				renderPassBeginInfo.pClearValues = m_ClearValues.data();
+				vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, pass.Contents);
+				pass.Execute(commandBuffer);
+				vkCmdEndRenderPass(commandBuffer);
+			}
+
+			if (m_GpuProfiler)
+				m_GpuProfiler->EndScope(commandBuffer, gpuScope);
+		}
+
+		RecordBarriers(commandBuffer, m_FinalBarriers);
+	}
+
+	std::string VulkanRenderGraph::Dump() const
+	{
+		std::ostringstream out;
+		out << "Render graph: " << m_Stats.PassCount << " passes, " << m_Stats.CulledPassCount << " culled, "
+			<< m_Stats.BarrierCount << " barriers in " << m_Stats.PipelineBarrierCount << " pipeline barriers\n";
+
+		auto dumpBarriers = [&](const std::vector<Barrier>& barriers)
+			{
+				for (auto& barrier : barriers)
+				{
+					const Resource& resource = m_Resources[barrier.Resource];
+					out << "    barrier " << resource.Name << " stages 0x" << std::hex << barrier.SourceStages << " -> 0x" << barrier.DestinationStages
+						<< " access 0x" << barrier.SourceAccess << " -> 0x" << barrier.DestinationAccess << std::dec;
+					if (resource.IsImage)
+						out << " layout " << GetLayoutName(barrier.OldLayout) << " -> " << GetLayoutName(barrier.NewLayout);
+					out << "\n";
+				}
+			};
+
+		for (size_t i = 0; i < m_Passes.size(); i++)
+		{
+			const Pass& pass = m_Passes[i];
+			out << "  [" << i << "] " << pass.Name << (pass.Type == VulkanGraphPassType::Graphics ? " (graphics)" : " (compute)");
+			if (pass.Culled)
+			{
+				out << " culled\n";
+				continue;
+			}
+			out << "\n";
+			dumpBarriers(pass.Barriers);
+		}
+		if (!m_FinalBarriers.empty())
+		{
+			out << "  final\n";
+			dumpBarriers(m_FinalBarriers);
+		}
+
+		for (auto& resource : m_Resources)
+		{
+			if (!resource.Used || resource.Imported)
+				continue;
+			out << "  transient " << resource.Name << " slot " << resource.Slot << ", " << resource.MemoryRequirements.size / 1024 << " KiB, passes "
+				<< resource.FirstPass << "-" << resource.LastPass << "\n";
+		}
+
+		VkDeviceSize saved = m_Stats.TransientBytes - m_Stats.AllocatedBytes;
+		out << "  transient memory: " << m_Stats.TransientBytes / 1024 << " KiB requested, " << m_Stats.AllocatedBytes / 1024 << " KiB allocated in "
+			<< m_MemorySlots.size() << " slots, " << saved / 1024 << " KiB saved by aliasing";
+		return out.str();
+	}
+
+	VulkanRenderGraph::UsageInfo VulkanRenderGraph::GetUsageInfo(VulkanGraphUsage usage, bool write)
+	{
+		switch (usage)
+		{
+			case VulkanGraphUsage::ColorAttachment:
+				return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, write ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT : VK_ACCESS_COLOR_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+			case VulkanGraphUsage::DepthAttachment:
+				// Depth testing reads the attachment even when the pass only writes it
+				return { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+					static_cast<VkAccessFlags>(VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | (write ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT : 0)), VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+			case VulkanGraphUsage::SampledFragment:
+				return { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+			case VulkanGraphUsage::SampledCompute:
+				return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+			case VulkanGraphUsage::StorageCompute:
+				return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, write ? VK_ACCESS_SHADER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL };
+			case VulkanGraphUsage::IndirectBuffer:
+				return { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED };
+			case VulkanGraphUsage::VertexShaderStorage:
+				return { VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, write ? VK_ACCESS_SHADER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL };
+			case VulkanGraphUsage::TransferSource:
+				return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+			case VulkanGraphUsage::TransferDestination:
+				return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+			case VulkanGraphUsage::Present:
+				// Presentation waits on a semaphore, the barrier only has to change the layout
+				return { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR };
+		}
+
+		BRICKENGINE_ASSERT(false);
+		return {};
+	}
+
+	VkImageUsageFlags VulkanRenderGraph::GetImageUsage(VulkanGraphUsage usage)
+	{
+		switch (usage)
+		{
+			case VulkanGraphUsage::ColorAttachment: return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+			case VulkanGraphUsage::DepthAttachment: return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+			case VulkanGraphUsage::SampledFragment:
+			case VulkanGraphUsage::SampledCompute: return VK_IMAGE_USAGE_SAMPLED_BIT;
+			case VulkanGraphUsage::StorageCompute:
+			case VulkanGraphUsage::VertexShaderStorage: return VK_IMAGE_USAGE_STORAGE_BIT;
+			case VulkanGraphUsage::TransferSource: return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+			case VulkanGraphUsage::TransferDestination: return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+			default: return 0;
+		}
+	}
+
+	void VulkanRenderGraph::Destroy()
+	{
+		std::vector<VkFramebuffer> framebuffers;
+		std::vector<VkRenderPass> renderPasses;
+		for (auto& pass : m_Passes)
+		{
+			for (auto& framebuffer : pass.Framebuffers)
+				framebuffers.push_back(framebuffer.Framebuffer);
+			pass.Framebuffers.clear();
+			if (pass.RenderPass)
+				renderPasses.push_back(pass.RenderPass);
+			pass.RenderPass = nullptr;
+			pass.Barriers.clear();
+			pass.Culled = false;
+		}
+
+		std::vector<VkImageView> imageViews;
+		std::vector<VkImage> images;
+		for (auto& resource : m_Resources)
+		{
+			if (!resource.Imported && resource.Image)
+			{
+				imageViews.push_back(resource.View);
+				images.push_back(resource.Image);
+				resource.Image = nullptr;
+				resource.View = nullptr;
+			}
+			resource.Used = false;
+		}
+
+		std::vector<VulkanAllocation*> allocations;
+		for (auto& slot : m_MemorySlots)
+			allocations.push_back(slot.Allocation);
+		m_MemorySlots.clear();
+		m_FinalBarriers.clear();
+
+		bool empty = framebuffers.empty() && renderPasses.empty() && images.empty() && allocations.empty();
+
+		auto destroy = [device = m_Device, allocator = m_Allocator, framebuffers = std::move(framebuffers), renderPasses = std::move(renderPasses),
+			imageViews = std::move(imageViews), images = std::move(images), allocations = std::move(allocations)]()
+			{
+				for (auto& framebuffer : framebuffers)
+					vkDestroyFramebuffer(device, framebuffer, nullptr);
+				for (auto& renderPass : renderPasses)
+					vkDestroyRenderPass(device, renderPass, nullptr);
+				for (auto& imageView : imageViews)
+					vkDestroyImageView(device, imageView, nullptr);
+				for (auto& image : images)
+					vkDestroyImage(device, image, nullptr);
+				for (auto& allocation : allocations)
+					allocator->Free(allocation);
+			};
+
+		// The new images are allocated before these are freed, a resize briefly needs the transient memory twice
+		if (m_Retire && !empty)
+			m_Retire(std::move(destroy));
+		else
+			destroy();
+	}
+
+	void VulkanRenderGraph::CullPasses()
+	{
+		// Walks the passes backwards, a pass is needed when it writes something a later needed pass reads or an output
+		std::vector<bool> needed(m_Resources.size(), false);
+		for (size_t i = 0; i < m_Resources.size(); i++)
+			needed[i] = m_Resources[i].Output;
+
+		for (size_t i = m_Passes.size(); i-- > 0;)
+		{
+			Pass& pass = m_Passes[i];
+			bool alive = pass.SideEffects;
+			for (auto& access : pass.Accesses)
+				alive |= access.Write && needed[access.Resource];
+
+			pass.Culled = !alive;
+			if (pass.Culled)
+				continue;
+			for (auto& access : pass.Accesses)
+			{
+				if (!access.Write)
+					needed[access.Resource] = true;
+			}
+		}
+
+		for (uint32_t i = 0; i < m_Passes.size(); i++)
+		{
+			if (m_Passes[i].Culled)
+				continue;
+			for (auto& access : m_Passes[i].Accesses)
+			{
+				Resource& resource = m_Resources[access.Resource];
+				if (!resource.Used)
+					resource.FirstPass = i;
+				resource.LastPass = i;
+				resource.Used = true;
+			}
+		}
+
+		// Outputs live until the end of the frame
+		for (auto& resource : m_Resources)
+		{
+			if (resource.Output && resource.Used)
+				resource.LastPass = static_cast<uint32_t>(m_Passes.size());
+		}
+	}
+
+	void VulkanRenderGraph::CreateTransientImages(VkExtent2D extent)
+	{
+		std::vector<VulkanGraphResource> transients;
+		for (uint32_t i = 0; i < m_Resources.size(); i++)
+		{
+			Resource& resource = m_Resources[i];
+			if (!resource.Used || resource.Imported)
+				continue;
+			BRICKENGINE_ASSERT(resource.IsImage && !resource.Output);
+
+			VkImageUsageFlags usage = 0;
+			for (auto& pass : m_Passes)
+			{
+				if (pass.Culled)
+					continue;
+				for (auto& access : pass.Accesses)
+				{
+					if (access.Resource == i)
+						usage |= GetImageUsage(access.Usage);
+				}
+			}
+
+			VkExtent2D imageExtent = resource.Description.Extent.width > 0 ? resource.Description.Extent : extent;
+
+			VkImageCreateInfo imageCreateInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+			imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageCreateInfo.format = resource.Description.Format;
+			imageCreateInfo.extent = { imageExtent.width, imageExtent.height, 1 };
+			imageCreateInfo.mipLevels = 1;
+			imageCreateInfo.arrayLayers = 1;
+			imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageCreateInfo.usage = usage;
+			imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VK_CHECK(vkCreateImage(m_Device, &imageCreateInfo, nullptr, &resource.Image));
+			vkGetImageMemoryRequirements(m_Device, resource.Image, &resource.MemoryRequirements);
+
+			transients.push_back(i);
+			m_Stats.TransientImageCount++;
+			m_Stats.TransientBytes += resource.MemoryRequirements.size;
+		}
+
+		// Largest first, smaller images then fill the slots the large ones leave free at other points of the frame
+		std::sort(transients.begin(), transients.end(), [&](VulkanGraphResource a, VulkanGraphResource b)
+			{
+				return m_Resources[a].MemoryRequirements.size > m_Resources[b].MemoryRequirements.size;
+			}
+		);
+
+		for (VulkanGraphResource index : transients)
+		{
+			Resource& resource = m_Resources[index];
+			const VkMemoryRequirements& requirements = resource.MemoryRequirements;
+
+			auto it = std::find_if(m_MemorySlots.begin(), m_MemorySlots.end(), [&](const MemorySlot& slot)
+				{
+					if ((slot.Requirements.memoryTypeBits & requirements.memoryTypeBits) == 0)
+						return false;
+					for (VulkanGraphResource other : slot.Images)
+					{
+						if (resource.FirstPass <= m_Resources[other].LastPass && m_Resources[other].FirstPass <= resource.LastPass)
+							return false;
+					}
+					return true;
+				}
+			);
+
+			if (it == m_MemorySlots.end())
+			{
+				MemorySlot& slot = m_MemorySlots.emplace_back();
+				slot.Requirements = requirements;
+				it = m_MemorySlots.end() - 1;
+			}
+
+			it->Requirements.size = std::max(it->Requirements.size, requirements.size);
+			it->Requirements.alignment = std::max(it->Requirements.alignment, requirements.alignment);
+			it->Requirements.memoryTypeBits &= requirements.memoryTypeBits;
+			it->Images.push_back(index);
+			resource.Slot = static_cast<uint32_t>(it - m_MemorySlots.begin());
+		}
+
+		for (auto& slot : m_MemorySlots)
+		{
+			slot.Allocation = m_Allocator->Allocate(slot.Requirements, VulkanMemoryUsage::GPUOnly, false);
+			BRICKENGINE_ASSERT(slot.Allocation);
+			m_Stats.AllocatedBytes += slot.Requirements.size;
+
+			for (VulkanGraphResource index : slot.Images)
+			{
+				Resource& resource = m_Resources[index];
+				VK_CHECK(vkBindImageMemory(m_Device, resource.Image, slot.Allocation->Memory, slot.Allocation->Offset));
+
+				VkImageViewCreateInfo imageViewCreateInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+				imageViewCreateInfo.image = resource.Image;
+				imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+				imageViewCreateInfo.format = resource.Description.Format;
+				imageViewCreateInfo.subresourceRange.aspectMask = resource.Description.Aspect;
+				imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+				imageViewCreateInfo.subresourceRange.levelCount = 1;
+				imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+				imageViewCreateInfo.subresourceRange.layerCount = 1;
+				VK_CHECK(vkCreateImageView(m_Device, &imageViewCreateInfo, nullptr, &resource.View));
+			}
+		}
+	}
+
+	void VulkanRenderGraph::PlanBarriers()
+	{
+		// What the planner knows about a resource at the current point of the frame
+		struct State
+		{
+			// Last write, or the layout transition that last changed the contents
+			VkPipelineStageFlags WriteStages = 0;
+			VkAccessFlags WriteAccess = 0;
+			// Reads since the last write, a following write has to wait on them
+			VkPipelineStageFlags ReadStages = 0;
+			// Stages and accesses the last write was already made visible to
+			VkPipelineStageFlags VisibleStages = 0;
+			VkAccessFlags VisibleAccess = 0;
+			VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		};
+
+		// A pass may access a resource several ways, they are merged into one barrier
+		struct PassAccess
+		{
+			VulkanGraphResource Resource = 0;
+			UsageInfo Info = {};
+			bool Write = false;
+		};
+
+		std::vector<State> states(m_Resources.size());
+
+		// Every pass of the frame uses a slot, the first use of an aliased image waits on all of it, which also covers the previous frame
+		for (auto& pass : m_Passes)
+		{
+			if (pass.Culled)
+				continue;
+			for (auto& access : pass.Accesses)
+			{
+				const Resource& resource = m_Resources[access.Resource];
+				UsageInfo info = GetUsageInfo(access.Usage, access.Write);
+				if (!resource.Imported)
+				{
+					m_MemorySlots[resource.Slot].Stages |= info.Stages;
+					m_MemorySlots[resource.Slot].WriteAccess |= access.Write ? info.Access : 0;
+				}
+				else if (!resource.IsImage)
+				{
+					// Imported buffers are used the same way every frame, so the frame starts where the previous one ended
+					State& state = states[access.Resource];
+					(access.Write ? state.WriteStages : state.ReadStages) |= info.Stages;
+					state.WriteAccess |= access.Write ? info.Access : 0;
+				}
+			}
+		}
+
+		for (uint32_t i = 0; i < m_Resources.size(); i++)
+		{
+			const Resource& resource = m_Resources[i];
+			State& state = states[i];
+			if (!resource.Used)
+				continue;
+
+			if (!resource.Imported)
+			{
+				state.WriteStages = m_MemorySlots[resource.Slot].Stages;
+				state.WriteAccess = m_MemorySlots[resource.Slot].WriteAccess;
+			}
+			else if (resource.IsImage)
+			{
+				state.WriteStages = resource.InitialStages;
+				state.Layout = resource.InitialLayout;
+			}
+			else if (resource.Output)
+			{
+				state.ReadStages |= GetUsageInfo(resource.FinalUsage, false).Stages;
+			}
+		}
+
+		auto plan = [&](const PassAccess& access, std::vector<Barrier>& barriers)
+			{
+				const Resource& resource = m_Resources[access.Resource];
+				State& state = states[access.Resource];
+				bool layoutChange = resource.IsImage && access.Info.Layout != state.Layout;
+
+				Barrier barrier;
+				barrier.Resource = access.Resource;
+				barrier.DestinationStages = access.Info.Stages;
+				barrier.DestinationAccess = access.Info.Access;
+				barrier.OldLayout = layoutChange ? state.Layout : access.Info.Layout;
+				barrier.NewLayout = access.Info.Layout;
+				// Transient contents are never carried over, everything starts from scratch
+				if (layoutChange && !resource.Imported)
+					barrier.OldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+				if (access.Write || layoutChange)
+				{
+					// Write after read, write after write and layout transitions wait on everything since the last write
+					barrier.SourceStages = state.WriteStages | state.ReadStages;
+					barrier.SourceAccess = state.WriteAccess;
+					if (barrier.SourceStages != 0 || layoutChange)
+						barriers.push_back(barrier);
+
+					state.WriteStages = access.Info.Stages;
+					state.WriteAccess = access.Write ? access.Info.Access : 0;
+					state.ReadStages = access.Write ? 0 : access.Info.Stages;
+					// A layout transition is visible to the barrier's destination, written data to nobody yet
+					state.VisibleStages = access.Write ? 0 : access.Info.Stages;
+					state.VisibleAccess = access.Write ? 0 : access.Info.Access;
+					state.Layout = access.Info.Layout;
+					return;
+				}
+
+				// Read after write, only when the stages or accesses didn't already see the write
+				if (state.WriteStages != 0 && ((access.Info.Stages & ~state.VisibleStages) != 0 || (access.Info.Access & ~state.VisibleAccess) != 0))
+				{
+					barrier.SourceStages = state.WriteStages;
+					barrier.SourceAccess = state.WriteAccess;
+					barriers.push_back(barrier);
+					state.VisibleStages |= access.Info.Stages;
+					state.VisibleAccess |= access.Info.Access;
+				}
+				state.ReadStages |= access.Info.Stages;
+			};
+
+		std::vector<PassAccess> passAccesses;
+		for (auto& pass : m_Passes)
+		{
+			if (pass.Culled)
+				continue;
+
+			passAccesses.clear();
+			for (auto& access : pass.Accesses)
+			{
+				UsageInfo info = GetUsageInfo(access.Usage, access.Write);
+				auto it = std::find_if(passAccesses.begin(), passAccesses.end(), [&](const PassAccess& other) { return other.Resource == access.Resource; });
+				if (it == passAccesses.end())
+				{
+					passAccesses.push_back({ access.Resource, info, access.Write });
+					continue;
+				}
+
+				BRICKENGINE_ASSERT(!m_Resources[access.Resource].IsImage || it->Info.Layout == info.Layout);
+				it->Info.Stages |= info.Stages;
+				it->Info.Access |= info.Access;
+				it->Write |= access.Write;
+			}
+
+			for (auto& access : passAccesses)
+				plan(access, pass.Barriers);
+		}
+
+		for (uint32_t i = 0; i < m_Resources.size(); i++)
+		{
+			const Resource& resource = m_Resources[i];
+			if (resource.Output && resource.Used)
+				plan({ i, GetUsageInfo(resource.FinalUsage, false), false }, m_FinalBarriers);
+		}
+	}
+
+	void VulkanRenderGraph::CreateRenderPass(Pass& pass)
+	{
+		uint32_t passIndex = static_cast<uint32_t>(&pass - m_Passes.data());
+
+		std::vector<VkAttachmentDescription> attachments;
+		std::vector<VkAttachmentReference> colorReferences;
+		VkAttachmentReference depthReference = {};
+
+		auto addAttachment = [&](const Attachment& attachment, VkImageLayout layout)
+			{
+				const Resource& resource = m_Resources[attachment.Resource];
+				// Stored only when something after this pass still looks at it
+				bool store = resource.Imported || resource.Output || resource.LastPass > passIndex;
+
+				VkAttachmentDescription& description = attachments.emplace_back();
+				description.format = resource.Description.Format;
+				description.samples = VK_SAMPLE_COUNT_1_BIT;
+				description.loadOp = attachment.LoadOp;
+				description.storeOp = store ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				// The graph's barriers do the transitions, the render pass keeps the layout
+				description.initialLayout = layout;
+				description.finalLayout = layout;
+				return VkAttachmentReference{ static_cast<uint32_t>(attachments.size() - 1), layout };
+			};
+
+		for (auto& attachment : pass.ColorAttachments)
+			colorReferences.push_back(addAttachment(attachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+		if (pass.DepthAttachment.Resource != InvalidResource)
+			depthReference = addAttachment(pass.DepthAttachment, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+
+		VkSubpassDescription subpass = {};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+		subpass.pColorAttachments = colorReferences.data();
+		subpass.pDepthStencilAttachment = pass.DepthAttachment.Resource != InvalidResource ? &depthReference : nullptr;
+
+		VkRenderPassCreateInfo renderPassCreateInfo = { VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO };
+		renderPassCreateInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+		renderPassCreateInfo.pAttachments = attachments.data();
+		renderPassCreateInfo.subpassCount = 1;
+		renderPassCreateInfo.pSubpasses = &subpass;
+		VK_CHECK(vkCreateRenderPass(m_Device, &renderPassCreateInfo, nullptr, &pass.RenderPass));
+	}
+
+	VkFramebuffer VulkanRenderGraph::GetFramebuffer(Pass& pass)
+	{
+		// Imported attachments change every frame, one framebuffer per combination of views is kept
+		m_FramebufferViews.clear();
+		for (auto& attachment : pass.ColorAttachments)
+			m_FramebufferViews.push_back(m_Resources[attachment.Resource].View);
+		if (pass.DepthAttachment.Resource != InvalidResource)
+			m_FramebufferViews.push_back(m_Resources[pass.DepthAttachment.Resource].View);
+
+		for (auto& framebuffer : pass.Framebuffers)
+		{
+			if (framebuffer.Views == m_FramebufferViews)
+				return framebuffer.Framebuffer;
+		}
+
+		for (VkImageView view : m_FramebufferViews)
+			BRICKENGINE_ASSERT(view);
+
+		CachedFramebuffer& framebuffer = pass.Framebuffers.emplace_back();
+		framebuffer.Views = m_FramebufferViews;
+
+		VkFramebufferCreateInfo framebufferCreateInfo = { VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO };
+		framebufferCreateInfo.renderPass = pass.RenderPass;
+		framebufferCreateInfo.attachmentCount = static_cast<uint32_t>(framebuffer.Views.size());
+		framebufferCreateInfo.pAttachments = framebuffer.Views.data();
+		framebufferCreateInfo.width = m_Extent.width;
+		framebufferCreateInfo.height = m_Extent.height;
+		framebufferCreateInfo.layers = 1;
+		VK_CHECK(vkCreateFramebuffer(m_Device, &framebufferCreateInfo, nullptr, &framebuffer.Framebuffer));
+		return framebuffer.Framebuffer;
+	}
+
+	void VulkanRenderGraph::RecordBarriers(VkCommandBuffer commandBuffer, const std::vector<Barrier>& barriers)
+	{
+		if (barriers.empty())
+			return;
+
+		m_ImageBarriers.clear();
+		m_BufferBarriers.clear();
+		VkPipelineStageFlags sourceStages = 0;
+		VkPipelineStageFlags destinationStages = 0;
+		for (auto& barrier : barriers)
+		{
+			const Resource& resource = m_Resources[barrier.Resource];
+			sourceStages |= barrier.SourceStages;
+			destinationStages |= barrier.DestinationStages;
+
+			if (!resource.IsImage)
+			{
+				VkBufferMemoryBarrier& bufferBarrier = m_BufferBarriers.emplace_back();
+				bufferBarrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+				bufferBarrier.srcAccessMask = barrier.SourceAccess;
+				bufferBarrier.dstAccessMask = barrier.DestinationAccess;
+				bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				bufferBarrier.buffer = resource.Buffer;
+				bufferBarrier.offset = 0;
+				bufferBarrier.size = VK_WHOLE_SIZE;
+				continue;
+			}
+
+			BRICKENGINE_ASSERT(resource.Image);
+			VkImageMemoryBarrier& imageBarrier = m_ImageBarriers.emplace_back();
+			imageBarrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			imageBarrier.srcAccessMask = barrier.SourceAccess;
+			imageBarrier.dstAccessMask = barrier.DestinationAccess;
+			imageBarrier.oldLayout = barrier.OldLayout;
+			imageBarrier.newLayout = barrier.NewLayout;
+			imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.image = resource.Image;
+			imageBarrier.subresourceRange.aspectMask = resource.Description.Aspect;
+			imageBarrier.subresourceRange.baseMipLevel = 0;
+			imageBarrier.subresourceRange.levelCount = 1;
+			imageBarrier.subresourceRange.baseArrayLayer = 0;
+			imageBarrier.subresourceRange.layerCount = 1;
+		}
+
+		if (sourceStages == 0)
+			sourceStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, sourceStages, destinationStages, 0, 0, nullptr,
+			static_cast<uint32_t>(m_BufferBarriers.size()), m_BufferBarriers.data(), static_cast<uint32_t>(m_ImageBarriers.size()), m_ImageBarriers.data());
+	}
+
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanPlatform.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanMemoryAllocator.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanGpuProfiler.hpp"
+
+namespace BrickEngine {
+
+	using VulkanGraphResource = uint32_t;
+	using VulkanGraphPass = uint32_t;
+
+	// How a pass accesses a resource, decides the stages, access flags and image layout barriers are built from
+	enum class VulkanGraphUsage : uint8_t
+	{
+		ColorAttachment,
+		DepthAttachment,
+		SampledFragment,
+		SampledCompute,
+		StorageCompute,
+		IndirectBuffer,
+		VertexShaderStorage,
+		TransferSource,
+		TransferDestination,
+		Present
+	};
+
+	enum class VulkanGraphPassType : uint8_t
+	{
+		// Recorded inside a render pass built from the pass' attachments
+		Graphics,
+		// Compute and transfer work, recorded outside any render pass
+		Compute
+	};
+
+	// Images created by the graph, they only live within a frame and share memory when their lifetimes don't overlap
+	struct VulkanGraphImageDescription
+	{
+		VkFormat Format = VK_FORMAT_UNDEFINED;
+		// Zero takes the extent passed to Compile
+		VkExtent2D Extent = {};
+		VkImageAspectFlags Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+	};
+
+	struct VulkanRenderGraphStats
+	{
+		uint32_t PassCount = 0;
+		uint32_t CulledPassCount = 0;
+		// Barriers recorded per frame, every image and buffer barrier counts
+		uint32_t BarrierCount = 0;
+		uint32_t PipelineBarrierCount = 0;
+		uint32_t TransientImageCount = 0;
+		// Memory the transient images would need without aliasing and what they actually got
+		VkDeviceSize TransientBytes = 0;
+		VkDeviceSize AllocatedBytes = 0;
+	};
+
+	// Frame render graph. Passes declare the resources they read and write in execution order, Compile then culls
+	// passes nothing depends on, places transient images so images with disjoint lifetimes alias the same memory and
+	// plans the pipeline barriers between the passes. Execute only records what was planned. Resources keep their
+	// declared layouts between frames, so the plan stays valid until the graph is compiled again. Not thread safe.
+	class VulkanRenderGraph
+	{
+	public:
+		using ExecuteFunction = std::function<void(VkCommandBuffer)>;
+		// Receives a function destroying what the previous compile created, to be run once no recorded frame uses it
+		using RetireFunction = std::function<void(std::function<void()>)>;
+
+		static constexpr VulkanGraphResource InvalidResource = std::numeric_limits<VulkanGraphResource>::max();
+
+		VulkanRenderGraph(VkDevice device, VulkanMemoryAllocator* allocator);
+		~VulkanRenderGraph();
+
+		VulkanRenderGraph(const VulkanRenderGraph&) = delete;
+		VulkanRenderGraph& operator=(const VulkanRenderGraph&) = delete;
+
+		VulkanGraphResource CreateImage(const std::string& name, const VulkanGraphImageDescription& description);
+		// The image and view are set per frame with SetImportedImage. initialStages are the stages whatever hands the image
+		// to the graph waits at, like the wait stage of the swapchain acquire semaphore.
+		VulkanGraphResource ImportImage(const std::string& name, VkFormat format, VkImageAspectFlags aspect, VkPipelineStageFlags initialStages, VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+		VulkanGraphResource ImportBuffer(const std::string& name, VkBuffer buffer);
+		void SetImportedImage(VulkanGraphResource resource, VkImage image, VkImageView view);
+
+		// Outputs are what keeps passes alive, finalUsage is the state the resource is left in at the end of the frame
+		void MarkOutput(VulkanGraphResource resource, VulkanGraphUsage finalUsage);
+
+		// Passes run in the order they were added. contents applies to graphics passes only.
+		VulkanGraphPass AddPass(const std::string& name, VulkanGraphPassType type, ExecuteFunction execute, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+		void Read(VulkanGraphPass pass, VulkanGraphResource resource, VulkanGraphUsage usage);
+		void Write(VulkanGraphPass pass, VulkanGraphResource resource, VulkanGraphUsage usage);
+		// Attachments in the order the render pass lists them, colors before the depth attachment. Loading reads the attachment.
+		void SetColorAttachment(VulkanGraphPass pass, VulkanGraphResource resource, VkAttachmentLoadOp loadOp, VkClearColorValue clearColor = {});
+		void SetDepthAttachment(VulkanGraphPass pass, VulkanGraphResource resource, VkAttachmentLoadOp loadOp, float clearDepth = 1.0f);
+		// Never culled, for passes whose results leave the graph some other way
+		void SetSideEffects(VulkanGraphPass pass);
+
+		// Destroys what the last compile created, the device has to be idle unless a retire function was set
+		void Compile(VkExtent2D extent);
+		void Execute(VkCommandBuffer commandBuffer);
+		// Times every pass Execute records on the GPU, nullptr stops it
+		void SetGpuProfiler(VulkanGpuProfiler* profiler) { m_GpuProfiler = profiler; }
+		void SetRetireFunction(RetireFunction retire) { m_Retire = std::move(retire); }
+
+		// Render pass of a compiled graphics pass, nullptr for culled ones
+		VkRenderPass GetRenderPass(VulkanGraphPass pass) const { return m_Passes[pass].RenderPass; }
+		bool IsCulled(VulkanGraphPass pass) const { return m_Passes[pass].Culled; }
+		const VulkanRenderGraphStats& GetStats() const { return m_Stats; }
+		// Passes, barriers and transient memory of the last compile in a readable form
+		std::string Dump() const;
+	private:
+		struct Access
+		{
+			VulkanGraphResource Resource = 0;
+			VulkanGraphUsage Usage = VulkanGraphUsage::ColorAttachment;
+			bool Write = false;
+		};
+
+		struct Attachment
+		{
+			VulkanGraphResource Resource = 0;
+			VkAttachmentLoadOp LoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			VkClearValue ClearValue = {};
+		};
+
+		struct Barrier
+		{
+			VulkanGraphResource Resource = 0;
+			VkPipelineStageFlags SourceStages = 0;
+			VkAccessFlags SourceAccess = 0;
+			VkPipelineStageFlags DestinationStages = 0;
+			VkAccessFlags DestinationAccess = 0;
+			VkImageLayout OldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkImageLayout NewLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		};
+
+		struct CachedFramebuffer
+		{
+			std::vector<VkImageView> Views = {};
+			VkFramebuffer Framebuffer = nullptr;
+		};
+
+		struct Pass
+		{
+			std::string Name = {};
+			VulkanGraphPassType Type = VulkanGraphPassType::Graphics;
+			ExecuteFunction Execute = {};
+			VkSubpassContents Contents = VK_SUBPASS_CONTENTS_INLINE;
+			std::vector<Access> Accesses = {};
+			std::vector<Attachment> ColorAttachments = {};
+			Attachment DepthAttachment = { InvalidResource };
+			bool SideEffects = false;
+
+			// Set by Compile
+			bool Culled = false;
+			std::vector<Barrier> Barriers = {};
+			VkRenderPass RenderPass = nullptr;
+			std::vector<CachedFramebuffer> Framebuffers = {};
+		};
+
+		struct Resource
+		{
+			std::string Name = {};
+			bool IsImage = true;
+			bool Imported = false;
+			VulkanGraphImageDescription Description = {};
+			VkPipelineStageFlags InitialStages = 0;
+			VkImageLayout InitialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			bool Output = false;
+			VulkanGraphUsage FinalUsage = VulkanGraphUsage::ColorAttachment;
+
+			VkImage Image = nullptr;
+			VkImageView View = nullptr;
+			VkBuffer Buffer = nullptr;
+
+			// Set by Compile, passes are indices into m_Passes
+			uint32_t FirstPass = 0;
+			uint32_t LastPass = 0;
+			bool Used = false;
+			// Index into m_MemorySlots, transient images only
+			uint32_t Slot = 0;
+			VkMemoryRequirements MemoryRequirements = {};
+		};
+
+		// Memory shared by transient images whose lifetimes don't overlap
+		struct MemorySlot
+		{
+			VkMemoryRequirements Requirements = {};
+			VulkanAllocation* Allocation = nullptr;
+			std::vector<VulkanGraphResource> Images = {};
+			// Everything done to the slot's images, the first use of each image waits on it as the previous contents are discarded
+			VkPipelineStageFlags Stages = 0;
+			VkAccessFlags WriteAccess = 0;
+		};
+
+		struct UsageInfo
+		{
+			VkPipelineStageFlags Stages = 0;
+			VkAccessFlags Access = 0;
+			VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		};
+
+		static UsageInfo GetUsageInfo(VulkanGraphUsage usage, bool write);
+		static VkImageUsageFlags GetImageUsage(VulkanGraphUsage usage);
+
+		void Destroy();
+		void CullPasses();
+		void CreateTransientImages(VkExtent2D extent);
+		void PlanBarriers();
+		void CreateRenderPass(Pass& pass);
+		VkFramebuffer GetFramebuffer(Pass& pass);
+		void RecordBarriers(VkCommandBuffer commandBuffer, const std::vector<Barrier>& barriers);
+	private:
+		VkDevice m_Device = nullptr;
+		VulkanMemoryAllocator* m_Allocator = nullptr;
+		VulkanGpuProfiler* m_GpuProfiler = nullptr;
+		RetireFunction m_Retire = {};
+		VkExtent2D m_Extent = {};
+
+		std::vector<Pass> m_Passes = {};
+		std::vector<Resource> m_Resources = {};
+		std::vector<MemorySlot> m_MemorySlots = {};
+		// Moves the outputs into their final usage after the last pass
+		std::vector<Barrier> m_FinalBarriers = {};
+
+		VulkanRenderGraphStats m_Stats = {};
+
+		// Reused by Execute
+		std::vector<VkImageMemoryBarrier> m_ImageBarriers = {};
+		std::vector<VkBufferMemoryBarrier> m_BufferBarriers = {};
+		std::vector<VkClearValue> m_ClearValues = {};
+		std::vector<VkImageView> m_FramebufferViews = {};
+	};
+
+}
@@ -1,13 +1,6 @@
 #include "brickpch.hpp"
 #include "BrickEngine/Renderer/Vulkan/VulkanRenderer.hpp"
 
-#define VK_CHECK(x) { \
-	VkResult result = x; BRICKENGINE_ASSERT(result == VK_SUCCESS) \
-}
-
-#undef min
-#undef max
-
 namespace BrickEngine {
 
 	static VKAPI_ATTR VkBool32 VKAPI_CALL VulkanDebugCallback(
@@ -20,43 +13,61 @@ namespace BrickEngine {
 		{
 		default:
 		case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
-			Log::Trace(pCallbackData->pMessage);
+			Log::Trace(LogCategory::Renderer, "{}", pCallbackData->pMessage);
 			break;
 		case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
-			Log::Info(pCallbackData->pMessage);
+			Log::Info(LogCategory::Renderer, "{}", pCallbackData->pMessage);
 			break;
 		case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
-			Log::Warn(pCallbackData->pMessage);
+			Log::Warn(LogCategory::Renderer, "{}", pCallbackData->pMessage);
 			break;
 		case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT:
-			Log::Error(pCallbackData->pMessage);
+			Log::Error(LogCategory::Renderer, "{}", pCallbackData->pMessage);
 			break;
 		}
 
 		return VK_FALSE;
 	}
 
-	VulkanRenderer::VulkanRenderer(Window* window)
+	VulkanRenderer::VulkanRenderer(Window* window, uint32_t framesInFlight)
 		: m_Window(window)
 	{
-		std::vector<const char*> instanceExtentions = {
-#if defined(BRICKENGINE_PLATFORM_WINDOWS)
-		   VK_KHR_WIN32_SURFACE_EXTENSION_NAME,
-#else
-   #error Unsupported platform!
-#endif
-		   VK_KHR_SURFACE_EXTENSION_NAME
-		};
+		BRICKENGINE_ASSERT(m_Window);
+		Init(framesInFlight);
+	}
+
+	VulkanRenderer::VulkanRenderer(VkExtent2D extent, uint32_t framesInFlight)
+		: m_SwapchainExtent(extent)
+	{
+		BRICKENGINE_ASSERT(extent.width > 0 && extent.height > 0);
+		Init(framesInFlight);
+	}
+
+	void VulkanRenderer::Init(uint32_t framesInFlight)
+	{
+		std::vector<const char*> instanceExtentions;
+		std::vector<const char*> deviceExtentions;
+		if (m_Window)
+		{
+			instanceExtentions.push_back(VulkanPlatform::GetSurfaceExtensionName());
+			instanceExtentions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+			deviceExtentions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+		}
 		CreateInstance(instanceExtentions);
 		BRICKENGINE_ASSERT(m_Instance);
 
-		m_Surface = VulkanPlatform::CreateSurface(m_Instance, m_Window);
-		BRICKENGINE_ASSERT(m_Surface);
+		if (m_Window)
+		{
+			m_Surface = VulkanPlatform::CreateSurface(m_Instance, m_Window);
+			BRICKENGINE_ASSERT(m_Surface);
+		}
 
-		std::vector<const char*> deviceExtentions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
 		SelectPhysicalDevice(deviceExtentions);
 		BRICKENGINE_ASSERT(m_PhysicalDevice);
 
+		if (m_Features.CalibratedTimestamps)
+			deviceExtentions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+
 		CreateDevice(deviceExtentions);
 		BRICKENGINE_ASSERT(m_Device);
 
@@ -64,40 +75,127 @@ namespace BrickEngine {
 		BRICKENGINE_ASSERT(m_GraphicsQueue);
 		vkGetDeviceQueue(m_Device, m_PresentQueueFamilyIndex, 0, &m_PresentQueue);
 		BRICKENGINE_ASSERT(m_PresentQueue);
+		vkGetDeviceQueue(m_Device, m_TransferQueueFamilyIndex, 0, &m_TransferQueue);
+		BRICKENGINE_ASSERT(m_TransferQueue);
 
-		CreateShader("assets/shaders/main");
-		BRICKENGINE_ASSERT(m_ShaderStages.size() == 2);
+		m_Allocator = std::make_unique<VulkanMemoryAllocator>(m_PhysicalDevice, m_Device);
+		bool sharedTransferQueue = m_TransferQueue == m_GraphicsQueue || m_TransferQueue == m_PresentQueue;
+		m_UploadManager = std::make_unique<VulkanUploadManager>(m_PhysicalDevice, m_Device, m_Allocator.get(), m_TransferQueue, m_TransferQueueFamilyIndex, m_GraphicsQueueFamilyIndex, sharedTransferQueue ? &m_QueueMutex : nullptr);
 
-		OnWindowResize();
+		m_PipelineCache = std::make_unique<VulkanPipelineCache>(m_Device, m_PhysicalDevice, "pipeline_cache.bin");
+		m_ShaderCompiler = std::make_unique<VulkanShaderCompiler>("shader_cache");
+		m_LayoutCache = std::make_unique<VulkanLayoutCache>(m_Device);
+		m_PipelineLibrary = std::make_unique<VulkanPipelineLibrary>(m_Device, m_PipelineCache->Get(), m_ShaderCompiler.get(), m_LayoutCache.get());
+
+		if (m_Features.DescriptorIndexing)
+		{
+			// Images and buffers share the per stage resource limit
+			uint32_t sampledImages = std::min(BindlessSampledImages, m_Features.MaxBindlessSampledImages);
+			uint32_t storageBuffers = std::min(BindlessStorageBuffers, m_Features.MaxBindlessStorageBuffers);
+			if (sampledImages + storageBuffers > m_Features.MaxBindlessResources)
+			{
+				sampledImages = std::min(sampledImages, m_Features.MaxBindlessResources / 2);
+				storageBuffers = std::min(storageBuffers, m_Features.MaxBindlessResources - sampledImages);
+			}
+			uint32_t samplers = std::min(BindlessSamplers, m_Features.MaxBindlessSamplers);
+			m_BindlessHeap = std::make_unique<VulkanBindlessHeap>(this, m_Device, sampledImages, samplers, storageBuffers);
+		}
+		else
+		{
+			Log::Warn(LogCategory::Renderer, "Descriptor indexing isn't supported, falling back to pooled descriptor sets");
+		}
 
 		CreateRenderPass();
 		BRICKENGINE_ASSERT(m_RenderPass);
 
+		if (m_Window)
+			OnWindowResize();
+		else
+			CreateOffscreenImages(framesInFlight);
+
 		CreateGraphicsPipeline();
-		BRICKENGINE_ASSERT(m_PipelineLayout);
-		BRICKENGINE_ASSERT(m_Pipeline);
+		BRICKENGINE_ASSERT(m_BatchRenderer);
+
+		CreateRenderGraph();
+		BRICKENGINE_ASSERT(m_RenderGraph);
+
+		CreateFrames(framesInFlight);
+		BRICKENGINE_ASSERT(m_FrameTimeline);
+
+		if (Profiler::IsCompiledIn() && m_Features.TimestampValidBits > 0)
+		{
+			m_GpuProfiler = std::make_unique<VulkanGpuProfiler>(m_Instance, m_PhysicalDevice, m_Device, framesInFlight, m_Features.TimestampValidBits, m_Features.CalibratedTimestamps);
+			m_RenderGraph->SetGpuProfiler(m_GpuProfiler.get());
+		}
+
+#if defined(BRICKENGINE_ENABLE_SHADER_HOT_RELOAD)
+		m_ShaderReloader = std::make_unique<VulkanShaderReloader>(m_PipelineLibrary.get(), m_ShaderCompiler.get());
+#endif
 	}
 
 	VulkanRenderer::~VulkanRenderer()
 	{
+#if defined(BRICKENGINE_ENABLE_SHADER_HOT_RELOAD)
+		// Its thread may be creating pipelines
+		m_ShaderReloader.reset();
+#endif
 		VK_CHECK(vkDeviceWaitIdle(m_Device));
 
-		vkDestroyPipeline(m_Device, m_Pipeline, nullptr);
-		vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
+		for (auto& frame : m_Frames)
+		{
+			for (auto& threadCommandPool : frame.ThreadCommandPools)
+				vkDestroyCommandPool(m_Device, threadCommandPool.CommandPool, nullptr);
+			vkDestroyCommandPool(m_Device, frame.CommandPool, nullptr);
+			vkDestroySemaphore(m_Device, frame.ImageAvailableSemaphore, nullptr);
+			frame.TransientPool.reset();
+		}
+		vkDestroySemaphore(m_Device, m_FrameTimeline, nullptr);
+		m_GpuProfiler.reset();
+		m_RenderGraph.reset();
+
+		// The device is idle, whatever is left can go
+		for (auto& retired : m_RetiredObjects)
+			retired.Destroy();
+		m_RetiredObjects.clear();
+		m_MeshRenderer.reset();
+		m_BatchRenderer.reset();
+		m_BindlessHeap.reset();
+		m_UploadManager.reset();
+
+		m_PipelineLibrary.reset();
+		m_LayoutCache.reset();
+		m_ShaderCompiler.reset();
+		m_PipelineCache->Save();
+		m_PipelineCache.reset();
 
 		vkDestroyRenderPass(m_Device, m_RenderPass, nullptr);
 
+		if (m_ReadbackCommandPool)
+		{
+			vkDestroyCommandPool(m_Device, m_ReadbackCommandPool, nullptr);
+			vkDestroyBuffer(m_Device, m_ReadbackBuffer, nullptr);
+			m_Allocator->Free(m_ReadbackAllocation);
+		}
+
+		DestroySwapchainResources();
 		for (auto& imageView : m_SwapchainImageViews)
 			vkDestroyImageView(m_Device, imageView, nullptr);
 
-		vkDestroySwapchainKHR(m_Device, m_Swapchain, nullptr);
+		if (m_Swapchain)
+			vkDestroySwapchainKHR(m_Device, m_Swapchain, nullptr);
+		for (size_t i = 0; i < m_OffscreenAllocations.size(); i++)
+		{
+			vkDestroyImage(m_Device, m_SwapchainImages[i], nullptr);
+			m_Allocator->Free(m_OffscreenAllocations[i]);
+		}
 
-		for (auto& shaderModule : m_ShaderStages)
-			vkDestroyShaderModule(m_Device, shaderModule.module, nullptr);
+		m_Allocator->LogStats();
+		m_Allocator.reset();
 
 		vkDestroyDevice(m_Device, nullptr);
 
-		vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
+		if (m_Surface)
+			vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
 
 #if defined(BRICKENGINE_DEBUG)
 		PFN_vkDestroyDebugUtilsMessengerEXT vkDestroyDebugUtilsMessengerEXT = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(m_Instance, "vkDestroyDebugUtilsMessengerEXT");
@@ -110,8 +208,10 @@ namespace BrickEngine {
 
 	void VulkanRenderer::CreateInstance(std::vector<const char*>& requiredExtentions)
 	{
+		BRICKENGINE_PROFILE_FUNCTION();
+
 		VkApplicationInfo applicationInfo = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
-		applicationInfo.apiVersion = VK_API_VERSION_1_1;
+		applicationInfo.apiVersion = VK_API_VERSION_1_2;
 		applicationInfo.pEngineName = "BrickEngine";
 		applicationInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
 		applicationInfo.pApplicationName = "BrickEngine Application";
@@ -205,6 +305,8 @@ namespace BrickEngine {
 
 	void VulkanRenderer::SelectPhysicalDevice(std::vector<const char*>& requiredExtentions)
 	{
+		BRICKENGINE_PROFILE_FUNCTION();
+
 		uint32_t physicalDeviceCount = 0;
 		VK_CHECK(vkEnumeratePhysicalDevices(m_Instance, &physicalDeviceCount, nullptr));
 		std::vector<VkPhysicalDevice> physicalDevices(physicalDeviceCount);
@@ -212,25 +314,26 @@ namespace BrickEngine {
 
 		for (auto& physicalDevice : physicalDevices)
 		{
-			bool hasRequiredExtentions = [&]()
+			uint32_t physicalDeviceExtentionCount = 0;
+			VK_CHECK(vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &physicalDeviceExtentionCount, nullptr));
+			std::vector<VkExtensionProperties> physicalDeviceExtentions(physicalDeviceExtentionCount);
+			VK_CHECK(vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &physicalDeviceExtentionCount, physicalDeviceExtentions.data()));
+
+			auto hasExtention = [&](const char* name)
 			{
-				uint32_t physicalDeviceExtentionCount = 0;
-				VK_CHECK(vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &physicalDeviceExtentionCount, nullptr));
-				std::vector<VkExtensionProperties> physicalDeviceExtentions(physicalDeviceExtentionCount);
-				VK_CHECK(vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &physicalDeviceExtentionCount, physicalDeviceExtentions.data()));
+				for (auto& extention : physicalDeviceExtentions)
+				{
+					if (strcmp(extention.extensionName, name) == 0)
+						return true;
+				}
+				return false;
+			};
 
+			bool hasRequiredExtentions = [&]()
+			{
 				for (auto& requiredExtention : requiredExtentions)
 				{
-					bool hasExtention = false;
-					for (auto& extention : physicalDeviceExtentions)
-					{
-						if (strcmp(extention.extensionName, requiredExtention) == 0)
-						{
-							hasExtention = true;
-							break;
-						}
-					}
-					if (!hasExtention)
+					if (!hasExtention(requiredExtention))
 						return false;
 				}
 				return true;
@@ -251,8 +354,33 @@ namespace BrickEngine {
 				return -1;
 			}();
 
+			// Prefer a family that can only transfer, it maps to the copy engines which run alongside graphics work
+			uint32_t transferQueueFamilyIndex = [&]() -> uint32_t
+			{
+				uint32_t transferOnly = -1;
+				uint32_t nonGraphics = -1;
+				for (uint32_t i = 0; i < queueFamilyCount; i++)
+				{
+					VkQueueFlags flags = queueFamilyProperties[i].queueFlags;
+					if (!(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT))
+						continue;
+					if (!(flags & VK_QUEUE_COMPUTE_BIT) && transferOnly == static_cast<uint32_t>(-1))
+						transferOnly = i;
+					if (nonGraphics == static_cast<uint32_t>(-1))
+						nonGraphics = i;
+				}
+				if (transferOnly < queueFamilyCount)
+					return transferOnly;
+				if (nonGraphics < queueFamilyCount)
+					return nonGraphics;
+				return graphicsQueueFamilyIndex;
+			}();
+
+			// Headless renderers never present
 			uint32_t presentQueueFamilyIndex = [&]() -> uint32_t
 			{
+				if (!m_Surface)
+					return graphicsQueueFamilyIndex;
 				for (uint32_t i = 0; i < queueFamilyCount; i++)
 				{
 					VkBool32 supportsPresentation = VK_FALSE;
@@ -264,12 +392,23 @@ namespace BrickEngine {
 			}();
 
 			uint32_t surfaceFormatCount = 0;
-			VK_CHECK(vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, m_Surface, &surfaceFormatCount, nullptr));
+			if (m_Surface)
+				VK_CHECK(vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, m_Surface, &surfaceFormatCount, nullptr));
 			std::vector<VkSurfaceFormatKHR> surfaceFormats(surfaceFormatCount);
-			VK_CHECK(vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, m_Surface, &surfaceFormatCount, surfaceFormats.data()));
+			if (m_Surface)
+				VK_CHECK(vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, m_Surface, &surfaceFormatCount, surfaceFormats.data()));
 
 			VkSurfaceFormatKHR surfaceFormat = {};
-			if (surfaceFormatCount == 0 && surfaceFormats[0].format == VK_FORMAT_UNDEFINED)
+			if (!m_Surface)
+			{
+				// Headless images are rendered to and then copied out for readback
+				VkFormatProperties formatProperties;
+				vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R8G8B8A8_UNORM, &formatProperties);
+				VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_TRANSFER_SRC_BIT;
+				if ((formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures)
+					surfaceFormat = { VK_FORMAT_R8G8B8A8_UNORM, VK_COLORSPACE_SRGB_NONLINEAR_KHR };
+			}
+			else if (surfaceFormatCount == 0 && surfaceFormats[0].format == VK_FORMAT_UNDEFINED)
 				surfaceFormat = { VK_FORMAT_R8G8B8A8_UNORM, VK_COLORSPACE_SRGB_NONLINEAR_KHR };
 			else
 			{
@@ -281,39 +420,71 @@ namespace BrickEngine {
 			}
 
 			uint32_t presentModeCount = 0;
-			VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, m_Surface, &presentModeCount, nullptr));
+			if (m_Surface)
+				VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, m_Surface, &presentModeCount, nullptr));
 			std::vector<VkPresentModeKHR> presentModes(presentModeCount);
-			VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, m_Surface, &presentModeCount, presentModes.data()));
+			if (m_Surface)
+				VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, m_Surface, &presentModeCount, presentModes.data()));
 
-			VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
-			for (auto& mode : presentModes)
-			{
-				if (mode == VK_PRESENT_MODE_MAILBOX_KHR)
-					presentMode = mode;
-			}
+			bool mailboxSupported = std::find(presentModes.begin(), presentModes.end(), VK_PRESENT_MODE_MAILBOX_KHR) != presentModes.end();
 
 			VkPhysicalDeviceProperties physicalDeviceProperties;
 			vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
 
+			VkPhysicalDeviceVulkan12Properties vulkan12Properties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES };
+			VkPhysicalDeviceProperties2 physicalDeviceProperties2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+			physicalDeviceProperties2.pNext = &vulkan12Properties;
+			if (physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2)
+				vkGetPhysicalDeviceProperties2(physicalDevice, &physicalDeviceProperties2);
+
 			VkPhysicalDeviceFeatures physicalDeviceFeatures;
 			vkGetPhysicalDeviceFeatures(physicalDevice, &physicalDeviceFeatures);
 
+			VkPhysicalDeviceVulkan12Features vulkan12Features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+			VkPhysicalDeviceFeatures2 physicalDeviceFeatures2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+			physicalDeviceFeatures2.pNext = &vulkan12Features;
+			if (physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2)
+				vkGetPhysicalDeviceFeatures2(physicalDevice, &physicalDeviceFeatures2);
+
 			if (
 				hasRequiredExtentions																			&&
 				graphicsQueueFamilyIndex < queueFamilyCount														&&
 				presentQueueFamilyIndex < queueFamilyCount														&&
 				surfaceFormat.format != VK_FORMAT_UNDEFINED														&&
 				physicalDeviceFeatures.samplerAnisotropy														&&
-				VK_VERSION_MAJOR(physicalDeviceProperties.apiVersion) >= VK_VERSION_MAJOR(VK_API_VERSION_1_1)	&&
-				VK_VERSION_MINOR(physicalDeviceProperties.apiVersion) >= VK_VERSION_MINOR(VK_API_VERSION_1_1)	&&
-				VK_VERSION_PATCH(physicalDeviceProperties.apiVersion) >= VK_VERSION_PATCH(VK_API_VERSION_1_1)
+				vulkan12Features.timelineSemaphore																&&
+				physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2
 			)
 			{
 				m_PhysicalDevice = physicalDevice;
 				m_GraphicsQueueFamilyIndex = graphicsQueueFamilyIndex;
 				m_PresentQueueFamilyIndex = presentQueueFamilyIndex;
+				m_TransferQueueFamilyIndex = transferQueueFamilyIndex;
 				m_SurfaceFormat = surfaceFormat;
-				m_PresentMode = presentMode;
+				m_MailboxSupported = mailboxSupported;
+
+				m_Features = {};
+				m_Features.MultiDrawIndirect = physicalDeviceFeatures.multiDrawIndirect;
+				m_Features.DrawIndirectFirstInstance = physicalDeviceFeatures.drawIndirectFirstInstance;
+				m_Features.DrawIndirectCount = vulkan12Features.drawIndirectCount;
+				m_Features.MaxDrawIndirectCount = physicalDeviceFeatures.multiDrawIndirect ? physicalDeviceProperties.limits.maxDrawIndirectCount : 1;
+				m_Features.DescriptorIndexing =
+					physicalDeviceFeatures.shaderSampledImageArrayDynamicIndexing				&&
+					physicalDeviceFeatures.shaderStorageBufferArrayDynamicIndexing				&&
+					vulkan12Features.runtimeDescriptorArray										&&
+					vulkan12Features.descriptorBindingPartiallyBound							&&
+					vulkan12Features.descriptorBindingUpdateUnusedWhilePending					&&
+					vulkan12Features.descriptorBindingSampledImageUpdateAfterBind				&&
+					vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind;
+				if (m_Features.DescriptorIndexing)
+				{
+					m_Features.MaxBindlessSampledImages = std::min(vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages, vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages);
+					m_Features.MaxBindlessSamplers = std::min(vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSamplers, vulkan12Properties.maxDescriptorSetUpdateAfterBindSamplers);
+					m_Features.MaxBindlessStorageBuffers = std::min(vulkan12Properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers, vulkan12Properties.maxDescriptorSetUpdateAfterBindStorageBuffers);
+					m_Features.MaxBindlessResources = vulkan12Properties.maxPerStageUpdateAfterBindResources;
+				}
+				m_Features.TimestampValidBits = physicalDeviceProperties.limits.timestampComputeAndGraphics ? queueFamilyProperties[graphicsQueueFamilyIndex].timestampValidBits : 0;
+				m_Features.CalibratedTimestamps = Profiler::IsCompiledIn() && hasExtention(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
 				if (physicalDeviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
 					break;
 			}
@@ -322,6 +493,8 @@ namespace BrickEngine {
 
 	void VulkanRenderer::CreateDevice(std::vector<const char*>& requiredExtentions)
 	{
+		BRICKENGINE_PROFILE_FUNCTION();
+
 		float queuePriorities[] = { 1.0f };
 		std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 		VkDeviceQueueCreateInfo& graphicsQueueCreateInfo = queueCreateInfos.emplace_back();
@@ -339,10 +512,36 @@ namespace BrickEngine {
 			presentQueueCreateInfo.queueFamilyIndex = m_PresentQueueFamilyIndex;
 		}
 
+		if (m_TransferQueueFamilyIndex != m_GraphicsQueueFamilyIndex && m_TransferQueueFamilyIndex != m_PresentQueueFamilyIndex)
+		{
+			VkDeviceQueueCreateInfo& transferQueueCreateInfo = queueCreateInfos.emplace_back();
+			transferQueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+			transferQueueCreateInfo.pQueuePriorities = queuePriorities;
+			transferQueueCreateInfo.queueCount = 1;
+			transferQueueCreateInfo.queueFamilyIndex = m_TransferQueueFamilyIndex;
+		}
+
 		VkPhysicalDeviceFeatures physicalDeviceFeatures = {};
 		physicalDeviceFeatures.samplerAnisotropy = VK_TRUE;
+		physicalDeviceFeatures.multiDrawIndirect = m_Features.MultiDrawIndirect ? VK_TRUE : VK_FALSE;
+		physicalDeviceFeatures.drawIndirectFirstInstance = m_Features.DrawIndirectFirstInstance ? VK_TRUE : VK_FALSE;
+
+		VkPhysicalDeviceVulkan12Features vulkan12Features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+		vulkan12Features.timelineSemaphore = VK_TRUE;
+		vulkan12Features.drawIndirectCount = m_Features.DrawIndirectCount ? VK_TRUE : VK_FALSE;
+		if (m_Features.DescriptorIndexing)
+		{
+			physicalDeviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+			physicalDeviceFeatures.shaderStorageBufferArrayDynamicIndexing = VK_TRUE;
+			vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+			vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+			vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+			vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+			vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+		}
 
 		VkDeviceCreateInfo deviceCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+		deviceCreateInfo.pNext = &vulkan12Features;
 		deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(requiredExtentions.size());
 		deviceCreateInfo.ppEnabledExtensionNames = requiredExtentions.data();
 		deviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
@@ -352,53 +551,336 @@ namespace BrickEngine {
 		VK_CHECK(vkCreateDevice(m_PhysicalDevice, &deviceCreateInfo, nullptr, &m_Device));
 	}
 
-	void VulkanRenderer::CreateShader(const std::string& path)
+	bool VulkanRenderer::BeginFrame()
 	{
-		// Vertex Shader
-		std::vector<char> vertexShaderSource = File::LoadFile(path + ".vert.spv");
+		BRICKENGINE_PROFILE_FUNCTION();
 
-		VkShaderModuleCreateInfo vertexShaderCreateInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
-		vertexShaderCreateInfo.codeSize = vertexShaderSource.size() * sizeof(char);
-		vertexShaderCreateInfo.pCode = (uint32_t*)vertexShaderSource.data();
+		if (m_Window)
+		{
+			// Nothing can be presented to a minimized window
+			if (m_Window->GetWidth() == 0 || m_Window->GetHeight() == 0)
+				return false;
+
+			// Not every platform reports VK_ERROR_OUT_OF_DATE_KHR when the window changes size. Interactive resizes pass
+			// through a new size every few frames, the old swapchain is kept for as long as it's still presentable so
+			// the swapchain is only recreated once the size settles.
+			if (m_Window->GetWidth() != m_WindowWidth || m_Window->GetHeight() != m_WindowHeight)
+				RequestResize();
+			if (m_ResizePending && std::chrono::duration<double>(std::chrono::steady_clock::now() - m_ResizeRequestTime).count() >= ResizeDebounceTime)
+				OnWindowResize();
+		}
 
-		VkShaderModule vertexShaderModule;
-		VK_CHECK(vkCreateShaderModule(m_Device, &vertexShaderCreateInfo, nullptr, &vertexShaderModule));
+		VulkanFrame& frame = m_Frames[m_FrameIndex];
+		WaitForTimeline(frame.SubmitValue);
+		frame.TransientPool->Reset();
+		DestroyRetiredObjects();
+#if defined(BRICKENGINE_ENABLE_SHADER_HOT_RELOAD)
+		// Nothing records between frames, the pipelines replaced go once the frames already submitted are done
+		m_ShaderReloader->Apply([this](std::function<void()> destroy) { Retire(std::move(destroy)); });
+#endif
 
-		VkPipelineShaderStageCreateInfo vertexShaderStageCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
-		vertexShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-		vertexShaderStageCreateInfo.module = vertexShaderModule;
-		vertexShaderStageCreateInfo.pName = "main";
+		if (m_Window)
+		{
+			VkResult result = vkAcquireNextImageKHR(m_Device, m_Swapchain, std::numeric_limits<uint64_t>::max(), frame.ImageAvailableSemaphore, nullptr, &m_ImageIndex);
+			if (result == VK_ERROR_OUT_OF_DATE_KHR)
+			{
+				OnWindowResize();
+				return false;
+			}
+			BRICKENGINE_ASSERT(result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR);
+		}
+		else
+		{
+			// The frame's own image, free since the wait above
+			m_ImageIndex = m_FrameIndex;
+		}
 
-		m_ShaderStages.push_back(vertexShaderStageCreateInfo);
+		VK_CHECK(vkResetCommandPool(m_Device, frame.CommandPool, 0));
+		for (auto& threadCommandPool : frame.ThreadCommandPools)
+		{
+			if (threadCommandPool.UsedCount > 0)
+				VK_CHECK(vkResetCommandPool(m_Device, threadCommandPool.CommandPool, 0));
+			threadCommandPool.UsedCount = 0;
+		}
+		frame.SecondaryCommandBuffers.clear();
+		m_FrameStats = {};
+		m_FrameThread = std::this_thread::get_id();
 
-		// Fragment Shader
-		std::vector<char> fragmentShaderSource = File::LoadFile(path + ".frag.spv");
+		// Workers may have been added since the last frame
+		uint32_t threadCount = JobSystem::GetWorkerCount() + 1;
+		while (frame.ThreadCommandPools.size() < threadCount)
+		{
+			VkCommandPoolCreateInfo commandPoolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+			commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			commandPoolCreateInfo.queueFamilyIndex = m_GraphicsQueueFamilyIndex;
+			VK_CHECK(vkCreateCommandPool(m_Device, &commandPoolCreateInfo, nullptr, &frame.ThreadCommandPools.emplace_back().CommandPool));
+		}
 
-		VkShaderModuleCreateInfo fragmentShaderCreateInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
-		fragmentShaderCreateInfo.codeSize = fragmentShaderSource.size() * sizeof(char);
-		fragmentShaderCreateInfo.pCode = (uint32_t*)fragmentShaderSource.data();
+		VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		VK_CHECK(vkBeginCommandBuffer(frame.CommandBuffer, &beginInfo));
 
-		VkShaderModule fragmentShaderModule;
-		VK_CHECK(vkCreateShaderModule(m_Device, &fragmentShaderCreateInfo, nullptr, &fragmentShaderModule));
+		if (m_GpuProfiler)
+			m_GpuProfiler->BeginFrame(m_FrameIndex, frame.CommandBuffer);
 
-		VkPipelineShaderStageCreateInfo fragmentShaderStageCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
-		fragmentShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		fragmentShaderStageCreateInfo.module = fragmentShaderModule;
-		fragmentShaderStageCreateInfo.pName = "main";
+		// Ownership acquires have to happen outside the render pass
+		frame.UploadWaitValue = m_UploadManager->AcquireUploads(frame.CommandBuffer);
 
-		m_ShaderStages.push_back(fragmentShaderStageCreateInfo);
+		return true;
+	}
+
+	void VulkanRenderer::EndFrame()
+	{
+		BRICKENGINE_PROFILE_FUNCTION();
+
+		VulkanFrame& frame = m_Frames[m_FrameIndex];
+
+		// Secondary command buffers don't need the scene pass to have begun, the graph records the culling pass and barriers ahead of it
+		if (m_MeshRenderer)
+			m_FrameStats.Meshes = m_MeshRenderer->Draw();
+		m_FrameStats.Batches = m_BatchRenderer->Flush();
+
+		m_RenderGraph->SetImportedImage(m_BackbufferResource, m_SwapchainImages[m_ImageIndex], m_SwapchainImageViews[m_ImageIndex]);
+		m_RenderGraph->Execute(frame.CommandBuffer);
+		if (m_GpuProfiler)
+			m_GpuProfiler->EndFrame(frame.CommandBuffer);
+		VK_CHECK(vkEndCommandBuffer(frame.CommandBuffer));
+
+		frame.SubmitValue = ++m_FrameNumber;
+
+		// Headless frames neither acquire nor present, they only signal the frame timeline
+		uint32_t signalCount = m_Window ? 2 : 1;
+		VkSemaphore renderFinishedSemaphore = m_Window ? m_RenderFinishedSemaphores[m_ImageIndex] : nullptr;
+		VkSemaphore signalSemaphores[] = { m_FrameTimeline, renderFinishedSemaphore };
+		// The value for the binary semaphore is ignored
+		uint64_t signalValues[] = { frame.SubmitValue, 0 };
+
+		VkSemaphore waitSemaphores[2] = {};
+		uint64_t waitValues[2] = {};
+		VkPipelineStageFlags waitStages[2] = {};
+		uint32_t waitCount = 0;
+		if (m_Window)
+		{
+			waitSemaphores[waitCount] = frame.ImageAvailableSemaphore;
+			waitStages[waitCount++] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		}
+		// Only wait on the transfer queue once something was uploaded, and only at the stages reading it
+		if (frame.UploadWaitValue > 0)
+		{
+			waitSemaphores[waitCount] = m_UploadManager->GetTimeline();
+			waitValues[waitCount] = frame.UploadWaitValue;
+			waitStages[waitCount++] = VulkanUploadManager::ConsumerStages;
+		}
+
+		VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+		timelineSubmitInfo.waitSemaphoreValueCount = waitCount;
+		timelineSubmitInfo.pWaitSemaphoreValues = waitValues;
+		timelineSubmitInfo.signalSemaphoreValueCount = signalCount;
+		timelineSubmitInfo.pSignalSemaphoreValues = signalValues;
+
+		VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		submitInfo.pNext = &timelineSubmitInfo;
+		submitInfo.waitSemaphoreCount = waitCount;
+		submitInfo.pWaitSemaphores = waitSemaphores;
+		submitInfo.pWaitDstStageMask = waitStages;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &frame.CommandBuffer;
+		submitInfo.signalSemaphoreCount = signalCount;
+		submitInfo.pSignalSemaphores = signalSemaphores;
+
+		std::unique_lock<std::mutex> queueLock(m_QueueMutex);
+		VK_CHECK(vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, nullptr));
+
+		if (m_Window)
+		{
+			VkPresentInfoKHR presentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+			presentInfo.waitSemaphoreCount = 1;
+			presentInfo.pWaitSemaphores = &renderFinishedSemaphore;
+			presentInfo.swapchainCount = 1;
+			presentInfo.pSwapchains = &m_Swapchain;
+			presentInfo.pImageIndices = &m_ImageIndex;
+
+			VkResult result = vkQueuePresentKHR(m_PresentQueue, &presentInfo);
+			queueLock.unlock();
+			// Suboptimal still presents, the swapchain can wait for the size to settle
+			if (result == VK_ERROR_OUT_OF_DATE_KHR)
+				OnWindowResize();
+			else if (result == VK_SUBOPTIMAL_KHR)
+				RequestResize();
+			else
+				BRICKENGINE_ASSERT(result == VK_SUCCESS);
+		}
+
+		m_FrameStats.SecondaryCommandBufferCount = static_cast<uint32_t>(frame.SecondaryCommandBuffers.size());
+		m_FrameStats.TransientBytes = frame.TransientPool->GetUsedBytes();
+		m_FrameStats.Graph = m_RenderGraph->GetStats();
+
+		auto now = std::chrono::steady_clock::now();
+		m_FrameStats.Uploads = m_UploadManager->ResetStats();
+		if (m_LastFrameEnd != std::chrono::steady_clock::time_point())
+			m_FrameStats.UploadBandwidth = m_FrameStats.Uploads.Bytes / std::chrono::duration<double>(now - m_LastFrameEnd).count();
+		m_LastFrameEnd = now;
+		m_LastFrameStats = m_FrameStats;
+
+		m_FrameIndex = (m_FrameIndex + 1) % static_cast<uint32_t>(m_Frames.size());
+	}
+
+	size_t VulkanRenderer::ReserveSecondaryCommandBuffers(size_t count)
+	{
+		std::vector<VkCommandBuffer>& commandBuffers = m_Frames[m_FrameIndex].SecondaryCommandBuffers;
+		size_t first = commandBuffers.size();
+		commandBuffers.resize(first + count);
+		return first;
+	}
+
+	VkCommandBuffer VulkanRenderer::BeginSecondaryCommandBuffer()
+	{
+		VulkanFrame& frame = m_Frames[m_FrameIndex];
+		BRICKENGINE_ASSERT(JobSystem::GetWorkerIndex() >= 0 || std::this_thread::get_id() == m_FrameThread);
+		VulkanThreadCommandPool& threadCommandPool = frame.ThreadCommandPools[JobSystem::GetWorkerIndex() + 1];
+
+		if (threadCommandPool.UsedCount == threadCommandPool.CommandBuffers.size())
+		{
+			VkCommandBufferAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+			allocateInfo.commandPool = threadCommandPool.CommandPool;
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+			allocateInfo.commandBufferCount = 1;
+			VK_CHECK(vkAllocateCommandBuffers(m_Device, &allocateInfo, &threadCommandPool.CommandBuffers.emplace_back()));
+		}
+		VkCommandBuffer commandBuffer = threadCommandPool.CommandBuffers[threadCommandPool.UsedCount++];
+
+		VkCommandBufferInheritanceInfo inheritanceInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO };
+		inheritanceInfo.renderPass = m_RenderPass;
+		inheritanceInfo.subpass = 0;
+		// The graph owns the framebuffers, leaving it out is allowed and only costs drivers a possible optimization
+		inheritanceInfo.framebuffer = nullptr;
+
+		VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
+		VK_CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+		// Dynamic state isn't inherited, every secondary command buffer sets its own. Y is flipped so +Y points up.
+		VkViewport viewport = {};
+		viewport.x = 0.0f;
+		viewport.y = static_cast<float>(m_SwapchainExtent.height);
+		viewport.width = static_cast<float>(m_SwapchainExtent.width);
+		viewport.height = -static_cast<float>(m_SwapchainExtent.height);
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+		VkRect2D scissor = {};
+		scissor.offset = { 0, 0 };
+		scissor.extent = m_SwapchainExtent;
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+		return commandBuffer;
+	}
+
+	void VulkanRenderer::SetVSync(bool vsync)
+	{
+		// FIFO is the only mode every surface supports
+		VkPresentModeKHR presentMode = vsync || !m_MailboxSupported ? VK_PRESENT_MODE_FIFO_KHR : VK_PRESENT_MODE_MAILBOX_KHR;
+		if (presentMode == m_PresentMode)
+			return;
+
+		m_PresentMode = presentMode;
+		if (m_Swapchain)
+			OnWindowResize();
 	}
 
 	void VulkanRenderer::OnWindowResize()
 	{
+		// Keep the old swapchain while minimized, BeginFrame recreates it once the window has a size again
+		if (m_Swapchain && (m_Window->GetWidth() == 0 || m_Window->GetHeight() == 0))
+			return;
+
+		BRICKENGINE_PROFILE_FUNCTION();
+		auto start = std::chrono::steady_clock::now();
+
+		m_WindowWidth = m_Window->GetWidth();
+		m_WindowHeight = m_Window->GetHeight();
+		m_ResizePending = false;
+
+		// Frames in flight may still render to or present the old images, their views and semaphores. Instead of waiting
+		// for the device to go idle they are retired along with the old swapchain, the new one is created from it.
+		VkSwapchainKHR oldSwapchain = m_Swapchain;
+		std::vector<VkImageView> oldImageViews = std::move(m_SwapchainImageViews);
+		std::vector<VkSemaphore> oldSemaphores = std::move(m_RenderFinishedSemaphores);
+		m_SwapchainImageViews.clear();
+		m_RenderFinishedSemaphores.clear();
+
 		CreateSwapchain();
 		BRICKENGINE_ASSERT(m_Swapchain);
 
 		CreateSwapchainImagesAndViews();
+		CreateSwapchainSemaphores();
+
+		if (oldSwapchain)
+		{
+			// Presents aren't tracked by the frame timeline, frames submitted after them finishing is what says they're done
+			Retire([device = m_Device, oldSwapchain, oldImageViews = std::move(oldImageViews), oldSemaphores = std::move(oldSemaphores)]()
+				{
+					for (auto& imageView : oldImageViews)
+						vkDestroyImageView(device, imageView, nullptr);
+					for (auto& semaphore : oldSemaphores)
+						vkDestroySemaphore(device, semaphore, nullptr);
+					vkDestroySwapchainKHR(device, oldSwapchain, nullptr);
+				}, GetFramesInFlight()
+			);
+		}
+
+		// Not created yet on the first call from the constructor, CreateRenderGraph compiles it then
+		if (m_RenderGraph)
+			m_RenderGraph->Compile(m_SwapchainExtent);
+
+		double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		m_SwapchainStats.RecreateCount++;
+		m_SwapchainStats.LastRecreateTime = time;
+		m_SwapchainStats.MaxRecreateTime = std::max(m_SwapchainStats.MaxRecreateTime, time);
+		Log::Info(LogCategory::Renderer, "Created a {}x{} swapchain in {} ms", m_SwapchainExtent.width, m_SwapchainExtent.height, time * 1000.0);
+	}
+
+	void VulkanRenderer::RequestResize()
+	{
+		int32_t width = m_Window->GetWidth();
+		int32_t height = m_Window->GetHeight();
+		if (m_ResizePending && width == m_PendingWidth && height == m_PendingHeight)
+			return;
+
+		m_ResizePending = true;
+		m_PendingWidth = width;
+		m_PendingHeight = height;
+		m_ResizeRequestTime = std::chrono::steady_clock::now();
+	}
+
+	void VulkanRenderer::Retire(std::function<void()> destroy, uint32_t extraFrames)
+	{
+		RetiredObject& retired = m_RetiredObjects.emplace_back();
+		retired.Destroy = std::move(destroy);
+		retired.FrameNumber = m_FrameNumber + extraFrames;
+	}
+
+	void VulkanRenderer::DestroyRetiredObjects()
+	{
+		while (!m_RetiredObjects.empty() && IsFrameComplete(m_RetiredObjects.front().FrameNumber))
+		{
+			m_RetiredObjects.front().Destroy();
+			m_RetiredObjects.pop_front();
+		}
+	}
+
+	VulkanSwapchainStats VulkanRenderer::GetSwapchainStats() const
+	{
+		VulkanSwapchainStats stats = m_SwapchainStats;
+		stats.RetiredCount = static_cast<uint32_t>(m_RetiredObjects.size());
+		return stats;
 	}
 
 	void VulkanRenderer::CreateSwapchain()
 	{
+		BRICKENGINE_PROFILE_FUNCTION();
+
 		VkSurfaceCapabilitiesKHR surfaceCapabilities;
 		VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_PhysicalDevice, m_Surface, &surfaceCapabilities));
 
@@ -412,7 +894,8 @@ namespace BrickEngine {
 		}
 
 		uint32_t imageCount = surfaceCapabilities.minImageCount + 1;
-		imageCount = std::min(imageCount, surfaceCapabilities.maxImageCount);
+		if (surfaceCapabilities.maxImageCount > 0)
+			imageCount = std::min(imageCount, surfaceCapabilities.maxImageCount);
 
 		VkSwapchainCreateInfoKHR swapchainCreateInfo = { VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR };
 		swapchainCreateInfo.surface = m_Surface;
@@ -445,19 +928,14 @@ namespace BrickEngine {
 		swapchainCreateInfo.clipped = VK_TRUE;
 		swapchainCreateInfo.oldSwapchain = oldSwapchain;
 
+		// The old swapchain is retired by OnWindowResize, its images may still be presented
 		VK_CHECK(vkCreateSwapchainKHR(m_Device, &swapchainCreateInfo, nullptr, &m_Swapchain));
-
-		if (oldSwapchain)
-			vkDestroySwapchainKHR(m_Device, oldSwapchain, nullptr);
 	}
 
 	void VulkanRenderer::CreateSwapchainImagesAndViews()
 	{
+		BRICKENGINE_ASSERT(m_SwapchainImageViews.empty());
 		m_SwapchainImages.clear();
-		if (m_SwapchainImageViews.size() > 0)
-			for (auto& imageView : m_SwapchainImageViews)
-				vkDestroyImageView(m_Device, imageView, nullptr);
-		m_SwapchainImageViews.clear();
 
 		uint32_t swapchainImageCount = 0;
 		VK_CHECK(vkGetSwapchainImagesKHR(m_Device, m_Swapchain, &swapchainImageCount, nullptr));
@@ -481,6 +959,58 @@ namespace BrickEngine {
 		}
 	}
 
+	void VulkanRenderer::CreateSwapchainSemaphores()
+	{
+		// Recreated with the swapchain since the image count may change
+		VkSemaphoreCreateInfo semaphoreCreateInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+		m_RenderFinishedSemaphores.resize(m_SwapchainImageViews.size());
+		for (auto& semaphore : m_RenderFinishedSemaphores)
+			VK_CHECK(vkCreateSemaphore(m_Device, &semaphoreCreateInfo, nullptr, &semaphore));
+	}
+
+	void VulkanRenderer::CreateOffscreenImages(uint32_t count)
+	{
+		m_SwapchainImages.resize(count);
+		m_SwapchainImageViews.resize(count);
+		m_OffscreenAllocations.resize(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			VkImageCreateInfo imageCreateInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+			imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageCreateInfo.format = m_SurfaceFormat.format;
+			imageCreateInfo.extent = { m_SwapchainExtent.width, m_SwapchainExtent.height, 1 };
+			imageCreateInfo.mipLevels = 1;
+			imageCreateInfo.arrayLayers = 1;
+			imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageCreateInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+			imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VK_CHECK(vkCreateImage(m_Device, &imageCreateInfo, nullptr, &m_SwapchainImages[i]));
+
+			m_OffscreenAllocations[i] = m_Allocator->AllocateForImage(m_SwapchainImages[i], VulkanMemoryUsage::GPUOnly);
+			BRICKENGINE_ASSERT(m_OffscreenAllocations[i]);
+
+			VkImageViewCreateInfo imageViewCreateInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+			imageViewCreateInfo.image = m_SwapchainImages[i];
+			imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			imageViewCreateInfo.format = m_SurfaceFormat.format;
+			imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+			imageViewCreateInfo.subresourceRange.levelCount = 1;
+			imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+			imageViewCreateInfo.subresourceRange.layerCount = 1;
+			VK_CHECK(vkCreateImageView(m_Device, &imageViewCreateInfo, nullptr, &m_SwapchainImageViews[i]));
+		}
+	}
+
+	void VulkanRenderer::DestroySwapchainResources()
+	{
+		for (auto& semaphore : m_RenderFinishedSemaphores)
+			vkDestroySemaphore(m_Device, semaphore, nullptr);
+		m_RenderFinishedSemaphores.clear();
+	}
+
 	void VulkanRenderer::CreateRenderPass()
 	{
 		// Color Attachment
@@ -492,7 +1022,8 @@ namespace BrickEngine {
 		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		// Headless images have no swapchain to present to, they end up in the layout ReadFrame copies from
+		colorAttachment.finalLayout = m_Window ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
 
 		VkAttachmentReference colorAttachmentRefrence = {};
 		colorAttachmentRefrence.attachment = 0;
@@ -504,7 +1035,7 @@ namespace BrickEngine {
 			VK_FORMAT_D32_SFLOAT_S8_UINT,
 			VK_FORMAT_D24_UNORM_S8_UINT
 		};
-		VkFormat depthFormat = [&]()
+		m_DepthFormat = [&]()
 		{
 			uint32_t flags = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
 			for (auto& candidate : depthFormatCandidates)
@@ -522,7 +1053,7 @@ namespace BrickEngine {
 		}();
 
 		VkAttachmentDescription depthAttachment = {};
-		depthAttachment.format = depthFormat;
+		depthAttachment.format = m_DepthFormat;
 		depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
 		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
 		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
@@ -568,109 +1099,214 @@ namespace BrickEngine {
 
 	void VulkanRenderer::CreateGraphicsPipeline()
 	{
-		VkViewport viewport = {};
-		viewport.x = 0.0f;
-		viewport.y = static_cast<float>(m_SwapchainExtent.height);
-		viewport.width = static_cast<float>(m_SwapchainExtent.width);
-		viewport.height = -static_cast<float>(m_SwapchainExtent.height);
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
+		BRICKENGINE_PROFILE_FUNCTION();
 
-		VkRect2D scissor = {};
-		scissor.offset = { 0, 0 };
-		scissor.extent = { m_SwapchainExtent.width, m_SwapchainExtent.height };
-
-		VkPipelineViewportStateCreateInfo viewportState = { VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
-		viewportState.viewportCount = 1;
-		viewportState.pViewports = &viewport;
-		viewportState.scissorCount = 1;
-		viewportState.pScissors = &scissor;
-
-		VkPipelineRasterizationStateCreateInfo rasterizerCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO };
-		rasterizerCreateInfo.depthBiasEnable = VK_FALSE;
-		rasterizerCreateInfo.rasterizerDiscardEnable = VK_FALSE;
-		rasterizerCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
-		rasterizerCreateInfo.lineWidth = 1.0f;
-		rasterizerCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
-		rasterizerCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-		rasterizerCreateInfo.depthBiasEnable = VK_FALSE;
-		rasterizerCreateInfo.depthBiasConstantFactor = 0.0f;
-		rasterizerCreateInfo.depthBiasClamp = 0.0f;
-		rasterizerCreateInfo.depthBiasSlopeFactor = 0.0f;
-
-		VkPipelineMultisampleStateCreateInfo multisamplingCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO };
-		multisamplingCreateInfo.sampleShadingEnable = VK_FALSE;
-		multisamplingCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-		multisamplingCreateInfo.minSampleShading = 1.0f;
-		multisamplingCreateInfo.pSampleMask = nullptr;
-		multisamplingCreateInfo.alphaToCoverageEnable = VK_FALSE;
-		multisamplingCreateInfo.alphaToOneEnable = VK_FALSE;
-
-		VkPipelineDepthStencilStateCreateInfo depthStencil = { VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO };
-		depthStencil.depthTestEnable = VK_TRUE;
-		depthStencil.depthWriteEnable = VK_TRUE;
-		depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-		depthStencil.depthBoundsTestEnable = VK_FALSE;
-		depthStencil.stencilTestEnable = VK_FALSE;
-
-		VkPipelineColorBlendAttachmentState colorBlendAttachmentState = {};
-		colorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		colorBlendAttachmentState.blendEnable = VK_FALSE;
-
-		VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO };
-		colorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
-		colorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
-		colorBlendStateCreateInfo.attachmentCount = 1;
-		colorBlendStateCreateInfo.pAttachments = &colorBlendAttachmentState;
-		colorBlendStateCreateInfo.blendConstants[0] = 0.0f;
-		colorBlendStateCreateInfo.blendConstants[1] = 0.0f;
-		colorBlendStateCreateInfo.blendConstants[2] = 0.0f;
-		colorBlendStateCreateInfo.blendConstants[3] = 0.0f;
-
-		std::vector<VkDynamicState> dynamicStates = {
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_LINE_WIDTH
-		};
+		// Both register their pipelines, everything registered so far is built in one go below
+		m_BatchRenderer = std::make_unique<VulkanBatchRenderer>(this, m_Device, m_PipelineLibrary.get(), m_RenderPass);
+		if (m_Features.DrawIndirectFirstInstance)
+			m_MeshRenderer = std::make_unique<VulkanMeshRenderer>(this, m_Device, m_PipelineLibrary.get(), m_RenderPass);
+		else
+			Log::Warn(LogCategory::Renderer, "drawIndirectFirstInstance isn't supported, GPU driven meshes are disabled");
+
+		m_PipelineLibrary->BuildAll();
+		if (!m_PipelineLibrary->Get(m_BatchRenderer->GetDefaultPipeline()))
+			Log::Error(LogCategory::Renderer, "Failed to build the sprite pipeline, are the shaders in assets/shaders?");
+
+		VulkanShaderCompilerStats shaderStats = m_ShaderCompiler->GetStats();
+		Log::Info(LogCategory::Renderer, "Compiled {} shader(s) in {} ms, loaded {} from the cache in {} ms", shaderStats.CompileCount,
+			shaderStats.CompileTime * 1000.0, shaderStats.CacheHitCount, shaderStats.CacheHitTime * 1000.0);
+		VulkanLayoutCacheStats layoutStats = m_LayoutCache->GetStats();
+		Log::Info(LogCategory::Renderer, "Pipelines share {} pipeline layout(s) and {} descriptor set layout(s), {} request(s) reused one",
+			layoutStats.PipelineLayoutCount, layoutStats.DescriptorSetLayoutCount, layoutStats.HitCount);
+
+		// Save right away as well so a crash later on doesn't cost the next launch its warm start
+		m_PipelineCache->Save();
+	}
+
+	void VulkanRenderer::CreateRenderGraph()
+	{
+		m_RenderGraph = std::make_unique<VulkanRenderGraph>(m_Device, m_Allocator.get());
+		VulkanRenderGraph& graph = *m_RenderGraph;
+		// Recompiles on resize then don't have to wait for the frames still using the old attachments
+		graph.SetRetireFunction([this](std::function<void()> destroy)
+			{
+				Retire(std::move(destroy));
+			}
+		);
+
+		// The acquire semaphore is waited on at the color output stage, the previous contents are never needed.
+		// Headless frames are left ready for ReadFrame to copy instead of being presented.
+		m_BackbufferResource = graph.ImportImage("Backbuffer", m_SurfaceFormat.format, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		graph.MarkOutput(m_BackbufferResource, m_Window ? VulkanGraphUsage::Present : VulkanGraphUsage::TransferSource);
+		VulkanGraphResource depth = graph.CreateImage("Depth", { m_DepthFormat, {}, VK_IMAGE_ASPECT_DEPTH_BIT });
+
+		VulkanGraphResource drawBuffer = VulkanRenderGraph::InvalidResource;
+		VulkanGraphResource countBuffer = VulkanRenderGraph::InvalidResource;
+		if (m_MeshRenderer)
+		{
+			drawBuffer = graph.ImportBuffer("MeshDraws", m_MeshRenderer->GetDrawBuffer());
+			countBuffer = graph.ImportBuffer("MeshDrawCount", m_MeshRenderer->GetCountBuffer());
+
+			VulkanGraphPass culling = graph.AddPass("MeshCulling", VulkanGraphPassType::Compute, [this](VkCommandBuffer commandBuffer)
+				{
+					m_MeshRenderer->RecordCulling(commandBuffer);
+				}
+			);
+			graph.Write(culling, drawBuffer, VulkanGraphUsage::StorageCompute);
+			graph.Write(culling, countBuffer, VulkanGraphUsage::StorageCompute);
+		}
+
+		VulkanGraphPass scene = graph.AddPass("Scene", VulkanGraphPassType::Graphics, [this](VkCommandBuffer commandBuffer)
+			{
+				VulkanFrame& frame = m_Frames[m_FrameIndex];
+				if (!frame.SecondaryCommandBuffers.empty())
+					vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(frame.SecondaryCommandBuffers.size()), frame.SecondaryCommandBuffers.data());
+			}, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+		);
+		graph.SetColorAttachment(scene, m_BackbufferResource, VK_ATTACHMENT_LOAD_OP_CLEAR, { { 0.1f, 0.1f, 0.1f, 1.0f } });
+		graph.SetDepthAttachment(scene, depth, VK_ATTACHMENT_LOAD_OP_CLEAR);
+		if (m_MeshRenderer)
+		{
+			graph.Read(scene, drawBuffer, VulkanGraphUsage::IndirectBuffer);
+			graph.Read(scene, countBuffer, VulkanGraphUsage::IndirectBuffer);
+		}
+
+		graph.Compile(m_SwapchainExtent);
+	}
+
+	void VulkanRenderer::CreateFrames(uint32_t framesInFlight)
+	{
+		BRICKENGINE_ASSERT(framesInFlight > 0);
+
+		VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+		semaphoreTypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		semaphoreTypeCreateInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo timelineCreateInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+		timelineCreateInfo.pNext = &semaphoreTypeCreateInfo;
+		VK_CHECK(vkCreateSemaphore(m_Device, &timelineCreateInfo, nullptr, &m_FrameTimeline));
 
-		VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
-		dynamicStateCreateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-		dynamicStateCreateInfo.pDynamicStates = dynamicStates.data();
-
-		VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
-		vertexInputCreateInfo.vertexBindingDescriptionCount = 0;
-		vertexInputCreateInfo.vertexAttributeDescriptionCount = 0;
-
-		VkPipelineInputAssemblyStateCreateInfo inputAssembly = { VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO };
-		inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
-		pipelineLayoutCreateInfo.setLayoutCount = 0;
-		pipelineLayoutCreateInfo.pSetLayouts = nullptr;
-		pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-		pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
-
-		VK_CHECK(vkCreatePipelineLayout(m_Device, &pipelineLayoutCreateInfo, nullptr, &m_PipelineLayout));
-
-		VkGraphicsPipelineCreateInfo pipelineCreateInfo = { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
-		pipelineCreateInfo.stageCount = static_cast<uint32_t>(m_ShaderStages.size());
-		pipelineCreateInfo.pStages = m_ShaderStages.data();
-		pipelineCreateInfo.pVertexInputState = &vertexInputCreateInfo;
-		pipelineCreateInfo.pInputAssemblyState = &inputAssembly;
-		pipelineCreateInfo.pViewportState = &viewportState;
-		pipelineCreateInfo.pRasterizationState = &rasterizerCreateInfo;
-		pipelineCreateInfo.pMultisampleState = &multisamplingCreateInfo;
-		pipelineCreateInfo.pDepthStencilState = &depthStencil;
-		pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
-		pipelineCreateInfo.pDynamicState = nullptr;
-
-		pipelineCreateInfo.layout = m_PipelineLayout;
-		pipelineCreateInfo.renderPass = m_RenderPass;
-		pipelineCreateInfo.subpass = 0;
-		pipelineCreateInfo.basePipelineHandle = nullptr;
-		pipelineCreateInfo.basePipelineIndex = -1;
-
-		VK_CHECK(vkCreateGraphicsPipelines(m_Device, nullptr, 1, &pipelineCreateInfo, nullptr, &m_Pipeline));
+		m_Frames.resize(framesInFlight);
+		for (auto& frame : m_Frames)
+		{
+			VkCommandPoolCreateInfo commandPoolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+			commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			commandPoolCreateInfo.queueFamilyIndex = m_GraphicsQueueFamilyIndex;
+			VK_CHECK(vkCreateCommandPool(m_Device, &commandPoolCreateInfo, nullptr, &frame.CommandPool));
+
+			VkCommandBufferAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+			allocateInfo.commandPool = frame.CommandPool;
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocateInfo.commandBufferCount = 1;
+			VK_CHECK(vkAllocateCommandBuffers(m_Device, &allocateInfo, &frame.CommandBuffer));
+
+			VkSemaphoreCreateInfo semaphoreCreateInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+			VK_CHECK(vkCreateSemaphore(m_Device, &semaphoreCreateInfo, nullptr, &frame.ImageAvailableSemaphore));
+
+			VkBufferUsageFlags transientUsage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+			frame.TransientPool = std::make_unique<VulkanLinearPool>(m_Allocator.get(), m_Device, TransientPoolSize, transientUsage);
+		}
+	}
+
+	bool VulkanRenderer::ReadFrame(std::vector<uint8_t>& pixels)
+	{
+		BRICKENGINE_ASSERT(IsHeadless());
+		if (m_FrameNumber == 0)
+			return false;
+
+		VkDeviceSize size = static_cast<VkDeviceSize>(m_SwapchainExtent.width) * m_SwapchainExtent.height * 4;
+		if (!m_ReadbackCommandPool)
+		{
+			VkCommandPoolCreateInfo commandPoolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+			commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+			commandPoolCreateInfo.queueFamilyIndex = m_GraphicsQueueFamilyIndex;
+			VK_CHECK(vkCreateCommandPool(m_Device, &commandPoolCreateInfo, nullptr, &m_ReadbackCommandPool));
+
+			VkCommandBufferAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+			allocateInfo.commandPool = m_ReadbackCommandPool;
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocateInfo.commandBufferCount = 1;
+			VK_CHECK(vkAllocateCommandBuffers(m_Device, &allocateInfo, &m_ReadbackCommandBuffer));
+
+			VkBufferCreateInfo bufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+			bufferCreateInfo.size = size;
+			bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			VK_CHECK(vkCreateBuffer(m_Device, &bufferCreateInfo, nullptr, &m_ReadbackBuffer));
+			m_ReadbackAllocation = m_Allocator->AllocateForBuffer(m_ReadbackBuffer, VulkanMemoryUsage::Readback);
+			BRICKENGINE_ASSERT(m_ReadbackAllocation && m_ReadbackAllocation->MappedData);
+		}
+
+		WaitForTimeline(m_FrameNumber);
+
+		VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		VK_CHECK(vkBeginCommandBuffer(m_ReadbackCommandBuffer, &beginInfo));
+
+		// The render graph leaves headless images in TRANSFER_SRC_OPTIMAL, visible to transfers submitted after the frame
+		VkBufferImageCopy region = {};
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent = { m_SwapchainExtent.width, m_SwapchainExtent.height, 1 };
+		vkCmdCopyImageToBuffer(m_ReadbackCommandBuffer, m_SwapchainImages[m_ImageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_ReadbackBuffer, 1, &region);
+
+		VkMemoryBarrier hostBarrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+		hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(m_ReadbackCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+			1, &hostBarrier,
+			0, nullptr,
+			0, nullptr
+		);
+		VK_CHECK(vkEndCommandBuffer(m_ReadbackCommandBuffer));
+
+		VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &m_ReadbackCommandBuffer;
+		{
+			std::lock_guard<std::mutex> queueLock(m_QueueMutex);
+			VK_CHECK(vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, nullptr));
+			VK_CHECK(vkQueueWaitIdle(m_GraphicsQueue));
+		}
+
+		m_Allocator->Invalidate(m_ReadbackAllocation, 0, size);
+		pixels.resize(size);
+		std::memcpy(pixels.data(), m_ReadbackAllocation->MappedData, size);
+		return true;
+	}
+
+	FileError VulkanRenderer::WriteFrame(const std::string& filepath)
+	{
+		std::vector<uint8_t> pixels;
+		if (!ReadFrame(pixels))
+			return FileError::ReadFailed;
+
+		std::string header = "P6\n" + std::to_string(m_SwapchainExtent.width) + " " + std::to_string(m_SwapchainExtent.height) + "\n255\n";
+		std::vector<uint8_t> data(header.begin(), header.end());
+		data.reserve(header.size() + pixels.size() / 4 * 3);
+		// PPM has no alpha channel
+		for (size_t i = 0; i < pixels.size(); i += 4)
+			data.insert(data.end(), pixels.begin() + i, pixels.begin() + i + 3);
+		return File::WriteFile(filepath, data.data(), data.size());
+	}
+
+	bool VulkanRenderer::IsFrameComplete(uint64_t frameNumber) const
+	{
+		uint64_t value = 0;
+		VK_CHECK(vkGetSemaphoreCounterValue(m_Device, m_FrameTimeline, &value));
+		return value >= frameNumber;
+	}
+
+	void VulkanRenderer::WaitForTimeline(uint64_t value)
+	{
+		if (value == 0)
+			return;
+
+		VkSemaphoreWaitInfo waitInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &m_FrameTimeline;
+		waitInfo.pValues = &value;
+		VK_CHECK(vkWaitSemaphores(m_Device, &waitInfo, std::numeric_limits<uint64_t>::max()));
 	}
 
 }
@@ -2,26 +2,221 @@
 
 #include "BrickEngine/Core/Base.hpp"
 #include "BrickEngine/Core/Window.hpp"
+#include "BrickEngine/Core/JobSystem.hpp"
+#include "BrickEngine/Core/File.hpp"
 
 #include "BrickEngine/Renderer/Vulkan/VulkanPlatform.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanMemoryAllocator.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanUploadManager.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanPipelineCache.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanLayoutCache.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanPipelineLibrary.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanBindlessHeap.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanBatchRenderer.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanMeshRenderer.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanRenderGraph.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanGpuProfiler.hpp"
+#if defined(BRICKENGINE_ENABLE_SHADER_HOT_RELOAD)
+	#include "BrickEngine/Renderer/Vulkan/VulkanShaderReloader.hpp"
+#endif
 
 namespace BrickEngine {
 
+	// Optional device features, detected by SelectPhysicalDevice and enabled when present
+	struct VulkanDeviceFeatures
+	{
+		bool MultiDrawIndirect = false;
+		bool DrawIndirectFirstInstance = false;
+		bool DrawIndirectCount = false;
+		// 1 without MultiDrawIndirect
+		uint32_t MaxDrawIndirectCount = 1;
+		// Partially bound, update after bind descriptor arrays, what the bindless heap needs
+		bool DescriptorIndexing = false;
+		// Per stage limits of update after bind descriptors, 0 without DescriptorIndexing
+		uint32_t MaxBindlessSampledImages = 0;
+		uint32_t MaxBindlessSamplers = 0;
+		uint32_t MaxBindlessStorageBuffers = 0;
+		uint32_t MaxBindlessResources = 0;
+		// Of the graphics queue family, 0 when it can't write timestamps
+		uint32_t TimestampValidBits = 0;
+		// VK_EXT_calibrated_timestamps, only enabled for the profiler
+		bool CalibratedTimestamps = false;
+	};
+
+	// Secondary command buffers recorded by one thread, command pools can't be used from several threads at once.
+	struct VulkanThreadCommandPool
+	{
+		VkCommandPool CommandPool = nullptr;
+		std::vector<VkCommandBuffer> CommandBuffers = {};
+		uint32_t UsedCount = 0;
+	};
+
+	struct VulkanFrame
+	{
+		// Reset as a whole once the GPU is done with the frame, the command buffer is allocated once and reused
+		VkCommandPool CommandPool = nullptr;
+		VkCommandBuffer CommandBuffer = nullptr;
+		VkSemaphore ImageAvailableSemaphore = nullptr;
+		// Value of the frame timeline semaphore signaled by the last submit using this frame
+		uint64_t SubmitValue = 0;
+		// Upload timeline value the submit has to wait for, 0 before anything was uploaded
+		uint64_t UploadWaitValue = 0;
+
+		// Indexed by job system worker index + 1. The first one belongs to the thread calling BeginFrame when it isn't a
+		// worker, other threads that aren't workers must not record.
+		std::vector<VulkanThreadCommandPool> ThreadCommandPools = {};
+		// Executed in this order inside the render graph's scene pass by EndFrame
+		std::vector<VkCommandBuffer> SecondaryCommandBuffers = {};
+
+		// Per-frame vertex, index and uniform data, reset once the GPU is done with the frame
+		std::unique_ptr<VulkanLinearPool> TransientPool;
+	};
+
+	struct VulkanFrameStats
+	{
+		uint32_t SecondaryCommandBufferCount = 0;
+		// Seconds spent in RecordParallel, including waiting for the workers
+		double RecordTime = 0.0;
+		VkDeviceSize TransientBytes = 0;
+
+		VulkanUploadStats Uploads = {};
+		// Bytes per second uploaded since the previous frame
+		double UploadBandwidth = 0.0;
+
+		VulkanBatchStats Batches = {};
+		VulkanMeshStats Meshes = {};
+		VulkanRenderGraphStats Graph = {};
+	};
+
+	struct VulkanSwapchainStats
+	{
+		uint32_t RecreateCount = 0;
+		// Seconds the frame that recreated the swapchain spent on it, the hitch a resize causes
+		double LastRecreateTime = 0.0;
+		double MaxRecreateTime = 0.0;
+		// Objects of retired swapchains and graph compiles waiting for the frames using them
+		uint32_t RetiredCount = 0;
+	};
+
 	class VulkanRenderer
 	{
 	public:
-		VulkanRenderer(Window* window);
+		static constexpr VkDeviceSize TransientPoolSize = 4 * 1024 * 1024;
+		// Bindless heap capacities, lowered to the device limits
+		static constexpr uint32_t BindlessSampledImages = 64 * 1024;
+		static constexpr uint32_t BindlessSamplers = 1024;
+		static constexpr uint32_t BindlessStorageBuffers = 64 * 1024;
+		// Seconds the window size has to stay the same before the swapchain follows it
+		static constexpr double ResizeDebounceTime = 0.1;
+
+		VulkanRenderer(Window* window, uint32_t framesInFlight = 2);
+		// Headless, renders into offscreen images instead of a swapchain and needs neither a window nor a display.
+		// Any device with graphics and timeline semaphores will do, including software ones like lavapipe.
+		VulkanRenderer(VkExtent2D extent, uint32_t framesInFlight = 2);
 		~VulkanRenderer();
+
+		// Returns false when there is nothing to render to this frame, EndFrame must only be called after it returned true.
+		bool BeginFrame();
+		void EndFrame();
+
+		// Calls function(commandBuffer, begin, end) over [0, count) split into chunks of grainSize across the job system workers.
+		// Each chunk gets its own secondary command buffer inside the frame's scene pass, they execute in chunk order.
+		// Only the thread calling BeginFrame and EndFrame may call it, see VulkanFrame::ThreadCommandPools.
+		template<typename Function>
+		void RecordParallel(size_t count, Function&& function, size_t grainSize = 0)
+		{
+			if (count == 0)
+				return;
+
+			if (grainSize == 0)
+				grainSize = JobSystem::GetAutomaticGrainSize(count);
+
+			auto start = std::chrono::steady_clock::now();
+
+			// Sized from ParallelFor's own split, it runs everything as one chunk when the job system isn't running
+			size_t chunkCount = JobSystem::GetChunkCount(count, grainSize);
+			size_t firstCommandBuffer = ReserveSecondaryCommandBuffers(chunkCount);
+			std::vector<VkCommandBuffer>& commandBuffers = m_Frames[m_FrameIndex].SecondaryCommandBuffers;
+			JobSystem::ParallelFor(count, [&](size_t begin, size_t end)
+				{
+					BRICKENGINE_PROFILE_SCOPE("RecordParallel");
+					VkCommandBuffer commandBuffer = BeginSecondaryCommandBuffer();
+					function(commandBuffer, begin, end);
+					VK_CHECK(vkEndCommandBuffer(commandBuffer));
+					commandBuffers[firstCommandBuffer + (chunkCount == 1 ? 0 : begin / grainSize)] = commandBuffer;
+				}, grainSize
+			);
+
+			m_FrameStats.RecordTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		// Mapped memory that stays valid until the GPU finished the current frame, safe to call from RecordParallel
+		VulkanLinearAllocation AllocateTransient(VkDeviceSize size, VkDeviceSize alignment = 16) { return m_Frames[m_FrameIndex].TransientPool->Allocate(size, alignment); }
+
+		// Quads drawn between BeginFrame and EndFrame are flushed by EndFrame
+		VulkanBatchRenderer* GetBatchRenderer() const { return m_BatchRenderer.get(); }
+		// Drawn before the batches, nullptr when the device can't run the GPU driven path
+		VulkanMeshRenderer* GetMeshRenderer() const { return m_MeshRenderer.get(); }
+		VulkanShaderCompiler* GetShaderCompiler() const { return m_ShaderCompiler.get(); }
+		VulkanPipelineCache* GetPipelineCache() const { return m_PipelineCache.get(); }
+		VulkanPipelineLibrary* GetPipelineLibrary() const { return m_PipelineLibrary.get(); }
+		// Layouts shared by every pipeline and renderer, outlives both
+		VulkanLayoutCache* GetLayoutCache() const { return m_LayoutCache.get(); }
+		// nullptr without DescriptorIndexing, resources are then bound through per draw descriptor sets
+		VulkanBindlessHeap* GetBindlessHeap() const { return m_BindlessHeap.get(); }
+		VulkanMemoryAllocator* GetAllocator() const { return m_Allocator.get(); }
+		const VulkanRenderGraph* GetRenderGraph() const { return m_RenderGraph.get(); }
+		// Uploads are visible to the first frame begun after they were made
+		VulkanUploadManager* GetUploadManager() const { return m_UploadManager.get(); }
+		const VulkanDeviceFeatures& GetFeatures() const { return m_Features; }
+		uint32_t GetFramesInFlight() const { return static_cast<uint32_t>(m_Frames.size()); }
+		uint64_t GetFrameNumber() const { return m_FrameNumber; }
+		// True once the GPU finished the frame EndFrame numbered frameNumber
+		bool IsFrameComplete(uint64_t frameNumber) const;
+		// Stats of the last frame passed to EndFrame
+		const VulkanFrameStats& GetFrameStats() const { return m_LastFrameStats; }
+		VulkanSwapchainStats GetSwapchainStats() const;
+
+		// Runs destroy once the GPU finished every frame submitted so far and extraFrames after them, for objects
+		// recorded frames may still use. Destroyed by BeginFrame, or the destructor at the latest.
+		void Retire(std::function<void()> destroy, uint32_t extraFrames = 0);
+
+		bool IsHeadless() const { return m_Window == nullptr; }
+		// Size of the images rendered to, the swapchain's or the headless one
+		VkExtent2D GetExtent() const { return m_SwapchainExtent; }
+
+		// On by default. Off presents through mailbox where the surface supports it, frames then aren't limited by the
+		// display. Recreates the swapchain, so not between BeginFrame and EndFrame.
+		void SetVSync(bool vsync);
+		bool IsVSync() const { return m_PresentMode == VK_PRESENT_MODE_FIFO_KHR; }
+		// Headless only. Waits for the last frame passed to EndFrame and copies it into pixels as tightly packed RGBA8 rows,
+		// top row first. Stalls the graphics queue, meant for tests and captures rather than every frame.
+		bool ReadFrame(std::vector<uint8_t>& pixels);
+		// Writes the last frame as a binary PPM, which image diff tools read without any extra dependencies
+		FileError WriteFrame(const std::string& filepath);
 	private:
+		void Init(uint32_t framesInFlight);
+		size_t ReserveSecondaryCommandBuffers(size_t count);
+		VkCommandBuffer BeginSecondaryCommandBuffer();
+
 		void CreateInstance(std::vector<const char*>& requiredExtentions);
 		void SelectPhysicalDevice(std::vector<const char*>& requiredExtentions);
 		void CreateDevice(std::vector<const char*>& requiredExtentions);
-		void CreateShader(const std::string& path);
+		// Recreates the swapchain now, RequestResize waits for the window size to settle first
 		void OnWindowResize();
+		void RequestResize();
+		void DestroyRetiredObjects();
 		void CreateSwapchain();
 		void CreateSwapchainImagesAndViews();
+		void CreateSwapchainSemaphores();
+		// Headless replacement of the swapchain images, one per frame in flight
+		void CreateOffscreenImages(uint32_t count);
+		void DestroySwapchainResources();
 		void CreateRenderPass();
 		void CreateGraphicsPipeline();
+		void CreateRenderGraph();
+		void CreateFrames(uint32_t framesInFlight);
+		void WaitForTimeline(uint64_t value);
 	private:
 		Window* m_Window = nullptr;
 	private:
@@ -33,24 +228,88 @@ namespace BrickEngine {
 
 		uint32_t m_GraphicsQueueFamilyIndex = -1;
 		uint32_t m_PresentQueueFamilyIndex = -1;
+		// Same as the graphics family when the device has no separate transfer family
+		uint32_t m_TransferQueueFamilyIndex = -1;
 		VkSurfaceFormatKHR m_SurfaceFormat = {};
-		VkPresentModeKHR m_PresentMode = {};
+		VkPresentModeKHR m_PresentMode = VK_PRESENT_MODE_FIFO_KHR;
+		bool m_MailboxSupported = false;
 		VkPhysicalDevice m_PhysicalDevice = nullptr;
+		VulkanDeviceFeatures m_Features = {};
 
 		VkDevice m_Device = nullptr;
 
 		VkQueue m_GraphicsQueue = nullptr;
 		VkQueue m_PresentQueue = nullptr;
+		VkQueue m_TransferQueue = nullptr;
+		// Uploads may be flushed from any thread, guards the queues when the transfer queue is one of the others
+		std::mutex m_QueueMutex;
 
-		std::vector<VkPipelineShaderStageCreateInfo> m_ShaderStages = {};
+		std::unique_ptr<VulkanMemoryAllocator> m_Allocator;
+		std::unique_ptr<VulkanUploadManager> m_UploadManager;
 
+		int32_t m_WindowWidth = 0;
+		int32_t m_WindowHeight = 0;
+		// Size the window had when a resize was last requested, the debounce starts over when it changes
+		bool m_ResizePending = false;
+		int32_t m_PendingWidth = 0;
+		int32_t m_PendingHeight = 0;
+		std::chrono::steady_clock::time_point m_ResizeRequestTime = {};
+		VulkanSwapchainStats m_SwapchainStats = {};
 		VkExtent2D m_SwapchainExtent = {};
 		std::vector<VkImage> m_SwapchainImages = {};
 		std::vector<VkImageView> m_SwapchainImageViews = {};
 		VkSwapchainKHR m_Swapchain = nullptr;
+		// One per swapchain image, a present may still be waiting on it when the next frame using the same slot is submitted
+		std::vector<VkSemaphore> m_RenderFinishedSemaphores = {};
+		// Memory of the headless images, which take the place of the swapchain images
+		std::vector<VulkanAllocation*> m_OffscreenAllocations = {};
+
+		// Created by the first ReadFrame
+		VkCommandPool m_ReadbackCommandPool = nullptr;
+		VkCommandBuffer m_ReadbackCommandBuffer = nullptr;
+		VkBuffer m_ReadbackBuffer = nullptr;
+		VulkanAllocation* m_ReadbackAllocation = nullptr;
+
+		VkFormat m_DepthFormat = VK_FORMAT_UNDEFINED;
+
+		std::vector<VulkanFrame> m_Frames = {};
+		uint32_t m_FrameIndex = 0;
+		// Checked by BeginSecondaryCommandBuffer, only it may use the command pools of threads that aren't workers
+		std::thread::id m_FrameThread = {};
+		uint32_t m_ImageIndex = 0;
+		uint64_t m_FrameNumber = 0;
+		VkSemaphore m_FrameTimeline = nullptr;
+
+		struct RetiredObject
+		{
+			std::function<void()> Destroy = {};
+			uint64_t FrameNumber = 0;
+		};
+		// Destroyed in order, an object retired with extraFrames may hold back the ones retired after it for a few frames
+		std::deque<RetiredObject> m_RetiredObjects = {};
+
+		VulkanFrameStats m_FrameStats = {};
+		VulkanFrameStats m_LastFrameStats = {};
+		std::chrono::steady_clock::time_point m_LastFrameEnd = {};
+
+		std::unique_ptr<VulkanPipelineCache> m_PipelineCache;
+		std::unique_ptr<VulkanShaderCompiler> m_ShaderCompiler;
+		std::unique_ptr<VulkanLayoutCache> m_LayoutCache;
+		std::unique_ptr<VulkanPipelineLibrary> m_PipelineLibrary;
+		std::unique_ptr<VulkanBindlessHeap> m_BindlessHeap;
+		std::unique_ptr<VulkanBatchRenderer> m_BatchRenderer;
+		std::unique_ptr<VulkanMeshRenderer> m_MeshRenderer;
+		// Only created when the profiler is compiled in and the graphics queue can write timestamps
+		std::unique_ptr<VulkanGpuProfiler> m_GpuProfiler;
+#if defined(BRICKENGINE_ENABLE_SHADER_HOT_RELOAD)
+		// Swaps rebuilt pipelines in at the start of a frame
+		std::unique_ptr<VulkanShaderReloader> m_ShaderReloader;
+#endif
 
-		VkPipelineLayout m_PipelineLayout = nullptr;
-		VkPipeline m_Pipeline = nullptr;
+		// Owns the depth buffer and the frame's render passes, recompiled with the swapchain
+		std::unique_ptr<VulkanRenderGraph> m_RenderGraph;
+		VulkanGraphResource m_BackbufferResource = VulkanRenderGraph::InvalidResource;
+		// Pipelines and secondary command buffers are built against it, compatible with the graph's scene pass
 		VkRenderPass m_RenderPass = nullptr;
 	};
 
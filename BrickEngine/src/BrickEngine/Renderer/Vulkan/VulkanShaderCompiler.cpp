@@ -0,0 +1,313 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanShaderCompiler.hpp"
+
+#include "BrickEngine/Core/Profiler.hpp"
+
+#include <filesystem>
+#include <shaderc/shaderc.h>
+
+namespace BrickEngine {
+
+	struct VulkanShaderCacheHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t Key;
+		uint32_t DependencyCount;
+		// In bytes, after the dependencies
+		uint32_t CodeSize;
+	};
+
+	// Followed by PathLength characters
+	struct VulkanShaderCacheDependency
+	{
+		uint64_t Hash;
+		uint32_t PathLength;
+	};
+
+	static constexpr uint32_t s_CacheMagic = 0x43565053; // "SPVC"
+
+	static uint64_t HashData(const char* data, size_t size, uint64_t hash = 0xcbf29ce484222325)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= static_cast<uint8_t>(data[i]);
+			hash *= 0x100000001b3;
+		}
+		return hash;
+	}
+
+	namespace {
+
+		struct IncludeResult
+		{
+			shaderc_include_result Result = {};
+			std::string Name = {};
+			std::vector<char> Content = {};
+		};
+
+		struct IncludeContext
+		{
+			const std::vector<std::string>* IncludeDirectories = nullptr;
+			std::vector<VulkanShaderCompiler::Dependency>* Dependencies = nullptr;
+		};
+
+	}
+
+	static shaderc_include_result* ResolveInclude(void* userData, const char* requestedSource, int type, const char* requestingSource, size_t includeDepth)
+	{
+		IncludeContext* context = static_cast<IncludeContext*>(userData);
+
+		std::vector<std::string> candidates;
+		if (type == shaderc_include_type_relative)
+		{
+			std::string requesting = requestingSource;
+			size_t separator = requesting.find_last_of("/\\");
+			candidates.push_back(separator == std::string::npos ? requestedSource : requesting.substr(0, separator + 1) + requestedSource);
+		}
+		for (auto& directory : *context->IncludeDirectories)
+			candidates.push_back(directory + "/" + requestedSource);
+
+		IncludeResult* include = new IncludeResult();
+		for (auto& candidate : candidates)
+		{
+			if (File::LoadFile(candidate, include->Content) == FileError::None)
+			{
+				include->Name = candidate;
+				context->Dependencies->push_back({ candidate, HashData(include->Content.data(), include->Content.size()) });
+				break;
+			}
+		}
+
+		// An empty name tells shaderc the include failed, the content is the error message then
+		if (include->Name.empty())
+		{
+			std::string message = std::string("Can't find '") + requestedSource + "'";
+			include->Content.assign(message.begin(), message.end());
+		}
+
+		include->Result.source_name = include->Name.data();
+		include->Result.source_name_length = include->Name.size();
+		include->Result.content = include->Content.data();
+		include->Result.content_length = include->Content.size();
+		include->Result.user_data = include;
+		return &include->Result;
+	}
+
+	static void ReleaseInclude(void* userData, shaderc_include_result* result)
+	{
+		delete static_cast<IncludeResult*>(result->user_data);
+	}
+
+	VulkanShaderCompiler::VulkanShaderCompiler(const std::string& cacheDirectory, const std::vector<std::string>& includeDirectories)
+		: m_CacheDirectory(cacheDirectory), m_IncludeDirectories(includeDirectories)
+	{
+		m_Compiler = shaderc_compiler_initialize();
+		BRICKENGINE_ASSERT(m_Compiler);
+
+		unsigned int version = 0, revision = 0;
+		shaderc_get_spv_version(&version, &revision);
+		m_SpirvVersion = version;
+		m_CompilerRevision = revision;
+
+		if (!m_CacheDirectory.empty())
+		{
+			std::error_code errorCode;
+			std::filesystem::create_directories(m_CacheDirectory, errorCode);
+			if (errorCode)
+			{
+				Log::Warn(LogCategory::Renderer, "Can't create shader cache '{}', shaders are compiled on every start: {}", m_CacheDirectory, errorCode.message());
+				m_CacheDirectory.clear();
+			}
+		}
+	}
+
+	VulkanShaderCompiler::~VulkanShaderCompiler()
+	{
+		shaderc_compiler_release(m_Compiler);
+	}
+
+	bool VulkanShaderCompiler::Compile(const std::string& filepath, VulkanShaderStage stage, const std::vector<std::string>& defines, std::vector<uint32_t>& code)
+	{
+		BRICKENGINE_PROFILE_FUNCTION();
+		auto start = std::chrono::steady_clock::now();
+		code.clear();
+
+		std::vector<char> source;
+		FileError error = File::LoadFile(filepath, source);
+		if (error != FileError::None)
+		{
+			Log::Error(LogCategory::Renderer, "Failed to load shader '{}': {}", filepath, File::GetErrorString(error));
+			m_FailedCount++;
+			return false;
+		}
+
+		uint64_t key = GetKey(source, stage, defines);
+		if (!m_CacheDirectory.empty() && LoadCached(key, code))
+		{
+			m_CacheHitCount++;
+			m_CacheHitNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			return true;
+		}
+
+		shaderc_compile_options_t options = shaderc_compile_options_initialize();
+		shaderc_compile_options_set_target_env(options, shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
+#if defined(BRICKENGINE_DEBUG)
+		shaderc_compile_options_set_optimization_level(options, shaderc_optimization_level_zero);
+		shaderc_compile_options_set_generate_debug_info(options);
+#else
+		shaderc_compile_options_set_optimization_level(options, shaderc_optimization_level_performance);
+#endif
+		for (auto& define : defines)
+		{
+			size_t equals = define.find('=');
+			size_t nameLength = std::min(equals, define.size());
+			const char* value = equals == std::string::npos ? nullptr : define.data() + equals + 1;
+			shaderc_compile_options_add_macro_definition(options, define.data(), nameLength, value, value ? define.size() - equals - 1 : 0);
+		}
+
+		std::vector<Dependency> dependencies;
+		IncludeContext includeContext;
+		includeContext.IncludeDirectories = &m_IncludeDirectories;
+		includeContext.Dependencies = &dependencies;
+		shaderc_compile_options_set_include_callbacks(options, &ResolveInclude, &ReleaseInclude, &includeContext);
+
+		shaderc_shader_kind kind = shaderc_vertex_shader;
+		switch (stage)
+		{
+			case VulkanShaderStage::Vertex: kind = shaderc_vertex_shader; break;
+			case VulkanShaderStage::Fragment: kind = shaderc_fragment_shader; break;
+			case VulkanShaderStage::Compute: kind = shaderc_compute_shader; break;
+		}
+
+		shaderc_compilation_result_t result = shaderc_compile_into_spv(m_Compiler, source.data(), source.size(), kind, filepath.c_str(), "main", options);
+		bool succeeded = shaderc_result_get_compilation_status(result) == shaderc_compilation_status_success;
+		if (succeeded)
+		{
+			size_t size = shaderc_result_get_length(result);
+			code.resize(size / sizeof(uint32_t));
+			memcpy(code.data(), shaderc_result_get_bytes(result), code.size() * sizeof(uint32_t));
+		}
+		else
+			Log::Error(LogCategory::Renderer, "Failed to compile '{}':\n{}", filepath, shaderc_result_get_error_message(result));
+		shaderc_result_release(result);
+		shaderc_compile_options_release(options);
+
+		if (!succeeded)
+		{
+			m_FailedCount++;
+			return false;
+		}
+
+		if (!m_CacheDirectory.empty())
+			SaveCached(key, dependencies, code);
+
+		m_CompileCount++;
+		m_CompileNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		return true;
+	}
+
+	VulkanShaderCompilerStats VulkanShaderCompiler::GetStats() const
+	{
+		VulkanShaderCompilerStats stats;
+		stats.CompileCount = m_CompileCount;
+		stats.CacheHitCount = m_CacheHitCount;
+		stats.FailedCount = m_FailedCount;
+		stats.CompileTime = m_CompileNanoseconds * 1e-9;
+		stats.CacheHitTime = m_CacheHitNanoseconds * 1e-9;
+		return stats;
+	}
+
+	uint64_t VulkanShaderCompiler::GetKey(const std::vector<char>& source, VulkanShaderStage stage, const std::vector<std::string>& defines) const
+	{
+		uint32_t version[] = { CacheVersion, m_SpirvVersion, m_CompilerRevision, static_cast<uint32_t>(stage), 0 };
+#if defined(BRICKENGINE_DEBUG)
+		// Unoptimized with debug info
+		version[4] = 1;
+#endif
+		uint64_t hash = HashData(reinterpret_cast<const char*>(version), sizeof(version));
+		hash = HashData(source.data(), source.size(), hash);
+		for (auto& define : defines)
+		{
+			// The terminator keeps { "AB" } and { "A", "B" } apart
+			hash = HashData(define.c_str(), define.size() + 1, hash);
+		}
+		return hash;
+	}
+
+	std::string VulkanShaderCompiler::GetCachePath(uint64_t key) const
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "/%016llx.spv", static_cast<unsigned long long>(key));
+		return m_CacheDirectory + name;
+	}
+
+	bool VulkanShaderCompiler::LoadCached(uint64_t key, std::vector<uint32_t>& code)
+	{
+		FileView file;
+		if (File::MapFile(GetCachePath(key), file) != FileError::None)
+			return false;
+
+		const char* data = file.GetData();
+		size_t size = file.GetSize();
+		if (size < sizeof(VulkanShaderCacheHeader))
+			return false;
+
+		VulkanShaderCacheHeader header;
+		memcpy(&header, data, sizeof(header));
+		if (header.Magic != s_CacheMagic || header.Version != CacheVersion || header.Key != key || header.CodeSize % sizeof(uint32_t) != 0)
+			return false;
+
+		size_t offset = sizeof(header);
+		std::vector<char> contents;
+		for (uint32_t i = 0; i < header.DependencyCount; i++)
+		{
+			VulkanShaderCacheDependency dependency;
+			if (size - offset < sizeof(dependency))
+				return false;
+			memcpy(&dependency, data + offset, sizeof(dependency));
+			offset += sizeof(dependency);
+			if (size - offset < dependency.PathLength)
+				return false;
+
+			std::string path(data + offset, dependency.PathLength);
+			offset += dependency.PathLength;
+			if (File::LoadFile(path, contents) != FileError::None || HashData(contents.data(), contents.size()) != dependency.Hash)
+				return false;
+		}
+
+		if (size - offset != header.CodeSize)
+			return false;
+		code.resize(header.CodeSize / sizeof(uint32_t));
+		memcpy(code.data(), data + offset, header.CodeSize);
+		return true;
+	}
+
+	void VulkanShaderCompiler::SaveCached(uint64_t key, const std::vector<Dependency>& dependencies, const std::vector<uint32_t>& code)
+	{
+		VulkanShaderCacheHeader header = {};
+		header.Magic = s_CacheMagic;
+		header.Version = CacheVersion;
+		header.Key = key;
+		header.DependencyCount = static_cast<uint32_t>(dependencies.size());
+		header.CodeSize = static_cast<uint32_t>(code.size() * sizeof(uint32_t));
+
+		std::vector<char> data(reinterpret_cast<const char*>(&header), reinterpret_cast<const char*>(&header + 1));
+		for (auto& dependency : dependencies)
+		{
+			VulkanShaderCacheDependency entry = {};
+			entry.Hash = dependency.Hash;
+			entry.PathLength = static_cast<uint32_t>(dependency.Path.size());
+			data.insert(data.end(), reinterpret_cast<const char*>(&entry), reinterpret_cast<const char*>(&entry + 1));
+			data.insert(data.end(), dependency.Path.begin(), dependency.Path.end());
+		}
+		data.insert(data.end(), reinterpret_cast<const char*>(code.data()), reinterpret_cast<const char*>(code.data() + code.size()));
+
+		// A thread compiling the same shader may be writing it as well, either copy is fine
+		std::string filepath = GetCachePath(key);
+		FileError error = File::WriteFile(filepath, data.data(), data.size());
+		if (error != FileError::None)
+			Log::Trace(LogCategory::Renderer, "Failed to write shader cache '{}': {}", filepath, File::GetErrorString(error));
+	}
+
+}
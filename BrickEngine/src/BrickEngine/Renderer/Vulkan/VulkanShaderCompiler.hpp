@@ -0,0 +1,74 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+struct shaderc_compiler;
+
+namespace BrickEngine {
+
+	enum class VulkanShaderStage : uint8_t
+	{
+		Vertex,
+		Fragment,
+		Compute
+	};
+
+	struct VulkanShaderCompilerStats
+	{
+		uint32_t CompileCount = 0;
+		uint32_t CacheHitCount = 0;
+		uint32_t FailedCount = 0;
+		// Seconds summed over every thread, hashing and validating cache entries counts as compiling on a miss
+		double CompileTime = 0.0;
+		double CacheHitTime = 0.0;
+	};
+
+	// Compiles GLSL to SPIR-V in process with shaderc. #include "file" is looked up next to the including file first,
+	// #include <file> only in the include directories, both through File so packed sources work as well.
+	// Results are cached in a directory, keyed by a hash of the source, stage, definitions and compiler version. Entries
+	// record what the source included and are ignored once any of it changed. Thread safe.
+	class VulkanShaderCompiler
+	{
+	public:
+		// Bump when the cache file layout or anything else the key doesn't cover changes
+		static constexpr uint32_t CacheVersion = 1;
+
+		// An empty cacheDirectory disables the cache
+		VulkanShaderCompiler(const std::string& cacheDirectory, const std::vector<std::string>& includeDirectories = {});
+		~VulkanShaderCompiler();
+
+		VulkanShaderCompiler(const VulkanShaderCompiler&) = delete;
+		VulkanShaderCompiler& operator=(const VulkanShaderCompiler&) = delete;
+
+		// defines are NAME or NAME=VALUE. Errors are logged, code is left empty then.
+		bool Compile(const std::string& filepath, VulkanShaderStage stage, const std::vector<std::string>& defines, std::vector<uint32_t>& code);
+
+		const std::string& GetCacheDirectory() const { return m_CacheDirectory; }
+		VulkanShaderCompilerStats GetStats() const;
+
+		// A file a shader included and the hash of what it contained
+		struct Dependency
+		{
+			std::string Path = {};
+			uint64_t Hash = 0;
+		};
+	private:
+		uint64_t GetKey(const std::vector<char>& source, VulkanShaderStage stage, const std::vector<std::string>& defines) const;
+		std::string GetCachePath(uint64_t key) const;
+		bool LoadCached(uint64_t key, std::vector<uint32_t>& code);
+		void SaveCached(uint64_t key, const std::vector<Dependency>& dependencies, const std::vector<uint32_t>& code);
+	private:
+		std::string m_CacheDirectory = {};
+		std::vector<std::string> m_IncludeDirectories = {};
+		shaderc_compiler* m_Compiler = nullptr;
+		uint32_t m_SpirvVersion = 0;
+		uint32_t m_CompilerRevision = 0;
+
+		std::atomic<uint32_t> m_CompileCount = 0;
+		std::atomic<uint32_t> m_CacheHitCount = 0;
+		std::atomic<uint32_t> m_FailedCount = 0;
+		std::atomic<uint64_t> m_CompileNanoseconds = 0;
+		std::atomic<uint64_t> m_CacheHitNanoseconds = 0;
+	};
+
+}
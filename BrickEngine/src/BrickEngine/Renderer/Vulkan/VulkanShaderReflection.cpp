@@ -0,0 +1,548 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanShaderReflection.hpp"
+
+namespace BrickEngine {
+
+	// The parts of the SPIR-V specification reflection needs
+	namespace Spirv {
+
+		constexpr uint32_t Magic = 0x07230203;
+		constexpr uint32_t HeaderWords = 5;
+
+		enum Op : uint16_t
+		{
+			OpName = 5,
+			OpEntryPoint = 15,
+			OpTypeBool = 20,
+			OpTypeInt = 21,
+			OpTypeFloat = 22,
+			OpTypeVector = 23,
+			OpTypeMatrix = 24,
+			OpTypeImage = 25,
+			OpTypeSampler = 26,
+			OpTypeSampledImage = 27,
+			OpTypeArray = 28,
+			OpTypeRuntimeArray = 29,
+			OpTypeStruct = 30,
+			OpTypePointer = 32,
+			OpConstant = 43,
+			OpSpecConstantTrue = 48,
+			OpSpecConstantFalse = 49,
+			OpSpecConstant = 50,
+			OpVariable = 59,
+			OpDecorate = 71,
+			OpMemberDecorate = 72
+		};
+
+		enum Decoration : uint32_t
+		{
+			SpecId = 1,
+			Block = 2,
+			BufferBlock = 3,
+			RowMajor = 4,
+			ArrayStride = 6,
+			MatrixStride = 7,
+			BuiltIn = 11,
+			Location = 30,
+			Binding = 33,
+			DescriptorSet = 34,
+			Offset = 35
+		};
+
+		enum StorageClass : uint32_t
+		{
+			UniformConstant = 0,
+			Input = 1,
+			Uniform = 2,
+			PushConstant = 9,
+			StorageBuffer = 12
+		};
+
+		enum Dim : uint32_t
+		{
+			DimBuffer = 5,
+			DimSubpassData = 6
+		};
+
+	}
+
+	namespace {
+
+		constexpr uint32_t s_Unset = std::numeric_limits<uint32_t>::max();
+
+		struct MemberInfo
+		{
+			uint32_t Offset = s_Unset;
+			uint32_t MatrixStride = 0;
+			bool RowMajor = false;
+		};
+
+		struct IdInfo
+		{
+			uint16_t Opcode = 0;
+			// Index of the instruction's first word
+			uint32_t Instruction = 0;
+			std::string Name = {};
+
+			uint32_t Location = s_Unset;
+			uint32_t Binding = s_Unset;
+			uint32_t Set = s_Unset;
+			uint32_t SpecId = s_Unset;
+			uint32_t ArrayStride = 0;
+			bool BuiltIn = false;
+			bool Block = false;
+			bool BufferBlock = false;
+			std::vector<MemberInfo> Members = {};
+		};
+
+		class SpirvModule
+		{
+		public:
+			SpirvModule(const uint32_t* code, size_t wordCount)
+				: m_Code(code), m_WordCount(wordCount)
+			{
+			}
+
+			bool Parse()
+			{
+				if (m_WordCount < Spirv::HeaderWords || m_Code[0] != Spirv::Magic)
+					return false;
+				m_Ids.resize(m_Code[3]);
+
+				for (size_t word = Spirv::HeaderWords; word < m_WordCount;)
+				{
+					uint16_t opcode = m_Code[word] & 0xffff;
+					uint32_t count = m_Code[word] >> 16;
+					if (count == 0 || word + count > m_WordCount)
+						return false;
+					if (!ParseInstruction(opcode, static_cast<uint32_t>(word), count))
+						return false;
+					word += count;
+				}
+				return m_HasEntryPoint;
+			}
+
+			VkShaderStageFlagBits GetStage() const { return m_Stage; }
+			const std::vector<IdInfo>& GetIds() const { return m_Ids; }
+
+			const uint32_t* GetOperands(const IdInfo& info) const { return m_Code + info.Instruction + 1; }
+			uint32_t GetOperandCount(const IdInfo& info) const { return (m_Code[info.Instruction] >> 16) - 1; }
+
+			const IdInfo* Find(uint32_t id) const
+			{
+				if (id >= m_Ids.size() || m_Ids[id].Opcode == 0)
+					return nullptr;
+				return &m_Ids[id];
+			}
+
+			// Follows arrays down to their element type, multiplying their lengths into count. Zero for runtime arrays.
+			const IdInfo* StripArrays(uint32_t type, uint32_t& count) const
+			{
+				count = 1;
+				const IdInfo* info = Find(type);
+				while (info && (info->Opcode == Spirv::OpTypeArray || info->Opcode == Spirv::OpTypeRuntimeArray))
+				{
+					const uint32_t* operands = GetOperands(*info);
+					if (info->Opcode == Spirv::OpTypeRuntimeArray)
+						count = 0;
+					else
+						count *= GetConstant(operands[2]);
+					info = Find(operands[1]);
+				}
+				return info;
+			}
+
+			uint32_t GetConstant(uint32_t id) const
+			{
+				const IdInfo* info = Find(id);
+				if (!info || info->Opcode != Spirv::OpConstant)
+					return 0;
+				return GetOperands(*info)[2];
+			}
+
+			// Bytes a value of type takes in an explicitly laid out block, member describes how its struct lays it out
+			uint32_t GetSize(uint32_t type, const MemberInfo& member) const
+			{
+				const IdInfo* info = Find(type);
+				if (!info)
+					return 0;
+
+				const uint32_t* operands = GetOperands(*info);
+				switch (info->Opcode)
+				{
+					case Spirv::OpTypeBool: return 4;
+					case Spirv::OpTypeInt:
+					case Spirv::OpTypeFloat: return operands[1] / 8;
+					case Spirv::OpTypeVector: return GetSize(operands[1], member) * operands[2];
+					case Spirv::OpTypeMatrix:
+					{
+						uint32_t columns = operands[2];
+						if (!member.RowMajor)
+							return member.MatrixStride * columns;
+						const IdInfo* column = Find(operands[1]);
+						return column ? member.MatrixStride * GetOperands(*column)[2] : 0;
+					}
+					case Spirv::OpTypeArray: return info->ArrayStride * GetConstant(operands[2]);
+					// Only the fixed part, the array is as long as the buffer
+					case Spirv::OpTypeRuntimeArray: return 0;
+					case Spirv::OpTypeStruct:
+					{
+						uint32_t size = 0;
+						for (uint32_t i = 0; i + 1 < GetOperandCount(*info); i++)
+						{
+							const MemberInfo& structMember = i < info->Members.size() ? info->Members[i] : MemberInfo();
+							if (structMember.Offset != s_Unset)
+								size = std::max(size, structMember.Offset + GetSize(operands[i + 1], structMember));
+						}
+						return size;
+					}
+					default: return 0;
+				}
+			}
+		private:
+			bool ParseInstruction(uint16_t opcode, uint32_t word, uint32_t count)
+			{
+				const uint32_t* operands = m_Code + word + 1;
+				uint32_t operandCount = count - 1;
+				switch (opcode)
+				{
+					case Spirv::OpEntryPoint:
+					{
+						// One stage per module, the first entry point decides it
+						if (operandCount < 3 || m_HasEntryPoint)
+							return true;
+						switch (operands[0])
+						{
+							case 0: m_Stage = VK_SHADER_STAGE_VERTEX_BIT; break;
+							case 1: m_Stage = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT; break;
+							case 2: m_Stage = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT; break;
+							case 3: m_Stage = VK_SHADER_STAGE_GEOMETRY_BIT; break;
+							case 4: m_Stage = VK_SHADER_STAGE_FRAGMENT_BIT; break;
+							case 5: m_Stage = VK_SHADER_STAGE_COMPUTE_BIT; break;
+							default: return false;
+						}
+						m_HasEntryPoint = true;
+						return true;
+					}
+					case Spirv::OpName:
+					{
+						if (operandCount < 2 || operands[0] >= m_Ids.size())
+							return operandCount >= 2;
+						// Nul terminated and padded to whole words
+						const char* name = reinterpret_cast<const char*>(operands + 1);
+						m_Ids[operands[0]].Name.assign(name, strnlen(name, (operandCount - 1) * sizeof(uint32_t)));
+						return true;
+					}
+					case Spirv::OpDecorate:
+					{
+						if (operandCount < 2 || operands[0] >= m_Ids.size())
+							return false;
+						IdInfo& info = m_Ids[operands[0]];
+						uint32_t value = operandCount > 2 ? operands[2] : 0;
+						switch (operands[1])
+						{
+							case Spirv::SpecId: info.SpecId = value; break;
+							case Spirv::Block: info.Block = true; break;
+							case Spirv::BufferBlock: info.BufferBlock = true; break;
+							case Spirv::ArrayStride: info.ArrayStride = value; break;
+							case Spirv::BuiltIn: info.BuiltIn = true; break;
+							case Spirv::Location: info.Location = value; break;
+							case Spirv::Binding: info.Binding = value; break;
+							case Spirv::DescriptorSet: info.Set = value; break;
+						}
+						return true;
+					}
+					case Spirv::OpMemberDecorate:
+					{
+						if (operandCount < 3 || operands[0] >= m_Ids.size())
+							return false;
+						std::vector<MemberInfo>& members = m_Ids[operands[0]].Members;
+						if (members.size() <= operands[1])
+							members.resize(operands[1] + 1);
+						MemberInfo& member = members[operands[1]];
+						uint32_t value = operandCount > 3 ? operands[3] : 0;
+						switch (operands[2])
+						{
+							case Spirv::Offset: member.Offset = value; break;
+							case Spirv::MatrixStride: member.MatrixStride = value; break;
+							case Spirv::RowMajor: member.RowMajor = true; break;
+						}
+						return true;
+					}
+					case Spirv::OpTypeBool:
+					case Spirv::OpTypeInt:
+					case Spirv::OpTypeFloat:
+					case Spirv::OpTypeVector:
+					case Spirv::OpTypeMatrix:
+					case Spirv::OpTypeImage:
+					case Spirv::OpTypeSampler:
+					case Spirv::OpTypeSampledImage:
+					case Spirv::OpTypeArray:
+					case Spirv::OpTypeRuntimeArray:
+					case Spirv::OpTypeStruct:
+					case Spirv::OpTypePointer:
+						// Types define their result id first
+						return Define(operandCount > 0 ? operands[0] : s_Unset, opcode, word);
+					case Spirv::OpConstant:
+					case Spirv::OpSpecConstantTrue:
+					case Spirv::OpSpecConstantFalse:
+					case Spirv::OpSpecConstant:
+					case Spirv::OpVariable:
+						// Everything else has its result type first
+						return Define(operandCount > 1 ? operands[1] : s_Unset, opcode, word);
+					default:
+						return true;
+				}
+			}
+
+			bool Define(uint32_t id, uint16_t opcode, uint32_t word)
+			{
+				if (id >= m_Ids.size())
+					return false;
+				m_Ids[id].Opcode = opcode;
+				m_Ids[id].Instruction = word;
+				return true;
+			}
+		private:
+			const uint32_t* m_Code = nullptr;
+			size_t m_WordCount = 0;
+			std::vector<IdInfo> m_Ids = {};
+			VkShaderStageFlagBits m_Stage = VK_SHADER_STAGE_VERTEX_BIT;
+			bool m_HasEntryPoint = false;
+		};
+
+		VkFormat GetVertexFormat(const SpirvModule& module, const IdInfo& type)
+		{
+			uint32_t components = 1;
+			const IdInfo* scalar = &type;
+			if (type.Opcode == Spirv::OpTypeVector)
+			{
+				components = module.GetOperands(type)[2];
+				scalar = module.Find(module.GetOperands(type)[1]);
+			}
+			if (!scalar || components < 1 || components > 4 || module.GetOperands(*scalar)[1] != 32)
+				return VK_FORMAT_UNDEFINED;
+
+			static constexpr VkFormat floatFormats[] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+			static constexpr VkFormat intFormats[] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+			static constexpr VkFormat uintFormats[] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+			if (scalar->Opcode == Spirv::OpTypeFloat)
+				return floatFormats[components - 1];
+			if (scalar->Opcode == Spirv::OpTypeInt)
+				return module.GetOperands(*scalar)[2] ? intFormats[components - 1] : uintFormats[components - 1];
+			return VK_FORMAT_UNDEFINED;
+		}
+
+		VkDescriptorType GetDescriptorType(const SpirvModule& module, const IdInfo& type, uint32_t storageClass)
+		{
+			switch (type.Opcode)
+			{
+				case Spirv::OpTypeSampler: return VK_DESCRIPTOR_TYPE_SAMPLER;
+				case Spirv::OpTypeSampledImage:
+				{
+					const IdInfo* image = module.Find(module.GetOperands(type)[1]);
+					if (image && module.GetOperands(*image)[2] == Spirv::DimBuffer)
+						return VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+					return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				}
+				case Spirv::OpTypeImage:
+				{
+					// Result, sampled type, dim, depth, arrayed, multisampled, sampled
+					const uint32_t* operands = module.GetOperands(type);
+					bool storage = operands[6] == 2;
+					if (operands[2] == Spirv::DimSubpassData)
+						return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+					if (operands[2] == Spirv::DimBuffer)
+						return storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+					return storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+				}
+				case Spirv::OpTypeStruct:
+				{
+					if (storageClass == Spirv::StorageBuffer || type.BufferBlock)
+						return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+					if (type.Block)
+						return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+					return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+				}
+				default: return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+			}
+		}
+
+	}
+
+	bool VulkanShaderReflection::Reflect(const uint32_t* code, size_t wordCount)
+	{
+		SpirvModule module(code, wordCount);
+		if (!module.Parse())
+			return false;
+
+		VkShaderStageFlagBits stage = module.GetStage();
+		std::vector<VulkanShaderVertexInput> vertexInputs;
+		std::vector<VulkanShaderBinding> bindings;
+		std::vector<VulkanShaderSpecializationConstant> constants;
+		VkPushConstantRange pushConstants = { static_cast<VkShaderStageFlags>(stage), s_Unset, 0 };
+
+		for (auto& info : module.GetIds())
+		{
+			if (info.Opcode == Spirv::OpSpecConstant || info.Opcode == Spirv::OpSpecConstantTrue || info.Opcode == Spirv::OpSpecConstantFalse)
+			{
+				if (info.SpecId == s_Unset)
+					continue;
+
+				const uint32_t* operands = module.GetOperands(info);
+				VulkanShaderSpecializationConstant& constant = constants.emplace_back();
+				constant.Id = info.SpecId;
+				constant.Stages = stage;
+				constant.Name = info.Name;
+				if (info.Opcode == Spirv::OpSpecConstant)
+				{
+					constant.Size = module.GetSize(operands[0], {});
+					if (constant.Size != 4 && constant.Size != 8)
+						return false;
+					if (module.GetOperandCount(info) < 2 + constant.Size / 4)
+						return false;
+					constant.DefaultValue = operands[2];
+					if (constant.Size == 8)
+						constant.DefaultValue |= static_cast<uint64_t>(operands[3]) << 32;
+				}
+				else
+					constant.DefaultValue = info.Opcode == Spirv::OpSpecConstantTrue ? 1 : 0;
+				continue;
+			}
+
+			if (info.Opcode != Spirv::OpVariable || info.BuiltIn)
+				continue;
+
+			// Result type, result, storage class
+			const uint32_t* operands = module.GetOperands(info);
+			uint32_t storageClass = operands[2];
+			const IdInfo* pointer = module.Find(operands[0]);
+			if (!pointer || pointer->Opcode != Spirv::OpTypePointer)
+				return false;
+			uint32_t typeId = module.GetOperands(*pointer)[2];
+
+			switch (storageClass)
+			{
+				case Spirv::Input:
+				{
+					if (stage != VK_SHADER_STAGE_VERTEX_BIT)
+						break;
+					const IdInfo* type = module.Find(typeId);
+					// Interface blocks carry built ins like gl_PerVertex
+					if (!type || type->Opcode == Spirv::OpTypeStruct)
+						break;
+					if (info.Location == s_Unset)
+						return false;
+
+					uint32_t columns = 1;
+					const IdInfo* column = type;
+					if (type->Opcode == Spirv::OpTypeMatrix)
+					{
+						columns = module.GetOperands(*type)[2];
+						column = module.Find(module.GetOperands(*type)[1]);
+					}
+					VkFormat format = column ? GetVertexFormat(module, *column) : VK_FORMAT_UNDEFINED;
+					if (format == VK_FORMAT_UNDEFINED)
+						return false;
+					uint32_t size = module.GetSize(column == type ? typeId : module.GetOperands(*type)[1], {});
+					for (uint32_t i = 0; i < columns; i++)
+						vertexInputs.push_back({ info.Location + i, format, size, info.Name });
+					break;
+				}
+				case Spirv::UniformConstant:
+				case Spirv::Uniform:
+				case Spirv::StorageBuffer:
+				{
+					uint32_t count = 1;
+					const IdInfo* type = module.StripArrays(typeId, count);
+					if (!type || info.Binding == s_Unset)
+						return false;
+
+					VulkanShaderBinding& binding = bindings.emplace_back();
+					binding.Set = info.Set == s_Unset ? 0 : info.Set;
+					binding.Binding = info.Binding;
+					binding.Type = GetDescriptorType(module, *type, storageClass);
+					binding.Count = count;
+					binding.Stages = stage;
+					// Anonymous blocks only have their type named
+					binding.Name = info.Name.empty() ? type->Name : info.Name;
+					if (binding.Type == VK_DESCRIPTOR_TYPE_MAX_ENUM)
+						return false;
+					break;
+				}
+				case Spirv::PushConstant:
+				{
+					const IdInfo* type = module.Find(typeId);
+					if (!type || type->Opcode != Spirv::OpTypeStruct)
+						return false;
+					for (uint32_t i = 0; i < type->Members.size(); i++)
+					{
+						if (type->Members[i].Offset != s_Unset)
+							pushConstants.offset = std::min(pushConstants.offset, type->Members[i].Offset);
+					}
+					pushConstants.size = module.GetSize(typeId, {});
+					break;
+				}
+			}
+		}
+
+		Stages |= stage;
+		VertexInputs.insert(VertexInputs.end(), vertexInputs.begin(), vertexInputs.end());
+		std::sort(VertexInputs.begin(), VertexInputs.end(), [](const VulkanShaderVertexInput& a, const VulkanShaderVertexInput& b) { return a.Location < b.Location; });
+
+		if (pushConstants.offset != s_Unset && pushConstants.size > pushConstants.offset)
+		{
+			pushConstants.size -= pushConstants.offset;
+			PushConstantRanges.push_back(pushConstants);
+		}
+
+		for (auto& binding : bindings)
+		{
+			auto it = std::find_if(Bindings.begin(), Bindings.end(), [&](const VulkanShaderBinding& existing) { return existing.Set == binding.Set && existing.Binding == binding.Binding; });
+			if (it == Bindings.end())
+				Bindings.push_back(binding);
+			else if (it->Type == binding.Type)
+			{
+				it->Stages |= binding.Stages;
+				it->Count = it->Count == 0 || binding.Count == 0 ? 0 : std::max(it->Count, binding.Count);
+			}
+			else
+				Log::Warn(LogCategory::Renderer, "Binding {} of set {} is '{}' in one stage and something else in another", binding.Binding, binding.Set, binding.Name);
+		}
+		std::sort(Bindings.begin(), Bindings.end(), [](const VulkanShaderBinding& a, const VulkanShaderBinding& b) { return a.Set != b.Set ? a.Set < b.Set : a.Binding < b.Binding; });
+
+		for (auto& constant : constants)
+		{
+			auto it = std::find_if(SpecializationConstants.begin(), SpecializationConstants.end(), [&](const VulkanShaderSpecializationConstant& existing) { return existing.Id == constant.Id; });
+			if (it == SpecializationConstants.end())
+				SpecializationConstants.push_back(constant);
+			else
+				it->Stages |= constant.Stages;
+		}
+		std::sort(SpecializationConstants.begin(), SpecializationConstants.end(), [](const VulkanShaderSpecializationConstant& a, const VulkanShaderSpecializationConstant& b) { return a.Id < b.Id; });
+		return true;
+	}
+
+	uint32_t VulkanShaderReflection::GetSetCount() const
+	{
+		return Bindings.empty() ? 0 : Bindings.back().Set + 1;
+	}
+
+	std::vector<VkDescriptorSetLayoutBinding> VulkanShaderReflection::GetSetBindings(uint32_t set) const
+	{
+		std::vector<VkDescriptorSetLayoutBinding> setBindings;
+		for (auto& binding : Bindings)
+		{
+			if (binding.Set != set)
+				continue;
+			VkDescriptorSetLayoutBinding& setBinding = setBindings.emplace_back();
+			setBinding.binding = binding.Binding;
+			setBinding.descriptorType = binding.Type;
+			setBinding.descriptorCount = binding.Count;
+			setBinding.stageFlags = binding.Stages;
+			setBinding.pImmutableSamplers = nullptr;
+		}
+		return setBindings;
+	}
+
+}
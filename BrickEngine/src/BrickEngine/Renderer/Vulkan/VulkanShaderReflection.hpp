@@ -0,0 +1,63 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanPlatform.hpp"
+
+namespace BrickEngine {
+
+	struct VulkanShaderVertexInput
+	{
+		uint32_t Location = 0;
+		VkFormat Format = VK_FORMAT_UNDEFINED;
+		// Bytes the format takes
+		uint32_t Size = 0;
+		std::string Name = {};
+	};
+
+	struct VulkanShaderBinding
+	{
+		uint32_t Set = 0;
+		uint32_t Binding = 0;
+		VkDescriptorType Type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+		// Zero for runtime sized arrays
+		uint32_t Count = 1;
+		VkShaderStageFlags Stages = 0;
+		std::string Name = {};
+	};
+
+	struct VulkanShaderSpecializationConstant
+	{
+		uint32_t Id = 0;
+		// In bytes, booleans are 4 like VkBool32
+		uint32_t Size = 4;
+		uint64_t DefaultValue = 0;
+		VkShaderStageFlags Stages = 0;
+		std::string Name = {};
+	};
+
+	// Interface of one or more shader stages read from their SPIR-V, everything a pipeline layout and the vertex input
+	// state are built from. Resources are reported whether the entry point uses them or not.
+	struct VulkanShaderReflection
+	{
+		VkShaderStageFlags Stages = 0;
+		// Vertex stage only, by location. Matrices take a location per column.
+		std::vector<VulkanShaderVertexInput> VertexInputs = {};
+		// By set, then binding
+		std::vector<VulkanShaderBinding> Bindings = {};
+		// One per stage, covering every member of its push constant block
+		std::vector<VkPushConstantRange> PushConstantRanges = {};
+		// By id
+		std::vector<VulkanShaderSpecializationConstant> SpecializationConstants = {};
+
+		// Adds the interface of one stage, bindings and constants already present gain the stage. False when code isn't
+		// SPIR-V, has no entry point or declares something in a way this doesn't understand, nothing is added then.
+		bool Reflect(const uint32_t* code, size_t wordCount);
+
+		// Highest set a binding uses plus one
+		uint32_t GetSetCount() const;
+		// Bindings of one set as a descriptor set layout takes them
+		std::vector<VkDescriptorSetLayoutBinding> GetSetBindings(uint32_t set) const;
+	};
+
+}
@@ -0,0 +1,127 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanShaderReloader.hpp"
+
+#include "BrickEngine/Core/Profiler.hpp"
+
+namespace BrickEngine {
+
+	namespace {
+
+		std::string GetDirectory(const std::string& path)
+		{
+			size_t separator = path.find_last_of("/\\");
+			return separator == std::string::npos ? "." : path.substr(0, separator);
+		}
+
+		std::string GetFileName(const std::string& path)
+		{
+			size_t separator = path.find_last_of("/\\");
+			return separator == std::string::npos ? path : path.substr(separator + 1);
+		}
+
+		bool EndsWith(const std::string& string, std::string_view suffix)
+		{
+			return string.size() >= suffix.size() && string.compare(string.size() - suffix.size(), suffix.size(), suffix) == 0;
+		}
+
+	}
+
+	VulkanShaderReloader::VulkanShaderReloader(VulkanPipelineLibrary* library, VulkanShaderCompiler* compiler)
+		: m_Library(library), m_Compiler(compiler)
+	{
+		for (auto& source : m_Library->GetShaderSources())
+		{
+			std::string directory = GetDirectory(source.Source);
+			auto it = std::find_if(m_Watchers.begin(), m_Watchers.end(), [&](const std::unique_ptr<FileWatcher>& watcher) { return watcher->GetDirectory() == directory; });
+			if (it == m_Watchers.end())
+				m_Watchers.push_back(std::make_unique<FileWatcher>(directory));
+		}
+
+		m_Running = true;
+		m_Thread = std::thread(&VulkanShaderReloader::Run, this);
+		Log::Info(LogCategory::Renderer, "Hot reloading shaders from {} directory(s)", m_Watchers.size());
+	}
+
+	VulkanShaderReloader::~VulkanShaderReloader()
+	{
+		m_Running = false;
+		m_Thread.join();
+	}
+
+	uint32_t VulkanShaderReloader::Apply(const std::function<void(std::function<void()>)>& retire)
+	{
+		uint32_t count = m_Library->ApplyReloads(retire);
+		if (count > 0)
+			Log::Info(LogCategory::Renderer, "Swapped in {} reloaded pipeline(s)", count);
+		return count;
+	}
+
+	void VulkanShaderReloader::Run()
+	{
+		BRICKENGINE_PROFILE_THREAD("Shader Reloader");
+
+		// Shared by the watchers, waiting on each in turn
+		uint32_t timeoutMs = 100 / static_cast<uint32_t>(std::max<size_t>(m_Watchers.size(), 1));
+		std::vector<std::string> changedFiles;
+		while (m_Running)
+		{
+			std::vector<VulkanShaderSource> sources;
+			for (auto& watcher : m_Watchers)
+			{
+				changedFiles.clear();
+				if (!watcher->Wait(changedFiles, timeoutMs))
+					continue;
+				while (watcher->Wait(changedFiles, SettleTimeMs))
+				{
+				}
+
+				// Pipelines may have been registered since the last change
+				for (auto& source : m_Library->GetShaderSources())
+				{
+					if (GetDirectory(source.Source) != watcher->GetDirectory())
+						continue;
+
+					std::string name = GetFileName(source.Source);
+					bool affected = std::any_of(changedFiles.begin(), changedFiles.end(), [&](const std::string& file)
+						{
+							if (!EndsWith(file, ".glsl"))
+								return false;
+							if (EndsWith(file, ".vert.glsl") || EndsWith(file, ".frag.glsl") || EndsWith(file, ".comp.glsl"))
+								return file.size() == name.size() + 10 && file.compare(0, name.size(), name) == 0;
+							return true;
+						}
+					);
+					if (affected)
+						sources.push_back(source);
+				}
+			}
+
+			if (!sources.empty())
+				Reload(sources);
+		}
+	}
+
+	void VulkanShaderReloader::Reload(const std::vector<VulkanShaderSource>& sources)
+	{
+		BRICKENGINE_PROFILE_FUNCTION();
+
+		for (auto& source : sources)
+		{
+			auto start = std::chrono::steady_clock::now();
+
+			VulkanShaderCode code;
+			bool compiled = source.Compute ? m_Compiler->Compile(source.Source + ".comp.glsl", VulkanShaderStage::Compute, source.Defines, code.Compute) :
+				m_Compiler->Compile(source.Source + ".vert.glsl", VulkanShaderStage::Vertex, source.Defines, code.Vertex) &&
+				m_Compiler->Compile(source.Source + ".frag.glsl", VulkanShaderStage::Fragment, source.Defines, code.Fragment);
+			if (!compiled || !m_Library->PrepareReload(source.ShaderPath, code))
+			{
+				Log::Warn(LogCategory::Renderer, "Keeping the previous '{}' shaders", source.ShaderPath);
+				continue;
+			}
+
+			Log::Info(LogCategory::Renderer, "Recompiled '{}' in {} ms", source.ShaderPath,
+				std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1000.0);
+		}
+	}
+
+}
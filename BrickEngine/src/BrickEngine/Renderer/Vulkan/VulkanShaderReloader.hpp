@@ -0,0 +1,41 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+#include "BrickEngine/Core/FileWatcher.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanPipelineLibrary.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanShaderCompiler.hpp"
+
+namespace BrickEngine {
+
+	// Watches the GLSL sources of a pipeline library's shaders. A background thread recompiles what changed and prepares
+	// the affected pipelines, Apply swaps them in between frames.
+	// Editing a source other than a shader stage, like an included one, recompiles every shader next to it. Shaders
+	// failing to compile keep running the old code.
+	class VulkanShaderReloader
+	{
+	public:
+		// Debounce for editors saving a file in several writes
+		static constexpr uint32_t SettleTimeMs = 50;
+
+		VulkanShaderReloader(VulkanPipelineLibrary* library, VulkanShaderCompiler* compiler);
+		~VulkanShaderReloader();
+
+		VulkanShaderReloader(const VulkanShaderReloader&) = delete;
+		VulkanShaderReloader& operator=(const VulkanShaderReloader&) = delete;
+
+		// See VulkanPipelineLibrary::ApplyReloads
+		uint32_t Apply(const std::function<void(std::function<void()>)>& retire);
+	private:
+		void Run();
+		void Reload(const std::vector<VulkanShaderSource>& sources);
+	private:
+		VulkanPipelineLibrary* m_Library = nullptr;
+		VulkanShaderCompiler* m_Compiler = nullptr;
+		std::vector<std::unique_ptr<FileWatcher>> m_Watchers = {};
+
+		std::atomic<bool> m_Running = false;
+		std::thread m_Thread;
+	};
+
+}
@@ -0,0 +1,419 @@
+#include "brickpch.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanUploadManager.hpp"
+
+#include "BrickEngine/Core/Profiler.hpp"
+
+namespace BrickEngine {
+
+	// Anything uploaded may end up as vertices, indices, indirect arguments, uniforms or storage
+	static constexpr VkAccessFlags s_BufferConsumerAccess = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+	VulkanUploadManager::VulkanUploadManager(VkPhysicalDevice physicalDevice, VkDevice device, VulkanMemoryAllocator* allocator,
+		VkQueue transferQueue, uint32_t transferQueueFamilyIndex, uint32_t graphicsQueueFamilyIndex, std::mutex* queueMutex, VkDeviceSize ringSize)
+		: m_Device(device), m_Allocator(allocator), m_TransferQueue(transferQueue), m_QueueMutex(queueMutex),
+		m_TransferQueueFamilyIndex(transferQueueFamilyIndex), m_GraphicsQueueFamilyIndex(graphicsQueueFamilyIndex), m_RingSize(ringSize)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		m_ImageAlignment = std::max<VkDeviceSize>(properties.limits.optimalBufferCopyOffsetAlignment, 16);
+		BRICKENGINE_ASSERT(m_RingSize % m_ImageAlignment == 0);
+
+		VkBufferCreateInfo bufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		bufferCreateInfo.size = m_RingSize;
+		bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		VK_CHECK(vkCreateBuffer(m_Device, &bufferCreateInfo, nullptr, &m_RingBuffer));
+
+		m_RingAllocation = m_Allocator->AllocateForBuffer(m_RingBuffer, VulkanMemoryUsage::Upload);
+		BRICKENGINE_ASSERT(m_RingAllocation && m_RingAllocation->MappedData);
+
+		VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+		semaphoreTypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		semaphoreTypeCreateInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo timelineCreateInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+		timelineCreateInfo.pNext = &semaphoreTypeCreateInfo;
+		VK_CHECK(vkCreateSemaphore(m_Device, &timelineCreateInfo, nullptr, &m_Timeline));
+
+		Log::Info(LogCategory::Renderer, "Uploading on {} with a {} KiB staging ring", UsesDedicatedQueue() ? "a dedicated transfer queue" : "the graphics queue", m_RingSize / 1024);
+	}
+
+	VulkanUploadManager::~VulkanUploadManager()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			FlushLocked();
+			WaitForValue(m_SubmitValue);
+			Reclaim();
+		}
+		BRICKENGINE_ASSERT(m_Submissions.empty());
+
+		for (auto& [commandPool, commandBuffer] : m_UnusedCommandBuffers)
+			vkDestroyCommandPool(m_Device, commandPool, nullptr);
+		vkDestroySemaphore(m_Device, m_Timeline, nullptr);
+
+		vkDestroyBuffer(m_Device, m_RingBuffer, nullptr);
+		m_Allocator->Free(m_RingAllocation);
+	}
+
+	uint64_t VulkanUploadManager::UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		// Large uploads go through the ring in pieces instead of needing staging memory of their own
+		const uint8_t* source = static_cast<const uint8_t*>(data);
+		for (VkDeviceSize done = 0; done < size;)
+		{
+			VkDeviceSize chunkSize = std::min(size - done, m_RingSize / 2);
+			VkDeviceSize stagingOffset = AllocateStaging(chunkSize, 4);
+			std::memcpy(static_cast<uint8_t*>(m_RingAllocation->MappedData) + stagingOffset, source + done, chunkSize);
+
+			BufferCopy& copy = m_BufferCopies.emplace_back();
+			copy.Destination = buffer;
+			copy.Region.srcOffset = stagingOffset;
+			copy.Region.dstOffset = offset + done;
+			copy.Region.size = chunkSize;
+			done += chunkSize;
+		}
+
+		m_Stats.Bytes += size;
+		m_Stats.UploadCount++;
+		return m_SubmitValue + 1;
+	}
+
+	uint64_t VulkanUploadManager::UploadImage(const VulkanImageUpload& upload, const void* data, VkDeviceSize size)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		// Only queued once the data is staged, staging may flush the pending copies when the ring is full
+		ImageCopy copy;
+		copy.Upload = upload;
+		copy.Region.imageSubresource.aspectMask = upload.Aspect;
+		copy.Region.imageSubresource.mipLevel = upload.MipLevel;
+		copy.Region.imageSubresource.baseArrayLayer = upload.ArrayLayer;
+		copy.Region.imageSubresource.layerCount = 1;
+		copy.Region.imageExtent = upload.Extent;
+
+		// A subresource can't be copied in pieces as easily as a buffer, big ones get their own staging buffer
+		if (size > m_RingSize / 2)
+		{
+			OversizedStaging& staging = m_Oversized.emplace_back();
+
+			VkBufferCreateInfo bufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+			bufferCreateInfo.size = size;
+			bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+			bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			VK_CHECK(vkCreateBuffer(m_Device, &bufferCreateInfo, nullptr, &staging.Buffer));
+
+			staging.Allocation = m_Allocator->AllocateForBuffer(staging.Buffer, VulkanMemoryUsage::Upload);
+			BRICKENGINE_ASSERT(staging.Allocation && staging.Allocation->MappedData);
+			std::memcpy(staging.Allocation->MappedData, data, size);
+
+			copy.Source = staging.Buffer;
+			copy.Region.bufferOffset = 0;
+		}
+		else
+		{
+			VkDeviceSize stagingOffset = AllocateStaging(size, m_ImageAlignment);
+			std::memcpy(static_cast<uint8_t*>(m_RingAllocation->MappedData) + stagingOffset, data, size);
+
+			copy.Source = m_RingBuffer;
+			copy.Region.bufferOffset = stagingOffset;
+		}
+		m_ImageCopies.push_back(copy);
+
+		m_Stats.Bytes += size;
+		m_Stats.UploadCount++;
+		return m_SubmitValue + 1;
+	}
+
+	uint64_t VulkanUploadManager::Flush()
+	{
+		BRICKENGINE_PROFILE_FUNCTION();
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return FlushLocked();
+	}
+
+	uint64_t VulkanUploadManager::AcquireUploads(VkCommandBuffer commandBuffer)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		FlushLocked();
+
+		// The source stages chain with the timeline wait, which the caller does at ConsumerStages
+		if (!m_BufferAcquires.empty() || !m_ImageAcquires.empty())
+		{
+			vkCmdPipelineBarrier(commandBuffer, ConsumerStages, ConsumerStages, 0,
+				0, nullptr,
+				static_cast<uint32_t>(m_BufferAcquires.size()), m_BufferAcquires.data(),
+				static_cast<uint32_t>(m_ImageAcquires.size()), m_ImageAcquires.data()
+			);
+			m_BufferAcquires.clear();
+			m_ImageAcquires.clear();
+		}
+
+		return m_SubmitValue;
+	}
+
+	bool VulkanUploadManager::IsComplete(uint64_t value) const
+	{
+		uint64_t completedValue = 0;
+		VK_CHECK(vkGetSemaphoreCounterValue(m_Device, m_Timeline, &completedValue));
+		return completedValue >= value;
+	}
+
+	void VulkanUploadManager::Wait(uint64_t value)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (value > m_SubmitValue)
+				FlushLocked();
+		}
+		WaitForValue(value);
+	}
+
+	VulkanUploadStats VulkanUploadManager::ResetStats()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return std::exchange(m_Stats, {});
+	}
+
+	VkDeviceSize VulkanUploadManager::AllocateStaging(VkDeviceSize size, VkDeviceSize alignment)
+	{
+		BRICKENGINE_ASSERT(size <= m_RingSize);
+
+		while (true)
+		{
+			uint64_t position = (m_RingHead + alignment - 1) & ~(alignment - 1);
+			// Never wrap in the middle of an upload
+			if (position % m_RingSize + size > m_RingSize)
+				position = (position / m_RingSize + 1) * m_RingSize;
+
+			if (position + size - m_RingTail <= m_RingSize)
+			{
+				m_RingHead = position + size;
+				return position % m_RingSize;
+			}
+
+			Reclaim();
+			if (position + size - m_RingTail <= m_RingSize)
+				continue;
+
+			// Full, the copies still waiting to be submitted may be what is holding the space
+			if (!m_BufferCopies.empty() || !m_ImageCopies.empty())
+				FlushLocked();
+			BRICKENGINE_ASSERT(!m_Submissions.empty());
+
+			auto start = std::chrono::steady_clock::now();
+			WaitForValue(m_Submissions.front().Value);
+			m_Stats.StallTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			Reclaim();
+		}
+	}
+
+	uint64_t VulkanUploadManager::FlushLocked()
+	{
+		if (m_BufferCopies.empty() && m_ImageCopies.empty())
+			return m_SubmitValue;
+
+		Reclaim();
+
+		Submission submission;
+		if (!m_UnusedCommandBuffers.empty())
+		{
+			std::tie(submission.CommandPool, submission.CommandBuffer) = m_UnusedCommandBuffers.back();
+			m_UnusedCommandBuffers.pop_back();
+		}
+		else
+		{
+			VkCommandPoolCreateInfo commandPoolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+			commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			commandPoolCreateInfo.queueFamilyIndex = m_TransferQueueFamilyIndex;
+			VK_CHECK(vkCreateCommandPool(m_Device, &commandPoolCreateInfo, nullptr, &submission.CommandPool));
+
+			VkCommandBufferAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+			allocateInfo.commandPool = submission.CommandPool;
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocateInfo.commandBufferCount = 1;
+			VK_CHECK(vkAllocateCommandBuffers(m_Device, &allocateInfo, &submission.CommandBuffer));
+		}
+
+		VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		VK_CHECK(vkBeginCommandBuffer(submission.CommandBuffer, &beginInfo));
+
+		bool transferOwnership = UsesDedicatedQueue();
+		uint32_t sourceQueueFamilyIndex = transferOwnership ? m_TransferQueueFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
+		uint32_t destinationQueueFamilyIndex = transferOwnership ? m_GraphicsQueueFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
+
+		std::vector<VkImageMemoryBarrier> imageBarriers;
+		for (auto& copy : m_ImageCopies)
+		{
+			VkImageMemoryBarrier& barrier = imageBarriers.emplace_back();
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = copy.Upload.Image;
+			barrier.subresourceRange = { copy.Upload.Aspect, copy.Upload.MipLevel, 1, copy.Upload.ArrayLayer, 1 };
+		}
+		if (!imageBarriers.empty())
+			vkCmdPipelineBarrier(submission.CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+
+		// One copy command per destination no matter how many uploads went to it
+		std::stable_sort(m_BufferCopies.begin(), m_BufferCopies.end(), [](const BufferCopy& a, const BufferCopy& b) { return a.Destination < b.Destination; });
+		std::stable_sort(m_ImageCopies.begin(), m_ImageCopies.end(), [](const ImageCopy& a, const ImageCopy& b)
+			{
+				return a.Upload.Image != b.Upload.Image ? a.Upload.Image < b.Upload.Image : a.Source < b.Source;
+			}
+		);
+
+		std::vector<VkBufferMemoryBarrier> bufferBarriers;
+		std::vector<VkBufferCopy> bufferRegions;
+		for (size_t begin = 0; begin < m_BufferCopies.size();)
+		{
+			VkBuffer destination = m_BufferCopies[begin].Destination;
+			bufferRegions.clear();
+			size_t end = begin;
+			for (; end < m_BufferCopies.size() && m_BufferCopies[end].Destination == destination; end++)
+				bufferRegions.push_back(m_BufferCopies[end].Region);
+
+			vkCmdCopyBuffer(submission.CommandBuffer, m_RingBuffer, destination, static_cast<uint32_t>(bufferRegions.size()), bufferRegions.data());
+			m_Stats.CopyCount++;
+
+			// The timeline semaphore already makes the writes visible when no ownership changes hands
+			if (transferOwnership)
+			{
+				VkBufferMemoryBarrier& barrier = bufferBarriers.emplace_back();
+				barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = 0;
+				barrier.srcQueueFamilyIndex = sourceQueueFamilyIndex;
+				barrier.dstQueueFamilyIndex = destinationQueueFamilyIndex;
+				barrier.buffer = destination;
+				barrier.offset = 0;
+				barrier.size = VK_WHOLE_SIZE;
+
+				VkBufferMemoryBarrier& acquire = m_BufferAcquires.emplace_back(barrier);
+				acquire.srcAccessMask = 0;
+				acquire.dstAccessMask = s_BufferConsumerAccess;
+			}
+			begin = end;
+		}
+
+		std::vector<VkBufferImageCopy> imageRegions;
+		for (size_t begin = 0; begin < m_ImageCopies.size();)
+		{
+			const ImageCopy& first = m_ImageCopies[begin];
+			imageRegions.clear();
+			size_t end = begin;
+			for (; end < m_ImageCopies.size() && m_ImageCopies[end].Upload.Image == first.Upload.Image && m_ImageCopies[end].Source == first.Source; end++)
+				imageRegions.push_back(m_ImageCopies[end].Region);
+
+			vkCmdCopyBufferToImage(submission.CommandBuffer, first.Source, first.Upload.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(imageRegions.size()), imageRegions.data());
+			m_Stats.CopyCount++;
+			begin = end;
+		}
+
+		// Images move to their final layout as part of the release, the acquire has to repeat the same transition
+		imageBarriers.clear();
+		for (auto& copy : m_ImageCopies)
+		{
+			VkImageMemoryBarrier& barrier = imageBarriers.emplace_back();
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = 0;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = copy.Upload.FinalLayout;
+			barrier.srcQueueFamilyIndex = sourceQueueFamilyIndex;
+			barrier.dstQueueFamilyIndex = destinationQueueFamilyIndex;
+			barrier.image = copy.Upload.Image;
+			barrier.subresourceRange = { copy.Upload.Aspect, copy.Upload.MipLevel, 1, copy.Upload.ArrayLayer, 1 };
+
+			if (transferOwnership)
+			{
+				VkImageMemoryBarrier& acquire = m_ImageAcquires.emplace_back(barrier);
+				acquire.srcAccessMask = 0;
+				acquire.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			}
+		}
+		if (!bufferBarriers.empty() || !imageBarriers.empty())
+		{
+			vkCmdPipelineBarrier(submission.CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+				0, nullptr,
+				static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+				static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data()
+			);
+		}
+
+		VK_CHECK(vkEndCommandBuffer(submission.CommandBuffer));
+
+		submission.Value = ++m_SubmitValue;
+		submission.RingEnd = m_RingHead;
+		submission.Oversized = std::move(m_Oversized);
+		m_Oversized.clear();
+
+		VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+		timelineSubmitInfo.signalSemaphoreValueCount = 1;
+		timelineSubmitInfo.pSignalSemaphoreValues = &submission.Value;
+
+		VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		submitInfo.pNext = &timelineSubmitInfo;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &submission.CommandBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &m_Timeline;
+		if (m_QueueMutex)
+		{
+			std::lock_guard<std::mutex> queueLock(*m_QueueMutex);
+			VK_CHECK(vkQueueSubmit(m_TransferQueue, 1, &submitInfo, nullptr));
+		}
+		else
+			VK_CHECK(vkQueueSubmit(m_TransferQueue, 1, &submitInfo, nullptr));
+
+		m_BufferCopies.clear();
+		m_ImageCopies.clear();
+		m_Submissions.push_back(std::move(submission));
+		m_Stats.SubmissionCount++;
+		return m_SubmitValue;
+	}
+
+	void VulkanUploadManager::Reclaim()
+	{
+		if (m_Submissions.empty())
+			return;
+
+		uint64_t completedValue = 0;
+		VK_CHECK(vkGetSemaphoreCounterValue(m_Device, m_Timeline, &completedValue));
+
+		while (!m_Submissions.empty() && m_Submissions.front().Value <= completedValue)
+		{
+			Submission& submission = m_Submissions.front();
+			m_RingTail = submission.RingEnd;
+
+			for (auto& staging : submission.Oversized)
+			{
+				vkDestroyBuffer(m_Device, staging.Buffer, nullptr);
+				m_Allocator->Free(staging.Allocation);
+			}
+
+			VK_CHECK(vkResetCommandPool(m_Device, submission.CommandPool, 0));
+			m_UnusedCommandBuffers.emplace_back(submission.CommandPool, submission.CommandBuffer);
+			m_Submissions.pop_front();
+		}
+	}
+
+	void VulkanUploadManager::WaitForValue(uint64_t value) const
+	{
+		VkSemaphoreWaitInfo waitInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &m_Timeline;
+		waitInfo.pValues = &value;
+		VK_CHECK(vkWaitSemaphores(m_Device, &waitInfo, std::numeric_limits<uint64_t>::max()));
+	}
+
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "BrickEngine/Core/Base.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanPlatform.hpp"
+#include "BrickEngine/Renderer/Vulkan/VulkanMemoryAllocator.hpp"
+
+namespace BrickEngine {
+
+	// Uploads always overwrite the whole subresource, whatever the image contained before is discarded
+	struct VulkanImageUpload
+	{
+		VkImage Image = nullptr;
+		VkImageAspectFlags Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		uint32_t MipLevel = 0;
+		uint32_t ArrayLayer = 0;
+		VkExtent3D Extent = {};
+		VkImageLayout FinalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	};
+
+	struct VulkanUploadStats
+	{
+		VkDeviceSize Bytes = 0;
+		uint32_t UploadCount = 0;
+		// Copy commands recorded, uploads to the same resource in one batch share one
+		uint32_t CopyCount = 0;
+		uint32_t SubmissionCount = 0;
+		// Seconds spent waiting for the transfer queue because the staging ring was full
+		double StallTime = 0.0;
+	};
+
+	// Copies data into a persistently mapped staging ring and batches the copies into few submissions on the transfer queue.
+	// Every upload returns the value the manager's timeline semaphore reaches once the data is on the GPU.
+	// When the transfer queue belongs to another family than the graphics queue, ownership of the destination is
+	// released on the transfer queue and acquired again by AcquireUploads on the graphics queue. Thread safe.
+	class VulkanUploadManager
+	{
+	public:
+		static constexpr VkDeviceSize DefaultRingSize = 32ull * 1024 * 1024;
+		// Stages that read uploaded data, the graphics submission waits on the timeline at these
+		static constexpr VkPipelineStageFlags ConsumerStages = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+		// queueMutex is locked around submits when the transfer queue is shared with the renderer, nullptr otherwise
+		VulkanUploadManager(VkPhysicalDevice physicalDevice, VkDevice device, VulkanMemoryAllocator* allocator,
+			VkQueue transferQueue, uint32_t transferQueueFamilyIndex, uint32_t graphicsQueueFamilyIndex, std::mutex* queueMutex, VkDeviceSize ringSize = DefaultRingSize);
+		~VulkanUploadManager();
+
+		VulkanUploadManager(const VulkanUploadManager&) = delete;
+		VulkanUploadManager& operator=(const VulkanUploadManager&) = delete;
+
+		uint64_t UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+		uint64_t UploadImage(const VulkanImageUpload& upload, const void* data, VkDeviceSize size);
+
+		// Submits everything uploaded so far, returns the value of the last submission
+		uint64_t Flush();
+		// Flushes and records the ownership acquires for everything released since the last call into commandBuffer.
+		// Returns the timeline value the submission of commandBuffer has to wait for, 0 if nothing was uploaded yet. Waiting on
+		// a value that was reached already costs next to nothing, and a later submit can't rely on an earlier one having waited.
+		uint64_t AcquireUploads(VkCommandBuffer commandBuffer);
+
+		bool IsComplete(uint64_t value) const;
+		// Flushes first when value belongs to uploads that weren't submitted yet
+		void Wait(uint64_t value);
+
+		VkSemaphore GetTimeline() const { return m_Timeline; }
+		bool UsesDedicatedQueue() const { return m_TransferQueueFamilyIndex != m_GraphicsQueueFamilyIndex; }
+
+		// Stats accumulated since the last call
+		VulkanUploadStats ResetStats();
+	private:
+		struct BufferCopy
+		{
+			VkBuffer Destination = nullptr;
+			VkBufferCopy Region = {};
+		};
+
+		struct ImageCopy
+		{
+			VkBuffer Source = nullptr;
+			VulkanImageUpload Upload = {};
+			VkBufferImageCopy Region = {};
+		};
+
+		// Staging memory too big for the ring, freed once its submission completed
+		struct OversizedStaging
+		{
+			VkBuffer Buffer = nullptr;
+			VulkanAllocation* Allocation = nullptr;
+		};
+
+		struct Submission
+		{
+			uint64_t Value = 0;
+			// Ring position right after the last byte used by this submission
+			uint64_t RingEnd = 0;
+			VkCommandPool CommandPool = nullptr;
+			VkCommandBuffer CommandBuffer = nullptr;
+			std::vector<OversizedStaging> Oversized = {};
+		};
+
+		// Returns the ring offset to copy size bytes to, flushing and waiting for the transfer queue when the ring is full
+		VkDeviceSize AllocateStaging(VkDeviceSize size, VkDeviceSize alignment);
+		uint64_t FlushLocked();
+		void Reclaim();
+		void WaitForValue(uint64_t value) const;
+	private:
+		VkDevice m_Device = nullptr;
+		VulkanMemoryAllocator* m_Allocator = nullptr;
+		VkQueue m_TransferQueue = nullptr;
+		std::mutex* m_QueueMutex = nullptr;
+		uint32_t m_TransferQueueFamilyIndex = -1;
+		uint32_t m_GraphicsQueueFamilyIndex = -1;
+		VkDeviceSize m_ImageAlignment = 16;
+
+		mutable std::mutex m_Mutex;
+
+		VkBuffer m_RingBuffer = nullptr;
+		VulkanAllocation* m_RingAllocation = nullptr;
+		VkDeviceSize m_RingSize = 0;
+		// Positions only ever grow, the offset in the buffer is the position modulo the ring size
+		uint64_t m_RingHead = 0;
+		uint64_t m_RingTail = 0;
+
+		VkSemaphore m_Timeline = nullptr;
+		uint64_t m_SubmitValue = 0;
+
+		std::vector<BufferCopy> m_BufferCopies = {};
+		std::vector<ImageCopy> m_ImageCopies = {};
+		std::vector<OversizedStaging> m_Oversized = {};
+
+		std::deque<Submission> m_Submissions = {};
+		std::vector<std::pair<VkCommandPool, VkCommandBuffer>> m_UnusedCommandBuffers = {};
+
+		// Acquire half of the ownership transfers released by submitted batches
+		std::vector<VkBufferMemoryBarrier> m_BufferAcquires = {};
+		std::vector<VkImageMemoryBarrier> m_ImageAcquires = {};
+
+		VulkanUploadStats m_Stats = {};
+	};
+
+}
@@ -0,0 +1,47 @@
+#include "brickpch.hpp"
+
+#include "BrickEngine/Renderer/Vulkan/VulkanPlatform.hpp"
+
+#if defined(BRICKENGINE_PLATFORM_LINUX)
+
+#include "Platform/Linux/LinuxWindow.hpp"
+
+// Included here instead of defining VK_USE_PLATFORM_XLIB_KHR globally, Xlib's macros would leak into every file
+#include <X11/Xlib.h>
+#include <vulkan/vulkan_xlib.h>
+
+namespace BrickEngine {
+
+	const char* VulkanPlatform::GetSurfaceExtensionName()
+	{
+		return VK_KHR_XLIB_SURFACE_EXTENSION_NAME;
+	}
+
+	VkSurfaceKHR VulkanPlatform::CreateSurface(VkInstance instance, Window* window)
+	{
+		LinuxWindow* linuxWindow = dynamic_cast<LinuxWindow*>(window);
+		BRICKENGINE_ASSERT(linuxWindow && linuxWindow->IsOpen());
+
+		VkXlibSurfaceCreateInfoKHR surfaceCreateInfo = { VK_STRUCTURE_TYPE_XLIB_SURFACE_CREATE_INFO_KHR };
+		surfaceCreateInfo.dpy = linuxWindow->m_Display;
+		surfaceCreateInfo.window = linuxWindow->m_Window;
+
+		VkSurfaceKHR surface = nullptr;
+		VK_CHECK(vkCreateXlibSurfaceKHR(instance, &surfaceCreateInfo, nullptr, &surface));
+		return surface;
+	}
+
+	VkTimeDomainEXT VulkanPlatform::GetHostTimeDomain()
+	{
+		return VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+	}
+
+	uint64_t VulkanPlatform::HostTimestampToNanoseconds(uint64_t timestamp)
+	{
+		// CLOCK_MONOTONIC already counts nanoseconds
+		return timestamp;
+	}
+
+}
+
+#endif
@@ -0,0 +1,171 @@
+#include "brickpch.hpp"
+#include "Platform/Linux/LinuxWindow.hpp"
+
+#if defined(BRICKENGINE_PLATFORM_LINUX)
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/XKBlib.h>
+#include <X11/keysym.h>
+
+namespace BrickEngine {
+
+	static KeyCode TranslateKey(KeySym key)
+	{
+		if (key >= XK_a && key <= XK_z)
+			return static_cast<KeyCode>(static_cast<uint32_t>(KeyCode::A) + (key - XK_a));
+		if (key >= XK_0 && key <= XK_9)
+			return static_cast<KeyCode>(static_cast<uint32_t>(KeyCode::Num0) + (key - XK_0));
+		if (key >= XK_F1 && key <= XK_F12)
+			return static_cast<KeyCode>(static_cast<uint32_t>(KeyCode::F1) + (key - XK_F1));
+
+		switch (key)
+		{
+			case XK_space: return KeyCode::Space;
+			case XK_Return: return KeyCode::Enter;
+			case XK_Escape: return KeyCode::Escape;
+			case XK_Tab: return KeyCode::Tab;
+			case XK_BackSpace: return KeyCode::Backspace;
+			case XK_Left: return KeyCode::Left;
+			case XK_Right: return KeyCode::Right;
+			case XK_Up: return KeyCode::Up;
+			case XK_Down: return KeyCode::Down;
+			case XK_Shift_L: return KeyCode::LeftShift;
+			case XK_Control_L: return KeyCode::LeftControl;
+			case XK_Alt_L: return KeyCode::LeftAlt;
+			default: return KeyCode::Unknown;
+		}
+	}
+
+	LinuxWindow::LinuxWindow(uint32_t width, uint32_t height, const std::string& title, bool resizable)
+		: m_Width(width), m_Height(height)
+	{
+		m_Display = XOpenDisplay(nullptr);
+		if (!m_Display)
+		{
+			Log::Warn(LogCategory::Window, "Failed to open the X display, is DISPLAY set?");
+			return;
+		}
+
+		int screen = DefaultScreen(m_Display);
+		m_Window = XCreateSimpleWindow(m_Display, RootWindow(m_Display, screen), 100, 100, width, height, 0, BlackPixel(m_Display, screen), BlackPixel(m_Display, screen));
+		XStoreName(m_Display, m_Window, title.c_str());
+
+		// Closing through the window manager sends a message instead of killing the connection
+		m_DeleteAtom = XInternAtom(m_Display, "WM_DELETE_WINDOW", False);
+		Atom deleteAtom = m_DeleteAtom;
+		XSetWMProtocols(m_Display, m_Window, &deleteAtom, 1);
+
+		if (!resizable)
+		{
+			XSizeHints* sizeHints = XAllocSizeHints();
+			sizeHints->flags = PMinSize | PMaxSize;
+			sizeHints->min_width = sizeHints->max_width = width;
+			sizeHints->min_height = sizeHints->max_height = height;
+			XSetWMNormalHints(m_Display, m_Window, sizeHints);
+			XFree(sizeHints);
+		}
+
+		XSelectInput(m_Display, m_Window, StructureNotifyMask | KeyPressMask | KeyReleaseMask | ButtonPressMask | ButtonReleaseMask | PointerMotionMask | FocusChangeMask);
+		// Held keys send presses only, otherwise every repeat would come with a release
+		XkbSetDetectableAutoRepeat(m_Display, True, nullptr);
+
+		XMapWindow(m_Display, m_Window);
+		XFlush(m_Display);
+	}
+
+	LinuxWindow::~LinuxWindow()
+	{
+		if (!m_Display)
+			return;
+		XDestroyWindow(m_Display, m_Window);
+		XCloseDisplay(m_Display);
+	}
+
+	void LinuxWindow::PollEvents()
+	{
+		Event event;
+		XEvent xEvent;
+		// XPending flushes and reads what has arrived without waiting for more
+		while (XPending(m_Display))
+		{
+			XNextEvent(m_Display, &xEvent);
+			switch (xEvent.type)
+			{
+				case ConfigureNotify:
+				{
+					// Also sent when the window moves
+					if (xEvent.xconfigure.width == m_Width && xEvent.xconfigure.height == m_Height)
+						break;
+					m_Width = xEvent.xconfigure.width;
+					m_Height = xEvent.xconfigure.height;
+					event.Type = EventType::WindowResize;
+					event.Resize = { m_Width, m_Height };
+					m_Events.Push(event);
+					break;
+				}
+				case ClientMessage:
+				{
+					if (static_cast<unsigned long>(xEvent.xclient.data.l[0]) != m_DeleteAtom)
+						break;
+					m_WantsToClose = true;
+					event.Type = EventType::WindowClose;
+					m_Events.Push(event);
+					break;
+				}
+				case FocusIn:
+				case FocusOut:
+				{
+					event.Type = xEvent.type == FocusIn ? EventType::FocusGained : EventType::FocusLost;
+					m_Events.Push(event);
+					break;
+				}
+				case KeyPress:
+				case KeyRelease:
+				{
+					bool pressed = xEvent.type == KeyPress;
+					KeyCode code = TranslateKey(XLookupKeysym(&xEvent.xkey, 0));
+					bool& down = m_KeysDown[static_cast<size_t>(code)];
+					event.Type = pressed ? EventType::KeyPressed : EventType::KeyReleased;
+					event.Key = { code, pressed && down && code != KeyCode::Unknown };
+					down = pressed;
+					m_Events.Push(event);
+					break;
+				}
+				case ButtonPress:
+				case ButtonRelease:
+				{
+					bool pressed = xEvent.type == ButtonPress;
+					unsigned int button = xEvent.xbutton.button;
+					// Buttons 4 to 7 are the wheel, each notch is a press and release
+					if (button >= 4 && button <= 7)
+					{
+						if (!pressed)
+							break;
+						event.Type = EventType::MouseScrolled;
+						event.Scroll = { button == 6 ? -1.0f : button == 7 ? 1.0f : 0.0f, button == 4 ? 1.0f : button == 5 ? -1.0f : 0.0f };
+						m_Events.Push(event);
+						break;
+					}
+					if (button > 3)
+						break;
+
+					event.Type = pressed ? EventType::MouseButtonPressed : EventType::MouseButtonReleased;
+					event.Mouse = { static_cast<float>(xEvent.xbutton.x), static_cast<float>(xEvent.xbutton.y), button == 1 ? MouseButton::Left : button == 2 ? MouseButton::Middle : MouseButton::Right };
+					m_Events.Push(event);
+					break;
+				}
+				case MotionNotify:
+				{
+					event.Type = EventType::MouseMoved;
+					event.Mouse = { static_cast<float>(xEvent.xmotion.x), static_cast<float>(xEvent.xmotion.y), {} };
+					m_Events.Push(event);
+					break;
+				}
+			}
+		}
+	}
+
+}
+
+#endif
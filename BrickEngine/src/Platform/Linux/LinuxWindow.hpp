@@ -0,0 +1,42 @@
+#pragma once
+
+#include "BrickEngine/Core/Window.hpp"
+
+#if defined(BRICKENGINE_PLATFORM_LINUX)
+
+// Xlib's macros clash with engine names, only the translation units talking to X include it
+struct _XDisplay;
+
+namespace BrickEngine {
+
+	// Xlib window, Wayland sessions get one through XWayland
+	class LinuxWindow final : public Window
+	{
+		friend class VulkanPlatform;
+	public:
+		LinuxWindow(uint32_t width, uint32_t height, const std::string& title, bool resizable);
+		~LinuxWindow();
+
+		// False when no display could be opened, the window is unusable then
+		bool IsOpen() const { return m_Display != nullptr; }
+
+		virtual bool WantsToClose() override final { return m_WantsToClose; }
+		virtual void PollEvents() override final;
+
+		virtual int32_t GetWidth() override final { return m_Width; }
+		virtual int32_t GetHeight() override final { return m_Height; }
+	private:
+		_XDisplay* m_Display = nullptr;
+		// Window and Atom XIDs
+		unsigned long m_Window = 0;
+		unsigned long m_DeleteAtom = 0;
+		bool m_WantsToClose = false;
+		int32_t m_Width;
+		int32_t m_Height;
+		// X reports no repeat flag, a press of a key that is already down is a repeat
+		std::array<bool, static_cast<size_t>(KeyCode::Count)> m_KeysDown = {};
+	};
+
+}
+
+#endif
@@ -8,6 +8,11 @@
 
 namespace BrickEngine {
 
+	const char* VulkanPlatform::GetSurfaceExtensionName()
+	{
+		return VK_KHR_WIN32_SURFACE_EXTENSION_NAME;
+	}
+
 	VkSurfaceKHR VulkanPlatform::CreateSurface(VkInstance instance, Window* window)
 	{
 		WindowsWindow* windowsWindow = dynamic_cast<WindowsWindow*>(window);
@@ -22,6 +27,24 @@ namespace BrickEngine {
 		return surface;
 	}
 
+	VkTimeDomainEXT VulkanPlatform::GetHostTimeDomain()
+	{
+		return VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+	}
+
+	uint64_t VulkanPlatform::HostTimestampToNanoseconds(uint64_t timestamp)
+	{
+		static const uint64_t frequency = []()
+			{
+				LARGE_INTEGER frequency;
+				QueryPerformanceFrequency(&frequency);
+				return static_cast<uint64_t>(frequency.QuadPart);
+			}();
+
+		// Split so the multiplication can't overflow
+		return timestamp / frequency * 1000000000 + timestamp % frequency * 1000000000 / frequency;
+	}
+
 }
 
 #endif
@@ -9,6 +9,33 @@ namespace BrickEngine {
 
 	static std::uint32_t s_WindowCount = 0;
 
+	static KeyCode TranslateKey(WPARAM key)
+	{
+		if (key >= 'A' && key <= 'Z')
+			return static_cast<KeyCode>(static_cast<uint32_t>(KeyCode::A) + (key - 'A'));
+		if (key >= '0' && key <= '9')
+			return static_cast<KeyCode>(static_cast<uint32_t>(KeyCode::Num0) + (key - '0'));
+		if (key >= VK_F1 && key <= VK_F12)
+			return static_cast<KeyCode>(static_cast<uint32_t>(KeyCode::F1) + (key - VK_F1));
+
+		switch (key)
+		{
+			case VK_SPACE: return KeyCode::Space;
+			case VK_RETURN: return KeyCode::Enter;
+			case VK_ESCAPE: return KeyCode::Escape;
+			case VK_TAB: return KeyCode::Tab;
+			case VK_BACK: return KeyCode::Backspace;
+			case VK_LEFT: return KeyCode::Left;
+			case VK_RIGHT: return KeyCode::Right;
+			case VK_UP: return KeyCode::Up;
+			case VK_DOWN: return KeyCode::Down;
+			case VK_SHIFT: return KeyCode::LeftShift;
+			case VK_CONTROL: return KeyCode::LeftControl;
+			case VK_MENU: return KeyCode::LeftAlt;
+			default: return KeyCode::Unknown;
+		}
+	}
+
 	WindowsWindow::WindowsWindow(uint32_t width, uint32_t height, const std::string& title, bool resizable)
 		: m_Instance(GetModuleHandle(nullptr)), m_Width(width), m_Height(height)
 	{
@@ -100,18 +127,76 @@ namespace BrickEngine {
 
 	LRESULT CALLBACK WindowsWindow::HandleMessages(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 	{
+		Event event;
 		switch (msg)
 		{
 			case WM_SIZE:
 			{
 				m_Width = LOWORD(lParam);
 				m_Height = HIWORD(lParam);
+				event.Type = EventType::WindowResize;
+				event.Resize = { m_Width, m_Height };
+				m_Events.Push(event);
 				return 0;
 			}
 			case WM_QUIT:
 			case WM_CLOSE:
 			{
 				m_WantsToClose = true;
+				event.Type = EventType::WindowClose;
+				m_Events.Push(event);
+				return 0;
+			}
+			case WM_SETFOCUS:
+			case WM_KILLFOCUS:
+			{
+				event.Type = msg == WM_SETFOCUS ? EventType::FocusGained : EventType::FocusLost;
+				m_Events.Push(event);
+				return 0;
+			}
+			case WM_KEYDOWN:
+			case WM_SYSKEYDOWN:
+			case WM_KEYUP:
+			case WM_SYSKEYUP:
+			{
+				bool pressed = msg == WM_KEYDOWN || msg == WM_SYSKEYDOWN;
+				event.Type = pressed ? EventType::KeyPressed : EventType::KeyReleased;
+				// Bit 30 is the previous key state
+				event.Key = { TranslateKey(wParam), pressed && (lParam & (1 << 30)) != 0 };
+				m_Events.Push(event);
+				// Alt combinations still have to reach DefWindowProc
+				if (msg == WM_SYSKEYDOWN || msg == WM_SYSKEYUP)
+					break;
+				return 0;
+			}
+			case WM_MOUSEMOVE:
+			{
+				event.Type = EventType::MouseMoved;
+				event.Mouse = { static_cast<float>(static_cast<int16_t>(LOWORD(lParam))), static_cast<float>(static_cast<int16_t>(HIWORD(lParam))), {} };
+				m_Events.Push(event);
+				return 0;
+			}
+			case WM_LBUTTONDOWN:
+			case WM_LBUTTONUP:
+			case WM_RBUTTONDOWN:
+			case WM_RBUTTONUP:
+			case WM_MBUTTONDOWN:
+			case WM_MBUTTONUP:
+			{
+				bool pressed = msg == WM_LBUTTONDOWN || msg == WM_RBUTTONDOWN || msg == WM_MBUTTONDOWN;
+				MouseButton button = msg == WM_LBUTTONDOWN || msg == WM_LBUTTONUP ? MouseButton::Left : msg == WM_RBUTTONDOWN || msg == WM_RBUTTONUP ? MouseButton::Right : MouseButton::Middle;
+				event.Type = pressed ? EventType::MouseButtonPressed : EventType::MouseButtonReleased;
+				event.Mouse = { static_cast<float>(static_cast<int16_t>(LOWORD(lParam))), static_cast<float>(static_cast<int16_t>(HIWORD(lParam))), button };
+				m_Events.Push(event);
+				return 0;
+			}
+			case WM_MOUSEWHEEL:
+			case WM_MOUSEHWHEEL:
+			{
+				float notches = static_cast<float>(GET_WHEEL_DELTA_WPARAM(wParam)) / WHEEL_DELTA;
+				event.Type = EventType::MouseScrolled;
+				event.Scroll = { msg == WM_MOUSEHWHEEL ? notches : 0.0f, msg == WM_MOUSEWHEEL ? notches : 0.0f };
+				m_Events.Push(event);
 				return 0;
 			}
 		}
@@ -7,13 +7,28 @@
 #include <algorithm>
 #include <functional>
 #include <new>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <limits>
+#include <type_traits>
 
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
 #include <string>
+#include <string_view>
 #include <chrono>
 #include <thread>
 #include <sstream>
+#include <iomanip>
 #include <fstream>
 #include <vector>
+#include <deque>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -0,0 +1,99 @@
+#version 450
+
+// Specialized with VulkanMeshRenderer::CullGroupSize, 64 is only the default
+layout(local_size_x = 64, local_size_x_id = 0) in;
+
+struct Object
+{
+	mat4 Transform;
+	// World space center and radius
+	vec4 BoundingSphere;
+	uint Mesh;
+	uint Color;
+	uvec2 Padding;
+};
+
+struct Mesh
+{
+	uint IndexCount;
+	uint FirstIndex;
+	int VertexOffset;
+	uint Padding;
+};
+
+struct DrawCommand
+{
+	uint IndexCount;
+	uint InstanceCount;
+	uint FirstIndex;
+	int VertexOffset;
+	uint FirstInstance;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Objects
+{
+	Object u_Objects[];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Meshes
+{
+	Mesh u_Meshes[];
+};
+
+layout(std430, set = 0, binding = 2) writeonly buffer Draws
+{
+	DrawCommand u_Draws[];
+};
+
+layout(std430, set = 0, binding = 3) buffer DrawCount
+{
+	uint u_DrawCount;
+};
+
+layout(push_constant) uniform PushConstants
+{
+	// Normalized, pointing inwards
+	vec4 FrustumPlanes[6];
+	uint ObjectCount;
+	// Visible objects are appended behind u_DrawCount, otherwise every object gets its own draw
+	uint Compact;
+} u_PushConstants;
+
+const uint InvalidMesh = 0xffffffffu;
+
+void main()
+{
+	uint index = gl_GlobalInvocationID.x;
+	if (index >= u_PushConstants.ObjectCount)
+		return;
+
+	Object object = u_Objects[index];
+	bool visible = object.Mesh != InvalidMesh;
+	for (uint i = 0; i < 6 && visible; i++)
+		visible = dot(u_PushConstants.FrustumPlanes[i].xyz, object.BoundingSphere.xyz) + u_PushConstants.FrustumPlanes[i].w > -object.BoundingSphere.w;
+
+	DrawCommand draw;
+	draw.IndexCount = 0;
+	draw.InstanceCount = visible ? 1 : 0;
+	draw.FirstIndex = 0;
+	draw.VertexOffset = 0;
+	// The vertex shader finds the object through gl_InstanceIndex
+	draw.FirstInstance = index;
+	if (visible)
+	{
+		Mesh mesh = u_Meshes[object.Mesh];
+		draw.IndexCount = mesh.IndexCount;
+		draw.FirstIndex = mesh.FirstIndex;
+		draw.VertexOffset = mesh.VertexOffset;
+	}
+
+	if (u_PushConstants.Compact != 0)
+	{
+		if (visible)
+			u_Draws[atomicAdd(u_DrawCount, 1)] = draw;
+	}
+	else
+	{
+		u_Draws[index] = draw;
+	}
+}
@@ -0,0 +1,14 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec3 v_Normal;
+layout(location = 1) in vec4 v_Color;
+
+layout(location = 0) out vec4 o_Color;
+
+void main()
+{
+	const vec3 lightDirection = normalize(vec3(0.4, 1.0, 0.6));
+	float diffuse = max(dot(normalize(v_Normal), lightDirection), 0.0);
+	o_Color = vec4(v_Color.rgb * (0.25 + 0.75 * diffuse), v_Color.a);
+}
@@ -0,0 +1,36 @@
+#version 450
+
+struct Object
+{
+	mat4 Transform;
+	vec4 BoundingSphere;
+	uint Mesh;
+	uint Color;
+	uvec2 Padding;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Objects
+{
+	Object u_Objects[];
+};
+
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in vec3 a_Normal;
+
+layout(push_constant) uniform PushConstants
+{
+	mat4 ViewProjection;
+} u_PushConstants;
+
+layout(location = 0) out vec3 v_Normal;
+layout(location = 1) out vec4 v_Color;
+
+void main()
+{
+	// The culling pass stores the object index as the first instance
+	Object object = u_Objects[gl_InstanceIndex];
+	gl_Position = u_PushConstants.ViewProjection * object.Transform * vec4(a_Position, 1.0);
+	// Good enough for uniform scales
+	v_Normal = mat3(object.Transform) * a_Normal;
+	v_Color = unpackUnorm4x8(object.Color);
+}
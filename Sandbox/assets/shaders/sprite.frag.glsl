@@ -0,0 +1,37 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+#if defined(BRICKENGINE_POOLED_DESCRIPTORS)
+layout(set = 0, binding = 0) uniform sampler2D u_Texture;
+#else
+#extension GL_EXT_nonuniform_qualifier : require
+
+// The renderer's bindless heap, the indices are pushed per draw
+layout(set = 0, binding = 0) uniform texture2D u_Textures[];
+layout(set = 0, binding = 1) uniform sampler u_Samplers[];
+
+layout(push_constant) uniform PushConstants
+{
+	// Behind the vertex shader's view projection
+	layout(offset = 64) uint TextureIndex;
+	uint SamplerIndex;
+} u_PushConstants;
+#endif
+
+layout(location = 0) in vec2 v_UV;
+layout(location = 1) in vec4 v_Color;
+
+layout(location = 0) out vec4 o_Color;
+
+void main()
+{
+#if defined(BRICKENGINE_POOLED_DESCRIPTORS)
+	vec4 color = texture(u_Texture, v_UV) * v_Color;
+#else
+	vec4 color = texture(sampler2D(u_Textures[u_PushConstants.TextureIndex], u_Samplers[u_PushConstants.SamplerIndex]), v_UV) * v_Color;
+#endif
+	// Keep fully transparent texels out of the depth buffer
+	if (color.a == 0.0)
+		discard;
+	o_Color = color;
+}
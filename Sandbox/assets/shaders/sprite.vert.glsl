@@ -0,0 +1,30 @@
+#version 450
+
+layout(location = 0) in vec4 a_PositionRotation;
+layout(location = 1) in vec2 a_Size;
+layout(location = 2) in vec4 a_UV;
+layout(location = 3) in vec4 a_Color;
+
+layout(push_constant) uniform PushConstants
+{
+	mat4 ViewProjection;
+} u_PushConstants;
+
+layout(location = 0) out vec2 v_UV;
+layout(location = 1) out vec4 v_Color;
+
+void main()
+{
+	// Drawn as a triangle strip of 4 vertices per instance
+	vec2 corner = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1);
+	vec2 position = (corner - 0.5) * a_Size;
+
+	float s = sin(a_PositionRotation.w);
+	float c = cos(a_PositionRotation.w);
+	position = vec2(position.x * c - position.y * s, position.x * s + position.y * c);
+
+	gl_Position = u_PushConstants.ViewProjection * vec4(a_PositionRotation.xy + position, a_PositionRotation.z, 1.0);
+	// UV min is the top left corner
+	v_UV = mix(a_UV.xy, a_UV.zw, vec2(corner.x, 1.0 - corner.y));
+	v_Color = a_Color;
+}
@@ -3,34 +3,373 @@
 
 using namespace BrickEngine;
 
-void Application::Run()
+namespace {
+
+	const uint32_t MeshGridSize = 128;
+
+	// Column major, right handed with Y up, depth mapped to [0, 1] and Y flipped for Vulkan's clip space
+	void Perspective(float matrix[16], float fovY, float aspect, float nearPlane, float farPlane)
+	{
+		float f = 1.0f / std::tan(fovY * 0.5f);
+		std::memset(matrix, 0, 16 * sizeof(float));
+		matrix[0] = f / aspect;
+		matrix[5] = -f;
+		matrix[10] = farPlane / (nearPlane - farPlane);
+		matrix[11] = -1.0f;
+		matrix[14] = nearPlane * farPlane / (nearPlane - farPlane);
+	}
+
+	void LookAt(float matrix[16], const float eye[3], const float target[3])
+	{
+		float forward[3] = { target[0] - eye[0], target[1] - eye[1], target[2] - eye[2] };
+		float length = std::sqrt(forward[0] * forward[0] + forward[1] * forward[1] + forward[2] * forward[2]);
+		for (float& value : forward)
+			value /= length;
+
+		// Cross product of forward and Y up
+		float right[3] = { -forward[2], 0.0f, forward[0] };
+		length = std::sqrt(right[0] * right[0] + right[2] * right[2]);
+		right[0] /= length;
+		right[2] /= length;
+		float up[3] = { right[1] * forward[2] - right[2] * forward[1], right[2] * forward[0] - right[0] * forward[2], right[0] * forward[1] - right[1] * forward[0] };
+
+		const float* axes[3] = { right, up, forward };
+		for (uint32_t row = 0; row < 3; row++)
+		{
+			float sign = row == 2 ? -1.0f : 1.0f;
+			matrix[row] = sign * axes[row][0];
+			matrix[4 + row] = sign * axes[row][1];
+			matrix[8 + row] = sign * axes[row][2];
+			matrix[12 + row] = -sign * (axes[row][0] * eye[0] + axes[row][1] * eye[1] + axes[row][2] * eye[2]);
+		}
+		matrix[3] = matrix[7] = matrix[11] = 0.0f;
+		matrix[15] = 1.0f;
+	}
+
+	void Multiply(float result[16], const float a[16], const float b[16])
+	{
+		for (uint32_t column = 0; column < 4; column++)
+		{
+			for (uint32_t row = 0; row < 4; row++)
+			{
+				float value = 0.0f;
+				for (uint32_t i = 0; i < 4; i++)
+					value += a[i * 4 + row] * b[column * 4 + i];
+				result[column * 4 + row] = value;
+			}
+		}
+	}
+
+}
+
+Application::Application(Scene scene, uint32_t headlessFrames, FramePacingMode pacing, double targetRate)
+	: m_Scene(scene), m_HeadlessFrames(headlessFrames), m_Pacer(pacing, targetRate)
 {
-	using namespace std::chrono;
+}
 
+void Application::Run()
+{
 	Init();
-	high_resolution_clock::time_point time, lastTime = high_resolution_clock::now();
-	double delta;
-	while (!m_Window->WantsToClose())
+	if (!m_Window)
 	{
-		time = high_resolution_clock::now();
-		delta = duration<double>(time - lastTime).count();
-		lastTime = high_resolution_clock::now();
-		Update(delta);
+		// Fixed time step so every run renders the same frames, the last one can then be compared against a reference image
+		while (m_FrameCount < m_HeadlessFrames)
+			Update(1.0 / 60.0);
+
+		FileError error = m_Renderer->WriteFrame("frame.ppm");
+		if (error != FileError::None)
+			Log::Error(LogCategory::Renderer, "Failed to write 'frame.ppm': {}", File::GetErrorString(error));
+		else
+			Log::Info(LogCategory::Renderer, "Wrote frame {} to 'frame.ppm'", m_FrameCount);
+		Shutdown();
+		return;
 	}
+
+	m_Pacer.ResetStats();
+	while (!m_Window->WantsToClose() && !m_CloseRequested)
+		Update(m_Pacer.BeginFrame());
 	Shutdown();
 }
 
 void Application::Init()
 {
-	m_Window.reset(Window::Create(1280, 720, "Vulkan Engine", false));
-	m_Renderer.reset(new VulkanRenderer(m_Window.get()));
+	if (m_ProfileFrames > 0)
+		BeginProfile();
+
+	JobSystem::Init();
+
+	FileError packError = File::MountPack("assets.bpak");
+	if (packError != FileError::None && packError != FileError::NotFound)
+		Log::Warn(LogCategory::File, "Failed to mount 'assets.bpak': {}", File::GetErrorString(packError));
+
+	if (m_HeadlessFrames == 0)
+	{
+		m_Window.reset(Window::Create(1280, 720, "Vulkan Engine", false));
+		if (!m_Window)
+		{
+			Log::Warn(LogCategory::Renderer, "Couldn't create a window, rendering 60 frames headless instead");
+			m_HeadlessFrames = 60;
+		}
+	}
+
+	if (m_Window)
+	{
+		m_Renderer.reset(new VulkanRenderer(m_Window.get()));
+		// Anything but vsync paces on the CPU, a blocking present would only get in the way
+		m_Renderer->SetVSync(m_Pacer.GetMode() == FramePacingMode::VSync);
+		// Only resizes are reported
+		m_SwapchainRecreateCount = m_Renderer->GetSwapchainStats().RecreateCount;
+	}
+	else
+		m_Renderer.reset(new VulkanRenderer(VkExtent2D{ 1280, 720 }));
+
+	if (m_Scene == Scene::Meshes)
+	{
+		if (m_Renderer->GetMeshRenderer())
+		{
+			CreateMeshScene();
+		}
+		else
+		{
+			Log::Warn(LogCategory::Renderer, "GPU driven meshes aren't supported, drawing the sprite scene instead");
+			m_Scene = Scene::Sprites;
+		}
+	}
 }
 
 void Application::Update(const double& dt)
 {
-	m_Window->PollEvents();
+	if (m_Window)
+	{
+		m_Window->PollEvents();
+		Event event;
+		while (m_Window->PollEvent(event))
+			HandleEvent(event);
+
+		while (m_Pacer.StepSimulation())
+			m_SimulationTime += m_Pacer.GetSimulationDelta();
+		m_Time = m_SimulationTime + (m_Pacer.GetInterpolation() - 1.0) * m_Pacer.GetSimulationDelta();
+	}
+	else
+	{
+		m_Time += dt;
+	}
+
+	BRICKENGINE_PROFILE_SCOPE("Frame");
+	if (m_Renderer->BeginFrame())
+	{
+		auto start = std::chrono::steady_clock::now();
+		switch (m_Scene)
+		{
+		case Scene::Sprites: DrawScene(); break;
+		case Scene::SpriteBenchmark: DrawSpriteBenchmark(); break;
+		case Scene::Meshes: DrawMeshScene(); break;
+		}
+		m_DrawTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		m_Renderer->EndFrame();
+		m_FrameCount++;
+		LogFrameStats(dt);
+
+		if (m_ProfileEndFrame > 0 && m_FrameCount >= m_ProfileEndFrame)
+			EndProfile();
+	}
+}
+
+void Application::HandleEvent(const Event& event)
+{
+	switch (event.Type)
+	{
+	case EventType::KeyPressed:
+		if (event.Key.Code == KeyCode::Escape)
+			m_CloseRequested = true;
+		else if (event.Key.Code == KeyCode::F9 && !event.Key.Repeat)
+		{
+			if (Profiler::IsCapturing())
+				EndProfile();
+			else
+				BeginProfile();
+		}
+		break;
+	case EventType::WindowResize:
+		Log::Trace(LogCategory::Renderer, "Window resized to {}x{}", event.Resize.Width, event.Resize.Height);
+		break;
+	default:
+		break;
+	}
+}
+
+void Application::DrawScene()
+{
+	VulkanBatchRenderer* batchRenderer = m_Renderer->GetBatchRenderer();
+	float width = static_cast<float>(m_Renderer->GetExtent().width);
+	float height = static_cast<float>(m_Renderer->GetExtent().height);
+	batchRenderer->SetOrthographic(0.0f, width, 0.0f, height);
+
+	const uint32_t columns = 32;
+	const uint32_t rows = 18;
+	float cellWidth = width / columns;
+	float cellHeight = height / rows;
+	for (uint32_t y = 0; y < rows; y++)
+	{
+		for (uint32_t x = 0; x < columns; x++)
+		{
+			uint32_t color = VulkanBatchRenderer::PackColor(static_cast<float>(x) / columns, static_cast<float>(y) / rows, 0.5f);
+			float rotation = static_cast<float>(m_Time) + (x + y) * 0.1f;
+			batchRenderer->DrawQuad((x + 0.5f) * cellWidth, (y + 0.5f) * cellHeight, 0.5f, cellWidth * 0.6f, cellHeight * 0.6f, color, rotation);
+		}
+	}
+}
+
+void Application::DrawSpriteBenchmark()
+{
+	VulkanBatchRenderer* batchRenderer = m_Renderer->GetBatchRenderer();
+	batchRenderer->SetOrthographic(0.0f, 1000.0f, 0.0f, 1000.0f);
+
+	const uint32_t size = 1000;
+	for (uint32_t y = 0; y < size; y++)
+	{
+		for (uint32_t x = 0; x < size; x++)
+			batchRenderer->DrawQuad(x + 0.5f, y + 0.5f, 0.5f, 0.8f, 0.8f, 0xff000000 | (x & 0xff) | ((y & 0xff) << 8), static_cast<float>(m_Time));
+	}
+}
+
+void Application::CreateMeshScene()
+{
+	VulkanMeshRenderer* meshRenderer = m_Renderer->GetMeshRenderer();
+
+	// 4 vertices per face so every face gets its own normal, counter clockwise seen from outside
+	VulkanMeshVertex vertices[24];
+	uint32_t indices[36];
+	for (uint32_t face = 0; face < 6; face++)
+	{
+		uint32_t axis = face / 2;
+		float sign = face % 2 == 0 ? 1.0f : -1.0f;
+		uint32_t u = (axis + 1) % 3;
+		uint32_t v = (axis + 2) % 3;
+		for (uint32_t corner = 0; corner < 4; corner++)
+		{
+			VulkanMeshVertex& vertex = vertices[face * 4 + corner];
+			vertex.Position[axis] = 0.5f * sign;
+			vertex.Position[u] = ((corner & 1) ? 0.5f : -0.5f) * sign;
+			vertex.Position[v] = (corner & 2) ? 0.5f : -0.5f;
+			vertex.Normal[0] = vertex.Normal[1] = vertex.Normal[2] = 0.0f;
+			vertex.Normal[axis] = sign;
+		}
+		const uint32_t faceIndices[6] = { 0, 1, 3, 0, 3, 2 };
+		for (uint32_t i = 0; i < 6; i++)
+			indices[face * 6 + i] = face * 4 + faceIndices[i];
+	}
+	VulkanMeshHandle cube = meshRenderer->CreateMesh(vertices, 24, indices, 36);
+
+	float transform[16] = {
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+	for (uint32_t z = 0; z < MeshGridSize; z++)
+	{
+		for (uint32_t x = 0; x < MeshGridSize; x++)
+		{
+			transform[12] = (x - MeshGridSize * 0.5f) * 2.0f;
+			transform[14] = (z - MeshGridSize * 0.5f) * 2.0f;
+			uint32_t color = VulkanBatchRenderer::PackColor(static_cast<float>(x) / MeshGridSize, 0.5f, static_cast<float>(z) / MeshGridSize);
+			meshRenderer->CreateObject(cube, transform, color);
+		}
+	}
+}
+
+void Application::DrawMeshScene()
+{
+	VkExtent2D extent = m_Renderer->GetExtent();
+	float aspect = static_cast<float>(extent.width) / std::max(extent.height, 1u);
+	float angle = static_cast<float>(m_Time) * 0.2f;
+	const float eye[3] = { std::cos(angle) * 40.0f, 20.0f, std::sin(angle) * 40.0f };
+	const float target[3] = { 0.0f, 0.0f, 0.0f };
+
+	float projection[16], view[16], viewProjection[16];
+	Perspective(projection, 1.0f, aspect, 0.1f, 500.0f);
+	LookAt(view, eye, target);
+	Multiply(viewProjection, projection, view);
+	m_Renderer->GetMeshRenderer()->SetViewProjection(viewProjection);
+}
+
+void Application::LogFrameStats(const double& dt)
+{
+	const VulkanFrameStats& stats = m_Renderer->GetFrameStats();
+	m_StatsTime += dt;
+	m_StatsFrames++;
+	m_SubmitTime += stats.Batches.SubmitTime + stats.Meshes.RecordTime;
+	if (m_StatsTime < 1.0)
+		return;
+
+	if (m_Scene == Scene::Meshes)
+	{
+		Log::Info(LogCategory::Renderer, "{} objects culled on the GPU, {} updated, {} indirect draw call(s), {} ms recording per frame, {} fps",
+			stats.Meshes.ObjectCount, stats.Meshes.UpdatedObjects, stats.Meshes.IndirectDrawCalls, m_SubmitTime * 1000.0 / m_StatsFrames, m_StatsFrames / m_StatsTime);
+	}
+	else
+	{
+		Log::Info(LogCategory::Renderer, "{} quads in {} draw call(s), {} ms drawing and {} ms submitting per frame, {} fps",
+			stats.Batches.QuadCount, stats.Batches.DrawCalls, m_DrawTime * 1000.0 / m_StatsFrames, m_SubmitTime * 1000.0 / m_StatsFrames, m_StatsFrames / m_StatsTime);
+	}
+
+	if (m_Window)
+	{
+		FrameTimeStats frameTimes = m_Pacer.ComputeStats();
+		Log::Info(LogCategory::Core, "Frame time mean {} ms, p50 {} ms, p99 {} ms, max {} ms, jitter {} ms, {} hitch(es), {}% CPU",
+			frameTimes.MeanMs, frameTimes.P50Ms, frameTimes.P99Ms, frameTimes.MaxMs, frameTimes.JitterMs, frameTimes.HitchCount, frameTimes.CpuUsage * 100.0);
+		m_Pacer.ResetStats();
+
+		// The hitch a resize causes, the pacer counts it as one as well when it's long enough
+		VulkanSwapchainStats swapchain = m_Renderer->GetSwapchainStats();
+		if (swapchain.RecreateCount != m_SwapchainRecreateCount)
+		{
+			Log::Info(LogCategory::Renderer, "Swapchain recreated {} time(s), last took {} ms, longest {} ms, {} retired object(s) pending",
+				swapchain.RecreateCount - m_SwapchainRecreateCount, swapchain.LastRecreateTime * 1000.0, swapchain.MaxRecreateTime * 1000.0, swapchain.RetiredCount);
+			m_SwapchainRecreateCount = swapchain.RecreateCount;
+		}
+	}
+
+	m_StatsTime = 0.0;
+	m_StatsFrames = 0;
+	m_DrawTime = 0.0;
+	m_SubmitTime = 0.0;
 }
 
 void Application::Shutdown()
 {
+	if (Profiler::IsCapturing())
+		EndProfile();
+
+	m_Renderer.reset();
+	m_Window.reset();
+
+	JobSystem::Shutdown();
+}
+
+void Application::BeginProfile()
+{
+	if (!Profiler::IsCompiledIn())
+	{
+		Log::Warn(LogCategory::Core, "The profiler isn't compiled into this configuration, use Debug or Dist with --profiler");
+		return;
+	}
+
+	Profiler::BeginCapture();
+	// Without a frame count the capture runs until F9 is pressed again
+	m_ProfileEndFrame = m_ProfileFrames > 0 ? m_FrameCount + m_ProfileFrames : 0;
+	m_ProfileFrames = 0;
+}
+
+void Application::EndProfile()
+{
+	Profiler::EndCapture();
+	m_ProfileEndFrame = 0;
+
+	// Opens in chrome://tracing or ui.perfetto.dev
+	FileError error = Profiler::WriteChromeTrace("profile.json");
+	if (error != FileError::None)
+		Log::Error(LogCategory::Core, "Failed to write 'profile.json': {}", File::GetErrorString(error));
 }
@@ -4,15 +4,58 @@
 
 #include "BrickEngine/Renderer/Vulkan/VulkanRenderer.hpp"
 
+enum class Scene : uint8_t
+{
+	Sprites,
+	// A million quads every frame
+	SpriteBenchmark,
+	// A grid of cubes drawn by the GPU driven mesh renderer, seen by an orbiting camera
+	Meshes
+};
+
 class Application
 {
 public:
+	// headlessFrames > 0 renders that many frames without a window at a fixed time step and writes the last one to disk.
+	// targetRate is only used by FramePacingMode::TargetRate.
+	Application(Scene scene = Scene::Sprites, uint32_t headlessFrames = 0, BrickEngine::FramePacingMode pacing = BrickEngine::FramePacingMode::VSync, double targetRate = 60.0);
+
+	// Captures the first frames of Run, startup included, and writes them to profile.json. F9 captures later ones.
+	void CaptureProfile(uint32_t frames) { m_ProfileFrames = frames; }
+
 	void Run();
 private:
 	void Init();
 	void Update(const double& dt);
 	void Shutdown();
+	void HandleEvent(const BrickEngine::Event& event);
+
+	void DrawScene();
+	void DrawSpriteBenchmark();
+	void CreateMeshScene();
+	void DrawMeshScene();
+	void LogFrameStats(const double& dt);
+	void BeginProfile();
+	void EndProfile();
 private:
+	Scene m_Scene = Scene::Sprites;
+	uint32_t m_HeadlessFrames = 0;
+	uint32_t m_FrameCount = 0;
+	bool m_CloseRequested = false;
+	// Frame the running profiler capture ends after, 0 until F9 is pressed again
+	uint32_t m_ProfileFrames = 0;
+	uint32_t m_ProfileEndFrame = 0;
+	BrickEngine::FramePacer m_Pacer;
+	// Advanced in fixed steps, m_Time is what gets drawn, interpolated between the last two steps
+	double m_SimulationTime = 0.0;
+	double m_Time = 0.0;
+	// Accumulated since the stats were logged last
+	double m_StatsTime = 0.0;
+	uint32_t m_StatsFrames = 0;
+	uint32_t m_SwapchainRecreateCount = 0;
+	double m_DrawTime = 0.0;
+	double m_SubmitTime = 0.0;
+
 	std::unique_ptr<BrickEngine::Window> m_Window = nullptr;
 	std::unique_ptr<BrickEngine::VulkanRenderer> m_Renderer = nullptr; // TEMPORARY
 };
@@ -2,9 +2,36 @@
 
 #include "Application.hpp"
 
-int main(int /*argc*/, char** /*argv*/)
+int main(int argc, char** argv)
 {
-	Application* app = new Application();
+	Scene scene = Scene::Sprites;
+	uint32_t headlessFrames = 0;
+	BrickEngine::FramePacingMode pacing = BrickEngine::FramePacingMode::VSync;
+	double targetRate = 60.0;
+	uint32_t profileFrames = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--sprite-benchmark") == 0)
+			scene = Scene::SpriteBenchmark;
+		else if (strcmp(argv[i], "--meshes") == 0)
+			scene = Scene::Meshes;
+		else if (strcmp(argv[i], "--headless") == 0)
+			headlessFrames = i + 1 < argc && isdigit(argv[i + 1][0]) ? static_cast<uint32_t>(atoi(argv[++i])) : 60;
+		else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+		{
+			pacing = BrickEngine::FramePacingMode::TargetRate;
+			targetRate = std::max(atof(argv[++i]), 1.0);
+		}
+		// The loop before frame pacing, for comparing CPU usage and frame times against it
+		else if (strcmp(argv[i], "--unlimited") == 0)
+			pacing = BrickEngine::FramePacingMode::Unlimited;
+		else if (strcmp(argv[i], "--profile") == 0)
+			profileFrames = i + 1 < argc && isdigit(argv[i + 1][0]) ? static_cast<uint32_t>(atoi(argv[++i])) : 120;
+	}
+
+	Application* app = new Application(scene, headlessFrames, pacing, targetRate);
+	if (profileFrames > 0)
+		app->CaptureProfile(profileFrames);
 	app->Run();
 	delete app;
 	return 0;
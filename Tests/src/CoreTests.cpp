@@ -0,0 +1,686 @@
+#include "Test.hpp"
+
+#include "BrickEngine/Core/RingBuffer.hpp"
+#include "BrickEngine/Core/TLSFAllocator.hpp"
+
+#include <filesystem>
+#include <random>
+
+using namespace BrickEngine;
+
+// When a frame doesn't fit before the end the padding is published on its own first, the frame only fits after the
+// consumer skipped it
+static uint8_t* ReserveAfterPadding(RingBuffer& buffer, size_t payloadSize)
+{
+	uint8_t* payload = buffer.TryReserve(payloadSize);
+	if (!payload && !buffer.Peek())
+		payload = buffer.TryReserve(payloadSize);
+	return payload;
+}
+
+TEST_CASE(RingBufferWrapsLargeFrames)
+{
+	RingBuffer buffer(1024);
+
+	// A frame over half the capacity that doesn't fit before the end has to wait for the start, not for both
+	std::array<size_t, 6> payloadSizes = { 392, 704, 8, 1016, 600, 600 };
+	for (size_t payloadSize : payloadSizes)
+	{
+		uint8_t* payload = ReserveAfterPadding(buffer, payloadSize);
+		TEST_REQUIRE(payload);
+		std::memset(payload, static_cast<int>(payloadSize & 0xff), payloadSize);
+		buffer.Commit();
+
+		const uint8_t* read = buffer.Peek();
+		TEST_REQUIRE(read);
+		TEST_CHECK(read[0] == (payloadSize & 0xff) && read[payloadSize - 1] == (payloadSize & 0xff));
+		buffer.Pop();
+		TEST_CHECK(buffer.IsEmpty());
+	}
+
+	TEST_CHECK(!buffer.TryReserve(1024));
+	TEST_CHECK(ReserveAfterPadding(buffer, 1016));
+}
+
+TEST_CASE(RingBufferFull)
+{
+	RingBuffer buffer(256);
+	TEST_REQUIRE(buffer.TryReserve(120));
+	buffer.Commit();
+	TEST_REQUIRE(buffer.TryReserve(56));
+	buffer.Commit();
+
+	// 192 bytes used, the padding before the end fits but the frame after it doesn't until the first one is popped
+	TEST_CHECK(!buffer.TryReserve(120));
+	TEST_REQUIRE(buffer.Peek());
+	buffer.Pop();
+	TEST_CHECK(buffer.TryReserve(120));
+	buffer.Commit();
+
+	TEST_REQUIRE(buffer.Peek());
+	buffer.Pop();
+	TEST_REQUIRE(buffer.Peek());
+	buffer.Pop();
+	TEST_CHECK(buffer.IsEmpty());
+}
+
+TEST_CASE(RingBufferConcurrent)
+{
+	RingBuffer buffer(4096);
+	const uint32_t frameCount = 100000;
+
+	std::thread producer([&]()
+		{
+			for (uint32_t i = 0; i < frameCount; i++)
+			{
+				size_t payloadSize = sizeof(uint32_t) + 1 + i % 3000;
+				uint8_t* payload;
+				while (!(payload = buffer.TryReserve(payloadSize)))
+					std::this_thread::yield();
+				std::memcpy(payload, &i, sizeof(uint32_t));
+				payload[payloadSize - 1] = static_cast<uint8_t>(i);
+				buffer.Commit();
+			}
+		}
+	);
+
+	uint32_t mismatches = 0;
+	for (uint32_t i = 0; i < frameCount; i++)
+	{
+		const uint8_t* payload;
+		while (!(payload = buffer.Peek()))
+			std::this_thread::yield();
+
+		uint32_t index;
+		std::memcpy(&index, payload, sizeof(uint32_t));
+		if (index != i || payload[sizeof(uint32_t) + i % 3000] != static_cast<uint8_t>(i))
+			mismatches++;
+		buffer.Pop();
+	}
+	producer.join();
+
+	TEST_CHECK(mismatches == 0);
+	TEST_CHECK(buffer.IsEmpty());
+}
+
+// Keeps the lines in memory, the sink is called from the logging thread
+class CaptureLogSink final : public LogSink
+{
+public:
+	virtual void Write(LogLevel, std::string_view line) override final
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Lines.emplace_back(line);
+	}
+
+	virtual void Flush() override final {}
+
+	std::vector<std::string> GetLines()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Lines;
+	}
+private:
+	std::mutex m_Mutex;
+	std::vector<std::string> m_Lines;
+};
+
+TEST_CASE(LogRecordsNearCapacity)
+{
+	Log::Flush();
+	std::shared_ptr<LogSink> consoleSink = Log::GetConsoleSink();
+	std::shared_ptr<CaptureLogSink> sink = std::make_shared<CaptureLogSink>();
+	Log::RemoveSink(consoleSink);
+	Log::AddSink(sink);
+
+	// Records over half the buffer that start part way into it, these used to wait for space that could never free up
+	std::string large(Log::ThreadBufferCapacity - 64, 'x');
+	Log::Info("small");
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		Log::Info("{}", std::string_view(large).substr(i * 1000));
+		Log::Info("small {}", i);
+	}
+
+	std::string tooLarge(Log::ThreadBufferCapacity, 'x');
+	Log::Info("{}", tooLarge);
+
+	bool flushed = Log::Flush(std::chrono::seconds(5));
+	Log::RemoveSink(sink);
+	Log::AddSink(consoleSink);
+	TEST_REQUIRE(flushed);
+
+	// The dropped record is reported whenever the logging thread notices it
+	std::vector<std::string> lines;
+	uint32_t droppedLines = 0;
+	for (auto& line : sink->GetLines())
+	{
+		if (line.find("Dropped 1 log message") != std::string::npos)
+			droppedLines++;
+		else
+			lines.push_back(line);
+	}
+	TEST_CHECK(droppedLines == 1);
+
+	TEST_REQUIRE(lines.size() == 9);
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		const std::string& line = lines[1 + i * 2];
+		size_t length = large.size() - i * 1000;
+		TEST_CHECK(line.size() > length && line.compare(line.size() - length - 1, length, large, 0, length) == 0);
+		TEST_CHECK(lines[2 + i * 2].find("small " + std::to_string(i)) != std::string::npos);
+	}
+}
+
+static std::string WriteTestFile(const std::string& name, size_t size)
+{
+	std::string filepath = (std::filesystem::temp_directory_path() / name).string();
+	std::vector<uint8_t> data(size);
+	for (size_t i = 0; i < size; i++)
+		data[i] = static_cast<uint8_t>(i * 31 + (i >> 8));
+	return File::WriteFile(filepath, data.data(), data.size()) == FileError::None ? filepath : std::string();
+}
+
+static bool MatchesTestFile(const void* data, uint64_t offset, size_t size)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		size_t position = static_cast<size_t>(offset) + i;
+		if (bytes[i] != static_cast<uint8_t>(position * 31 + (position >> 8)))
+			return false;
+	}
+	return true;
+}
+
+TEST_CASE(AsyncFileReads)
+{
+	const size_t fileSize = 1 << 20;
+	std::string filepath = WriteTestFile("BrickEngineAsyncFileReads.bin", fileSize);
+	TEST_REQUIRE(!filepath.empty());
+
+	// Many reads in flight at once, some of them running past the end of the file
+	const uint32_t readCount = 2000;
+	std::vector<uint64_t> offsets(readCount);
+	std::vector<std::vector<uint8_t>> buffers(readCount);
+	std::vector<AsyncFileHandle> requests;
+	uint64_t state = 0x853c49e6748fea9bull;
+	for (uint32_t i = 0; i < readCount; i++)
+	{
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		offsets[i] = (state >> 33) % fileSize;
+		buffers[i].resize(1 + (state >> 13) % 65536);
+		requests.push_back(AsyncFile::Read(filepath, offsets[i], buffers[i].data(), buffers[i].size(), static_cast<AsyncFilePriority>(i % 3)));
+	}
+
+	uint32_t mismatches = 0;
+	for (uint32_t i = 0; i < readCount; i++)
+	{
+		AsyncFileRequest& request = *requests[i];
+		request.Wait();
+		size_t expectedSize = std::min<size_t>(buffers[i].size(), fileSize - offsets[i]);
+		if (request.GetStatus() != AsyncFileStatus::Completed || request.GetBytesRead() != expectedSize || !MatchesTestFile(buffers[i].data(), offsets[i], expectedSize))
+			mismatches++;
+	}
+	TEST_CHECK(mismatches == 0);
+
+	AsyncFileHandle load = AsyncFile::Load(filepath);
+	load->Wait();
+	TEST_CHECK(load->GetStatus() == AsyncFileStatus::Completed);
+	TEST_CHECK(load->GetData().size() == fileSize && MatchesTestFile(load->GetData().data(), 0, fileSize));
+
+	AsyncFileHandle missing = AsyncFile::Load(filepath + ".missing");
+	missing->Wait();
+	TEST_CHECK(missing->GetStatus() == AsyncFileStatus::Failed && missing->GetError() == FileError::NotFound);
+
+	std::error_code error;
+	std::filesystem::remove(filepath, error);
+}
+
+TEST_CASE(AsyncFileCallbackBeforeWait)
+{
+	std::string filepath = WriteTestFile("BrickEngineAsyncFileCallback.bin", 4096);
+	TEST_REQUIRE(!filepath.empty());
+
+	// Whatever the callback did has to be visible once Wait returns, and the callback already sees the final status
+	for (uint32_t i = 0; i < 20; i++)
+	{
+		AsyncFileStatus callbackStatus = AsyncFileStatus::Pending;
+		bool callbackDone = false;
+		AsyncFileHandle request = AsyncFile::Load(filepath, AsyncFilePriority::Normal, [&](AsyncFileRequest& request)
+			{
+				callbackStatus = request.GetStatus();
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				callbackDone = true;
+			}
+		);
+		request->Wait();
+		TEST_CHECK(callbackDone);
+		TEST_CHECK(callbackStatus == AsyncFileStatus::Completed);
+	}
+
+	std::error_code error;
+	std::filesystem::remove(filepath, error);
+}
+
+TEST_CASE(AssetPackRanges)
+{
+	// Compressible text over several blocks with a partial last one, random bytes that stay uncompressed, both in one
+	// entry where only some blocks are compressed, and an entry smaller than a block
+	std::vector<char> text;
+	while (text.size() < 5 * AssetPackBlockSize + 1234)
+	{
+		std::string line = "layout(location = " + std::to_string(text.size() % 97) + ") in vec4 value;\n";
+		text.insert(text.end(), line.begin(), line.end());
+	}
+	std::vector<char> noise(3 * AssetPackBlockSize);
+	uint64_t state = 1;
+	for (auto& value : noise)
+	{
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		value = static_cast<char>(state >> 56);
+	}
+	std::vector<char> small(text.begin(), text.begin() + 100);
+	std::vector<char> mixed(noise.begin(), noise.begin() + AssetPackBlockSize);
+	mixed.insert(mixed.end(), text.begin(), text.end());
+
+	std::string filepath = (std::filesystem::temp_directory_path() / "BrickEngineAssetPackRanges.bpak").string();
+	AssetPackWriter writer;
+	writer.AddData("assets/text.glsl", text, CompressionType::LZ4);
+	writer.AddData("assets/noise.bin", noise, CompressionType::LZ4);
+	writer.AddData("assets/small.glsl", small, CompressionType::LZ4);
+	writer.AddData("assets/mixed.bin", mixed, CompressionType::LZ4);
+	TEST_REQUIRE(writer.Write(filepath) == FileError::None);
+
+	std::shared_ptr<AssetPack> pack;
+	TEST_REQUIRE(AssetPack::Open(filepath, pack) == FileError::None);
+	const AssetPackEntry* textEntry = pack->Find("assets/text.glsl");
+	TEST_REQUIRE(textEntry);
+	TEST_CHECK(textEntry->Compression == CompressionType::LZ4 && textEntry->Size < text.size() / 2);
+	const AssetPackEntry* mixedEntry = pack->Find("assets/mixed.bin");
+	TEST_REQUIRE(mixedEntry);
+	TEST_CHECK(mixedEntry->Compression == CompressionType::LZ4 && mixedEntry->Size > AssetPackBlockSize);
+
+	TEST_REQUIRE(File::MountPack(filepath) == FileError::None);
+	const std::pair<const char*, const std::vector<char>*> files[] = { { "assets/text.glsl", &text }, { "assets/noise.bin", &noise }, { "assets/small.glsl", &small }, { "assets/mixed.bin", &mixed } };
+	for (auto& [path, contents] : files)
+	{
+		std::vector<char> data;
+		TEST_CHECK(File::LoadFile(path, data) == FileError::None && data == *contents);
+
+		// Within a block, across block boundaries, whole blocks and past the end
+		const uint64_t ranges[][2] = { { 0, 10 }, { 100, 1000 }, { AssetPackBlockSize - 5, 10 }, { AssetPackBlockSize, AssetPackBlockSize }, { 3, 3 * AssetPackBlockSize }, { contents->size() - 7, 100 }, { contents->size() + 1, 10 } };
+		for (auto& range : ranges)
+		{
+			std::vector<char> buffer(static_cast<size_t>(range[1]));
+			size_t bytesRead = 0;
+			TEST_CHECK(File::ReadFileRange(path, range[0], buffer.data(), buffer.size(), bytesRead) == FileError::None);
+
+			uint64_t expected = range[0] < contents->size() ? std::min<uint64_t>(range[1], contents->size() - range[0]) : 0;
+			TEST_CHECK(bytesRead == expected);
+			TEST_CHECK(bytesRead == 0 || std::equal(buffer.begin(), buffer.begin() + bytesRead, contents->begin() + range[0]));
+		}
+	}
+	File::UnmountPack(filepath);
+	pack.reset();
+
+	std::error_code error;
+	std::filesystem::remove(filepath, error);
+}
+
+// RecordParallel sizes its command buffer slots from GetChunkCount, it has to match the chunks ParallelFor runs
+TEST_CASE(ParallelForChunkCount)
+{
+	for (size_t count : { 1, 3, 64, 1000, 4097 })
+	{
+		for (size_t grainSize : { 0, 1, 7, 64, 5000 })
+		{
+			size_t grain = grainSize == 0 ? JobSystem::GetAutomaticGrainSize(count) : grainSize;
+			std::atomic<size_t> chunkCount = 0;
+			std::atomic<size_t> covered = 0;
+			JobSystem::ParallelFor(count, [&](size_t begin, size_t end)
+				{
+					chunkCount.fetch_add(1, std::memory_order_relaxed);
+					covered.fetch_add(end - begin, std::memory_order_relaxed);
+				}, grain
+			);
+			TEST_CHECK(chunkCount.load() == JobSystem::GetChunkCount(count, grain));
+			TEST_CHECK(covered.load() == count);
+		}
+	}
+	TEST_CHECK(JobSystem::GetChunkCount(0, 1) == 0);
+}
+
+TEST_CASE(TLSFAllocatorCoalesces)
+{
+	TLSFAllocator allocator(1024);
+	TLSFAllocation allocations[4];
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		allocations[i] = allocator.Allocate(256);
+		TEST_REQUIRE(allocations[i].IsValid());
+		TEST_CHECK(allocations[i].Offset == i * 256 && allocations[i].Size == 256);
+	}
+	TEST_CHECK(!allocator.Allocate(1).IsValid());
+	TEST_CHECK(allocator.GetStats().FreeBytes == 0 && allocator.GetStats().GetFragmentation() == 0.0f);
+
+	// Two holes that can't hold 512 together
+	allocator.Free(allocations[1]);
+	allocator.Free(allocations[3]);
+	TLSFStats stats = allocator.GetStats();
+	TEST_CHECK(stats.UsedBytes == 512 && stats.FreeBytes == 512);
+	TEST_CHECK(stats.FreeRegionCount == 2 && stats.LargestFreeRegion == 256);
+	TEST_CHECK(stats.GetFragmentation() == 0.5f);
+	TEST_CHECK(!allocator.Allocate(512).IsValid());
+
+	// Freeing the allocation between them merges all three into one region
+	allocator.Free(allocations[2]);
+	stats = allocator.GetStats();
+	TEST_CHECK(stats.FreeRegionCount == 1 && stats.LargestFreeRegion == 768);
+	TEST_CHECK(stats.GetFragmentation() == 0.0f);
+	TLSFAllocation merged = allocator.Allocate(768);
+	TEST_REQUIRE(merged.IsValid());
+	TEST_CHECK(merged.Offset == 256);
+
+	allocator.Free(merged);
+	allocator.Free(allocations[0]);
+	stats = allocator.GetStats();
+	TEST_CHECK(allocator.IsEmpty() && allocator.GetUsedBytes() == 0);
+	TEST_CHECK(stats.FreeRegionCount == 1 && stats.LargestFreeRegion == 1024);
+
+	TEST_CHECK(!allocator.Allocate(std::numeric_limits<uint64_t>::max()).IsValid());
+	TEST_CHECK(!allocator.Allocate(2, uint64_t(1) << 63).IsValid());
+	TEST_CHECK(allocator.IsEmpty());
+}
+
+TEST_CASE(TLSFAllocatorAlignment)
+{
+	TLSFAllocator allocator(1 << 20);
+	std::vector<TLSFAllocation> allocations;
+	for (uint64_t alignment = 1; alignment <= 4096; alignment *= 2)
+	{
+		// An odd sized allocation in front, so the next one has to be padded
+		allocations.push_back(allocator.Allocate(3));
+		allocations.push_back(allocator.Allocate(100, alignment));
+		TEST_REQUIRE(allocations.back().IsValid());
+		TEST_CHECK(allocations.back().Offset % alignment == 0);
+		TEST_CHECK(allocations.back().Size == 100);
+	}
+	TEST_CHECK(allocator.GetUsedBytes() == 13 * 103);
+
+	for (auto& allocation : allocations)
+		allocator.Free(allocation);
+	TLSFStats stats = allocator.GetStats();
+	TEST_CHECK(allocator.IsEmpty());
+	TEST_CHECK(stats.FreeRegionCount == 1 && stats.LargestFreeRegion == allocator.GetCapacity());
+}
+
+// Random allocations and frees with every invariant checked after each step
+TEST_CASE(TLSFAllocatorInvariants)
+{
+	const uint64_t capacity = 1 << 20;
+	TLSFAllocator allocator(capacity);
+	std::vector<TLSFAllocation> live;
+	std::mt19937 random(1234);
+	for (uint32_t step = 0; step < 20000; step++)
+	{
+		if (live.empty() || random() % 3 != 0)
+		{
+			uint64_t size = 1 + random() % (random() % 8 == 0 ? 16384 : 256);
+			uint64_t alignment = uint64_t(1) << (random() % 9);
+			TLSFAllocation allocation = allocator.Allocate(size, alignment);
+			if (allocation.IsValid())
+			{
+				TEST_CHECK(allocation.Offset % alignment == 0 && allocation.Size == size);
+				live.push_back(allocation);
+			}
+		}
+		else
+		{
+			size_t index = random() % live.size();
+			allocator.Free(live[index]);
+			live[index] = live.back();
+			live.pop_back();
+		}
+
+		uint64_t usedBytes = 0;
+		uint64_t end = 0;
+		uint32_t count = 0;
+		bool ordered = true;
+		allocator.ForEachAllocation([&](uint64_t offset, uint64_t size, uint32_t)
+			{
+				ordered = ordered && offset >= end;
+				end = offset + size;
+				usedBytes += size;
+				count++;
+			}
+		);
+		TLSFStats stats = allocator.GetStats();
+		TEST_REQUIRE(ordered && end <= capacity);
+		TEST_REQUIRE(count == live.size() && stats.AllocationCount == count);
+		TEST_REQUIRE(usedBytes == allocator.GetUsedBytes() && stats.UsedBytes == usedBytes);
+		TEST_REQUIRE(stats.UsedBytes + stats.FreeBytes == capacity);
+		// Free regions are always merged, so there is at most one more of them than allocations
+		TEST_REQUIRE(stats.FreeRegionCount <= count + 1);
+		TEST_REQUIRE(stats.GetFragmentation() >= 0.0f && stats.GetFragmentation() < 1.0f);
+	}
+
+	for (auto& allocation : live)
+		allocator.Free(allocation);
+	TEST_CHECK(allocator.IsEmpty() && allocator.GetStats().FreeRegionCount == 1);
+}
+
+static Event MakeKeyEvent(KeyCode code)
+{
+	Event event = {};
+	event.Type = EventType::KeyPressed;
+	event.Key = { code, false };
+	return event;
+}
+
+static Event MakeMouseMovedEvent(float x, float y)
+{
+	Event event = {};
+	event.Type = EventType::MouseMoved;
+	event.Mouse = { x, y, {} };
+	return event;
+}
+
+TEST_CASE(EventQueueCoalesces)
+{
+	EventQueue queue;
+	for (uint32_t i = 0; i < 1000; i++)
+		TEST_CHECK(queue.Push(MakeMouseMovedEvent(static_cast<float>(i), 1.0f)));
+
+	Event resize = {};
+	resize.Type = EventType::WindowResize;
+	for (int32_t i = 1; i <= 1000; i++)
+	{
+		resize.Resize = { i, i * 2 };
+		TEST_CHECK(queue.Push(resize));
+	}
+
+	// Only runs of the same kind collapse, a key press in between keeps both moves
+	TEST_CHECK(queue.Push(MakeKeyEvent(KeyCode::A)));
+	TEST_CHECK(queue.Push(MakeMouseMovedEvent(5.0f, 6.0f)));
+	TEST_CHECK(queue.Push(MakeKeyEvent(KeyCode::B)));
+	TEST_CHECK(queue.Push(MakeKeyEvent(KeyCode::B)));
+
+	Event event;
+	TEST_REQUIRE(queue.Pop(event));
+	TEST_CHECK(event.Type == EventType::MouseMoved && event.Mouse.X == 999.0f);
+	TEST_REQUIRE(queue.Pop(event));
+	TEST_CHECK(event.Type == EventType::WindowResize && event.Resize.Width == 1000 && event.Resize.Height == 2000);
+	TEST_REQUIRE(queue.Pop(event));
+	TEST_CHECK(event.Type == EventType::KeyPressed && event.Key.Code == KeyCode::A);
+	TEST_REQUIRE(queue.Pop(event));
+	TEST_CHECK(event.Type == EventType::MouseMoved && event.Mouse.X == 5.0f && event.Mouse.Y == 6.0f);
+	// Key presses never collapse
+	TEST_REQUIRE(queue.Pop(event));
+	TEST_CHECK(event.Type == EventType::KeyPressed && event.Key.Code == KeyCode::B);
+	TEST_REQUIRE(queue.Pop(event));
+	TEST_CHECK(event.Type == EventType::KeyPressed && event.Key.Code == KeyCode::B);
+	TEST_CHECK(!queue.Pop(event) && queue.IsEmpty());
+	TEST_CHECK(queue.GetDroppedCount() == 0);
+}
+
+TEST_CASE(EventQueueOverflow)
+{
+	EventQueue queue;
+	for (uint32_t i = 0; i < EventQueue::Capacity; i++)
+		TEST_CHECK(queue.Push(MakeKeyEvent(static_cast<KeyCode>(1 + i % 26))));
+	TEST_CHECK(!queue.Push(MakeKeyEvent(KeyCode::Z)));
+	TEST_CHECK(!queue.Push(MakeKeyEvent(KeyCode::Z)));
+	TEST_CHECK(queue.GetDroppedCount() == 2);
+
+	// A move still replaces the newest move when full, only new entries are dropped
+	Event event;
+	TEST_REQUIRE(queue.Pop(event));
+	TEST_CHECK(queue.Push(MakeMouseMovedEvent(1.0f, 1.0f)));
+	TEST_CHECK(queue.Push(MakeMouseMovedEvent(2.0f, 2.0f)));
+	TEST_CHECK(!queue.Push(MakeKeyEvent(KeyCode::Z)));
+	TEST_CHECK(queue.GetDroppedCount() == 3);
+
+	uint32_t count = 0;
+	while (queue.Pop(event))
+		count++;
+	TEST_CHECK(count == EventQueue::Capacity);
+	TEST_CHECK(event.Type == EventType::MouseMoved && event.Mouse.X == 2.0f);
+}
+
+// Pushes and pops through the ring many times over, in steps that don't divide the capacity
+TEST_CASE(EventQueueWrapsAround)
+{
+	EventQueue queue;
+	uint32_t pushed = 0;
+	uint32_t popped = 0;
+	for (uint32_t round = 0; round < 400; round++)
+	{
+		for (uint32_t i = 0; i < 37 + round % 150; i++)
+		{
+			TEST_REQUIRE(queue.Push(MakeKeyEvent(static_cast<KeyCode>(1 + pushed % 26))));
+			pushed++;
+		}
+
+		Event event;
+		while (queue.Pop(event))
+		{
+			TEST_REQUIRE(event.Type == EventType::KeyPressed && event.Key.Code == static_cast<KeyCode>(1 + popped % 26));
+			popped++;
+		}
+	}
+	TEST_CHECK(pushed == popped && pushed > 100 * EventQueue::Capacity);
+	TEST_CHECK(queue.GetDroppedCount() == 0);
+}
+
+TEST_CASE(WindowCreate)
+{
+#if defined(BRICKENGINE_PLATFORM_LINUX)
+	if (!std::getenv("DISPLAY"))
+		TEST_SKIP("DISPLAY isn't set");
+#endif
+
+	std::unique_ptr<Window> window(Window::Create(320, 240, "BrickEngine Tests", false));
+	TEST_REQUIRE(window);
+	window->PollEvents();
+	TEST_CHECK(window->GetWidth() == 320 && window->GetHeight() == 240);
+	TEST_CHECK(!window->WantsToClose());
+
+	// Whatever the platform sent while mapping the window has to drain
+	Event event;
+	uint32_t count = 0;
+	while (window->PollEvent(event))
+		count++;
+	TEST_CHECK(count <= EventQueue::Capacity);
+}
+
+// Every way of reading a file reports the same error for the same failure
+static void CheckFileErrors(TestContext& test, const std::string& filepath, FileError expected)
+{
+	std::vector<char> data;
+	TEST_CHECK(File::LoadFile(filepath, data) == expected && data.empty());
+	FileView view;
+	TEST_CHECK(File::MapFile(filepath, view) == expected && view.GetSize() == 0);
+	// The size of a file without read permission can still be queried
+	uint64_t size = 0;
+	if (expected != FileError::AccessDenied)
+		TEST_CHECK(File::GetFileSize(filepath, size) == expected);
+	char buffer[16];
+	size_t bytesRead = 0;
+	TEST_CHECK(File::ReadFileRange(filepath, 0, buffer, sizeof(buffer), bytesRead) == expected && bytesRead == 0);
+
+	AsyncFileHandle request = AsyncFile::Load(filepath);
+	request->Wait();
+	TEST_CHECK(request->GetStatus() == AsyncFileStatus::Failed && request->GetError() == expected);
+}
+
+TEST_CASE(FileErrors)
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "BrickEngineFileErrors";
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	TEST_REQUIRE(std::filesystem::create_directories(directory / "Folder", error));
+
+	CheckFileErrors(test, (directory / "Missing.bin").string(), FileError::NotFound);
+	CheckFileErrors(test, (directory / "Missing" / "File.bin").string(), FileError::NotFound);
+	CheckFileErrors(test, (directory / "Folder").string(), FileError::IsDirectory);
+
+	// Only testable without the privileges that ignore permissions
+	std::string lockedFilepath = (directory / "Locked.bin").string();
+	TEST_REQUIRE(File::WriteFile(lockedFilepath, "data", 4) == FileError::None);
+	std::filesystem::permissions(lockedFilepath, std::filesystem::perms::none, error);
+	if (!std::ifstream(lockedFilepath).is_open())
+		CheckFileErrors(test, lockedFilepath, FileError::AccessDenied);
+
+	std::filesystem::permissions(lockedFilepath, std::filesystem::perms::owner_all, error);
+	std::filesystem::remove_all(directory, error);
+}
+
+// Writers racing on one path each rename a complete file of their own over it, nothing torn or left behind
+TEST_CASE(FileWriteConcurrent)
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "BrickEngineFileWrite";
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	TEST_REQUIRE(std::filesystem::create_directories(directory, error));
+	std::string filepath = (directory / "pipeline_cache.bin").string();
+
+	const uint32_t writerCount = 4;
+	std::atomic<uint32_t> failures = 0;
+	std::vector<std::thread> writers;
+	for (uint32_t writer = 0; writer < writerCount; writer++)
+	{
+		writers.emplace_back([&, writer]()
+			{
+				std::vector<char> data(256 * 1024 + writer * 4096, static_cast<char>('a' + writer));
+				for (uint32_t i = 0; i < 20; i++)
+				{
+					if (File::WriteFile(filepath, data.data(), data.size()) != FileError::None)
+						failures++;
+				}
+			}
+		);
+	}
+	for (auto& writer : writers)
+		writer.join();
+	TEST_CHECK(failures == 0);
+
+	std::vector<char> data;
+	TEST_REQUIRE(File::LoadFile(filepath, data) == FileError::None && !data.empty());
+	uint32_t writer = static_cast<uint32_t>(data[0] - 'a');
+	TEST_CHECK(writer < writerCount && data.size() == 256 * 1024 + writer * 4096);
+	TEST_CHECK(std::all_of(data.begin(), data.end(), [&](char value) { return value == data[0]; }));
+
+	uint32_t fileCount = 0;
+	for (auto& entry : std::filesystem::directory_iterator(directory, error))
+		fileCount += entry.is_regular_file() ? 1 : 0;
+	TEST_CHECK(fileCount == 1);
+
+	std::filesystem::remove_all(directory, error);
+
+	// A path without a directory is written to the working directory
+	TEST_CHECK(File::WriteFile("BrickEngineFileWrite.bin", "data", 4) == FileError::None);
+	uint64_t size = 0;
+	TEST_CHECK(File::GetFileSize("BrickEngineFileWrite.bin", size) == FileError::None && size == 4);
+	std::filesystem::remove("BrickEngineFileWrite.bin", error);
+}
@@ -0,0 +1,70 @@
+#include "Test.hpp"
+
+using namespace BrickEngine;
+
+std::vector<TestCase>& GetTestCases()
+{
+	static std::vector<TestCase> testCases;
+	return testCases;
+}
+
+// Usage: Tests [name...] [--list]
+// Runs every test case whose name contains one of the given names, all of them when none are given. Returns 1 when any
+// of them failed.
+int main(int argc, char** argv)
+{
+	std::vector<std::string> filters;
+	bool list = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--list") == 0)
+			list = true;
+		else
+			filters.push_back(argv[i]);
+	}
+
+	std::vector<TestCase> testCases = GetTestCases();
+	std::sort(testCases.begin(), testCases.end(), [](const TestCase& a, const TestCase& b) { return strcmp(a.Name, b.Name) < 0; });
+	if (list)
+	{
+		for (auto& testCase : testCases)
+			std::printf("%s\n", testCase.Name);
+		return 0;
+	}
+
+	JobSystem::Init();
+
+	uint32_t passed = 0;
+	uint32_t failed = 0;
+	uint32_t skipped = 0;
+	for (auto& testCase : testCases)
+	{
+		bool selected = filters.empty() || std::any_of(filters.begin(), filters.end(), [&](const std::string& filter) { return strstr(testCase.Name, filter.c_str()) != nullptr; });
+		if (!selected)
+			continue;
+
+		std::printf("%s\n", testCase.Name);
+		std::fflush(stdout);
+
+		TestContext test;
+		testCase.Function(test);
+		if (test.GetFailureCount() > 0)
+		{
+			std::printf("  FAILED, %u check(s)\n", test.GetFailureCount());
+			failed++;
+		}
+		else if (test.GetSkipReason())
+		{
+			std::printf("  skipped, %s\n", test.GetSkipReason());
+			skipped++;
+		}
+		else
+			passed++;
+		std::fflush(stdout);
+	}
+
+	JobSystem::Shutdown();
+
+	std::printf("%u passed, %u failed, %u skipped\n", passed, failed, skipped);
+	return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <BrickEngine.hpp>
+
+// Passed to every test case, failed checks are reported and counted but the test keeps running
+class TestContext
+{
+public:
+	void Fail(const char* expression, const char* file, int line)
+	{
+		std::printf("    %s:%d: %s\n", file, line, expression);
+		m_FailureCount++;
+	}
+
+	void Skip(const char* reason) { m_SkipReason = reason; }
+
+	uint32_t GetFailureCount() const { return m_FailureCount; }
+	const char* GetSkipReason() const { return m_SkipReason; }
+private:
+	uint32_t m_FailureCount = 0;
+	const char* m_SkipReason = nullptr;
+};
+
+using TestFunction = void(*)(TestContext& test);
+
+struct TestCase
+{
+	const char* Name = nullptr;
+	TestFunction Function = nullptr;
+};
+
+// Test cases register themselves before main runs, in no particular order
+std::vector<TestCase>& GetTestCases();
+
+struct TestRegistration
+{
+	TestRegistration(const char* name, TestFunction function) { GetTestCases().push_back({ name, function }); }
+};
+
+#define TEST_CASE(name) \
+	static void CONCAT(Test, name)(TestContext& test); \
+	static TestRegistration CONCAT(s_Registration, name)(#name, &CONCAT(Test, name)); \
+	static void CONCAT(Test, name)(TestContext& test)
+
+#define TEST_CHECK(condition) do { if (!(condition)) test.Fail(#condition, __FILE__, __LINE__); } while (false)
+
+// Ends the test case when the condition fails, for checks the rest of the test depends on
+#define TEST_REQUIRE(condition) do { if (!(condition)) { test.Fail(#condition, __FILE__, __LINE__); return; } } while (false)
+
+#define TEST_SKIP(reason) do { test.Skip(reason); return; } while (false)
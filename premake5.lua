@@ -1,3 +1,28 @@
+newoption
+{
+	trigger = "pgo",
+	value = "PHASE",
+	description = "Profile guided optimization of the Dist configuration, see scripts/Linux-PGO.sh",
+	allowed =
+	{
+		{ "instrument", "Build instrumented binaries that write a profile when run" },
+		{ "use", "Optimize with the profile the instrumented binaries wrote" }
+	}
+}
+
+newoption
+{
+	trigger = "unity",
+	value = "FILES",
+	description = "Compile BrickEngine as jumbo translation units of up to FILES sources each (default 8)"
+}
+
+newoption
+{
+	trigger = "profiler",
+	description = "Compile the CPU and GPU profiler into the Dist configuration as well, Debug always has it"
+}
+
 workspace "GameEngineFromScratch"
 	architecture "x64"
 	startproject "Sandbox"
@@ -5,7 +30,8 @@ workspace "GameEngineFromScratch"
 	configurations
 	{
 		"Debug",
-		"Release"
+		"Release",
+		"Dist"
 	}
 	
 	flags
@@ -14,40 +40,144 @@ workspace "GameEngineFromScratch"
 	}
 
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
-	
-project "BrickEngine"
-	location "BrickEngine"
-	kind "StaticLib"
+pgodir = "%{wks.location}/bin-int/pgo"
+
+-- Unset when Vulkan comes from the distribution's packages, the headers and loader are in the system paths then.
+-- The Linux SDK uses lowercase directory names.
+vulkansdk = os.getenv("VULKAN_SDK")
+vulkanincludedir = vulkansdk and (vulkansdk .. (os.target() == "windows" and "/Include" or "/include"))
+vulkanlibdir = vulkansdk and (vulkansdk .. (os.target() == "windows" and "/Lib" or "/lib"))
+
+-- Includes the BrickEngine sources from generated files so the engine headers are parsed once per unit instead of once
+-- per source. Sources including Windows.h or Xlib are left alone, their macros would leak into the sources after them.
+-- Returns the generated units and the sources they replace.
+function generateunityfiles(sourcedir, filesperunit)
+	local groups = {}
+	local directories = {}
+	for _, source in ipairs(os.matchfiles(sourcedir .. "/BrickEngine/**.cpp")) do
+		local contents = io.readfile(source)
+		if not contents:find("#include <Windows.h>", 1, true) and not contents:find("#include <X11/", 1, true) then
+			local directory = path.getdirectory(path.getrelative(sourcedir, source))
+			if not groups[directory] then
+				groups[directory] = {}
+				table.insert(directories, directory)
+			end
+			table.insert(groups[directory], source)
+		end
+	end
+	table.sort(directories)
+
+	local unitdir = _MAIN_SCRIPT_DIR .. "/bin-int/unity/BrickEngine"
+	os.mkdir(unitdir)
+
+	local units = {}
+	local replaced = {}
+	for _, directory in ipairs(directories) do
+		local sources = groups[directory]
+		table.sort(sources)
+		for first = 1, #sources, filesperunit do
+			local lines = { "// Generated by premake5.lua", "#include \"brickpch.hpp\"" }
+			for i = first, math.min(first + filesperunit - 1, #sources) do
+				table.insert(lines, "#include \"" .. path.getrelative(sourcedir, sources[i]) .. "\"")
+				table.insert(replaced, sources[i])
+			end
+
+			local unit = unitdir .. "/" .. directory:gsub("/", "_") .. "_" .. math.floor((first - 1) / filesperunit + 1) .. ".cpp"
+			local contents = table.concat(lines, "\n") .. "\n"
+			-- Rewriting an unchanged unit would rebuild it
+			if io.readfile(unit) ~= contents then
+				io.writefile(unit, contents)
+			end
+			table.insert(units, unit)
+		end
+	end
+	return units, replaced
+end
+
+-- Dist is Release with link time optimization and without symbols, plus profile guided optimization when --pgo is given
+-- and the profiler when --profiler is.
+-- All projects of a PGO build have to share the phase, the profile covers the engine code linked into them.
+function distconfiguration()
+	filter "configurations:Dist"
+		defines "BRICKENGINE_DIST"
+		runtime "Release"
+		optimize "Speed"
+		symbols "off"
+		flags "LinkTimeOptimization"
+
+	-- Release never has the profiler, it's what the numbers the profiler shows are checked against
+	filter { "configurations:Dist", "options:profiler" }
+		defines "BRICKENGINE_ENABLE_PROFILER"
+
+	filter { "configurations:Dist", "options:pgo=instrument", "system:not windows" }
+		-- Atomic counters, the job system runs engine code on every core
+		buildoptions { "-fprofile-generate=" .. pgodir, "-fprofile-update=atomic" }
+		linkoptions { "-fprofile-generate=" .. pgodir }
+
+	filter { "configurations:Dist", "options:pgo=use", "system:not windows" }
+		if _OPTIONS["cc"] == "clang" then
+			-- Clang wants the raw profiles merged first, scripts/Linux-PGO.sh does that
+			buildoptions { "-fprofile-use=" .. pgodir .. "/default.profdata", "-Wno-profile-instr-unprofiled" }
+			linkoptions { "-fprofile-use=" .. pgodir .. "/default.profdata" }
+		else
+			buildoptions { "-fprofile-use=" .. pgodir, "-fprofile-partial-training", "-Wno-missing-profile" }
+		end
+
+	-- MSVC profiles per linked binary, the static library is optimized through the executables that link it
+	filter { "configurations:Dist", "options:pgo=instrument", "system:windows", "kind:ConsoleApp" }
+		linkoptions { "/GENPROFILE:PGD=" .. pgodir .. "/%{prj.name}.pgd" }
+
+	filter { "configurations:Dist", "options:pgo=use", "system:windows", "kind:ConsoleApp" }
+		linkoptions { "/USEPROFILE:PGD=" .. pgodir .. "/%{prj.name}.pgd" }
+
+	filter {}
+end
+
+-- Debug and Release as every project builds them, plus Dist
+function buildconfigurations()
+	filter "configurations:Debug"
+		defines { "BRICKENGINE_DEBUG", "BRICKENGINE_ENABLE_PROFILER", "BRICKENGINE_ENABLE_SHADER_HOT_RELOAD" }
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		defines "BRICKENGINE_RELEASE"
+		runtime "Release"
+		optimize "on"
+
+	distconfiguration()
+end
+
+-- Console application linking BrickEngine, built from the sources in its src directory. Only applications that render
+-- or open windows link Vulkan, shaderc and X11 on Linux, the others only pull the core out of the static library.
+function engineapplication(graphics)
+	kind "ConsoleApp"
 	language "C++"
 	cppdialect "C++17"
 	staticruntime "on"
-	
+
 	targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
 	objdir ("%{wks.location}/bin-int/" .. outputdir .. "/%{prj.name}")
 
-	pchheader "brickpch.hpp"
-	pchsource "%{prj.name}/src/brickpch.cpp"
-	
 	files
 	{
 		"%{wks.location}/%{prj.name}/src/**.hpp",
 		"%{wks.location}/%{prj.name}/src/**.cpp"
 	}
-	
+
 	includedirs
 	{
 		"%{wks.location}/%{prj.name}/src",
-		os.getenv("VULKAN_SDK") .. "/Include"
-	}
-	
-	links
-	{
-		os.getenv("VULKAN_SDK") .. "/Lib/vulkan-1.lib"
+		"%{wks.location}/BrickEngine/src"
 	}
 
-	defines
+	if vulkanincludedir then
+		includedirs { vulkanincludedir }
+	end
+
+	links
 	{
-		"_CRT_SECURE_NO_WARNINGS"
+		"BrickEngine"
 	}
 
 	filter "system:windows"
@@ -58,49 +188,70 @@ project "BrickEngine"
 			"BRICKENGINE_PLATFORM_WINDOWS"
 		}
 
-	filter "configurations:Debug"
-		defines "BRICKENGINE_DEBUG"
-		runtime "Debug"
-		symbols "on"
+	filter "system:linux"
+		defines
+		{
+			"BRICKENGINE_PLATFORM_LINUX"
+		}
 
-	filter "configurations:Release"
-		defines "BRICKENGINE_RELEASE"
-		runtime "Release"
-		optimize "on"
-		
-project "Sandbox"
-	location "Sandbox"
-	kind "ConsoleApp"
+		if graphics then
+			links
+			{
+				"vulkan",
+				"shaderc_shared",
+				"X11"
+			}
+
+			if vulkanlibdir then
+				libdirs { vulkanlibdir }
+			end
+		end
+
+		links
+		{
+			"pthread"
+		}
+
+	buildconfigurations()
+end
+	
+project "BrickEngine"
+	location "BrickEngine"
+	kind "StaticLib"
 	language "C++"
 	cppdialect "C++17"
 	staticruntime "on"
 	
 	targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
 	objdir ("%{wks.location}/bin-int/" .. outputdir .. "/%{prj.name}")
-	
-	pchheader "pch.hpp"
-	pchsource "%{prj.name}/src/pch.cpp"
 
+	pchheader "brickpch.hpp"
+	pchsource "%{prj.name}/src/brickpch.cpp"
+	
 	files
 	{
 		"%{wks.location}/%{prj.name}/src/**.hpp",
 		"%{wks.location}/%{prj.name}/src/**.cpp"
 	}
 	
-	includedirs
-	{
-		"%{wks.location}/%{prj.name}/src",
-		"%{wks.location}/BrickEngine/src",
-		os.getenv("VULKAN_SDK") .. "/Include"
-	}
+	if _OPTIONS["unity"] and _ACTION then
+		local units, replaced = generateunityfiles(_MAIN_SCRIPT_DIR .. "/BrickEngine/src", math.max(tonumber(_OPTIONS["unity"]) or 8, 1))
+		files(units)
+		removefiles(replaced)
+	end
 
-	links
+	includedirs
 	{
-		"BrickEngine"
+		"%{wks.location}/%{prj.name}/src"
 	}
+	
+	if vulkanincludedir then
+		includedirs { vulkanincludedir }
+	end
 
 	defines
 	{
+		"_CRT_SECURE_NO_WARNINGS"
 	}
 
 	filter "system:windows"
@@ -111,12 +262,46 @@ project "Sandbox"
 			"BRICKENGINE_PLATFORM_WINDOWS"
 		}
 
-	filter "configurations:Debug"
-		defines "BRICKENGINE_DEBUG"
-		runtime "Debug"
-		symbols "on"
+		-- shaderc behind a C interface, the static library would drag in a different C runtime
+		links
+		{
+			vulkanlibdir and (vulkanlibdir .. "/vulkan-1.lib") or "vulkan-1.lib",
+			vulkanlibdir and (vulkanlibdir .. "/shaderc_shared.lib") or "shaderc_shared.lib"
+		}
 
-	filter "configurations:Release"
-		defines "BRICKENGINE_RELEASE"
-		runtime "Release"
-		optimize "on"
+	filter "system:linux"
+		defines
+		{
+			"BRICKENGINE_PLATFORM_LINUX"
+		}
+
+	buildconfigurations()
+		
+project "Sandbox"
+	location "Sandbox"
+
+	pchheader "pch.hpp"
+	pchsource "%{prj.name}/src/pch.cpp"
+
+	engineapplication(true)
+
+project "AssetPacker"
+	location "AssetPacker"
+
+	engineapplication(false)
+
+project "Benchmarks"
+	location "Benchmarks"
+	-- The renderer benchmarks load the Sandbox shaders
+	debugdir "%{wks.location}/Sandbox"
+
+	engineapplication(true)
+
+project "Tests"
+	location "Tests"
+
+	engineapplication(false)
+
+	-- The window smoke test opens a window when there is a display
+	filter "system:linux"
+		links { "X11" }
@@ -1,4 +1,9 @@
 
-%VULKAN_SDK%\Bin\glslc.exe -fshader-stage=vert %~dp0\..\Sandbox\assets\shaders\main.vert.glsl -o %~dp0\..\Sandbox\assets\shaders\main.vert.spv
-%VULKAN_SDK%\Bin\glslc.exe -fshader-stage=frag %~dp0\..\Sandbox\assets\shaders\main.frag.glsl -o %~dp0\..\Sandbox\assets\shaders\main.frag.spv
+%VULKAN_SDK%\Bin\glslc.exe -fshader-stage=vert %~dp0\..\Sandbox\assets\shaders\sprite.vert.glsl -o %~dp0\..\Sandbox\assets\shaders\sprite.vert.spv
+%VULKAN_SDK%\Bin\glslc.exe -fshader-stage=frag %~dp0\..\Sandbox\assets\shaders\sprite.frag.glsl -o %~dp0\..\Sandbox\assets\shaders\sprite.frag.spv
+%VULKAN_SDK%\Bin\glslc.exe -fshader-stage=vert %~dp0\..\Sandbox\assets\shaders\sprite.vert.glsl -o %~dp0\..\Sandbox\assets\shaders\sprite_pooled.vert.spv
+%VULKAN_SDK%\Bin\glslc.exe -fshader-stage=frag -DBRICKENGINE_POOLED_DESCRIPTORS %~dp0\..\Sandbox\assets\shaders\sprite.frag.glsl -o %~dp0\..\Sandbox\assets\shaders\sprite_pooled.frag.spv
+%VULKAN_SDK%\Bin\glslc.exe -fshader-stage=vert %~dp0\..\Sandbox\assets\shaders\mesh.vert.glsl -o %~dp0\..\Sandbox\assets\shaders\mesh.vert.spv
+%VULKAN_SDK%\Bin\glslc.exe -fshader-stage=frag %~dp0\..\Sandbox\assets\shaders\mesh.frag.glsl -o %~dp0\..\Sandbox\assets\shaders\mesh.frag.spv
+%VULKAN_SDK%\Bin\glslc.exe -fshader-stage=comp %~dp0\..\Sandbox\assets\shaders\cull.comp.glsl -o %~dp0\..\Sandbox\assets\shaders\cull.comp.spv
 pause
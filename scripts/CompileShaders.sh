@@ -0,0 +1,12 @@
+#!/bin/sh
+set -e
+SHADERS="$(dirname "$0")/../Sandbox/assets/shaders"
+GLSLC=glslc
+[ -n "$VULKAN_SDK" ] && GLSLC="$VULKAN_SDK/bin/glslc"
+$GLSLC -fshader-stage=vert "$SHADERS/sprite.vert.glsl" -o "$SHADERS/sprite.vert.spv"
+$GLSLC -fshader-stage=frag "$SHADERS/sprite.frag.glsl" -o "$SHADERS/sprite.frag.spv"
+$GLSLC -fshader-stage=vert "$SHADERS/sprite.vert.glsl" -o "$SHADERS/sprite_pooled.vert.spv"
+$GLSLC -fshader-stage=frag -DBRICKENGINE_POOLED_DESCRIPTORS "$SHADERS/sprite.frag.glsl" -o "$SHADERS/sprite_pooled.frag.spv"
+$GLSLC -fshader-stage=vert "$SHADERS/mesh.vert.glsl" -o "$SHADERS/mesh.vert.spv"
+$GLSLC -fshader-stage=frag "$SHADERS/mesh.frag.glsl" -o "$SHADERS/mesh.frag.spv"
+$GLSLC -fshader-stage=comp "$SHADERS/cull.comp.glsl" -o "$SHADERS/cull.comp.spv"
@@ -0,0 +1,6 @@
+#!/bin/sh
+# Generates makefiles, extra premake options (--unity, --pgo, --cc=clang) are passed through
+cd "$(dirname "$0")/.."
+PREMAKE=premake5
+[ -x vendor/premake/premake5 ] && PREMAKE=vendor/premake/premake5
+$PREMAKE "$@" gmake2
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Profile guided Dist build: builds instrumented binaries, trains them on the headless Sandbox scenes and the
+# benchmarks, then rebuilds with the collected profile. Extra arguments go to premake, pass --cc=clang for clang.
+set -e
+cd "$(dirname "$0")/.."
+JOBS=$(nproc)
+BIN=bin/Dist-linux-x86_64
+
+rm -rf bin-int/pgo
+mkdir -p bin-int/pgo
+scripts/Linux-GenProjects.sh --pgo=instrument "$@"
+make config=dist clean
+make config=dist -j"$JOBS"
+
+# Training runs, the Sandbox assets are loaded relative to the working directory
+(
+	cd Sandbox
+	../$BIN/Sandbox/Sandbox --headless 300
+	../$BIN/Sandbox/Sandbox --sprite-benchmark --headless 120
+	../$BIN/Sandbox/Sandbox --meshes --headless 300
+	../$BIN/Benchmarks/Benchmarks --samples 5
+)
+
+case " $* " in
+	*" --cc=clang "*) llvm-profdata merge -output=bin-int/pgo/default.profdata bin-int/pgo/*.profraw ;;
+esac
+
+scripts/Linux-GenProjects.sh --pgo=use "$@"
+make config=dist clean
+make config=dist -j"$JOBS"
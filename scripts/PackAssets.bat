@@ -0,0 +1,5 @@
+
+pushd %~dp0\..\Sandbox
+call ..\bin\Release-windows-x86_64\AssetPacker\AssetPacker.exe assets.bpak assets --compress
+popd
+pause
@@ -0,0 +1,3 @@
+#!/bin/sh
+cd "$(dirname "$0")/../Sandbox"
+../bin/Release-linux-x86_64/AssetPacker/AssetPacker assets.bpak assets --compress